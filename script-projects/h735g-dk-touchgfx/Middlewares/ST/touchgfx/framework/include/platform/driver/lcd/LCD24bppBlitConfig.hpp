@@ -0,0 +1,59 @@
+/******************************************************************************
+* Copyright (c) 2018(-2021) STMicroelectronics.
+* All rights reserved.
+*
+* This file is part of the TouchGFX 4.18.1 distribution.
+*
+* This software is licensed under terms that can be found in the LICENSE file in
+* the root directory of this software component.
+* If no LICENSE file comes with this software, it is provided AS-IS.
+*
+*******************************************************************************/
+
+/**
+ * @file platform/driver/lcd/LCD24bppBlitConfig.hpp
+ *
+ * Selects the source formats drawn by the blit kernels of touchgfx::LCD24bppSpecialized.
+ *
+ * Each format set to 0, e.g. with -DLCD24BPP_BLIT_RGB565=0 on the compiler command line, is
+ * drawn by LCD24bpp instead, and no kernel is instantiated for it. Formats not used by the
+ * application should be disabled to keep the kernels out of flash. Formats of which the kernel
+ * does not beat LCD24bpp in the --blit-kernels benchmark default to 0.
+ */
+#ifndef TOUCHGFX_LCD24BPPBLITCONFIG_HPP
+#define TOUCHGFX_LCD24BPPBLITCONFIG_HPP
+
+/** Bitmaps in RGB565 drawn with a global alpha. */
+#ifndef LCD24BPP_BLIT_RGB565
+#define LCD24BPP_BLIT_RGB565 1
+#endif
+
+/** Bitmaps in RGB888, and blitCopy() of framebuffer data. */
+#ifndef LCD24BPP_BLIT_RGB888
+#define LCD24BPP_BLIT_RGB888 1
+#endif
+
+/** Bitmaps in ARGB8888. */
+#ifndef LCD24BPP_BLIT_ARGB8888
+#define LCD24BPP_BLIT_ARGB8888 1
+#endif
+
+/**
+ * L8 bitmaps with an RGB888 palette. Off by default, opaque bitmaps were drawn at 0.71x of
+ * LCD24bpp on some hosts, the kernel only gains with a global alpha.
+ */
+#ifndef LCD24BPP_BLIT_L8_RGB888
+#define LCD24BPP_BLIT_L8_RGB888 0
+#endif
+
+/** L8 bitmaps with an ARGB8888 palette. */
+#ifndef LCD24BPP_BLIT_L8_ARGB8888
+#define LCD24BPP_BLIT_L8_ARGB8888 1
+#endif
+
+/** Glyphs of fonts with 4 bits per pixel, drawn without text rotation. */
+#ifndef LCD24BPP_BLIT_A4
+#define LCD24BPP_BLIT_A4 1
+#endif
+
+#endif // TOUCHGFX_LCD24BPPBLITCONFIG_HPP
@@ -0,0 +1,559 @@
+/******************************************************************************
+* Copyright (c) 2018(-2021) STMicroelectronics.
+* All rights reserved.
+*
+* This file is part of the TouchGFX 4.18.1 distribution.
+*
+* This software is licensed under terms that can be found in the LICENSE file in
+* the root directory of this software component.
+* If no LICENSE file comes with this software, it is provided AS-IS.
+*
+*******************************************************************************/
+
+/**
+ * @file platform/driver/lcd/LCD24bppSpecialized.hpp
+ *
+ * Declares the touchgfx::LCD24bppSpecialized class.
+ */
+#ifndef TOUCHGFX_LCD24BPPSPECIALIZED_HPP
+#define TOUCHGFX_LCD24BPPSPECIALIZED_HPP
+
+#include <string.h>
+#include <platform/driver/lcd/LCD24bpp.hpp>
+#include <platform/driver/lcd/LCD24bppBlitConfig.hpp>
+#include <touchgfx/Bitmap.hpp>
+#include <touchgfx/hal/HAL.hpp>
+#include <touchgfx/hal/Types.hpp>
+#include <touchgfx/transforms/DisplayTransformation.hpp>
+
+namespace touchgfx
+{
+/**
+ * An LCD24bpp drawing bitmaps and glyphs in software with kernels specialized at compile
+ * time. Where LCD24bpp decides the source format and the alpha blending for every pixel, a
+ * kernel is instantiated for each combination, so the inner loops only do what the
+ * combination needs. Opaque RGB888 is copied a line at a time. Bitmaps for a rotated display
+ * are stored rotated, so the same kernels draw them in framebuffer coordinates. Glyphs of 4bpp
+ * fonts are drawn four pixels at a time, skipping transparent runs, when the DMA cannot draw
+ * them.
+ *
+ * Only the formats enabled in LCD24bppBlitConfig.hpp get kernels. Other formats, bitmaps and
+ * glyphs the DMA can draw, opaque RGB565, which LCD24bpp already draws faster, and rotated
+ * text are passed on to LCD24bpp, which hands the DMA capable drawing to the DMA. The output is the same as that of LCD24bpp, so it replaces the LCD24bpp
+ * instance given to the HAL, in TouchGFXHAL on the target and in the main of the simulator.
+ * Setting every format in LCD24bppBlitConfig.hpp to 0 draws as LCD24bpp does.
+ *
+ * @see LCD24bpp, LCD24bppBlitConfig.hpp
+ */
+class LCD24bppSpecialized : public LCD24bpp
+{
+public:
+    virtual void drawPartialBitmap(const Bitmap& bitmap, int16_t x, int16_t y, const Rect& rect, uint8_t alpha = 255, bool useOptimized = true)
+    {
+        const Rect bitmapRect(x, y, bitmap.getWidth(), bitmap.getHeight());
+        const Rect area = Rect(x + rect.x, y + rect.y, rect.width, rect.height) & bitmapRect;
+        const uint8_t* const data = bitmap.getData();
+        if (!blitBitmap(data, bitmap.getExtraData(), bitmap.getFormat(), bitmapRect, area, alpha))
+        {
+            LCD24bpp::drawPartialBitmap(bitmap, x, y, rect, alpha, useOptimized);
+        }
+    }
+
+    virtual void blitCopy(const uint16_t* sourceData, const Rect& source, const Rect& blitRect, uint8_t alpha, bool hasTransparentPixels)
+    {
+        const Rect area = Rect(source.x + blitRect.x, source.y + blitRect.y, blitRect.width, blitRect.height) & source;
+        if (!blitBitmap(reinterpret_cast<const uint8_t*>(sourceData), 0, Bitmap::RGB888, source, area, alpha))
+        {
+            LCD24bpp::blitCopy(sourceData, source, blitRect, alpha, hasTransparentPixels);
+        }
+    }
+
+    virtual void blitCopy(const uint8_t* sourceData, Bitmap::BitmapFormat sourceFormat, const Rect& source, const Rect& blitRect, uint8_t alpha, bool hasTransparentPixels)
+    {
+        const Rect area = Rect(source.x + blitRect.x, source.y + blitRect.y, blitRect.width, blitRect.height) & source;
+        // Only the formats without extra data can be given here
+        if ((sourceFormat != Bitmap::RGB565 && sourceFormat != Bitmap::RGB888 && sourceFormat != Bitmap::ARGB8888)
+            || !blitBitmap(sourceData, 0, sourceFormat, source, area, alpha))
+        {
+            LCD24bpp::blitCopy(sourceData, sourceFormat, source, blitRect, alpha, hasTransparentPixels);
+        }
+    }
+
+protected:
+    virtual void drawGlyph(uint16_t* wbuf16, Rect widgetArea, int16_t x, int16_t y, uint16_t offsetX, uint16_t offsetY, const Rect& invalidatedArea, const GlyphNode* glyph, const uint8_t* glyphData, uint8_t byteAlignRow, colortype color, uint8_t bitsPerPixel, uint8_t alpha, TextRotation rotation)
+    {
+#if LCD24BPP_BLIT_A4
+        // LCD24bpp draws 4bpp glyphs with the DMA when it can, e.g. ChromART on the target
+        if (bitsPerPixel == 4 && rotation == TEXT_ROTATE_0 && HAL::DISPLAY_ROTATION == rotate0 && !(HAL::getInstance()->getBlitCaps() & BLIT_OP_COPY_A4))
+        {
+            // x is offsetX right of the pen position, and the glyph data starts glyph->left right
+            // of the pen. Like LCD24bpp, columns are clipped to the invalidated area and to x
+            // when offsetX is set, lines are skipped by offsetY and clipped at the bottom.
+            const int16_t glyphX = x - offsetX + glyph->left;
+            const int16_t clipLeft = offsetX > 0 ? MAX(x, invalidatedArea.x) : invalidatedArea.x;
+            const int16_t skipX = MAX(clipLeft - glyphX, 0);
+            const int16_t width = MIN(glyph->width(), invalidatedArea.right() - glyphX) - skipX;
+            const int16_t height = MIN(glyph->height() - offsetY, invalidatedArea.bottom() - y);
+            if (width <= 0 || height <= 0 || alpha == 0)
+            {
+                return;
+            }
+            const uint16_t pitch = byteAlignRow ? (glyph->width() + 1) & ~1 : glyph->width();
+            uint8_t* const dst = reinterpret_cast<uint8_t*>(HAL::getInstance()->lockFrameBuffer()) + (widgetArea.y + y) * getFramebufferStride() + (widgetArea.x + glyphX + skipX) * 3;
+            const uint32_t firstNibble = offsetY * pitch + skipX;
+            if (alpha == 0xFF)
+            {
+                glyphKernelA4<false>(dst, glyphData, firstNibble, width, height, pitch, color, alpha);
+            }
+            else
+            {
+                glyphKernelA4<true>(dst, glyphData, firstNibble, width, height, pitch, color, alpha);
+            }
+            HAL::getInstance()->unlockFrameBuffer();
+            return;
+        }
+#endif
+        LCD24bpp::drawGlyph(wbuf16, widgetArea, x, y, offsetX, offsetY, invalidatedArea, glyph, glyphData, byteAlignRow, color, bitsPerPixel, alpha, rotation);
+    }
+
+    /** Reads RGB565 pixels. Like LCD24bpp, the alpha channel of RGB565 bitmaps is not used. */
+    class ReadRGB565
+    {
+    public:
+        static const bool HAS_ALPHA = false;
+
+        ReadRGB565(const uint8_t* data, const uint8_t* /*extraData*/)
+            : pixels(reinterpret_cast<const uint16_t*>(data))
+        {
+        }
+
+        FORCE_INLINE_FUNCTION uint32_t operator[](int32_t index) const
+        {
+            return expand565(pixels[index]);
+        }
+
+    private:
+        const uint16_t* pixels;
+    };
+
+    /** Reads RGB888 pixels, stored blue first like the framebuffer. */
+    class ReadRGB888
+    {
+    public:
+        static const bool HAS_ALPHA = false;
+
+        ReadRGB888(const uint8_t* data, const uint8_t* /*extraData*/)
+            : pixels(data)
+        {
+        }
+
+        FORCE_INLINE_FUNCTION uint32_t operator[](int32_t index) const
+        {
+            const uint8_t* const p = pixels + index * 3;
+            return (p[2] << 16) | (p[1] << 8) | p[0];
+        }
+
+        const uint8_t* address(int32_t index) const
+        {
+            return pixels + index * 3;
+        }
+
+    private:
+        const uint8_t* pixels;
+    };
+
+    /** Reads ARGB8888 pixels. */
+    class ReadARGB8888
+    {
+    public:
+        static const bool HAS_ALPHA = true;
+
+        ReadARGB8888(const uint8_t* data, const uint8_t* /*extraData*/)
+            : pixels(reinterpret_cast<const uint32_t*>(data))
+        {
+        }
+
+        FORCE_INLINE_FUNCTION uint32_t operator[](int32_t index) const
+        {
+            return pixels[index];
+        }
+
+    private:
+        const uint32_t* pixels;
+    };
+
+    /** Reads L8 pixels through an RGB888 palette. */
+    class ReadL8RGB888
+    {
+    public:
+        static const bool HAS_ALPHA = false;
+
+        ReadL8RGB888(const uint8_t* data, const uint8_t* extraData)
+            : indices(data), palette(extraData + 4)
+        {
+        }
+
+        FORCE_INLINE_FUNCTION uint32_t operator[](int32_t index) const
+        {
+            const uint8_t* const p = palette + indices[index] * 3;
+            return (p[2] << 16) | (p[1] << 8) | p[0];
+        }
+
+    private:
+        const uint8_t* indices;
+        const uint8_t* palette;
+    };
+
+    /** Reads L8 pixels through an ARGB8888 palette. */
+    class ReadL8ARGB8888
+    {
+    public:
+        static const bool HAS_ALPHA = true;
+
+        ReadL8ARGB8888(const uint8_t* data, const uint8_t* extraData)
+            : indices(data), palette(reinterpret_cast<const uint32_t*>(extraData + 4))
+        {
+        }
+
+        FORCE_INLINE_FUNCTION uint32_t operator[](int32_t index) const
+        {
+            return palette[indices[index]];
+        }
+
+    private:
+        const uint8_t* indices;
+        const uint32_t* palette;
+    };
+
+    /**
+     * Draws pixels of a source into the framebuffer.
+     *
+     * @tparam Source       The reader of the source pixels.
+     * @tparam GLOBAL_ALPHA True if the pixels are blended with a global alpha below 255.
+     *
+     * @param  dst       The first framebuffer pixel.
+     * @param  source    The source.
+     * @param  first     Index of the source pixel drawn at dst.
+     * @param  width     Number of pixels on each framebuffer line.
+     * @param  height    Number of framebuffer lines.
+     * @param  lineStep  Source index step between framebuffer lines.
+     * @param  alpha     The global alpha.
+     */
+    template <class Source, bool GLOBAL_ALPHA>
+    static void blitKernel(uint8_t* dst, const Source& source, int32_t first, int16_t width, int16_t height, int32_t lineStep, uint8_t alpha)
+    {
+        if (!GLOBAL_ALPHA && copyLines(dst, source, first, width, height, lineStep))
+        {
+            return;
+        }
+        const uint32_t stride = getFramebufferStride();
+        for (int16_t line = 0; line < height; line++, dst += stride, first += lineStep)
+        {
+            uint8_t* d = dst;
+            int32_t index = first;
+            for (int16_t n = 0; n < width; n++, d += 3, index++)
+            {
+                const uint32_t color = source[index];
+                if (!Source::HAS_ALPHA && !GLOBAL_ALPHA)
+                {
+                    d[0] = (uint8_t)color;
+                    d[1] = (uint8_t)(color >> 8);
+                    d[2] = (uint8_t)(color >> 16);
+                    continue;
+                }
+                uint8_t a = Source::HAS_ALPHA ? (uint8_t)(color >> 24) : alpha;
+                if (Source::HAS_ALPHA && GLOBAL_ALPHA)
+                {
+                    a = LCD::div255(a * alpha);
+                }
+                if (Source::HAS_ALPHA)
+                {
+                    if (a == 0)
+                    {
+                        continue;
+                    }
+                    if (a == 0xFF)
+                    {
+                        d[0] = (uint8_t)color;
+                        d[1] = (uint8_t)(color >> 8);
+                        d[2] = (uint8_t)(color >> 16);
+                        continue;
+                    }
+                }
+                blendPixel(d, color, a);
+            }
+        }
+    }
+
+    /**
+     * Copies whole lines of a source in the framebuffer format. Only done for RGB888 sources.
+     *
+     * @return False, the lines must be drawn pixel by pixel.
+     */
+    template <class Source>
+    FORCE_INLINE_FUNCTION static bool copyLines(uint8_t* /*dst*/, const Source& /*source*/, int32_t /*first*/, int16_t /*width*/, int16_t /*height*/, int32_t /*lineStep*/)
+    {
+        return false;
+    }
+
+    /**
+     * Copies whole lines of an RGB888 source, which is in the framebuffer format.
+     *
+     * @param  dst      The first framebuffer pixel.
+     * @param  source   The source.
+     * @param  first    Index of the source pixel copied to dst.
+     * @param  width    Number of pixels on each line.
+     * @param  height   Number of lines.
+     * @param  lineStep Source index step between lines.
+     *
+     * @return True.
+     */
+    static bool copyLines(uint8_t* dst, const ReadRGB888& source, int32_t first, int16_t width, int16_t height, int32_t lineStep)
+    {
+        const uint32_t stride = getFramebufferStride();
+        for (int16_t line = 0; line < height; line++, dst += stride, first += lineStep)
+        {
+            memcpy(dst, source.address(first), width * 3);
+        }
+        return true;
+    }
+
+    /**
+     * Draws an area of a source with the kernel of its format and alpha.
+     *
+     * @tparam Source The reader of the source pixels.
+     *
+     * @param  data       The source pixels.
+     * @param  extraData  The alpha channel or palette of the source.
+     * @param  sourceRect The position and size of the whole source on the display.
+     * @param  area       The area to draw, inside sourceRect.
+     * @param  alpha      The global alpha.
+     */
+    template <class Source>
+    static void blitArea(const uint8_t* data, const uint8_t* extraData, const Rect& sourceRect, const Rect& area, uint8_t alpha)
+    {
+        const Source source(data, extraData);
+        // Bitmaps for a rotated display are stored rotated, so the source is walked in framebuffer coordinates
+        Rect fbSource = sourceRect;
+        Rect fbArea = area;
+        DisplayTransformation::transformDisplayToFrameBuffer(fbSource);
+        DisplayTransformation::transformDisplayToFrameBuffer(fbArea);
+        uint8_t* const dst = reinterpret_cast<uint8_t*>(HAL::getInstance()->lockFrameBuffer()) + fbArea.y * getFramebufferStride() + fbArea.x * 3;
+        const int32_t first = (fbArea.y - fbSource.y) * fbSource.width + (fbArea.x - fbSource.x);
+        if (alpha == 0xFF)
+        {
+            blitKernel<Source, false>(dst, source, first, fbArea.width, fbArea.height, fbSource.width, alpha);
+        }
+        else
+        {
+            blitKernel<Source, true>(dst, source, first, fbArea.width, fbArea.height, fbSource.width, alpha);
+        }
+        HAL::getInstance()->unlockFrameBuffer();
+    }
+
+    /**
+     * Draws an area of a source if a kernel is enabled for its format and the DMA is not
+     * able to draw it.
+     *
+     * @param  data       The source pixels.
+     * @param  extraData  The alpha channel or palette of the source, or 0.
+     * @param  format     The format of the source.
+     * @param  sourceRect The position and size of the whole source on the display.
+     * @param  area       The area to draw.
+     * @param  alpha      The global alpha.
+     *
+     * @return True if the area was drawn, false if it must be drawn by LCD24bpp.
+     */
+    static bool blitBitmap(const uint8_t* data, const uint8_t* extraData, Bitmap::BitmapFormat format, const Rect& sourceRect, const Rect& area, uint8_t alpha)
+    {
+        if (alpha == 0 || area.isEmpty())
+        {
+            return true;
+        }
+        const BlitOperations caps = HAL::getInstance()->getBlitCaps();
+        switch (format)
+        {
+#if LCD24BPP_BLIT_RGB565
+        case Bitmap::RGB565:
+            if (alpha == 0xFF || (caps & BLIT_OP_COPY_WITH_ALPHA))
+            {
+                return false;
+            }
+            blitArea<ReadRGB565>(data, extraData, sourceRect, area, alpha);
+            return true;
+#endif
+#if LCD24BPP_BLIT_RGB888
+        case Bitmap::RGB888:
+            if (caps & (alpha == 0xFF ? BLIT_OP_COPY : BLIT_OP_COPY_WITH_ALPHA))
+            {
+                return false;
+            }
+            blitArea<ReadRGB888>(data, extraData, sourceRect, area, alpha);
+            return true;
+#endif
+#if LCD24BPP_BLIT_ARGB8888
+        case Bitmap::ARGB8888:
+            if (caps & (alpha == 0xFF ? BLIT_OP_COPY_ARGB8888 : BLIT_OP_COPY_ARGB8888_WITH_ALPHA))
+            {
+                return false;
+            }
+            blitArea<ReadARGB8888>(data, extraData, sourceRect, area, alpha);
+            return true;
+#endif
+        case Bitmap::L8:
+            if (caps & BLIT_OP_COPY_L8)
+            {
+                return false;
+            }
+            switch ((Bitmap::ClutFormat)(*reinterpret_cast<const uint16_t*>(extraData)))
+            {
+#if LCD24BPP_BLIT_L8_RGB888
+            case Bitmap::CLUT_FORMAT_L8_RGB888:
+                blitArea<ReadL8RGB888>(data, extraData, sourceRect, area, alpha);
+                return true;
+#endif
+#if LCD24BPP_BLIT_L8_ARGB8888
+            case Bitmap::CLUT_FORMAT_L8_ARGB8888:
+                blitArea<ReadL8ARGB8888>(data, extraData, sourceRect, area, alpha);
+                return true;
+#endif
+            default:
+                return false;
+            }
+        default:
+            return false;
+        }
+    }
+
+    /**
+     * Draws a 4bpp glyph into the framebuffer, four pixels at a time where the glyph data
+     * allows it. Two bytes of glyph data are unpacked into four 8 bit coverages in one word,
+     * four transparent pixels are skipped and four solid pixels are written as three words.
+     * The pixels in between are blended with red and blue in one word.
+     *
+     * @tparam GLOBAL_ALPHA True if the glyph is blended with a global alpha below 255.
+     *
+     * @param  dst         The first framebuffer pixel.
+     * @param  data        The glyph data, two pixels in each byte, the first in the low nibble.
+     * @param  firstNibble Index of the glyph pixel drawn at dst.
+     * @param  width       Number of pixels on each line.
+     * @param  height      Number of lines.
+     * @param  pitch       Number of glyph pixels between lines.
+     * @param  color       The color of the glyph as 0x00RRGGBB.
+     * @param  alpha       The global alpha.
+     */
+    template <bool GLOBAL_ALPHA>
+    static void glyphKernelA4(uint8_t* dst, const uint8_t* data, uint32_t firstNibble, int16_t width, int16_t height, uint16_t pitch, uint32_t color, uint8_t alpha)
+    {
+        const uint32_t colorRB = color & 0xFF00FF;
+        const uint32_t colorG = color & 0x00FF00;
+        // Four solid pixels, the bytes of the color repeated over three words
+        uint8_t solid[12];
+        for (int i = 0; i < 12; i += 3)
+        {
+            solid[i] = (uint8_t)color;
+            solid[i + 1] = (uint8_t)(color >> 8);
+            solid[i + 2] = (uint8_t)(color >> 16);
+        }
+        const uint32_t stride = getFramebufferStride();
+        for (int16_t line = 0; line < height; line++, dst += stride, firstNibble += pitch)
+        {
+            uint8_t* d = dst;
+            uint32_t nibble = firstNibble;
+            int16_t left = width;
+            // Single pixels up to a byte boundary of the glyph data
+            if ((nibble & 1) && left > 0)
+            {
+                blendGlyphPixel<GLOBAL_ALPHA>(d, (data[nibble >> 1] >> 4) * 0x11, colorRB, colorG, alpha);
+                d += 3;
+                nibble++;
+                left--;
+            }
+            for (; left >= 4; left -= 4, d += 12, nibble += 4)
+            {
+                const uint8_t* const p = data + (nibble >> 1);
+                const uint32_t packed = p[0] | (p[1] << 8);
+                if (packed == 0)
+                {
+                    continue;
+                }
+                if (!GLOBAL_ALPHA && packed == 0xFFFF)
+                {
+                    memcpy(d, solid, 12);
+                    continue;
+                }
+                // Spread the nibbles to bytes, 0xF becomes 0xFF
+                const uint32_t coverage = ((packed & 0x000F) | ((packed & 0x00F0) << 4) | ((packed & 0x0F00) << 8) | ((packed & 0xF000) << 12)) * 0x11;
+                blendGlyphPixel<GLOBAL_ALPHA>(d, (uint8_t)coverage, colorRB, colorG, alpha);
+                blendGlyphPixel<GLOBAL_ALPHA>(d + 3, (uint8_t)(coverage >> 8), colorRB, colorG, alpha);
+                blendGlyphPixel<GLOBAL_ALPHA>(d + 6, (uint8_t)(coverage >> 16), colorRB, colorG, alpha);
+                blendGlyphPixel<GLOBAL_ALPHA>(d + 9, (uint8_t)(coverage >> 24), colorRB, colorG, alpha);
+            }
+            for (; left > 0; left--, d += 3, nibble++)
+            {
+                blendGlyphPixel<GLOBAL_ALPHA>(d, ((data[nibble >> 1] >> ((nibble & 1) * 4)) & 0xF) * 0x11, colorRB, colorG, alpha);
+            }
+        }
+    }
+
+    /**
+     * Blends the color of a glyph into a framebuffer pixel.
+     *
+     * @tparam GLOBAL_ALPHA True if the coverage is scaled by a global alpha.
+     *
+     * @param [in,out] d        The framebuffer pixel.
+     * @param          coverage The coverage of the pixel by the glyph.
+     * @param          colorRB  The red and blue components of the color, as 0x00RR00BB.
+     * @param          colorG   The green component of the color, as 0x0000GG00.
+     * @param          alpha    The global alpha.
+     */
+    template <bool GLOBAL_ALPHA>
+    FORCE_INLINE_FUNCTION static void blendGlyphPixel(uint8_t* d, uint8_t coverage, uint32_t colorRB, uint32_t colorG, uint8_t alpha)
+    {
+        const uint8_t a = GLOBAL_ALPHA ? LCD::div255(coverage * alpha) : coverage;
+        if (a == 0)
+        {
+            return;
+        }
+        const uint8_t ia = 0xFF - a;
+        const uint32_t rb = LCD::div255rb(colorRB * a + ((d[2] << 16) | d[0]) * ia);
+        const uint32_t g = LCD::div255g(colorG * a + (d[1] << 8) * ia);
+        d[0] = (uint8_t)rb;
+        d[1] = (uint8_t)(g >> 8);
+        d[2] = (uint8_t)(rb >> 16);
+    }
+
+    /**
+     * Expands an RGB565 color to 0x00RRGGBB, repeating the top bits of each component.
+     *
+     * @param  color The RGB565 color.
+     *
+     * @return The RGB888 color.
+     */
+    FORCE_INLINE_FUNCTION static uint32_t expand565(uint16_t color)
+    {
+        const uint32_t red = (color >> 8) & 0xF8;
+        const uint32_t green = (color >> 3) & 0xFC;
+        const uint32_t blue = (color << 3) & 0xF8;
+        return ((red | (red >> 5)) << 16) | ((green | (green >> 6)) << 8) | (blue | (blue >> 5));
+    }
+
+    /**
+     * Blends a color into a framebuffer pixel.
+     *
+     * @param [in,out] d     The framebuffer pixel.
+     * @param          color The color as 0x00RRGGBB, the top byte is ignored.
+     * @param          a     The alpha of the color.
+     */
+    FORCE_INLINE_FUNCTION static void blendPixel(uint8_t* d, uint32_t color, uint8_t a)
+    {
+        const uint8_t ia = 0xFF - a;
+        d[0] = LCD::div255((color & 0xFF) * a + d[0] * ia);
+        d[1] = LCD::div255(((color >> 8) & 0xFF) * a + d[1] * ia);
+        d[2] = LCD::div255(((color >> 16) & 0xFF) * a + d[2] * ia);
+    }
+};
+
+} // namespace touchgfx
+
+#endif // TOUCHGFX_LCD24BPPSPECIALIZED_HPP
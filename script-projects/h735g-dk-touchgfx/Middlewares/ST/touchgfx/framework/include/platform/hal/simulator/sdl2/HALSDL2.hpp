@@ -67,7 +67,13 @@ public:
           isWindowVisible(true),
           isConsoleVisible(true),
           printFile(0),
-          windowDrag(false)
+          windowDrag(false),
+          headlessFrames(0),
+          headlessInput(0),
+          headlessReport(0),
+          headlessFrameFolder(0),
+          headlessCommandFrame(0),
+          headlessLine(0)
     {
         setVsyncInterval(30.f); // Simulate 20Hz per default for backward compatibility
         updateCurrentSkin();
@@ -77,7 +83,8 @@ public:
      * Main event loop. Will wait for VSYNC signal, and then process next frame. Call this
      * function from your GUI task.
      *
-     * @note This function never returns!
+     * @note This function only returns when the simulator is closed, or after drawing the
+     *       frames asked for by setHeadless().
      */
     virtual void taskEntry();
 
@@ -107,6 +114,17 @@ public:
      */
     virtual void flushFrameBuffer(const Rect& rect);
 
+    /**
+     * Locks the framebuffer, unless the calling thread draws tiles of a frame for which
+     * TileRenderer already holds the lock.
+     *
+     * @return A pointer to the beginning of the currently used framebuffer.
+     */
+    virtual uint16_t* lockFrameBuffer();
+
+    /** Unlocks the framebuffer, unless TileRenderer holds the lock for the calling thread. */
+    virtual void unlockFrameBuffer();
+
     /**
      * Sets vsync interval for simulating same tick speed as the real hardware. Due to
      * limitations in the granularity of SDL, the generated ticks in the simulator might not
@@ -128,6 +146,44 @@ public:
      */
     void setVsyncInterval(float ms);
 
+    /**
+     * Runs the simulator without a window, e.g. in a continuous integration build. Instead of
+     * waiting for vsync, taskEntry() draws a number of frames as fast as possible, one tick
+     * per frame, and returns. Touch and key input is read from a script, so the frames drawn
+     * only depend on the script. Must be called before sdl_init().
+     *
+     * The script has a command per line, prefixed by the frame it applies to, e.g. "10 touch
+     * 100 50" to press or drag at display coordinates (100,50), "12 release", "20 key 65" to
+     * press the key with code 65 and "200 quit". Empty lines and lines starting with '#' are
+     * ignored.
+     *
+     * Every frame, the hash of the framebuffer shown on the display and the time spent in
+     * backPorchExited() are written to the report as "frame hash microseconds". The first two
+     * columns only depend on the script and can be compared with a golden report. Frames
+     * different from the previous frame are saved as bitmaps named frame_000042.bmp.
+     *
+     * @param  frames      Number of frames to draw, 0 to draw until the last command of the
+     *                     script.
+     * @param  inputScript (Optional) The script, null for no input.
+     * @param  report      (Optional) The report file, null for no report.
+     * @param  frameFolder (Optional) The folder to save frames in, null to not save frames.
+     *
+     * @return True if the files could be opened and there are frames to draw, false otherwise.
+     */
+    bool setHeadless(uint32_t frames, const char* inputScript = 0, const char* report = 0, const char* frameFolder = 0);
+
+    /**
+     * Is the simulator running without a window?
+     *
+     * @return True if setHeadless() has been called, false otherwise.
+     *
+     * @see setHeadless
+     */
+    static bool isHeadless()
+    {
+        return headless;
+    }
+
     /**
      * Samples the position of the mouse cursor.
      *
@@ -263,6 +319,20 @@ public:
      */
     static uint8_t* scaleTo24bpp(uint16_t* src, Bitmap::BitmapFormat format);
 
+    /**
+     * Scale an area of the framebuffer to 24bpp. Only the pixels inside the area are
+     * converted, the rest of the result is left as converted by earlier calls.
+     *
+     * @param [in]  src    The framebuffer.
+     * @param       format Describes the format of the framebuffer (lcd().framebufferFormat()).
+     * @param       area   The area to convert, in framebuffer coordinates.
+     *
+     * @return Null if it fails, else a pointer to an uint8_t.
+     *
+     * @see scaleTo24bpp(uint16_t*,Bitmap::BitmapFormat)
+     */
+    static uint8_t* scaleTo24bpp(uint16_t* src, Bitmap::BitmapFormat format, const Rect& area);
+
     /**
      * Rotates a framebuffer if the display is rotated.
      *
@@ -272,6 +342,17 @@ public:
      */
     static uint8_t* doRotate(uint8_t* src);
 
+    /**
+     * Rotates an area of a framebuffer if the display is rotated. Only the pixels inside
+     * the area are rotated.
+     *
+     * @param [in]  src  The framebuffer.
+     * @param       area The area to rotate, in display coordinates.
+     *
+     * @return Null if it fails, else a pointer to an uint8_t.
+     */
+    static uint8_t* doRotate(uint8_t* src, const Rect& area);
+
     /**
      * Change visibility of window (hidden vs. shown) as well as (due to
      * backward compatibility) the visibility of the console window.
@@ -430,6 +511,10 @@ private:
     void updateCurrentSkin();
     int getCurrentSkinX() const;
     int getCurrentSkinY() const;
+    void headlessTaskEntry();
+    void readHeadlessCommand();
+    void runHeadlessCommand();
+    void saveHeadlessFrame(uint32_t frame);
 
     static bool debugInfoEnabled;
 
@@ -471,6 +556,16 @@ private:
     int windowDragX;
     int windowDragY;
 
+    static bool headless;
+    static bool headlessFrameChanged;
+    uint32_t headlessFrames;
+    FILE* headlessInput;
+    FILE* headlessReport;
+    const char* headlessFrameFolder;
+    uint32_t headlessCommandFrame;
+    uint32_t headlessLine;
+    char headlessCommand[200];
+
     static int32_t _xMouse;
     static int32_t _yMouse;
     static int32_t _x;
@@ -0,0 +1,170 @@
+/******************************************************************************
+* Copyright (c) 2018(-2021) STMicroelectronics.
+* All rights reserved.
+*
+* This file is part of the TouchGFX 4.18.1 distribution.
+*
+* This software is licensed under terms that can be found in the LICENSE file in
+* the root directory of this software component.
+* If no LICENSE file comes with this software, it is provided AS-IS.
+*
+*******************************************************************************/
+
+/**
+ * @file platform/hal/simulator/sdl2/TileRenderer.hpp
+ *
+ * Declares the touchgfx::TileRenderer class.
+ */
+#ifndef TOUCHGFX_TILERENDERER_HPP
+#define TOUCHGFX_TILERENDERER_HPP
+
+#include <touchgfx/Callback.hpp>
+#include <touchgfx/hal/Types.hpp>
+
+namespace touchgfx
+{
+class Container;
+
+/**
+ * Optional parallel rendering for the simulator. The areas to draw are split into tiles on a
+ * grid, and the tiles are distributed between a number of workers, balancing the number of
+ * pixels each worker draws. Tiles are disjoint, so the workers never touch the same pixel.
+ *
+ * The first worker is the thread calling render(), the others are threads started once and
+ * kept waiting for the next frame. Every thread draws with a CanvasWidgetRenderer::Context
+ * and buffer of its own. The framebuffer is locked by render() for the whole frame, and
+ * HALSDL2 does not lock it again for the threads drawing tiles. The tiles are drawn with the
+ * painter's algorithm by drawContainer(), as JSMOC links the drawables of an area into a
+ * draw chain kept in the drawables themselves, which threads drawing different areas would
+ * overwrite. Only the plain widgets of the framework are drawn in parallel, every other
+ * drawable, e.g. a canvas widget with its painter or a widget with a cache, is drawn by one
+ * thread at a time.
+ *
+ * Frames are drawn the normal way when there is a single hardware thread, and when the
+ * BitmapCache is in use.
+ *
+ * In verify mode the frame is also drawn the normal way and compared with the tiled frame,
+ * which measures the actual speedup and catches widgets drawing differently when clipped to
+ * a tile or drawn in parallel.
+ *
+ * @see HALSDL2
+ */
+class TileRenderer
+{
+public:
+    /** Timing and correctness of the frames drawn since the statistics were last reset. */
+    struct Statistics
+    {
+        uint32_t frames;           ///< Number of frames drawn
+        uint32_t tiles;            ///< Number of tiles drawn
+        uint64_t wallNs;           ///< Time spent drawing tiled frames, including composition
+        uint64_t workerNs;         ///< Time spent by all workers drawing tiles
+        uint64_t serialNs;         ///< Time spent drawing the frames the normal way, only in verify mode
+        uint32_t mismatchedFrames; ///< Number of tiled frames differing from the normal frame, only in verify mode
+    };
+
+    /**
+     * Sets the number of workers. A single worker disables tiled rendering. The threads of
+     * the workers are started when the next frame is drawn.
+     * @param  numberOfWorkers The number of workers, including the thread calling render().
+     */
+    static void setWorkers(uint16_t numberOfWorkers);
+
+    /**
+     * Gets the number of workers.
+     * @return The number of workers.
+     */
+    static uint16_t getWorkers()
+    {
+        return workers;
+    }
+
+    /**
+     * Sets the size of the tiles.
+     * @param  width  The tile width.
+     * @param  height The tile height.
+     */
+    static void setTileSize(uint16_t width, uint16_t height);
+
+    /**
+     * Enable or disable verify mode, where each frame is also drawn without tiles and
+     * compared.
+     * @param  enable True to verify each frame.
+     */
+    static void setVerify(bool enable)
+    {
+        verify = enable;
+    }
+
+    /**
+     * Sets how often the statistics are printed.
+     * @param  frames Number of frames between reports, 0 to never print.
+     */
+    static void setReportInterval(uint32_t frames)
+    {
+        reportInterval = frames;
+    }
+
+    /**
+     * Query if tiled rendering is enabled.
+     * @return True if more than one worker is used.
+     */
+    static bool isEnabled();
+
+    /**
+     * Draws a number of areas using the workers. The areas must not overlap. The threads
+     * drawing tiles must not flush the framebuffer, the caller flushes the areas when
+     * render() returns true.
+     * @param  areas    The areas to draw, in absolute coordinates.
+     * @param  count    The number of areas.
+     * @param  drawTile Callback drawing a tile, called from several threads at once. It must
+     *                  not use JSMOC or flush the framebuffer, e.g. drawing the root container
+     *                  of the screen with drawContainer().
+     * @param  drawArea Callback drawing an area the normal way, e.g. using
+     *                  Application::draw(Rect&), used when tiled rendering is disabled and
+     *                  to verify the tiled frame.
+     * @return True if the areas were drawn with drawTile only and should be flushed, false
+     *         if they were drawn with drawArea.
+     */
+    static bool render(const Rect* areas, uint16_t count, GenericCallback<const Rect&>& drawTile, GenericCallback<const Rect&>& drawArea);
+
+    /**
+     * Draws the children of a container back to front like Container::draw(), descending
+     * into plain containers. While drawing a tile, every drawable but the plain widgets of
+     * the framework is drawn by one thread at a time.
+     * @param  container        The container.
+     * @param  invalidatedArea  The area to draw, relative to the container.
+     */
+    static void drawContainer(Container& container, const Rect& invalidatedArea);
+
+    /**
+     * Query if the calling thread is drawing a frame for render(), which holds the
+     * framebuffer lock for all the threads drawing the frame.
+     * @return True if the framebuffer is locked for the calling thread.
+     */
+    static bool holdsFrameBufferLock();
+
+    /**
+     * Gets the statistics.
+     * @return The statistics.
+     */
+    static const Statistics& getStatistics()
+    {
+        return statistics;
+    }
+
+    /** Prints the statistics using touchgfx_printf() and resets them. */
+    static void printStatistics();
+
+private:
+    static uint16_t workers;
+    static uint16_t tileWidth;
+    static uint16_t tileHeight;
+    static bool verify;
+    static uint32_t reportInterval;
+    static Statistics statistics;
+};
+
+} // namespace touchgfx
+
+#endif // TOUCHGFX_TILERENDERER_HPP
@@ -0,0 +1,166 @@
+/******************************************************************************
+* Copyright (c) 2018(-2021) STMicroelectronics.
+* All rights reserved.
+*
+* This file is part of the TouchGFX 4.18.1 distribution.
+*
+* This software is licensed under terms that can be found in the LICENSE file in
+* the root directory of this software component.
+* If no LICENSE file comes with this software, it is provided AS-IS.
+*
+*******************************************************************************/
+
+/**
+ * @file touchgfx/BitmapCache.hpp
+ *
+ * Declares the touchgfx::BitmapCache class.
+ */
+#ifndef TOUCHGFX_BITMAPCACHE_HPP
+#define TOUCHGFX_BITMAPCACHE_HPP
+
+#include <touchgfx/Bitmap.hpp>
+#include <touchgfx/hal/Types.hpp>
+
+namespace touchgfx
+{
+/**
+ * Automatic management of the Bitmap cache. Instead of the application deciding which bitmaps
+ * to cache with Bitmap::cache(), the widgets drawing a bitmap report it with use(), and
+ * bitmaps are copied to the cache the first time they are drawn. When the cache is full, the
+ * bitmap used least recently, or least frequently, is removed from the cache to make room.
+ * Bitmaps drawn in the current frame are never removed.
+ *
+ * Bitmaps are copied to the cache by Bitmap::cache(), which reads the flash through
+ * HAL::blockCopy(). A HAL reading bitmaps from a flash that is not memory mapped must
+ * implement blockCopy() with its FlashDataReader.
+ *
+ * A bitmap missing from the cache is copied while it is drawn, after waiting for pending DMA
+ * operations. If dynamic bitmaps are allocated, one of them may be the target being drawn
+ * into, which must not be moved by compaction, so the bitmap is drawn from flash and copied
+ * at the start of the next frame instead. The cache is compacted at the start of a frame
+ * after bitmaps have been removed, rather than when the next bitmap is copied.
+ *
+ * @see Bitmap::registerBitmapDatabase, Bitmap::cache
+ */
+class BitmapCache
+{
+public:
+    /** The bitmap removed from the cache when room is needed. */
+    enum Policy
+    {
+        LEAST_RECENTLY_USED,  ///< Remove the bitmap drawn longest ago
+        LEAST_FREQUENTLY_USED ///< Remove the bitmap drawn in the fewest frames recently, the least recently drawn of those
+    };
+
+    /** Counters of the cache since it was registered or the statistics were reset. */
+    struct Statistics
+    {
+        uint32_t hits;        ///< Bitmaps drawn from the cache
+        uint32_t misses;      ///< Bitmaps drawn while not in the cache
+        uint32_t evictions;   ///< Bitmaps removed from the cache to make room
+        uint32_t failures;    ///< Misses that could not be cached, because the cache is too small or full of bitmaps in use
+        uint32_t compactions; ///< Compactions of the cache between frames
+    };
+
+    /**
+     * Registers the bitmap database with a cache managed by BitmapCache. Replaces the call
+     * to Bitmap::registerBitmapDatabase(). A small table of the recent use of every bitmap is
+     * kept at the start of the cache memory, the rest is passed on to Bitmap.
+     *
+     * @param      data                   A reference to the BitmapData storage array.
+     * @param      n                      The number of bitmaps in the array.
+     * @param [in] cachep                 Pointer to memory region in which bitmap data is
+     *                                    cached.
+     * @param      csize                  Size of cache memory region in bytes.
+     * @param      numberOfDynamicBitmaps (Optional) Number of dynamic bitmaps to be allowed in
+     *                                    the cache.
+     * @param      policy                 (Optional) The bitmaps removed when the cache is full.
+     */
+    static void registerBitmapDatabase(const Bitmap::BitmapData* data, uint16_t n, uint16_t* cachep, uint32_t csize,
+                                       uint32_t numberOfDynamicBitmaps = 0, Policy policy = LEAST_RECENTLY_USED);
+
+    /**
+     * Stops managing the cache. The bitmaps already cached stay in the cache.
+     */
+    static void disable();
+
+    /**
+     * Query if the cache is managed by BitmapCache.
+     *
+     * @return True if registerBitmapDatabase() has been called.
+     */
+    static bool isEnabled()
+    {
+        return entries != 0;
+    }
+
+    /**
+     * Sets the bitmaps removed when the cache is full.
+     *
+     * @param  cachePolicy The policy.
+     */
+    static void setPolicy(Policy cachePolicy)
+    {
+        policy = cachePolicy;
+    }
+
+    /**
+     * Reports that a bitmap is about to be drawn, caching it if it is not cached. Called by
+     * the widgets before drawing a bitmap.
+     *
+     * @param  id The bitmap.
+     */
+    static void use(BitmapId id)
+    {
+        if (entries && id < numberOfBitmaps)
+        {
+            touch(id);
+        }
+    }
+
+    /**
+     * Starts a new frame. Copies the bitmaps that could not be cached while drawing the last
+     * frame, and compacts the cache if bitmaps were removed. Called once per frame, before
+     * drawing.
+     */
+    static void nextFrame();
+
+    /**
+     * Gets the counters of the cache.
+     *
+     * @return The statistics.
+     */
+    static const Statistics& getStatistics()
+    {
+        return statistics;
+    }
+
+    /** Resets the counters of the cache. */
+    static void resetStatistics();
+
+private:
+    struct Entry
+    {
+        uint32_t lastUse; ///< Frame the bitmap was last drawn in, 0 if never
+        uint16_t uses;    ///< Number of frames the bitmap was drawn in, halved every AGING_FRAMES
+        uint16_t pending; ///< True if the bitmap is to be cached at the start of the next frame
+    };
+
+    static void touch(BitmapId id);
+    static bool load(BitmapId id);
+    static bool evict();
+    static uint32_t estimateSize(BitmapId id);
+
+    static Entry* entries;
+    static uint16_t numberOfBitmaps;
+    static uint32_t cacheSize;
+    static uint32_t frame;
+    static Policy policy;
+    static bool fragmented;
+    static bool pendingLoads;
+    static Statistics statistics;
+};
+
+} // namespace touchgfx
+
+#endif // TOUCHGFX_BITMAPCACHE_HPP
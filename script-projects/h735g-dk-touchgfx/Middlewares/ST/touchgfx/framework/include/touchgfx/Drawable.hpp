@@ -689,6 +689,7 @@ protected:
     /// @endcond
 
     friend class Container;
+    friend class IndexedContainer;
     friend class Screen;
 };
 
@@ -21,6 +21,13 @@
 #include <touchgfx/hal/Types.hpp>
 #include <touchgfx/canvas_widget_renderer/Cell.hpp>
 
+#ifdef SIMULATOR
+/** Storage of the context bound by CanvasWidgetRenderer::setContext(), one per thread in the simulator. */
+#define TOUCHGFX_CWR_THREAD_LOCAL thread_local
+#else
+#define TOUCHGFX_CWR_THREAD_LOCAL
+#endif
+
 namespace touchgfx
 {
 /**
@@ -30,19 +37,106 @@ namespace touchgfx
  * simulator, it is also possible to get a report on the actual amount of memory used
  * for drawing with CanvasWidgetRenderer to help adjusting the buffer size.
  *
+ * The buffer and the memory statistics are kept in a Context. The static functions use the
+ * context bound with setContext(), or a default context if none is bound. In the simulator
+ * the bound context is per thread, so several threads can draw CanvasWidgets at the same
+ * time, each with a context and buffer of its own.
+ *
  * @see Widget, setWriteMemoryUsageReport, getWriteMemoryUsageReport
  */
 class CanvasWidgetRenderer
 {
 public:
+    /**
+     * The memory required by the CanvasWidgets drawn since resetMemoryReport() was called,
+     * e.g. the CanvasWidgets of a screen.
+     *
+     * @see getMemoryReport
+     */
+    struct MemoryReport
+    {
+        unsigned unsplitBufferSize; ///< Smallest buffer drawing every area without splitting it
+        unsigned minimumBufferSize; ///< Smallest buffer drawing every area, split into single scanlines
+        unsigned outlines;          ///< Number of outlines drawn
+        unsigned retries;           ///< Number of areas split and drawn again because the outline did not fit
+        unsigned skippedLines;      ///< Number of scanlines left undrawn because a single pixel did not fit
+    };
+
+    /**
+     * The memory used by CanvasWidgetRenderer to draw, and the memory statistics of the
+     * drawings done with it.
+     *
+     * @see setContext
+     */
+    class Context
+    {
+    public:
+        /** Initializes a new instance of the Context class without a buffer. */
+        Context();
+
+    private:
+        uint8_t* memoryBuffer;
+        unsigned int memoryBufferSize;
+        unsigned int scanlineWidth;
+        void* scanlineCovers;
+        void* scanlineStartIndices;
+        void* scanlineCounts;
+        Cell* outlineBuffer;
+        unsigned int outlineBufferSize;
+        unsigned int lastOutlineCells;
+        MemoryReport report;
+#ifdef SIMULATOR
+        unsigned int scanlineSize;
+        unsigned int maxCellsUsed;
+        unsigned int maxCellsMissing;
+#endif
+
+        friend class CanvasWidgetRenderer;
+    };
+
+    /**
+     * Binds a context to the calling thread. All static functions, including setupBuffer(),
+     * use the bound context until another context is bound. Only the simulator keeps a
+     * context per thread, on target the context is shared by all tasks.
+     *
+     * @param [in] context The context to use, or 0 to use the default context.
+     */
+    static void setContext(Context* context)
+    {
+        currentContext = context;
+    }
+
+    /**
+     * Gets the context used by the calling thread.
+     *
+     * @return The bound context, or the default context if none is bound.
+     */
+    static Context& getContext()
+    {
+        return currentContext ? *currentContext : defaultContext;
+    }
+
     /**
      * Setup the buffers used by CanvasWidget.
      *
      * @param [in] buffer     Buffer reserved for CanvasWidget.
      * @param      bufferSize The size of the buffer.
+     *
+     * @note The buffer is set up in the context of the calling thread.
      */
     static void setupBuffer(uint8_t* buffer, unsigned bufferSize);
 
+    /**
+     * Gets the size of the buffer set up with setupBuffer(), e.g. to give another context a
+     * buffer of the same size.
+     *
+     * @return The size of the buffer of the calling thread, 0 if no buffer has been setup.
+     */
+    static unsigned getBufferSize()
+    {
+        return getContext().memoryBufferSize;
+    }
+
     /// @cond
     /**
      * Sets scanline width. Setting the scanline width will initialize the buffers for
@@ -105,8 +199,85 @@ public:
      * @return Size of memory area used internally by Outline.
      */
     static unsigned int getOutlineBufferSize();
+
+    /**
+     * Gets the number of Cell objects available for an Outline when drawing an area of the
+     * given width, without changing the buffer layout.
+     *
+     * @param  width The width of the scanline on screen.
+     *
+     * @return The number of Cell objects, 0 if the scanline buffers of the width do not fit.
+     */
+    static unsigned getCellCapacity(unsigned width);
+
+    /**
+     * Called by Canvas when the Outline of a shape is rendered, to keep track of the memory
+     * requirements of CanvasWidgets.
+     *
+     * @param  width           The width of the area drawn.
+     * @param  cells           The number of Cell objects in the Outline.
+     * @param  maxCellsPerLine The largest number of Cell objects on a single scanline.
+     */
+    static void registerOutline(unsigned width, unsigned cells, unsigned maxCellsPerLine);
+
+    /**
+     * Gets the number of Cell objects in the last Outline registered.
+     *
+     * @return The number of Cell objects.
+     */
+    static unsigned getLastOutlineCells();
+
+    /** Called by CanvasWidget when an area is split and drawn again, because the Outline did not fit. */
+    static void registerRetry();
+
+    /** Called by CanvasWidget when a scanline cannot be drawn, even one pixel at a time. */
+    static void registerSkippedLine();
     /// @endcond
 
+    /**
+     * Clears the memory report, e.g. when a new screen is entered.
+     *
+     * @see getMemoryReport
+     */
+    static void resetMemoryReport();
+
+    /**
+     * Turns the buffer sizes of the memory report on or off. Finding the minimumBufferSize
+     * scans the cells of every Outline drawn, so the buffer sizes are left at 0 unless the
+     * report is enabled, or in the simulator, unless setWriteMemoryUsageReport() is turned
+     * on. Outlines, retries and skipped lines are always counted.
+     *
+     * @param  enabled True to find the buffer sizes.
+     *
+     * @see getMemoryReport
+     */
+    static void setMemoryReportEnabled(bool enabled)
+    {
+        reportBufferSizes = enabled;
+    }
+
+    /**
+     * Query if the buffer sizes of the memory report are found.
+     *
+     * @return True if the buffer sizes are found.
+     *
+     * @see setMemoryReportEnabled
+     */
+    static bool isMemoryReportEnabled();
+
+    /**
+     * Gets the memory required by the CanvasWidgets drawn since resetMemoryReport(). The
+     * minimumBufferSize is the smallest buffer the CanvasWidgets can be drawn with, and a
+     * buffer of unsplitBufferSize bytes lets every area be drawn in one go. Buffers in
+     * between work, but areas are split into horizontal bands.
+     *
+     * @return The memory report.
+     */
+    static const MemoryReport& getMemoryReport()
+    {
+        return getContext().report;
+    }
+
 #ifdef SIMULATOR
 
     /**
@@ -187,18 +358,10 @@ public:
 #endif
 
 private:
-    static uint8_t* memoryBuffer;
-    static unsigned int memoryBufferSize;
-    static unsigned int scanlineWidth;
-    static void* scanlineCovers;
-    static void* scanlineStartIndices;
-    static void* scanlineCounts;
-    static Cell* outlineBuffer;
-    static unsigned int outlineBufferSize;
+    static Context defaultContext;
+    static TOUCHGFX_CWR_THREAD_LOCAL Context* currentContext;
+    static bool reportBufferSizes;
 #ifdef SIMULATOR
-    static unsigned int scanlineSize;
-    static unsigned int maxCellsUsed;
-    static unsigned int maxCellsMissing;
     static bool writeReport;
 #endif
 };
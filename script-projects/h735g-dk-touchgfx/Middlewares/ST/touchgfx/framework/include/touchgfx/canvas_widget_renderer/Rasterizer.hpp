@@ -283,6 +283,26 @@ public:
         outline.setMaxRenderY(y);
     }
 
+    /**
+     * Gets the number of Cell objects in the outline.
+     *
+     * @return The number of Cell objects.
+     */
+    unsigned getNumCells() const
+    {
+        return outline.getNumCells();
+    }
+
+    /**
+     * Gets the Cell objects of the outline, sorted by y and then x.
+     *
+     * @return A pointer to the sorted Cell objects.
+     */
+    const Cell* getCells()
+    {
+        return outline.getCells();
+    }
+
     /**
      * Determines if we the outline was too complex to draw completely.
      *
@@ -0,0 +1,57 @@
+/******************************************************************************
+* Copyright (c) 2018(-2021) STMicroelectronics.
+* All rights reserved.
+*
+* This file is part of the TouchGFX 4.18.1 distribution.
+*
+* This software is licensed under terms that can be found in the LICENSE file in
+* the root directory of this software component.
+* If no LICENSE file comes with this software, it is provided AS-IS.
+*
+*******************************************************************************/
+
+/**
+ * @file touchgfx/containers/BlitScrollableContainer.hpp
+ *
+ * Declares the touchgfx::BlitScrollableContainer class.
+ */
+#ifndef TOUCHGFX_BLITSCROLLABLECONTAINER_HPP
+#define TOUCHGFX_BLITSCROLLABLECONTAINER_HPP
+
+#include <touchgfx/hal/Types.hpp>
+#include <touchgfx/containers/ScrollBlitter.hpp>
+#include <touchgfx/containers/ScrollableContainer.hpp>
+
+namespace touchgfx
+{
+/**
+ * A ScrollableContainer which scrolls by copying the pixels already drawn in the framebuffer.
+ * Only the strips uncovered by a scroll, the scrollbars and the drawables on top of the
+ * container are drawn again, instead of the whole container.
+ *
+ * @see ScrollBlitter
+ *
+ * @note The children must cover the container with solid pixels, see ScrollBlitter.
+ */
+class BlitScrollableContainer : public ScrollableContainer
+{
+public:
+    BlitScrollableContainer()
+        : ScrollableContainer(), blitter(), blitterTicking(false)
+    {
+    }
+
+    virtual void handleTickEvent();
+
+    virtual void moveChildrenRelative(int16_t deltaX, int16_t deltaY);
+
+    virtual void invalidateRect(Rect& invalidatedArea) const;
+
+private:
+    mutable ScrollBlitter blitter; ///< Copies the pixels when the children are moved
+    bool blitterTicking;           ///< True if registered for ticks by the blitter
+};
+
+} // namespace touchgfx
+
+#endif // TOUCHGFX_BLITSCROLLABLECONTAINER_HPP
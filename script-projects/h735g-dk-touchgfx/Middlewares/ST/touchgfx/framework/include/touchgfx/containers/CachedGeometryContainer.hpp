@@ -0,0 +1,133 @@
+/******************************************************************************
+* Copyright (c) 2018(-2021) STMicroelectronics.
+* All rights reserved.
+*
+* This file is part of the TouchGFX 4.18.1 distribution.
+*
+* This software is licensed under terms that can be found in the LICENSE file in
+* the root directory of this software component.
+* If no LICENSE file comes with this software, it is provided AS-IS.
+*
+*******************************************************************************/
+
+/**
+ * @file touchgfx/containers/CachedGeometryContainer.hpp
+ *
+ * Declares the touchgfx::CachedGeometryContainer class.
+ */
+#ifndef TOUCHGFX_CACHEDGEOMETRYCONTAINER_HPP
+#define TOUCHGFX_CACHEDGEOMETRYCONTAINER_HPP
+
+#include <touchgfx/Drawable.hpp>
+#include <touchgfx/containers/Container.hpp>
+#include <touchgfx/hal/Types.hpp>
+
+namespace touchgfx
+{
+/**
+ * A Container remembering its absolute position and the part of it which is visible, for
+ * deeply nested containers. The absolute position, the visible area and the invalidated areas
+ * of a Drawable are found by passing a rectangle from parent to parent up to the root
+ * container of the Screen. A CachedGeometryContainer answers for all of its ancestors at once,
+ * so finding the absolute or visible rectangle of a child, as done by the occlusion culling of
+ * the Screen and by getLastChildNear(), takes the same time at any depth.
+ *
+ * An area invalidated in a CachedGeometryContainer nested directly in other
+ * CachedGeometryContainers is clipped and moved past all of them at once, and passed on from
+ * the outermost of them as by a Container. Other ancestors may handle the areas invalidated by
+ * their children, e.g. a CacheableContainer, so they always see the areas.
+ *
+ * Changing the position or size of any CachedGeometryContainer, including moving it by the
+ * moveChildrenRelative() of a ScrollableContainer, marks the geometry of every
+ * CachedGeometryContainer out of date, and each is found again the first time it is needed.
+ *
+ * @note The CachedGeometryContainer is not told when an ancestor which is not a
+ *       CachedGeometryContainer is moved, resized or added to another parent.
+ *       invalidateGeometry() must be called when that happens.
+ * @note The invalidateRect() of a class derived from CachedGeometryContainer is skipped for
+ *       areas invalidated by a nested CachedGeometryContainer.
+ */
+class CachedGeometryContainer : public Container
+{
+public:
+    CachedGeometryContainer()
+        : Container(),
+          geometryVersion(0), cachedParent(0), offsetX(0), offsetY(0), visibleArea(),
+          outermost(0), outermostX(0), outermostY(0), outermostClip()
+    {
+    }
+
+    /**
+     * Marks the geometry of every CachedGeometryContainer out of date. Must be called when an
+     * ancestor of a CachedGeometryContainer, which is not a CachedGeometryContainer itself, is
+     * moved, resized or added to another parent.
+     */
+    static void invalidateGeometry()
+    {
+        version++;
+    }
+
+    virtual void setX(int16_t x)
+    {
+        if (x != getX())
+        {
+            Container::setX(x);
+            invalidateGeometry();
+        }
+    }
+
+    virtual void setY(int16_t y)
+    {
+        if (y != getY())
+        {
+            Container::setY(y);
+            invalidateGeometry();
+        }
+    }
+
+    virtual void setWidth(int16_t width)
+    {
+        if (width != getWidth())
+        {
+            Container::setWidth(width);
+            invalidateGeometry();
+        }
+    }
+
+    virtual void setHeight(int16_t height)
+    {
+        if (height != getHeight())
+        {
+            Container::setHeight(height);
+            invalidateGeometry();
+        }
+    }
+
+    virtual void invalidateRect(Rect& invalidatedArea) const;
+
+    virtual void getVisibleRect(Rect& rect) const;
+
+    virtual void translateRectToAbsolute(Rect& r) const;
+
+protected:
+    /** Finds the absolute position and the visible area again if the geometry is out of date. */
+    void updateGeometry() const;
+
+private:
+    static uint32_t version;                              ///< Changed whenever the geometry of any CachedGeometryContainer changes
+    static const CachedGeometryContainer* lastTranslated; ///< The last CachedGeometryContainer to answer translateRectToAbsolute()
+
+    mutable uint32_t geometryVersion;                 ///< The version the geometry was found at
+    mutable const Drawable* cachedParent;             ///< The parent the geometry was found with
+    mutable int16_t offsetX;                          ///< Absolute x coordinate of the CachedGeometryContainer
+    mutable int16_t offsetY;                          ///< Absolute y coordinate of the CachedGeometryContainer
+    mutable Rect visibleArea;                         ///< The visible part of the CachedGeometryContainer, in absolute coordinates
+    mutable const CachedGeometryContainer* outermost; ///< The outermost of the CachedGeometryContainers this is nested directly in, 0 if none
+    mutable int16_t outermostX;                       ///< X coordinate of the CachedGeometryContainer in outermost
+    mutable int16_t outermostY;                       ///< Y coordinate of the CachedGeometryContainer in outermost
+    mutable Rect outermostClip;                       ///< The part not clipped by the parents up to outermost, in coordinates of outermost
+};
+
+} // namespace touchgfx
+
+#endif // TOUCHGFX_CACHEDGEOMETRYCONTAINER_HPP
@@ -0,0 +1,165 @@
+/******************************************************************************
+* Copyright (c) 2018(-2021) STMicroelectronics.
+* All rights reserved.
+*
+* This file is part of the TouchGFX 4.18.1 distribution.
+*
+* This software is licensed under terms that can be found in the LICENSE file in
+* the root directory of this software component.
+* If no LICENSE file comes with this software, it is provided AS-IS.
+*
+*******************************************************************************/
+
+/**
+ * @file touchgfx/containers/IndexedContainer.hpp
+ *
+ * Declares the touchgfx::IndexedContainer class.
+ */
+#ifndef TOUCHGFX_INDEXEDCONTAINER_HPP
+#define TOUCHGFX_INDEXEDCONTAINER_HPP
+
+#include <touchgfx/Drawable.hpp>
+#include <touchgfx/containers/Container.hpp>
+#include <touchgfx/hal/Types.hpp>
+
+namespace touchgfx
+{
+/**
+ * A Container keeping a spatial index of its children, for containers with hundreds of
+ * children. A Container finds the children under a touch, or inside an invalidated area, by
+ * testing every child. The IndexedContainer places its children in the cells of a uniform
+ * grid covering them, and only tests the children in the cells under the touch or the area.
+ * Children covering many cells, like a background, are kept in a separate list which is
+ * always tested. Children are still found, drawn and touched in the order they were added.
+ *
+ * The index is stored in a buffer supplied by the application, and is built when it is
+ * first needed after children have been added, inserted or removed. Moving the children by
+ * moveChildrenRelative() moves the index along. If the buffer is too small for the index,
+ * the IndexedContainer works like a Container.
+ *
+ * @see setIndexBuffer
+ *
+ * @note The IndexedContainer is not told when a child is moved or resized by the
+ *       application, invalidateIndex() must be called when that happens.
+ */
+class IndexedContainer : public Container
+{
+public:
+    IndexedContainer()
+        : Container(),
+          buffer(0), bufferSize(0), requestedCellSize(0),
+          indexValid(false), indexed(false), numberOfChildren(0), columns(0), rows(0), cellSize(0),
+          children(0), cellStart(0), entries(0), marks(0)
+    {
+    }
+
+    /**
+     * Sets the buffer to build the index in. For n children in c cells, the index needs n
+     * pointers, 2 bytes for every cell and every child in a cell, and a bit per child. Using
+     * 16 * n bytes plus 2 bytes per cell is usually enough. The buffer must be aligned for
+     * pointers. With no buffer, the IndexedContainer works like a Container.
+     *
+     * @param [in] indexBuffer The buffer, or 0 to not index the children.
+     * @param      size        The size of the buffer in bytes.
+     * @param      cellSizePx  (Optional) The width and height of the cells in pixels, or 0
+     *                         to choose cells holding about one child each.
+     */
+    void setIndexBuffer(void* indexBuffer, uint32_t size, int16_t cellSizePx = 0)
+    {
+        buffer = static_cast<uint8_t*>(indexBuffer);
+        bufferSize = size;
+        requestedCellSize = cellSizePx;
+        invalidateIndex();
+    }
+
+    /**
+     * Forces the index to be built again the next time it is used. Must be called when
+     * children have been moved or resized, except by moveChildrenRelative().
+     */
+    void invalidateIndex()
+    {
+        indexValid = false;
+    }
+
+    /**
+     * Query if the children are found through the index, building the index if needed.
+     *
+     * @return False if the IndexedContainer has no buffer, or the buffer is too small.
+     */
+    bool isIndexed() const
+    {
+        return updateIndex();
+    }
+
+    virtual void add(Drawable& d);
+
+    virtual void remove(Drawable& d);
+
+    virtual void removeAll();
+
+    virtual void unlink();
+
+    virtual void insert(Drawable* previous, Drawable& d);
+
+    virtual void getLastChild(int16_t x, int16_t y, Drawable** last);
+
+    virtual void getLastChildNear(int16_t x, int16_t y, Drawable** last, int16_t* fingerAdjustmentX, int16_t* fingerAdjustmentY);
+
+    virtual void draw(const Rect& invalidatedArea) const;
+
+protected:
+    virtual void moveChildrenRelative(int16_t deltaX, int16_t deltaY);
+
+    /// @cond
+    virtual void setupDrawChain(const Rect& invalidatedArea, Drawable** nextPreviousElement);
+    /// @endcond
+
+    /**
+     * Builds the index if children have been added, inserted or removed.
+     *
+     * @return True if the index can be used.
+     */
+    bool updateIndex() const;
+
+    /**
+     * Marks the children whose cells intersect an area, and the children in the list of large
+     * children.
+     *
+     * @param  area The area, relative to the IndexedContainer.
+     *
+     * @return One more than the index of the last word of marks with a child marked.
+     */
+    uint16_t markChildren(const Rect& area) const;
+
+    /**
+     * Gets the next marked child in the order the children were added, and clears its mark.
+     *
+     * @param [in,out] word  The word of marks to continue from, updated.
+     * @param          words One more than the last word with a child marked.
+     *
+     * @return The child, or 0 when all the marked children have been returned.
+     */
+    Drawable* nextMarkedChild(uint16_t& word, uint16_t words) const;
+
+private:
+    uint8_t* buffer;
+    uint32_t bufferSize;
+    int16_t requestedCellSize;
+
+    // The index, built from the children when it is used
+    mutable bool indexValid;
+    mutable bool indexed;
+    mutable uint16_t numberOfChildren;
+    mutable Rect bounds; ///< The area covered by the grid, relative to the IndexedContainer
+    mutable uint16_t columns;
+    mutable uint16_t rows;
+    mutable int16_t cellSize;
+    mutable Drawable** children;   ///< The children in the order they were added
+    mutable uint16_t* cellStart;   ///< Start of the children of each cell in entries, the large children last
+    mutable uint16_t* entries;     ///< The indices of the children of each cell, in increasing order
+    mutable uint32_t* marks;       ///< A bit for every child, set while collecting the children of an area
+};
+
+} // namespace touchgfx
+
+#endif // TOUCHGFX_INDEXEDCONTAINER_HPP
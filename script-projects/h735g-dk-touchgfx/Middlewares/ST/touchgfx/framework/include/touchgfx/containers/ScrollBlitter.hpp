@@ -0,0 +1,151 @@
+/******************************************************************************
+* Copyright (c) 2018(-2021) STMicroelectronics.
+* All rights reserved.
+*
+* This file is part of the TouchGFX 4.18.1 distribution.
+*
+* This software is licensed under terms that can be found in the LICENSE file in
+* the root directory of this software component.
+* If no LICENSE file comes with this software, it is provided AS-IS.
+*
+*******************************************************************************/
+
+/**
+ * @file touchgfx/containers/ScrollBlitter.hpp
+ *
+ * Declares the touchgfx::ScrollBlitter class.
+ */
+#ifndef TOUCHGFX_SCROLLBLITTER_HPP
+#define TOUCHGFX_SCROLLBLITTER_HPP
+
+#include <touchgfx/Drawable.hpp>
+#include <touchgfx/hal/Types.hpp>
+
+namespace touchgfx
+{
+/**
+ * Scrolls the pixels of a container on the framebuffer instead of drawing them again. When the
+ * content of a container is moved, the ScrollBlitter copies the part of the container which is
+ * still visible from the framebuffer being shown to the framebuffer being drawn, moved by the
+ * same distance, and invalidates only the strips uncovered by the move. The framebuffer being
+ * drawn is found one frame behind after a move, so in the frame following a move the content
+ * is copied again. Drawables placed on top of the container, like scrollbars or other widgets
+ * overlapping the container, are invalidated both where they are and where their pixels were
+ * copied to. If too many of them overlap the container, or the content moves more than the
+ * size of the container, the container is invalidated as usual.
+ *
+ * The ScrollBlitter is used by BlitScrollableContainer and BlitScroller, which tell it when the
+ * content moves and pass it the areas invalidated by their children.
+ *
+ * @note The pixels can only be copied with double buffering, without a partial framebuffer
+ *       and with a framebuffer of at least 8 bits per pixel. Otherwise the container is
+ *       invalidated as usual.
+ * @note The children must cover the container with solid pixels. A background seen through
+ *       the children does not move with the children, and is only allowed if it has the same
+ *       color everywhere.
+ */
+class ScrollBlitter
+{
+public:
+    /**
+     * The largest number of drawables on top of the container, for which the pixels of the
+     * container are still copied.
+     */
+    static const int MAX_OVERLAYS = 4;
+
+    ScrollBlitter()
+        : moving(false), updating(false), positionX(0), positionY(0), tftFrameBuffer(0),
+          clientValid(false), clientX(0), clientY(0), tftValid(false), tftX(0), tftY(0), pendingArea()
+    {
+    }
+
+    /**
+     * Query if the content is being moved. The container must ignore the areas invalidated by
+     * its children while the content is moved, as the ScrollBlitter invalidates what is needed.
+     *
+     * @return True if the content is being moved.
+     */
+    bool isMoving() const
+    {
+        return moving;
+    }
+
+    /**
+     * Called by the container before moving its content.
+     *
+     * @see endMove
+     */
+    void beginMove();
+
+    /**
+     * Called by the container after moving its content. Copies the pixels of the container,
+     * and invalidates the uncovered strips, or invalidates the container.
+     *
+     * @param  container The container.
+     * @param  deltaX    The horizontal distance the content was moved.
+     * @param  deltaY    The vertical distance the content was moved.
+     * @param  fixed     The children of the container which did not move, or 0.
+     * @param  numFixed  The number of children which did not move.
+     *
+     * @return True if the pixels must be copied again in the next frame, and update() must be
+     *         called from handleTickEvent() of the container.
+     */
+    bool endMove(Drawable& container, int16_t deltaX, int16_t deltaY, const Drawable* const* fixed = 0, int numFixed = 0);
+
+    /**
+     * Called by the container from handleTickEvent() after a move. Copies the pixels of the
+     * container to the framebuffer being drawn, if needed.
+     *
+     * @param  container The container.
+     * @param  fixed     The children of the container which did not move, or 0.
+     * @param  numFixed  The number of children which did not move.
+     *
+     * @return True if the pixels must be copied again in the next frame.
+     */
+    bool update(Drawable& container, const Drawable* const* fixed = 0, int numFixed = 0);
+
+    /**
+     * Called by the container for areas invalidated while the content is not moving. If the
+     * content is moved later in the same frame, the area is invalidated again where it was
+     * moved to, as the pixels copied there are out of date.
+     *
+     * @param  area The invalidated area, relative to the container.
+     */
+    void invalidatedByChild(const Rect& area);
+
+private:
+    /** Notices if the framebuffers have been swapped since the last call. */
+    void followFrameBuffers();
+
+    /** Brings the content of the framebuffer being drawn up to the current position. */
+    void bringUpToDate(Drawable& container, const Drawable* const* fixed, int numFixed);
+
+    /** Finds the areas of the drawables on top of the container, returns false if too many. */
+    static bool findOverlays(Drawable& container, const Rect& viewport, const Drawable* const* fixed, int numFixed, Rect* overlays, int& numOverlays);
+
+    /** Invalidates an absolute area, clipped to the container. */
+    void invalidateAbsolute(Drawable& container, const Rect& area);
+
+    /** Copies an area of the framebuffer being shown to another area of the framebuffer being drawn. */
+    static void copyPixels(const Rect& source, const Rect& destination);
+
+    /** Query if pixels can be copied between the framebuffers. */
+    static bool canCopyPixels();
+
+    bool moving;                     ///< True while the content is being moved
+    bool updating;                   ///< True while the ScrollBlitter invalidates areas itself
+    int32_t positionX;               ///< The total horizontal distance the content has moved
+    int32_t positionY;               ///< The total vertical distance the content has moved
+    const uint16_t* tftFrameBuffer;  ///< The framebuffer being shown at the last call
+    bool clientValid;                ///< True if the content of the framebuffer being drawn is known
+    int32_t clientX;                 ///< The position the framebuffer being drawn will show
+    int32_t clientY;                 ///< The position the framebuffer being drawn will show
+    bool tftValid;                   ///< True if the content of the framebuffer being shown is known
+    int32_t tftX;                    ///< The position the framebuffer being shown is showing
+    int32_t tftY;                    ///< The position the framebuffer being shown is showing
+    Rect pendingArea;                ///< Areas invalidated in this frame, moved along with the content
+};
+
+} // namespace touchgfx
+
+#endif // TOUCHGFX_SCROLLBLITTER_HPP
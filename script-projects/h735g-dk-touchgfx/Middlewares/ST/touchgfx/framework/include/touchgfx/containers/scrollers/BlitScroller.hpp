@@ -0,0 +1,115 @@
+/******************************************************************************
+* Copyright (c) 2018(-2021) STMicroelectronics.
+* All rights reserved.
+*
+* This file is part of the TouchGFX 4.18.1 distribution.
+*
+* This software is licensed under terms that can be found in the LICENSE file in
+* the root directory of this software component.
+* If no LICENSE file comes with this software, it is provided AS-IS.
+*
+*******************************************************************************/
+
+/**
+ * @file touchgfx/containers/scrollers/BlitScroller.hpp
+ *
+ * Declares the touchgfx::BlitScroller class.
+ */
+#ifndef TOUCHGFX_BLITSCROLLER_HPP
+#define TOUCHGFX_BLITSCROLLER_HPP
+
+#include <touchgfx/hal/Types.hpp>
+#include <touchgfx/Application.hpp>
+#include <touchgfx/containers/ScrollBlitter.hpp>
+
+namespace touchgfx
+{
+/**
+ * A BlitScroller makes a ScrollList or a ScrollWheel scroll by copying the pixels already
+ * drawn in the framebuffer. Only the strips uncovered by a scroll, where the drawables are
+ * filled with new items, and the drawables on top of the scroller are drawn again, instead of
+ * the whole scroller.
+ *
+ * @tparam T specifies the type to extend with the BlitScroller behavior, ScrollList or
+ *           ScrollWheel.
+ *
+ * @see ScrollBlitter
+ *
+ * @note The drawables must cover the scroller with solid pixels, see ScrollBlitter. A margin
+ *       between the items, or padding before the first item or after the last, must show a
+ *       background with the same color everywhere.
+ * @note A ScrollWheelWithSelectionStyle draws the selected item with other drawables, which do
+ *       not move along with the rest, and cannot be a BlitScroller.
+ */
+template <class T>
+class BlitScroller : public T
+{
+public:
+    BlitScroller()
+        : T(), blitter(), blitterTicking(false)
+    {
+    }
+
+    virtual void handleTickEvent()
+    {
+        T::handleTickEvent();
+        if (blitterTicking && !blitter.update(*this))
+        {
+            blitterTicking = false;
+            Application::getInstance()->unregisterTimerWidget(this);
+        }
+    }
+
+    virtual void invalidateRect(Rect& invalidatedArea) const
+    {
+        if (!blitter.isMoving())
+        {
+            blitter.invalidatedByChild(invalidatedArea);
+            T::invalidateRect(invalidatedArea);
+        }
+    }
+
+protected:
+    virtual void setOffset(int32_t offset)
+    {
+        int32_t delta = offset - T::getOffset();
+        const int32_t listSize = T::getNumberOfItems() * this->itemSize;
+        if (T::getCircular() && listSize > 0)
+        {
+            // A circular list looks the same when moved by its own size
+            delta %= listSize;
+            if (delta > listSize / 2)
+            {
+                delta -= listSize;
+            }
+            else if (delta < -listSize / 2)
+            {
+                delta += listSize;
+            }
+        }
+        if (delta == 0)
+        {
+            // Nothing moves, but the drawables may be filled again
+            T::setOffset(offset);
+            return;
+        }
+
+        delta = MAX(-0x4000, MIN(0x4000, delta));
+        blitter.beginMove();
+        T::setOffset(offset);
+        const bool horizontal = T::getHorizontal();
+        if (blitter.endMove(*this, horizontal ? (int16_t)delta : 0, horizontal ? 0 : (int16_t)delta) && !blitterTicking)
+        {
+            blitterTicking = true;
+            Application::getInstance()->registerTimerWidget(this);
+        }
+    }
+
+private:
+    mutable ScrollBlitter blitter; ///< Copies the pixels when the drawables are moved
+    bool blitterTicking;           ///< True if registered for ticks by the blitter
+};
+
+} // namespace touchgfx
+
+#endif // TOUCHGFX_BLITSCROLLER_HPP
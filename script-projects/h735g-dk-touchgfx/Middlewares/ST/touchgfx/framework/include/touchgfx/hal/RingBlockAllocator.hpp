@@ -0,0 +1,320 @@
+/******************************************************************************
+* Copyright (c) 2018(-2021) STMicroelectronics.
+* All rights reserved.
+*
+* This file is part of the TouchGFX 4.18.1 distribution.
+*
+* This software is licensed under terms that can be found in the LICENSE file in
+* the root directory of this software component.
+* If no LICENSE file comes with this software, it is provided AS-IS.
+*
+*******************************************************************************/
+
+/**
+ * @file touchgfx/hal/RingBlockAllocator.hpp
+ *
+ * Declares the touchgfx::RingBlockAllocator class.
+ */
+#ifndef TOUCHGFX_RINGBLOCKALLOCATOR_HPP
+#define TOUCHGFX_RINGBLOCKALLOCATOR_HPP
+
+#include <string.h>
+#include <touchgfx/hal/FrameBufferAllocator.hpp>
+#include <touchgfx/hal/HAL.hpp>
+#include <touchgfx/hal/Types.hpp>
+#ifdef SIMULATOR
+#include <chrono>
+#endif
+
+// Orders the memory accesses of the drawing and the transfer side of the ring
+#if defined(__GNUC__) || defined(__clang__)
+#define TOUCHGFX_RING_BARRIER() __sync_synchronize()
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#define TOUCHGFX_RING_BARRIER() _ReadWriteBarrier()
+#elif defined(__ICCARM__)
+#include <intrinsics.h>
+#define TOUCHGFX_RING_BARRIER() __DMB()
+#elif defined(__CC_ARM)
+#define TOUCHGFX_RING_BARRIER() __dmb(0xF)
+#else
+#define TOUCHGFX_RING_BARRIER()
+#endif
+
+namespace touchgfx
+{
+/**
+ * A FrameBufferAllocator handing blocks of variable size from a ring of memory to the display
+ * transfer. Where ManyBlockAllocator splits its memory into a fixed number of blocks of the
+ * same size, a block of the ring takes the lines asked for from any memory not waiting for
+ * transfer, so drawing continues while earlier blocks are transferred, and wide areas are not
+ * cut into thin blocks.
+ *
+ * The ring is lock free for a single drawing side (the UI task calling allocateBlock() and
+ * markBlockReadyForTransfer()) and a single transfer side (the display driver, often the
+ * transfer complete interrupt, calling getBlockForTransfer() and freeBlockAfterTransfer()).
+ * Each counter is only written by one of the sides.
+ *
+ * When the ring is full, allocateBlock() calls FrameBufferAllocatorWaitOnTransfer() until a
+ * block is freed. The time each side waits for the other is counted in the statistics, in
+ * cycles of HAL::getCPUCycles(), or nanoseconds in the simulator.
+ *
+ * @tparam buffer_size    Size of the ring in bytes, a multiple of 4.
+ * @tparam max_blocks     Maximum number of blocks drawn or waiting for transfer, a power of two.
+ * @tparam bytes_pr_pixel Number of bytes per pixel.
+ *
+ * @see FrameBufferAllocator, ManyBlockAllocator
+ */
+template <uint32_t buffer_size, uint32_t max_blocks, uint32_t bytes_pr_pixel>
+class RingBlockAllocator : public FrameBufferAllocator
+{
+public:
+    /** Counters since the allocator was created or the statistics were reset. */
+    struct Statistics
+    {
+        uint32_t blocks;            ///< Number of blocks allocated
+        uint32_t shortBlocks;       ///< Blocks allocated with fewer lines than asked for, for lack of memory
+        uint64_t bytes;             ///< Number of bytes allocated
+        uint32_t maxBytesInUse;     ///< Most memory drawn or waiting for transfer at the same time, including padding at the end of the ring
+        uint32_t drawStalls;        ///< Allocations waiting for the transfer to free memory
+        uint64_t drawStallTime;     ///< Time spent waiting for the transfer to free memory
+        uint32_t transferStalls;    ///< Times the transfer ran out of blocks to transfer
+        uint64_t transferStallTime; ///< Time from the transfer running out of blocks until the next block was drawn
+    };
+
+    RingBlockAllocator()
+        : allocated(0), drawn(0), sending(0), freed(0), head(0), released(0), headOffset(0), transferIdle(false), transferIdleSince(0)
+    {
+        resetStatistics();
+    }
+
+    /**
+     * Allocates a framebuffer block. The block will have at least the width requested. The
+     * height of the allocated block can be lower than requested if not enough memory is
+     * available. Waits for the transfer until a quarter of the ring, or the full height, is
+     * free. A block takes at most half of the ring, unless a line is larger, so the next
+     * block can be drawn while it is transferred.
+     *
+     * @param          x      The absolute x coordinate of the block on the screen.
+     * @param          y      The absolute y coordinate of the block on the screen.
+     * @param          width  The width of the block.
+     * @param          height The height of the block.
+     * @param [in,out] block  Pointer to pointer to return the block address in.
+     *
+     * @return The height of the allocated block.
+     */
+    virtual uint16_t allocateBlock(const uint16_t x, const uint16_t y, const uint16_t width, const uint16_t height, uint8_t** block)
+    {
+        assert(allocated == drawn && "The previous block must be marked ready for transfer first");
+        const uint32_t stride = width * bytes_pr_pixel;
+        assert(stride > 0 && stride <= buffer_size && "A line of the block does not fit in the ring");
+        // Do not settle for thin blocks when the transfer will soon free more memory
+        const uint32_t wantedLines = MIN((uint32_t)height, MAX(1u, buffer_size / 4 / stride));
+        // Leave room for drawing the next block while this one is transferred
+        const uint32_t maxLines = MAX(wantedLines, buffer_size / 2 / stride);
+
+        uint32_t position;
+        uint32_t padding;
+        uint32_t lines;
+        bool stalled = false;
+        uint32_t stallStart = 0;
+        while (true)
+        {
+            const uint32_t inUse = head - released;
+            TOUCHGFX_RING_BARRIER(); // Read the released memory before reusing it
+            // With nothing waiting for transfer, the whole ring is free from its start
+            position = inUse == 0 ? 0 : headOffset;
+            padding = 0;
+            if ((buffer_size - position) / stride < wantedLines)
+            {
+                // Too little room before the end of the ring, continue from the start
+                padding = buffer_size - position;
+                position = 0;
+            }
+            uint32_t available = 0;
+            if (inUse == 0)
+            {
+                available = buffer_size;
+            }
+            else if (inUse + padding < buffer_size && allocated - freed < max_blocks)
+            {
+                available = buffer_size - inUse - padding;
+            }
+            lines = MIN(available, buffer_size - position) / stride;
+            if (lines >= wantedLines)
+            {
+                break;
+            }
+            if (!stalled)
+            {
+                stalled = true;
+                stallStart = now();
+                statistics.drawStalls++;
+            }
+            FrameBufferAllocatorWaitOnTransfer();
+        }
+        if (stalled)
+        {
+            statistics.drawStallTime += now() - stallStart;
+        }
+
+        lines = MIN(MIN(lines, maxLines), (uint32_t)height);
+        const uint32_t size = (lines * stride + 3) & ~3u;
+        Block& b = blocks[allocated % max_blocks];
+        b.rect = Rect(x, y, width, lines);
+        b.offset = position;
+        b.span = padding + size;
+        head += b.span;
+        headOffset = position + size;
+        if (headOffset == buffer_size)
+        {
+            headOffset = 0;
+        }
+        allocated++;
+
+        statistics.blocks++;
+        statistics.bytes += size;
+        if (lines < (uint32_t)height)
+        {
+            statistics.shortBlocks++;
+        }
+        statistics.maxBytesInUse = MAX(statistics.maxBytesInUse, head - released);
+
+        *block = reinterpret_cast<uint8_t*>(memory) + position;
+        return lines;
+    }
+
+    /** Marks a previously allocated block as ready to be transferred to the LCD. */
+    virtual void markBlockReadyForTransfer()
+    {
+        assert(allocated == drawn + 1 && "No block allocated");
+        TOUCHGFX_RING_BARRIER(); // Publish the pixels and the block before the counter
+        drawn = allocated;
+        if (transferIdle)
+        {
+            transferIdle = false;
+            statistics.transferStalls++;
+            statistics.transferStallTime += now() - transferIdleSince;
+        }
+        FrameBufferAllocatorSignalBlockDrawn();
+    }
+
+    /**
+     * Check if a block is ready for transfer to the LCD.
+     *
+     * @return True if a block is ready for transfer.
+     */
+    virtual bool hasBlockReadyForTransfer()
+    {
+        return drawn != sending;
+    }
+
+    /**
+     * Get the block ready for transfer.
+     *
+     * @param [in,out] rect Reference to rect to write block x, y, width, and height.
+     *
+     * @return Returns the address of the block ready for transfer.
+     */
+    virtual const uint8_t* getBlockForTransfer(Rect& rect)
+    {
+        assert(hasBlockReadyForTransfer());
+        TOUCHGFX_RING_BARRIER(); // Read the counter before the block
+        const Block& b = blocks[sending % max_blocks];
+        rect = b.rect;
+        sending++;
+        return reinterpret_cast<const uint8_t*>(memory) + b.offset;
+    }
+
+    virtual const Rect& peekBlockForTransfer()
+    {
+        assert(hasBlockReadyForTransfer());
+        TOUCHGFX_RING_BARRIER();
+        return blocks[sending % max_blocks].rect;
+    }
+
+    virtual bool hasEmptyBlock()
+    {
+        return allocated - freed < max_blocks && head - released < buffer_size;
+    }
+
+    /**
+     * Free a block after transfer to the LCD.
+     *
+     * Marks the oldest block being transferred as transferred and its memory ready to reuse.
+     */
+    virtual void freeBlockAfterTransfer()
+    {
+        assert(freed != sending && "No block being transferred");
+        const uint32_t span = blocks[freed % max_blocks].span;
+        TOUCHGFX_RING_BARRIER(); // Complete the transfer before the memory is reused
+        released += span;
+        freed++;
+        if (drawn == sending)
+        {
+            // Nothing left to transfer, the time until the next block is drawn is a stall
+            transferIdleSince = now();
+            transferIdle = true;
+        }
+    }
+
+    /**
+     * Gets the counters of the allocator. The transfer stalls are approximate, as they are
+     * updated by both sides.
+     *
+     * @return The statistics.
+     */
+    const Statistics& getStatistics() const
+    {
+        return statistics;
+    }
+
+    /** Resets the counters of the allocator. */
+    void resetStatistics()
+    {
+        memset(&statistics, 0, sizeof(statistics));
+    }
+
+private:
+    // A compile error here means max_blocks is not a power of two, which the free running counters need
+    typedef char max_blocks_must_be_a_power_of_two[(max_blocks & (max_blocks - 1)) == 0 ? 1 : -1];
+
+    struct Block
+    {
+        Rect rect;       ///< The area of the block on the screen
+        uint32_t offset; ///< Offset of the pixels in the ring
+        uint32_t span;   ///< Bytes of the ring taken by the block, including the padding skipped before it
+    };
+
+    static uint32_t now()
+    {
+#ifdef SIMULATOR
+        return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#else
+        return HAL::getInstance()->getCPUCycles();
+#endif
+    }
+
+    uint32_t memory[buffer_size / 4];
+    Block blocks[max_blocks];
+
+    // Free running counters of blocks, each written by one side only
+    uint32_t allocated;         ///< Blocks allocated, written by the drawing side
+    volatile uint32_t drawn;    ///< Blocks drawn, written by the drawing side
+    volatile uint32_t sending;  ///< Blocks taken for transfer, written by the transfer side
+    volatile uint32_t freed;    ///< Blocks transferred, written by the transfer side
+    uint32_t head;              ///< Bytes of the ring allocated, written by the drawing side
+    volatile uint32_t released; ///< Bytes of the ring freed, written by the transfer side
+
+    // The counters of bytes wrap at 2^32, which is not a multiple of every buffer_size, so the
+    // offset of the next allocation is kept apart instead of taking head modulo buffer_size
+    uint32_t headOffset; ///< Offset in the ring of the next allocation, written by the drawing side
+
+    volatile bool transferIdle;
+    volatile uint32_t transferIdleSince;
+    Statistics statistics;
+};
+
+} // namespace touchgfx
+
+#endif // TOUCHGFX_RINGBLOCKALLOCATOR_HPP
@@ -773,7 +773,9 @@ protected:
      */
     static uint16_t getNumLines(TextProvider& textProvider, WideTextAction wideTextAction, TextDirection textDirection, const Font* font, int16_t width);
 
+    friend class CachedTextArea;
     friend class Font;
+    friend class NumericTextArea;
     friend class TextArea;
     friend class TextAreaWithWildcardBase;
 
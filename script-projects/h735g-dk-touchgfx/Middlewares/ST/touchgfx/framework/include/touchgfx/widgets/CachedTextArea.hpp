@@ -0,0 +1,115 @@
+/******************************************************************************
+* Copyright (c) 2018(-2021) STMicroelectronics.
+* All rights reserved.
+*
+* This file is part of the TouchGFX 4.18.1 distribution.
+*
+* This software is licensed under terms that can be found in the LICENSE file in
+* the root directory of this software component.
+* If no LICENSE file comes with this software, it is provided AS-IS.
+*
+*******************************************************************************/
+
+/**
+ * @file touchgfx/widgets/CachedTextArea.hpp
+ *
+ * Declares the touchgfx::CachedTextArea class.
+ */
+#ifndef TOUCHGFX_CACHEDTEXTAREA_HPP
+#define TOUCHGFX_CACHEDTEXTAREA_HPP
+
+#include <touchgfx/hal/Types.hpp>
+#include <touchgfx/lcd/LCD.hpp>
+#include <touchgfx/widgets/GlyphRunCache.hpp>
+#include <touchgfx/widgets/TextArea.hpp>
+
+namespace touchgfx
+{
+/**
+ * A TextArea which can keep the glyphs of its text in a GlyphRunCache. The text is laid out
+ * once into the cache, and invalidated parts of the CachedTextArea are redrawn from the
+ * cached glyphs, which is useful for static labels that are often partly covered by moving
+ * widgets. The cache is laid out again when the text, font, size, alignment, line space,
+ * indentation or wide text action changes. An invalidated part is drawn exactly as drawing
+ * the whole CachedTextArea leaves it, also when the text has more glyphs than the cache
+ * holds, unlike a TextArea where LCD::drawString() may choose the lines to draw by the
+ * invalidated area. Without a cache, or with text rotated by setRotation(), the
+ * CachedTextArea is drawn like a TextArea.
+ *
+ * @see GlyphRunCache
+ */
+class CachedTextArea : public TextArea
+{
+public:
+    CachedTextArea()
+        : TextArea(), glyphRunCache(0)
+    {
+    }
+
+    virtual void draw(const Rect& area) const;
+
+    /**
+     * Sets a cache for the glyphs of the text, or 0 to draw the text without a cache.
+     *
+     * @param [in] cache The cache to use. A cache must not be shared between text areas.
+     */
+    void setGlyphRunCache(GlyphRunCache* cache)
+    {
+        glyphRunCache = cache;
+        if (glyphRunCache)
+        {
+            glyphRunCache->invalidate();
+        }
+    }
+
+    /**
+     * Gets the glyph run cache previously set using setGlyphRunCache.
+     *
+     * @return The glyph run cache, or 0 if none is set.
+     */
+    GlyphRunCache* getGlyphRunCache() const
+    {
+        return glyphRunCache;
+    }
+
+protected:
+    GlyphRunCache* glyphRunCache; ///< The laid out glyphs of the text, or 0 if not cached.
+
+    /**
+     * Draws the text from the glyph run cache, laying it out first if the cache does not
+     * match the text and visuals.
+     *
+     * @param  area    The invalidated area, relative to the CachedTextArea.
+     * @param  visuals The visuals of the text.
+     *
+     * @return False if the text must be drawn with LCD::drawString() instead.
+     */
+    bool drawGlyphRuns(const Rect& area, const LCD::StringVisuals& visuals) const;
+
+private:
+    class GlyphRunRecorder;
+
+    /**
+     * Lays out the whole text, drawing its glyphs solid into an LCD which records them.
+     *
+     * @param [in] recorder The LCD recording the glyphs.
+     * @param      visuals  The visuals of the text.
+     */
+    void layoutText(LCD& recorder, const LCD::StringVisuals& visuals) const;
+
+    /**
+     * Draws the glyphs that intersect the invalidated area.
+     *
+     * @param  glyphs         The glyphs, relative to the CachedTextArea.
+     * @param  numberOfGlyphs The number of glyphs.
+     * @param  widgetArea     The absolute area of the CachedTextArea.
+     * @param  area           The invalidated area, relative to the CachedTextArea.
+     * @param  color          The color of the text.
+     * @param  alpha          The alpha of the text.
+     */
+    static void drawGlyphs(const GlyphRunCache::Glyph* glyphs, uint16_t numberOfGlyphs, const Rect& widgetArea, const Rect& area, colortype color, uint8_t alpha);
+};
+
+} // namespace touchgfx
+
+#endif // TOUCHGFX_CACHEDTEXTAREA_HPP
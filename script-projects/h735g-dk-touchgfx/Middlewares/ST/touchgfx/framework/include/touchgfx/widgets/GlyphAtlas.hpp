@@ -0,0 +1,239 @@
+/******************************************************************************
+* Copyright (c) 2018(-2021) STMicroelectronics.
+* All rights reserved.
+*
+* This file is part of the TouchGFX 4.18.1 distribution.
+*
+* This software is licensed under terms that can be found in the LICENSE file in
+* the root directory of this software component.
+* If no LICENSE file comes with this software, it is provided AS-IS.
+*
+*******************************************************************************/
+
+/**
+ * @file touchgfx/widgets/GlyphAtlas.hpp
+ *
+ * Declares the touchgfx::GlyphAtlas class.
+ */
+#ifndef TOUCHGFX_GLYPHATLAS_HPP
+#define TOUCHGFX_GLYPHATLAS_HPP
+
+#include <touchgfx/Bitmap.hpp>
+#include <touchgfx/Font.hpp>
+#include <touchgfx/Unicode.hpp>
+#include <touchgfx/hal/Types.hpp>
+
+namespace touchgfx
+{
+/**
+ * A small set of glyphs of a font, rasterized once into a dynamic bitmap in the bitmap cache.
+ * Every glyph is placed in a cell of the same size, and the cells are stacked vertically in
+ * an A4 bitmap for fonts with 4 bits per pixel, or a bitmap with a byte of coverage per pixel
+ * for fonts with 8 bits per pixel. A glyph is drawn by copying its cell, which the DMA can do
+ * with a single BLIT_OP_COPY_A4 or BLIT_OP_COPY_A8 operation. The cells are laid out so a
+ * cell drawn at the pen position of its glyph leaves the same pixels as LCD::drawString().
+ *
+ * An atlas can be shared by all the NumericTextArea widgets using its font.
+ *
+ * @see NumericTextArea
+ *
+ * @note The bitmap cache must be set up with room for a dynamic bitmap, see
+ *       Bitmap::registerBitmapDatabase(). If the cache is cleared, the atlas must be created
+ *       again.
+ */
+class GlyphAtlas
+{
+public:
+    static const uint8_t MAX_CHARACTERS = 16; ///< The maximum number of characters in an atlas
+
+    GlyphAtlas()
+        : font(0), bitmapId(BITMAP_INVALID), numberOfCharacters(0), cellTop(0)
+    {
+        cell.dataOffset = 0;
+        cell.unicode = 0;
+        cell._width = 0;
+        cell._height = 0;
+        cell._top = 0;
+        cell.left = 0;
+        cell._advance = 0;
+        cell._kerningTablePos = 0;
+        cell.kerningTableSize = 0;
+        cell.flags = 0;
+    }
+
+    /**
+     * Rasterizes the glyphs of the given characters into a new dynamic bitmap. Characters
+     * missing from the font are left out of the atlas. Any bitmap previously created by the
+     * atlas is deleted first.
+     *
+     * @param  atlasFont  The font to rasterize, with 4 or 8 bits per pixel.
+     * @param  characters (Optional) The characters to rasterize, at most MAX_CHARACTERS.
+     *
+     * @return True if the atlas was created. The atlas is not created if the font has another
+     *         bit depth, has kerning between the characters, has glyphs rising above the
+     *         font height or wider than 255 pixels, or if the dynamic bitmap could not be
+     *         allocated.
+     */
+    bool create(const Font* atlasFont, const char* characters = "0123456789-.");
+
+    /** Deletes the dynamic bitmap of the atlas. */
+    void destroy();
+
+    /**
+     * Query if the atlas has been created.
+     *
+     * @return True if the glyphs are rasterized.
+     */
+    bool isValid() const
+    {
+        return bitmapId != BITMAP_INVALID;
+    }
+
+    /**
+     * Gets the font rasterized into the atlas.
+     *
+     * @return The font, or 0 if the atlas has not been created.
+     */
+    const Font* getFont() const
+    {
+        return font;
+    }
+
+    /**
+     * Gets the dynamic bitmap holding the cells.
+     *
+     * @return The bitmap, or BITMAP_INVALID if the atlas has not been created.
+     */
+    BitmapId getBitmapId() const
+    {
+        return bitmapId;
+    }
+
+    /**
+     * Gets the index of the cell of a character.
+     *
+     * @param  character The character.
+     *
+     * @return The index, or -1 if the character is not in the atlas.
+     */
+    int16_t indexOf(Unicode::UnicodeChar character) const
+    {
+        for (uint8_t i = 0; i < numberOfCharacters; i++)
+        {
+            if (characters[i] == character)
+            {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * Gets the distance the pen is moved by a character.
+     *
+     * @param  index The index of the cell.
+     *
+     * @return The advance of the glyph.
+     */
+    uint16_t getAdvance(int16_t index) const
+    {
+        return advances[index];
+    }
+
+    /**
+     * Gets the pixels of a cell. The address is looked up every time, as the bitmap cache may
+     * move the dynamic bitmap when it is compacted.
+     *
+     * @param  index The index of the cell.
+     *
+     * @return The first row of the cell.
+     */
+    const uint8_t* getCellData(int16_t index) const
+    {
+        return Bitmap::dynamicBitmapGetAddress(bitmapId) + index * getCellHeight() * getCellStride();
+    }
+
+    /**
+     * Gets a glyph with the size of a cell, placed relative to the pen like the glyphs of the
+     * atlas.
+     *
+     * @return The glyph of a cell.
+     */
+    const GlyphNode* getCellGlyph() const
+    {
+        return &cell;
+    }
+
+    /**
+     * Gets the horizontal offset of a cell from the pen position.
+     *
+     * @return The offset of the left edge of the cells.
+     */
+    int16_t getCellLeft() const
+    {
+        return cell.left;
+    }
+
+    /**
+     * Gets the vertical offset of a cell from the top of the line.
+     *
+     * @return The offset of the top edge of the cells.
+     */
+    int16_t getCellTop() const
+    {
+        return cellTop;
+    }
+
+    /**
+     * Gets the width of a cell, which is even.
+     *
+     * @return The width of the cells.
+     */
+    int16_t getCellWidth() const
+    {
+        return cell._width;
+    }
+
+    /**
+     * Gets the height of a cell.
+     *
+     * @return The height of the cells.
+     */
+    int16_t getCellHeight() const
+    {
+        return cell._height;
+    }
+
+    /**
+     * Gets the number of bytes from one row of a cell to the next.
+     *
+     * @return The stride of the bitmap.
+     */
+    uint16_t getCellStride() const
+    {
+        return cell._width * getBitsPerPixel() / 8;
+    }
+
+    /**
+     * Gets the bit depth of the cells, the bit depth of the font.
+     *
+     * @return 4 or 8.
+     */
+    uint8_t getBitsPerPixel() const
+    {
+        return font ? font->getBitsPerPixel() : 0;
+    }
+
+private:
+    const Font* font;
+    BitmapId bitmapId;
+    Unicode::UnicodeChar characters[MAX_CHARACTERS];
+    uint8_t advances[MAX_CHARACTERS];
+    uint8_t numberOfCharacters;
+    GlyphNode cell;
+    int16_t cellTop;
+};
+
+} // namespace touchgfx
+
+#endif // TOUCHGFX_GLYPHATLAS_HPP
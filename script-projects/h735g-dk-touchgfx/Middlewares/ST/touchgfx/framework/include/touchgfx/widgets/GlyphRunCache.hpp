@@ -0,0 +1,119 @@
+/******************************************************************************
+* Copyright (c) 2018(-2021) STMicroelectronics.
+* All rights reserved.
+*
+* This file is part of the TouchGFX 4.18.1 distribution.
+*
+* This software is licensed under terms that can be found in the LICENSE file in
+* the root directory of this software component.
+* If no LICENSE file comes with this software, it is provided AS-IS.
+*
+*******************************************************************************/
+
+/**
+ * @file touchgfx/widgets/GlyphRunCache.hpp
+ *
+ * Declares the touchgfx::GlyphRunCache class.
+ */
+#ifndef TOUCHGFX_GLYPHRUNCACHE_HPP
+#define TOUCHGFX_GLYPHRUNCACHE_HPP
+
+#include <touchgfx/hal/Types.hpp>
+#include <touchgfx/Font.hpp>
+#include <touchgfx/Unicode.hpp>
+
+namespace touchgfx
+{
+/**
+ * The glyphs of a CachedTextArea, as laid out by LCD::drawString(). A CachedTextArea lays
+ * out its text once, and redraws an invalidated part of the text by drawing only the cached
+ * glyphs inside that part. Ligatures, contextual forms, kerning and word wrapping are not
+ * evaluated again until the text, font, size, alignment, line space, indentation or wide
+ * text action of the CachedTextArea changes.
+ *
+ * The glyphs are stored in a buffer supplied by the application. If the text has more
+ * glyphs than the buffer can hold, the CachedTextArea is drawn without the cache.
+ *
+ * @see CachedTextArea
+ *
+ * @note The cache holds pointers to the glyph data of the font. If the glyph data can be
+ *       moved or evicted, e.g. by a FontCache, invalidate() must be called when that
+ *       happens. A CachedTextArea only holds a pointer to its text, so invalidate() must
+ *       also be called if the contents of the text buffer are changed.
+ */
+class GlyphRunCache
+{
+public:
+    /** A glyph drawn by LCD::drawString(), relative to the CachedTextArea. */
+    struct Glyph
+    {
+        GlyphNode node;          ///< Copy of the glyph, as a font may reuse the GlyphNode it returns
+        const uint8_t* data;     ///< The pixel data of the glyph
+        int16_t x;               ///< The pen position of the glyph
+        int16_t y;               ///< The top of the glyph
+        uint8_t bitsPerPixel;    ///< Bit depth of the glyph data
+        uint8_t byteAlignRow;    ///< Each row of glyph data starts in a new byte
+    };
+
+    /**
+     * Initializes a new instance of the GlyphRunCache class.
+     *
+     * @param [in] glyphs   Buffer for the glyphs.
+     * @param      capacity The number of glyphs in the buffer.
+     */
+    GlyphRunCache(Glyph* glyphs, uint16_t capacity)
+        : glyphs(glyphs), capacity(capacity), numberOfGlyphs(0), overflow(false),
+          text(0), font(0), width(0), height(0), linespace(0), alignment(LEFT), textDirection(TEXT_DIRECTION_LTR), indentation(0), wideTextAction(WIDE_TEXT_NONE)
+    {
+    }
+
+    /** Forces the glyphs to be laid out again the next time the CachedTextArea is drawn. */
+    void invalidate()
+    {
+        text = 0;
+    }
+
+    /**
+     * Gets the number of glyphs laid out, which is zero until the CachedTextArea has been drawn
+     * and when the text has more glyphs than the buffer can hold.
+     *
+     * @return The number of glyphs.
+     */
+    uint16_t getNumberOfGlyphs() const
+    {
+        return numberOfGlyphs;
+    }
+
+    /**
+     * Query if the text had more glyphs than the buffer can hold.
+     *
+     * @return True if the CachedTextArea lays out the whole text every time it is drawn,
+     *         using the buffer to draw the glyphs a buffer at a time.
+     */
+    bool hasOverflow() const
+    {
+        return overflow;
+    }
+
+private:
+    Glyph* glyphs;
+    uint16_t capacity;
+    uint16_t numberOfGlyphs;
+    bool overflow;
+
+    const Unicode::UnicodeChar* text; ///< The laid out text, zero if nothing is cached
+    const Font* font;
+    int16_t width;
+    int16_t height;
+    int16_t linespace;
+    Alignment alignment;
+    TextDirection textDirection;
+    uint8_t indentation;
+    WideTextAction wideTextAction;
+
+    friend class CachedTextArea;
+};
+
+} // namespace touchgfx
+
+#endif // TOUCHGFX_GLYPHRUNCACHE_HPP
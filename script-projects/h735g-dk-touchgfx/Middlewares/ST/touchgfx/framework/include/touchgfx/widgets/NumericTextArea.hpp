@@ -0,0 +1,158 @@
+/******************************************************************************
+* Copyright (c) 2018(-2021) STMicroelectronics.
+* All rights reserved.
+*
+* This file is part of the TouchGFX 4.18.1 distribution.
+*
+* This software is licensed under terms that can be found in the LICENSE file in
+* the root directory of this software component.
+* If no LICENSE file comes with this software, it is provided AS-IS.
+*
+*******************************************************************************/
+
+/**
+ * @file touchgfx/widgets/NumericTextArea.hpp
+ *
+ * Declares the touchgfx::NumericTextArea class.
+ */
+#ifndef TOUCHGFX_NUMERICTEXTAREA_HPP
+#define TOUCHGFX_NUMERICTEXTAREA_HPP
+
+#include <touchgfx/Unicode.hpp>
+#include <touchgfx/hal/Types.hpp>
+#include <touchgfx/widgets/GlyphAtlas.hpp>
+#include <touchgfx/widgets/TextAreaWithWildcard.hpp>
+
+namespace touchgfx
+{
+/**
+ * A TextAreaWithOneWildcard showing a number, for values that are updated often. The value is
+ * formatted into the wildcard by setValue() without Unicode::snprintf(), and only the
+ * characters that changed, or moved, are invalidated.
+ *
+ * With a GlyphAtlas of the font of the text, every character is drawn by copying its cell
+ * from the atlas, which is a single BLIT_OP_COPY_A4 or BLIT_OP_COPY_A8 operation when the
+ * DMA supports it, instead of laying out the text with LCD::drawString(). Cells cut by the
+ * invalidated area at an odd pixel of an A4 atlas, or on a rotated display, are drawn by
+ * LCD::drawGlyph().
+ *
+ * The NumericTextArea is drawn like a TextAreaWithOneWildcard if it has no atlas, the text
+ * of the TypedText is not exactly the wildcard, the atlas does not hold every character of
+ * the wildcard, or the text is rotated, right to left or has a wide text action.
+ *
+ * @see GlyphAtlas
+ */
+class NumericTextArea : public TextAreaWithOneWildcard
+{
+public:
+    static const uint8_t MAX_CHARACTERS = 12; ///< Room for "-2147483648" with a decimal point
+
+    NumericTextArea()
+        : TextAreaWithOneWildcard(), glyphAtlas(0), value(0), decimals(0)
+    {
+        buffer[0] = '0';
+        buffer[1] = 0;
+        setWildcard(buffer);
+    }
+
+    virtual void draw(const Rect& area) const;
+
+    /**
+     * Sets the atlas to draw the characters from, or 0 to draw the text with
+     * LCD::drawString(). The atlas must hold the glyphs of the font of the TypedText.
+     *
+     * @param  atlas The atlas to use.
+     */
+    void setGlyphAtlas(const GlyphAtlas* atlas)
+    {
+        glyphAtlas = atlas;
+    }
+
+    /**
+     * Gets the atlas previously set using setGlyphAtlas.
+     *
+     * @return The atlas, or 0 if none is set.
+     */
+    const GlyphAtlas* getGlyphAtlas() const
+    {
+        return glyphAtlas;
+    }
+
+    /**
+     * Formats a value into the wildcard, and invalidates the characters that changed. The
+     * value is shown with a leading '-' if negative, and a '.' before the last decimals
+     * digits, e.g. "-0.05" for value -5 with 2 decimals.
+     *
+     * @param  newValue    The value.
+     * @param  newDecimals (Optional) The number of digits after the decimal point, at most 9.
+     */
+    void setValue(int32_t newValue, uint8_t newDecimals = 0);
+
+    /**
+     * Gets the value previously set using setValue.
+     *
+     * @return The value.
+     */
+    int32_t getValue() const
+    {
+        return value;
+    }
+
+    /**
+     * Gets the number of decimals previously set using setValue.
+     *
+     * @return The number of digits after the decimal point.
+     */
+    uint8_t getDecimals() const
+    {
+        return decimals;
+    }
+
+protected:
+    const GlyphAtlas* glyphAtlas;                   ///< The atlas to draw from, or 0.
+    int32_t value;                                  ///< The value shown.
+    uint8_t decimals;                               ///< The digits after the decimal point.
+    Unicode::UnicodeChar buffer[MAX_CHARACTERS + 1]; ///< The formatted value, the wildcard.
+
+    /**
+     * Query if the text can be drawn from the atlas.
+     *
+     * @param  text The wildcard to draw.
+     *
+     * @return True if every character is drawn from the atlas.
+     */
+    bool canDrawFromAtlas(const Unicode::UnicodeChar* text) const;
+
+    /**
+     * Gets the pen position of the first character, as placed by LCD::drawString().
+     *
+     * @param  text The wildcard to draw, which can be drawn from the atlas.
+     *
+     * @return The pen position relative to the NumericTextArea.
+     */
+    int16_t getFirstPen(const Unicode::UnicodeChar* text) const;
+
+    /**
+     * Gets the cell of a character drawn at a pen position.
+     *
+     * @param  pen The pen position relative to the NumericTextArea.
+     *
+     * @return The cell relative to the NumericTextArea.
+     */
+    Rect getCellRect(int16_t pen) const
+    {
+        return Rect(pen + glyphAtlas->getCellLeft(), glyphAtlas->getCellTop(), glyphAtlas->getCellWidth(), glyphAtlas->getCellHeight());
+    }
+
+    /**
+     * Invalidates the cells of the characters of a previous wildcard that are no longer
+     * drawn at the same position, and the cells of the new characters.
+     *
+     * @param  previous The previous wildcard, which can be drawn from the atlas.
+     */
+    void invalidateChangedCharacters(const Unicode::UnicodeChar* previous) const;
+};
+
+} // namespace touchgfx
+
+#endif // TOUCHGFX_NUMERICTEXTAREA_HPP
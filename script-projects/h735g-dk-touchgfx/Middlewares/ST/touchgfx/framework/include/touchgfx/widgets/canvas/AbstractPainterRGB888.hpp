@@ -42,6 +42,60 @@ public:
 
     virtual void render(uint8_t* ptr, int x, int xAdjust, int y, unsigned count, const uint8_t* covers);
 
+    /**
+     * Mix colors from a new pixel and a buffer pixel with the given alpha applied to the
+     * new pixel, and the inverse alpha applied to the buffer pixel. Red and blue are
+     * blended as two 16 bit lanes of the same 32 bit word, so a pixel costs two
+     * multiply-accumulates instead of three. The result is identical to blending each
+     * channel using LCD::div255().
+     *
+     * @param  newpix The new pixel value (0x00RRGGBB).
+     * @param  bufpix The buffer pixel value (0x00RRGGBB).
+     * @param  alpha  The alpha to apply to the new pixel.
+     *
+     * @return The result of blending the two colors into a new color (0x00RRGGBB).
+     */
+    FORCE_INLINE_FUNCTION static uint32_t mixColors(uint32_t newpix, uint32_t bufpix, uint8_t alpha)
+    {
+        const uint8_t ialpha = 0xFF - alpha;
+        return LCD::div255rb((newpix & 0xFF00FF) * alpha + (bufpix & 0xFF00FF) * ialpha) |
+               LCD::div255g((newpix & 0x00FF00) * alpha + (bufpix & 0x00FF00) * ialpha);
+    }
+
+    /**
+     * Blend a color into a pixel in the framebuffer.
+     *
+     * @param [in,out] p      Pointer to the pixel in the framebuffer (blue, green, red).
+     * @param          newpix The color to blend into the framebuffer (0x00RRGGBB).
+     * @param          alpha  The alpha to apply to the color.
+     */
+    FORCE_INLINE_FUNCTION static void blendPixel(uint8_t* p, uint32_t newpix, uint8_t alpha)
+    {
+        const uint32_t pix = mixColors(newpix, p[0] | (p[1] << 8) | (p[2] << 16), alpha);
+        p[0] = pix;
+        p[1] = pix >> 8;
+        p[2] = pix >> 16;
+    }
+
+    /**
+     * Find the number of solid pixels at the start of a span, i.e. the number of leading
+     * covers that are 0xFF.
+     *
+     * @param  covers The covers of the span.
+     * @param  count  The number of pixels in the span.
+     *
+     * @return The number of leading solid pixels.
+     */
+    FORCE_INLINE_FUNCTION static unsigned solidSpanLength(const uint8_t* covers, unsigned count)
+    {
+        unsigned length = 0;
+        while (length < count && covers[length] == 0xFF)
+        {
+            length++;
+        }
+        return length;
+    }
+
 protected:
     /**
      * @copydoc AbstractPainterRGB565::renderInit()
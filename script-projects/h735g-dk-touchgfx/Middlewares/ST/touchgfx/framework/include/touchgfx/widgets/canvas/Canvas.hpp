@@ -160,6 +160,8 @@ private:
     void transformFrameBufferToDisplay(CWRUtil::Q5& x, CWRUtil::Q5& y) const;
 
     void close();
+
+    void registerOutline();
 };
 
 } // namespace touchgfx
@@ -69,17 +69,17 @@ public:
     }
 
     /**
-     * Draws the given invalidated area. If the underlying CanvasWidgetRenderer fail to
-     * render the widget (if the widget is too complex), the invalidated area is cut into
-     * smaller slices (horizontally) which are then drawn separately. If drawing a single
-     * raster line fails, that line is considered too complex and skipped (it is left
-     * blank/transparent) and drawing continues on the next raster line.
-     *
-     * If drawing has failed at least once, which means that the number of horizontal lines
-     * draw has been reduced, the number of successfully drawn horizontal lines is
-     * remembered for the next invocation of draw(). A future call to draw() would then
-     * start off with the reduced number of horizontal lines to prevent potentially drawing
-     * the canvas widget in vain, as happened previously in draw().
+     * Draws the given invalidated area. The area is cut into horizontal bands sized to fit
+     * the buffer of CanvasWidgetRenderer up front, using the number of Cell objects per
+     * raster line predicted for the shape. The first prediction is estimated from the
+     * minimal rectangle of the shape, later predictions use the density of the previous
+     * outline drawn.
+     *
+     * If the outline of a band is denser than predicted and does not fit, the band is
+     * halved and drawn again. A single raster line that does not fit is drawn in parts,
+     * and if the raster lines are too wide for the buffer altogether, the area is drawn in
+     * columns. Only if a single pixel cannot be drawn is it skipped. Retries and skipped
+     * raster lines are counted in CanvasWidgetRenderer::getMemoryReport().
      *
      * @param  invalidatedArea The invalidated area.
      *
@@ -125,12 +125,9 @@ public:
     virtual Rect getSolidRect() const;
 
     /**
-     * Resets the maximum render lines. The maximum render lines is decreates if the
-     * rendering buffer is found to be too small to render a complex outline. This is done
-     * to speed up subsequent draws by not having to draw the outline in vain (as was done
-     * previously) to force the outline to be drawn in smaller blocks. The
-     * resetMaxRenderLines() will try to render the entire outline in one go on the next
-     * call to draw().
+     * Resets the number of Cell objects per raster line predicted for the shape. The next
+     * call to draw() estimates it from the minimal rectangle of the shape again, e.g. after
+     * the shape has changed completely.
      */
     void resetMaxRenderLines();
 
@@ -148,8 +145,12 @@ public:
     virtual bool drawCanvasWidget(const Rect& invalidatedArea) const = 0;
 
 private:
+    void drawBands(const Rect& area) const;
+    void drawSplitLine(const Rect& line) const;
+    int16_t predictRenderLines(unsigned capacity) const;
+
     AbstractPainter* canvasPainter;
-    mutable int16_t maxRenderLines;
+    mutable uint16_t cellsPerLine; ///< Predicted number of Cell objects per raster line, 0 if not known yet
     uint8_t alpha;
 };
 
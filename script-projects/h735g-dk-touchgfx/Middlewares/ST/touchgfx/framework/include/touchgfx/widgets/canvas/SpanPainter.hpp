@@ -0,0 +1,571 @@
+/******************************************************************************
+* Copyright (c) 2018(-2021) STMicroelectronics.
+* All rights reserved.
+*
+* This file is part of the TouchGFX 4.18.1 distribution.
+*
+* This software is licensed under terms that can be found in the LICENSE file in
+* the root directory of this software component.
+* If no LICENSE file comes with this software, it is provided AS-IS.
+*
+*******************************************************************************/
+
+/**
+ * @file touchgfx/widgets/canvas/SpanPainter.hpp
+ *
+ * Declares the touchgfx::SpanRenderer and touchgfx::SpanPainter class templates together with
+ * the pixel sources and destination formats they can be instantiated with.
+ */
+#ifndef TOUCHGFX_SPANPAINTER_HPP
+#define TOUCHGFX_SPANPAINTER_HPP
+
+#include <touchgfx/hal/Types.hpp>
+#include <touchgfx/Bitmap.hpp>
+#include <touchgfx/Color.hpp>
+#include <touchgfx/lcd/LCD.hpp>
+#include <touchgfx/widgets/canvas/AbstractPainter.hpp>
+#include <touchgfx/widgets/canvas/AbstractPainterRGB888.hpp>
+
+namespace touchgfx
+{
+/**
+ * Destination format for painting on a RGB888 framebuffer. Pixels are stored as blue, green,
+ * red.
+ *
+ * @see SpanRenderer
+ */
+class SpanDestinationRGB888
+{
+public:
+    static const Bitmap::BitmapFormat FORMAT = Bitmap::RGB888; ///< The framebuffer format
+    static const int BYTES_PER_PIXEL = 3;                      ///< Size of a pixel in the framebuffer
+
+    /**
+     * Write a solid color to a pixel in the framebuffer.
+     *
+     * @param [in,out] p     Pointer to the pixel in the framebuffer.
+     * @param          color The color (0x00RRGGBB).
+     */
+    FORCE_INLINE_FUNCTION static void writePixel(uint8_t* p, uint32_t color)
+    {
+        p[0] = color;
+        p[1] = color >> 8;
+        p[2] = color >> 16;
+    }
+
+    /**
+     * Blend a color into a pixel in the framebuffer.
+     *
+     * @param [in,out] p     Pointer to the pixel in the framebuffer.
+     * @param          color The color (0x00RRGGBB).
+     * @param          alpha The alpha to apply to the color.
+     */
+    FORCE_INLINE_FUNCTION static void blendPixel(uint8_t* p, uint32_t color, uint8_t alpha)
+    {
+        AbstractPainterRGB888::blendPixel(p, color, alpha);
+    }
+};
+
+/**
+ * Destination format for painting on a RGB565 framebuffer. Colors are reduced to 16 bits the
+ * same way as LCD16bpp::getNativeColor() and blended like AbstractPainterRGB565::mixColors().
+ *
+ * @see SpanRenderer
+ */
+class SpanDestinationRGB565
+{
+public:
+    static const Bitmap::BitmapFormat FORMAT = Bitmap::RGB565; ///< The framebuffer format
+    static const int BYTES_PER_PIXEL = 2;                      ///< Size of a pixel in the framebuffer
+
+    static const uint16_t RMASK = 0xF800; ///< Mask for red   (1111100000000000)
+    static const uint16_t GMASK = 0x07E0; ///< Mask for green (0000011111100000)
+    static const uint16_t BMASK = 0x001F; ///< Mask for blue  (0000000000011111)
+
+    /**
+     * Convert a 24 bit color to RGB565.
+     *
+     * @param  color The color (0x00RRGGBB).
+     *
+     * @return The color as RGB565.
+     */
+    FORCE_INLINE_FUNCTION static uint16_t toRGB565(uint32_t color)
+    {
+        return ((color >> 8) & RMASK) | ((color >> 5) & GMASK) | ((color >> 3) & BMASK);
+    }
+
+    /** @copydoc SpanDestinationRGB888::writePixel() */
+    FORCE_INLINE_FUNCTION static void writePixel(uint8_t* p, uint32_t color)
+    {
+        *reinterpret_cast<uint16_t*>(p) = toRGB565(color);
+    }
+
+    /** @copydoc SpanDestinationRGB888::blendPixel() */
+    FORCE_INLINE_FUNCTION static void blendPixel(uint8_t* p, uint32_t color, uint8_t alpha)
+    {
+        uint16_t* const p16 = reinterpret_cast<uint16_t*>(p);
+        const uint16_t newpix = toRGB565(color);
+        const uint16_t bufpix = *p16;
+        const uint8_t ialpha = 0xFF - alpha;
+        *p16 = ((((newpix & RMASK) * alpha + (bufpix & RMASK) * ialpha) / 255) & RMASK) |
+               ((((newpix & GMASK) * alpha + (bufpix & GMASK) * ialpha) / 255) & GMASK) |
+               ((((newpix & BMASK) * alpha + (bufpix & BMASK) * ialpha) / 255) & BMASK);
+    }
+};
+
+/**
+ * Pixel source filling a shape with a single color.
+ *
+ * A pixel source provides the pixels of a span to a SpanRenderer. It must have a static
+ * bool IS_OPAQUE telling if all pixels are solid, a renderInit(x, y, skip, count) setting up a
+ * span of count pixels starting at (x, y) relative to the widget, optionally reducing the
+ * span by skipping pixels at the start (skip) and/or the end (count), and a renderNext(color)
+ * returning the alpha of the next pixel and its color as 0x00RRGGBB. All functions should be
+ * inline so the compiler can generate a single loop for each source and destination.
+ *
+ * @see SpanRenderer, SpanPainter
+ */
+class SpanSourceColor
+{
+public:
+    static const bool IS_OPAQUE = true; ///< All pixels are solid
+
+    /**
+     * Initializes a new instance of the SpanSourceColor class.
+     *
+     * @param  color (Optional) The color, default is black.
+     */
+    SpanSourceColor(colortype color = 0)
+        : painterColor(0)
+    {
+        setColor(color);
+    }
+
+    /**
+     * Sets the color.
+     *
+     * @param  color The color.
+     */
+    void setColor(colortype color)
+    {
+        painterColor = Color::getRed(color) << 16 | Color::getGreen(color) << 8 | Color::getBlue(color);
+    }
+
+    /**
+     * Gets the color.
+     *
+     * @return The color.
+     */
+    colortype getColor() const
+    {
+        return Color::getColorFromRGB(painterColor >> 16, painterColor >> 8, painterColor);
+    }
+
+    /**
+     * Prepare rendering of a span.
+     *
+     * @param          x     The x coordinate of the first pixel relative to the widget.
+     * @param          y     The y coordinate of the span relative to the widget.
+     * @param [in,out] skip  Number of pixels to skip at the start of the span.
+     * @param [in,out] count Number of pixels to render after the skipped pixels.
+     *
+     * @return True if there is anything to render, false otherwise.
+     */
+    FORCE_INLINE_FUNCTION bool renderInit(int x, int y, unsigned& skip, unsigned& count)
+    {
+        return true;
+    }
+
+    /**
+     * Get the next pixel of the span.
+     *
+     * @param [out] color The color of the pixel (0x00RRGGBB).
+     *
+     * @return The alpha of the pixel.
+     */
+    FORCE_INLINE_FUNCTION uint8_t renderNext(uint32_t& color)
+    {
+        color = painterColor;
+        return 0xFF;
+    }
+
+private:
+    uint32_t painterColor; ///< The color as 0x00RRGGBB
+};
+
+/**
+ * Pixel source filling a shape with a horizontal linear gradient going from one color at the
+ * left edge of the widget to another color at the right edge of the widget.
+ *
+ * @see SpanSourceColor
+ */
+class SpanSourceLinearGradient
+{
+public:
+    static const bool IS_OPAQUE = true; ///< All pixels are solid
+
+    /** Initializes a new instance of the SpanSourceLinearGradient class. */
+    SpanSourceLinearGradient()
+        : startColor(0), endColor(0), width(1), red(0), green(0), blue(0), deltaRed(0), deltaGreen(0), deltaBlue(0)
+    {
+    }
+
+    /**
+     * Sets the gradient.
+     *
+     * @param  colorLeft     The color at the left edge of the widget.
+     * @param  colorRight    The color at the right edge of the widget.
+     * @param  gradientWidth The width of the gradient, typically the width of the widget.
+     */
+    void setGradient(colortype colorLeft, colortype colorRight, int16_t gradientWidth)
+    {
+        startColor = colorLeft;
+        endColor = colorRight;
+        width = MAX(gradientWidth, 1);
+        deltaRed = ((Color::getRed(endColor) - Color::getRed(startColor)) << 16) / width;
+        deltaGreen = ((Color::getGreen(endColor) - Color::getGreen(startColor)) << 16) / width;
+        deltaBlue = ((Color::getBlue(endColor) - Color::getBlue(startColor)) << 16) / width;
+    }
+
+    /** @copydoc SpanSourceColor::renderInit() */
+    FORCE_INLINE_FUNCTION bool renderInit(int x, int y, unsigned& skip, unsigned& count)
+    {
+        x = MIN(MAX(x, 0), width - 1);
+        red = (Color::getRed(startColor) << 16) + deltaRed * x + 0x8000;
+        green = (Color::getGreen(startColor) << 16) + deltaGreen * x + 0x8000;
+        blue = (Color::getBlue(startColor) << 16) + deltaBlue * x + 0x8000;
+        return true;
+    }
+
+    /** @copydoc SpanSourceColor::renderNext() */
+    FORCE_INLINE_FUNCTION uint8_t renderNext(uint32_t& color)
+    {
+        color = ((red >> 16) << 16) | ((green >> 16) << 8) | (blue >> 16);
+        red += deltaRed;
+        green += deltaGreen;
+        blue += deltaBlue;
+        return 0xFF;
+    }
+
+private:
+    colortype startColor; ///< The color at the left edge
+    colortype endColor;   ///< The color at the right edge
+    int width;            ///< The width of the gradient
+    int32_t red;          ///< Current red (16.16 fixed point)
+    int32_t green;        ///< Current green (16.16 fixed point)
+    int32_t blue;         ///< Current blue (16.16 fixed point)
+    int32_t deltaRed;     ///< Red increment per pixel (16.16 fixed point)
+    int32_t deltaGreen;   ///< Green increment per pixel (16.16 fixed point)
+    int32_t deltaBlue;    ///< Blue increment per pixel (16.16 fixed point)
+};
+
+/**
+ * Base class for the bitmap pixel sources. The bitmap is placed at the given offset relative
+ * to the widget and is not tiled, pixels outside the bitmap are not rendered.
+ *
+ * @see SpanSourceColor
+ */
+class SpanSourceBitmap
+{
+public:
+    /** Initializes a new instance of the SpanSourceBitmap class. */
+    SpanSourceBitmap()
+        : bitmap(), xOffset(0), yOffset(0), lineStart(0)
+    {
+    }
+
+    /**
+     * Sets the bitmap.
+     *
+     * @param  bmp The bitmap.
+     */
+    void setBitmap(const Bitmap& bmp)
+    {
+        bitmap = bmp;
+    }
+
+    /**
+     * Sets the position of the bitmap relative to the widget.
+     *
+     * @param  x The x coordinate of the bitmap.
+     * @param  y The y coordinate of the bitmap.
+     */
+    void setOffset(int16_t x, int16_t y)
+    {
+        xOffset = x;
+        yOffset = y;
+    }
+
+protected:
+    /**
+     * Clip a span against the bitmap and find the first pixel of the span in the bitmap.
+     *
+     * @param          x             The x coordinate of the first pixel relative to the widget.
+     * @param          y             The y coordinate of the span relative to the widget.
+     * @param [in,out] skip          Number of pixels to skip at the start of the span.
+     * @param [in,out] count         Number of pixels to render after the skipped pixels.
+     * @param          bytesPerPixel The size of a bitmap pixel.
+     *
+     * @return True if the span overlaps the bitmap, false otherwise.
+     */
+    FORCE_INLINE_FUNCTION bool clipSpan(int x, int y, unsigned& skip, unsigned& count, int bytesPerPixel)
+    {
+        const int width = bitmap.getWidth();
+        x -= xOffset;
+        y -= yOffset;
+        if (bitmap.getId() == BITMAP_INVALID || !bitmap.getData() || y < 0 || y >= bitmap.getHeight() || x >= width || x + (int)count <= 0)
+        {
+            return false;
+        }
+        if (x < 0)
+        {
+            skip = -x;
+            count += x;
+            x = 0;
+        }
+        if (x + (int)count > width)
+        {
+            count = width - x;
+        }
+        lineStart = bitmap.getData() + (y * width + x) * bytesPerPixel;
+        return true;
+    }
+
+    Bitmap bitmap;            ///< The bitmap
+    int16_t xOffset;          ///< The x offset of the bitmap
+    int16_t yOffset;          ///< The y offset of the bitmap
+    const uint8_t* lineStart; ///< The first bitmap pixel of the current span
+};
+
+/**
+ * Pixel source filling a shape with a RGB888 bitmap.
+ *
+ * @see SpanSourceBitmap
+ */
+class SpanSourceRGB888Bitmap : public SpanSourceBitmap
+{
+public:
+    static const bool IS_OPAQUE = true; ///< All pixels are solid
+
+    /** @copydoc SpanSourceColor::renderInit() */
+    FORCE_INLINE_FUNCTION bool renderInit(int x, int y, unsigned& skip, unsigned& count)
+    {
+        assert((bitmap.getId() == BITMAP_INVALID || bitmap.getFormat() == Bitmap::RGB888) && "The chosen source only works with RGB888 bitmaps");
+        return clipSpan(x, y, skip, count, 3);
+    }
+
+    /** @copydoc SpanSourceColor::renderNext() */
+    FORCE_INLINE_FUNCTION uint8_t renderNext(uint32_t& color)
+    {
+        color = lineStart[0] | (lineStart[1] << 8) | (lineStart[2] << 16);
+        lineStart += 3;
+        return 0xFF;
+    }
+};
+
+/**
+ * Pixel source filling a shape with an ARGB8888 bitmap.
+ *
+ * @see SpanSourceBitmap
+ */
+class SpanSourceARGB8888Bitmap : public SpanSourceBitmap
+{
+public:
+    static const bool IS_OPAQUE = false; ///< Pixels may be transparent
+
+    /** @copydoc SpanSourceColor::renderInit() */
+    FORCE_INLINE_FUNCTION bool renderInit(int x, int y, unsigned& skip, unsigned& count)
+    {
+        assert((bitmap.getId() == BITMAP_INVALID || bitmap.getFormat() == Bitmap::ARGB8888) && "The chosen source only works with ARGB8888 bitmaps");
+        return clipSpan(x, y, skip, count, 4);
+    }
+
+    /** @copydoc SpanSourceColor::renderNext() */
+    FORCE_INLINE_FUNCTION uint8_t renderNext(uint32_t& color)
+    {
+        const uint32_t argb8888 = *reinterpret_cast<const uint32_t*>(lineStart);
+        lineStart += 4;
+        color = argb8888 & 0xFFFFFF;
+        return argb8888 >> 24;
+    }
+};
+
+/**
+ * Pixel source filling a shape with an L8 bitmap using either a RGB888 or an ARGB8888 color
+ * lookup table.
+ *
+ * @see SpanSourceBitmap
+ */
+class SpanSourceL8Bitmap : public SpanSourceBitmap
+{
+public:
+    static const bool IS_OPAQUE = false; ///< Pixels may be transparent
+
+    /** Initializes a new instance of the SpanSourceL8Bitmap class. */
+    SpanSourceL8Bitmap()
+        : SpanSourceBitmap(), clut(0), clutARGB8888(false)
+    {
+    }
+
+    /** @copydoc SpanSourceColor::renderInit() */
+    FORCE_INLINE_FUNCTION bool renderInit(int x, int y, unsigned& skip, unsigned& count)
+    {
+        assert((bitmap.getId() == BITMAP_INVALID || bitmap.getFormat() == Bitmap::L8) && "The chosen source only works with L8 bitmaps");
+        if (!clipSpan(x, y, skip, count, 1))
+        {
+            return false;
+        }
+        const uint8_t* const extraData = bitmap.getExtraData();
+        assert(extraData);
+        clutARGB8888 = (Bitmap::ClutFormat)(*(const uint16_t*)extraData) == Bitmap::CLUT_FORMAT_L8_ARGB8888;
+        clut = extraData + 4; // Skip header
+        return true;
+    }
+
+    /** @copydoc SpanSourceColor::renderNext() */
+    FORCE_INLINE_FUNCTION uint8_t renderNext(uint32_t& color)
+    {
+        const uint8_t index = *lineStart++;
+        if (clutARGB8888)
+        {
+            const uint32_t argb8888 = reinterpret_cast<const uint32_t*>(clut)[index];
+            color = argb8888 & 0xFFFFFF;
+            return argb8888 >> 24;
+        }
+        const uint8_t* const src = clut + index * 3;
+        color = src[0] | (src[1] << 8) | (src[2] << 16);
+        return 0xFF;
+    }
+
+private:
+    const uint8_t* clut; ///< The color lookup table
+    bool clutARGB8888;   ///< True if the color lookup table is ARGB8888, false if RGB888
+};
+
+/**
+ * Renders a span of pixels from a pixel source into a framebuffer of a given format. Both the
+ * source and the destination are template parameters, so the entire span is rendered by a
+ * single loop with no virtual function calls per pixel, unlike the generic render() of the
+ * AbstractPainterXXX classes which calls renderNext() and renderPixel() for every pixel.
+ *
+ * @tparam Source      The pixel source, e.g. SpanSourceColor.
+ * @tparam Destination The framebuffer format, e.g. SpanDestinationRGB888.
+ *
+ * @see SpanPainter
+ */
+template <class Source, class Destination>
+class SpanRenderer
+{
+public:
+    /**
+     * Render a span of pixels. The arguments correspond to AbstractPainter::render() with the
+     * area offset already applied to the coordinates.
+     *
+     * @param [in,out] source      The pixel source.
+     * @param [in]     p           Pointer to the first pixel of the span in the framebuffer.
+     * @param          x           The x coordinate of the first pixel relative to the widget.
+     * @param          y           The y coordinate of the span relative to the widget.
+     * @param          count       Number of pixels to fill.
+     * @param          covers      The coverage of each pixel.
+     * @param          widgetAlpha The alpha of the widget.
+     */
+    FORCE_INLINE_FUNCTION static void render(Source& source, uint8_t* p, int x, int y, unsigned count, const uint8_t* covers, uint8_t widgetAlpha)
+    {
+        unsigned skip = 0;
+        if (!source.renderInit(x, y, skip, count) || count == 0)
+        {
+            return;
+        }
+        p += skip * Destination::BYTES_PER_PIXEL;
+        covers += skip;
+        const uint8_t* const p_lineend = p + count * Destination::BYTES_PER_PIXEL;
+        if (widgetAlpha == 0xFF)
+        {
+            do
+            {
+                uint32_t color;
+                const uint8_t srcAlpha = source.renderNext(color);
+                const uint8_t alpha = Source::IS_OPAQUE ? *covers : LCD::div255(*covers * srcAlpha);
+                covers++;
+                if (alpha == 0xFF)
+                {
+                    Destination::writePixel(p, color);
+                }
+                else if (alpha)
+                {
+                    Destination::blendPixel(p, color, alpha);
+                }
+                p += Destination::BYTES_PER_PIXEL;
+            } while (p < p_lineend);
+        }
+        else
+        {
+            do
+            {
+                uint32_t color;
+                const uint8_t srcAlpha = source.renderNext(color);
+                const uint8_t alpha = Source::IS_OPAQUE ? LCD::div255(*covers * widgetAlpha) : LCD::div255(*covers * LCD::div255(srcAlpha * widgetAlpha));
+                covers++;
+                if (alpha)
+                {
+                    Destination::blendPixel(p, color, alpha);
+                }
+                p += Destination::BYTES_PER_PIXEL;
+            } while (p < p_lineend);
+        }
+    }
+};
+
+/**
+ * A painter combining a pixel source and a destination format at compile time. The only
+ * virtual call is the call to render() for each span, the pixels of the span are produced
+ * and blended by SpanRenderer.
+ *
+ * Custom painters should derive from this class with their own source rather than
+ * overriding renderNext() in an AbstractPainterXXX class.
+ *
+ * @tparam Source      The pixel source, e.g. SpanSourceColor.
+ * @tparam Destination The framebuffer format, e.g. SpanDestinationRGB888.
+ *
+ * @see AbstractPainter, SpanRenderer
+ */
+template <class Source, class Destination>
+class SpanPainter : public AbstractPainter
+{
+public:
+    /** Initializes a new instance of the SpanPainter class. */
+    SpanPainter()
+        : AbstractPainter(), source()
+    {
+        assert(compatibleFramebuffer(Destination::FORMAT) && "The chosen painter does not match the framebuffer format");
+    }
+
+    /**
+     * Gets the pixel source used to fill the shape.
+     *
+     * @return The pixel source.
+     */
+    Source& getSource()
+    {
+        return source;
+    }
+
+    /** @copydoc getSource() */
+    const Source& getSource() const
+    {
+        return source;
+    }
+
+    virtual void render(uint8_t* ptr, int x, int xAdjust, int y, unsigned count, const uint8_t* covers)
+    {
+        SpanRenderer<Source, Destination>::render(source, ptr + (x + xAdjust) * Destination::BYTES_PER_PIXEL,
+                                                  x + areaOffsetX, y + areaOffsetY, count, covers, widgetAlpha);
+    }
+
+protected:
+    Source source; ///< The pixel source
+};
+
+} // namespace touchgfx
+
+#endif // TOUCHGFX_SPANPAINTER_HPP
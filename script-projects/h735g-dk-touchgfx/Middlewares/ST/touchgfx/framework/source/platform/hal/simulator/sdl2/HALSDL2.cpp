@@ -10,8 +10,10 @@
 *
 *******************************************************************************/
 
+#include <ctype.h>
 #include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include <touchgfx/hal/Types.hpp>
@@ -26,6 +28,7 @@
 #include <SDL2/SDL_shape.h>
 #include <SDL2/SDL_syswm.h>
 #include <platform/hal/simulator/sdl2/HALSDL2.hpp>
+#include <platform/hal/simulator/sdl2/TileRenderer.hpp>
 
 #if defined(WIN32) || defined(_WIN32)
 #include <windows.h>
@@ -55,6 +58,11 @@ static uint8_t* tft_framebuffer24 = NULL;
 static bool tft_framebuffer24_allocated = false;
 static SDL_Window* simulatorWindow = 0;
 static SDL_Renderer* simulatorRenderer = 0;
+static SDL_Texture* framebufferTexture = 0;
+static int framebufferTextureWidth = 0;
+static int framebufferTextureHeight = 0;
+static SDL_Texture* skinTexture = 0;
+static SDL_Surface* skinTextureSurface = 0;
 #ifndef __linux__
 static bool isConsoleAllocated = false;
 #endif
@@ -74,23 +82,51 @@ static SDL_sem* sem_transfer_ready = 0;
 static SDL_sem* sem_transfer_done = 0;
 
 bool HALSDL2::flashInvalidatedRect = false;
+bool HALSDL2::headless = false;
+bool HALSDL2::headlessFrameChanged = false;
+
+static const uint32_t HEADLESS_NO_COMMAND = 0xFFFFFFFF;
+
+static void destroyTextures()
+{
+    if (framebufferTexture != 0)
+    {
+        SDL_DestroyTexture(framebufferTexture);
+        framebufferTexture = 0;
+    }
+    if (skinTexture != 0)
+    {
+        SDL_DestroyTexture(skinTexture);
+        skinTexture = 0;
+        skinTextureSurface = 0;
+    }
+}
 
 void HALSDL2::renderLCD_FrameBufferToMemory(const Rect& _rectToUpdate, uint8_t* frameBuffer)
 {
     Rect rectToUpdate = _rectToUpdate;
 
+    if (isSkinActive && currentSkin != 0 && skinTextureSurface != currentSkin->surface)
+    {
+        // The skin is only uploaded when it changes
+        if (skinTexture != 0)
+        {
+            SDL_DestroyTexture(skinTexture);
+        }
+        skinTexture = SDL_CreateTextureFromSurface(simulatorRenderer, currentSkin->surface);
+        skinTextureSurface = currentSkin->surface;
+    }
+
     if (isSkinActive && currentSkin != 0 && (currentSkin->isOpaque || currentSkin->hasSemiTransparency))
     {
         // Opaque skin must be drawn before the framebuffer
-        SDL_Texture* currentSkinTexture = SDL_CreateTextureFromSurface(simulatorRenderer, currentSkin->surface);
         SDL_RenderClear(simulatorRenderer);
-        SDL_RenderCopy(simulatorRenderer, currentSkinTexture, NULL, NULL);
+        SDL_RenderCopy(simulatorRenderer, skinTexture, NULL, NULL);
         // The skin will overwrite everything, so expand the rect to the entire framebuffer
         rectToUpdate.x = 0;
         rectToUpdate.y = 0;
         rectToUpdate.width = DISPLAY_WIDTH;
         rectToUpdate.height = DISPLAY_HEIGHT;
-        SDL_DestroyTexture(currentSkinTexture);
     }
 
     if (flashInvalidatedRect)
@@ -98,10 +134,30 @@ void HALSDL2::renderLCD_FrameBufferToMemory(const Rect& _rectToUpdate, uint8_t*
         SDL_Delay(1);
     }
 
-    // Now draw the requested area
-    SDL_Surface* framebufferSurface = SDL_CreateRGBSurfaceFrom((void*)frameBuffer, DISPLAY_WIDTH, DISPLAY_HEIGHT, 24, 3 * DISPLAY_WIDTH, 0, 0, 0, 0);
-    SDL_Texture* framebufferTexture = SDL_CreateTextureFromSurface(simulatorRenderer, framebufferSurface);
+    // Only the requested area of the framebuffer is uploaded to the texture
+    Rect rectToUpload = _rectToUpdate & Rect(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    if (framebufferTexture == 0 || framebufferTextureWidth != DISPLAY_WIDTH || framebufferTextureHeight != DISPLAY_HEIGHT)
+    {
+        if (framebufferTexture != 0)
+        {
+            SDL_DestroyTexture(framebufferTexture);
+        }
+        framebufferTexture = SDL_CreateTexture(simulatorRenderer, SDL_MasksToPixelFormatEnum(24, 0, 0, 0, 0), SDL_TEXTUREACCESS_STREAMING, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+        framebufferTextureWidth = DISPLAY_WIDTH;
+        framebufferTextureHeight = DISPLAY_HEIGHT;
+        rectToUpload = Rect(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    }
+    if (!rectToUpload.isEmpty())
+    {
+        SDL_Rect uploadRect;
+        uploadRect.x = rectToUpload.x;
+        uploadRect.y = rectToUpload.y;
+        uploadRect.w = rectToUpload.width;
+        uploadRect.h = rectToUpload.height;
+        SDL_UpdateTexture(framebufferTexture, &uploadRect, frameBuffer + (rectToUpload.x + rectToUpload.y * DISPLAY_WIDTH) * 3, 3 * DISPLAY_WIDTH);
+    }
 
+    // Now draw the requested area
     SDL_Rect srcRect;
     srcRect.x = rectToUpdate.x;
     srcRect.y = rectToUpdate.y;
@@ -117,14 +173,10 @@ void HALSDL2::renderLCD_FrameBufferToMemory(const Rect& _rectToUpdate, uint8_t*
     if (isSkinActive && currentSkin != 0 && !(currentSkin->isOpaque || currentSkin->hasSemiTransparency))
     {
         // Non-opaque skin must be drawn last
-        SDL_Texture* currentSkinTexture = SDL_CreateTextureFromSurface(simulatorRenderer, currentSkin->surface);
-        SDL_RenderCopy(simulatorRenderer, currentSkinTexture, NULL, NULL);
-        SDL_DestroyTexture(currentSkinTexture);
+        SDL_RenderCopy(simulatorRenderer, skinTexture, NULL, NULL);
     }
 
     SDL_RenderPresent(simulatorRenderer);
-    SDL_DestroyTexture(framebufferTexture);
-    SDL_FreeSurface(framebufferSurface);
 }
 
 static void sdlCleanup2()
@@ -148,6 +200,7 @@ static void sdlCleanup2()
                 tft_framebuffer24_allocated = false;
             }
             sdl_initialized = false; // Make sure we don't get in here again
+            destroyTextures();
             SDL_DestroyRenderer(simulatorRenderer);
             SDL_DestroyWindow(simulatorWindow);
             SDL_VideoQuit();
@@ -217,7 +270,7 @@ bool HALSDL2::sdl_init(int /*argcount*/, char** args)
     }
     *filenamePos = '\0';
 
-    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER) < 0)
+    if (SDL_Init(headless ? 0 : SDL_INIT_VIDEO | SDL_INIT_TIMER) < 0)
     {
         touchgfx_printf("Unable to init SDL: %s\n", SDL_GetError());
         return false;
@@ -234,18 +287,21 @@ bool HALSDL2::sdl_init(int /*argcount*/, char** args)
     anim_store = new uint16_t[bufferSizeInWords];
     setFrameBufferStartAddresses(tft, double_buf, anim_store);
 
-    recreateWindow(false);
-    if (simulatorWindow == NULL)
+    if (!headless)
     {
-        touchgfx_printf("Unable to set video mode: %s\n", SDL_GetError());
-        return false;
-    }
+        recreateWindow(false);
+        if (simulatorWindow == NULL)
+        {
+            touchgfx_printf("Unable to set video mode: %s\n", SDL_GetError());
+            return false;
+        }
 
-    SDL_SetWindowTitle(simulatorWindow, getWindowTitle());
+        SDL_SetWindowTitle(simulatorWindow, getWindowTitle());
 
-    SDL_Surface* iconSurface = SDL_CreateRGBSurfaceFrom(icon, 32, 32, 16, 32 * 2, 0xf800, 0x07e0, 0x001f, 0x0000);
-    SDL_SetWindowIcon(simulatorWindow, iconSurface);
-    SDL_FreeSurface(iconSurface);
+        SDL_Surface* iconSurface = SDL_CreateRGBSurfaceFrom(icon, 32, 32, 16, 32 * 2, 0xf800, 0x07e0, 0x001f, 0x0000);
+        SDL_SetWindowIcon(simulatorWindow, iconSurface);
+        SDL_FreeSurface(iconSurface);
+    }
 
     lockDMAToFrontPorch(false);
     atexit(sdlCleanup2);
@@ -412,6 +468,10 @@ bool HALSDL2::debugInfoEnabled = false;
 
 void HALSDL2::updateTitle(int32_t x, int32_t y)
 {
+    if (headless)
+    {
+        return;
+    }
     char title[500];
     int length = sprintf_s(title, 500, "%s", getWindowTitle());
     if (debugInfoEnabled)
@@ -506,6 +566,12 @@ uint16_t HALSDL2::singleSteppingSteps = 0;
 
 void HALSDL2::taskEntry()
 {
+    if (headless)
+    {
+        headlessTaskEntry();
+        return;
+    }
+
     uint32_t lastTick = SDL_GetTicks();
     while (isAlive)
     {
@@ -714,8 +780,221 @@ void HALSDL2::taskEntry()
     }
 }
 
+bool HALSDL2::setHeadless(uint32_t frames, const char* inputScript /*= 0*/, const char* report /*= 0*/, const char* frameFolder /*= 0*/)
+{
+    assert(!sdl_initialized && "Please call setHeadless() before sdl_init()");
+
+    headless = true;
+    headlessFrames = frames;
+    headlessFrameFolder = frameFolder;
+    headlessCommandFrame = HEADLESS_NO_COMMAND;
+    if (inputScript)
+    {
+        if (fopen_s(&headlessInput, inputScript, "r") != 0)
+        {
+            touchgfx_printf("Unable to open input script %s\n", inputScript);
+            return false;
+        }
+        readHeadlessCommand();
+    }
+    if (report)
+    {
+        if (fopen_s(&headlessReport, report, "w") != 0)
+        {
+            touchgfx_printf("Unable to create report %s\n", report);
+            return false;
+        }
+    }
+    if (frameFolder)
+    {
+#if defined(WIN32) || defined(_WIN32)
+        CreateDirectory(frameFolder, 0);
+#elif defined(__GNUC__)
+        mkdir(frameFolder, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+#endif
+    }
+    return frames > 0 || headlessCommandFrame != HEADLESS_NO_COMMAND;
+}
+
+void HALSDL2::headlessTaskEntry()
+{
+    const double ticksPerUs = SDL_GetPerformanceFrequency() / 1000000.0;
+    // The dimensions of the framebuffer are overwritten when using Partial Framebuffer
+    const uint32_t frameBufferSize = (HALSDL2__FRAME_BUFFER_WIDTH * lcd().bitDepth() + 7) / 8 * HALSDL2__FRAME_BUFFER_HEIGHT;
+
+    if (headlessReport)
+    {
+        fprintf(headlessReport, "# frame hash microseconds\n");
+    }
+
+    uint32_t frame = 0;
+    uint32_t hash = 0;
+    uint64_t drawTicks = 0;
+    uint64_t maxDrawTicks = 0;
+    headlessFrameChanged = true; // The first frame is always hashed and saved
+    const uint64_t startTicks = SDL_GetPerformanceCounter();
+    while (headlessFrames == 0 || frame < headlessFrames)
+    {
+        while (headlessCommandFrame <= frame)
+        {
+            runHeadlessCommand();
+            readHeadlessCommand();
+        }
+        if (!isAlive)
+        {
+            break;
+        }
+
+        // One tick per frame, so animations only depend on the frame number
+        vSync();
+        const uint64_t frameStartTicks = SDL_GetPerformanceCounter();
+        backPorchExited();
+        const uint64_t frameTicks = SDL_GetPerformanceCounter() - frameStartTicks;
+        frontPorchEntered();
+        if (getFrameRefreshStrategy() == REFRESH_STRATEGY_PARTIAL_FRAMEBUFFER)
+        {
+            while (frameBufferAllocator->hasBlockReadyForTransfer())
+            {
+                FrameBufferAllocatorWaitOnTransfer();
+            }
+        }
+        drawTicks += frameTicks;
+        maxDrawTicks = MAX(maxDrawTicks, frameTicks);
+
+        if (headlessFrameChanged)
+        {
+            headlessFrameChanged = false;
+            // FNV-1a hash of the framebuffer shown on the display
+            const uint8_t* pixels = reinterpret_cast<const uint8_t*>(getTFTFrameBuffer());
+            hash = 2166136261u;
+            for (uint32_t i = 0; i < frameBufferSize; i++)
+            {
+                hash ^= pixels[i];
+                hash *= 16777619u;
+            }
+            if (headlessFrameFolder)
+            {
+                saveHeadlessFrame(frame);
+            }
+        }
+        if (headlessReport)
+        {
+            fprintf(headlessReport, "%u %08x %.1f\n", (unsigned int)frame, (unsigned int)hash, frameTicks / ticksPerUs);
+        }
+
+        frame++;
+        if (headlessFrames == 0 && headlessCommandFrame == HEADLESS_NO_COMMAND)
+        {
+            break;
+        }
+    }
+    const double elapsedUs = (SDL_GetPerformanceCounter() - startTicks) / ticksPerUs;
+
+    touchgfx_printf("Headless: %u frames, %.1f us/frame drawing on average, %.1f us max, %.0f frames/s\n",
+                    (unsigned int)frame, frame > 0 ? drawTicks / ticksPerUs / frame : 0.0, maxDrawTicks / ticksPerUs,
+                    elapsedUs > 0.0 ? frame * 1000000.0 / elapsedUs : 0.0);
+
+    if (headlessInput)
+    {
+        fclose(headlessInput);
+        headlessInput = 0;
+    }
+    if (headlessReport)
+    {
+        fclose(headlessReport);
+        headlessReport = 0;
+    }
+}
+
+void HALSDL2::readHeadlessCommand()
+{
+    char line[sizeof(headlessCommand)];
+    while (fgets(line, sizeof(line), headlessInput))
+    {
+        headlessLine++;
+        const char* text = line;
+        while (isspace((unsigned char)*text))
+        {
+            text++;
+        }
+        if (*text == '\0' || *text == '#')
+        {
+            continue;
+        }
+        char* command;
+        const unsigned long frame = strtoul(text, &command, 10);
+        if (command == text)
+        {
+            touchgfx_printf("Input script line %u: missing frame number\n", (unsigned int)headlessLine);
+            continue;
+        }
+        while (isspace((unsigned char)*command))
+        {
+            command++;
+        }
+        headlessCommandFrame = (uint32_t)frame;
+        strncpy_s(headlessCommand, sizeof(headlessCommand), command, sizeof(line) - (command - line));
+        return;
+    }
+    headlessCommandFrame = HEADLESS_NO_COMMAND;
+}
+
+void HALSDL2::runHeadlessCommand()
+{
+    char* args = headlessCommand;
+    while (*args != '\0' && !isspace((unsigned char)*args))
+    {
+        args++;
+    }
+    const size_t length = args - headlessCommand;
+
+    char* end;
+    if (length == 5 && !strncmp(headlessCommand, "touch", length))
+    {
+        const long x = strtol(args, &end, 10);
+        const long y = strtol(end, &end, 10);
+        _x = x;
+        _y = y;
+        pushTouch(true);
+    }
+    else if (length == 7 && !strncmp(headlessCommand, "release", length))
+    {
+        pushTouch(false);
+    }
+    else if (length == 3 && !strncmp(headlessCommand, "key", length))
+    {
+        keyPressed = (uint8_t)strtol(args, &end, 10);
+    }
+    else if (length == 4 && !strncmp(headlessCommand, "quit", length))
+    {
+        isAlive = false;
+    }
+    else
+    {
+        touchgfx_printf("Input script line %u: unknown command %s", (unsigned int)headlessLine, headlessCommand);
+    }
+}
+
+void HALSDL2::saveHeadlessFrame(uint32_t frame)
+{
+    char filename[320];
+    sprintf_s(filename, sizeof(filename), "%s/frame_%06u.bmp", headlessFrameFolder, (unsigned int)frame);
+
+    SDL_Surface* surface = SDL_CreateRGBSurfaceFrom(doRotate(scaleTo24bpp(getTFTFrameBuffer(), lcd().framebufferFormat())), DISPLAY_WIDTH, DISPLAY_HEIGHT, 24, 3 * DISPLAY_WIDTH, 0, 0, 0, 0);
+    if (surface == 0 || SDL_SaveBMP(surface, filename) != 0)
+    {
+        touchgfx_printf("Unable to save %s: %s\n", filename, SDL_GetError());
+    }
+    SDL_FreeSurface(surface);
+}
+
 void HALSDL2::recreateWindow(bool updateContent /*= true*/)
 {
+    if (headless)
+    {
+        return;
+    }
+
 #if defined(WIN32) || defined(_WIN32)
     mainThreadHandle = GetCurrentThreadId();
 #endif
@@ -726,6 +1005,7 @@ void HALSDL2::recreateWindow(bool updateContent /*= true*/)
     {
         // Save previous coordinates
         SDL_GetWindowPosition(simulatorWindow, &windowX, &windowY);
+        destroyTextures();
         SDL_DestroyRenderer(simulatorRenderer);
         SDL_DestroyWindow(simulatorWindow);
     }
@@ -769,222 +1049,188 @@ uint16_t* HALSDL2::getTFTFrameBuffer() const
     return tft;
 }
 
-static Rect dirty(0, 0, 0, 0);
-
-uint8_t* HALSDL2::scaleTo24bpp(uint16_t* src, Bitmap::BitmapFormat format)
+uint16_t* HALSDL2::lockFrameBuffer()
 {
-    if (format == Bitmap::RGB888)
+    if (TileRenderer::holdsFrameBufferLock())
     {
-        if (tft_framebuffer24_allocated)
-        {
-            delete tft_framebuffer24;
-            tft_framebuffer24_allocated = false;
-        }
-        tft_framebuffer24 = reinterpret_cast<uint8_t*>(src);
-        return tft_framebuffer24;
+        return getClientFrameBuffer();
     }
+    return HAL::lockFrameBuffer();
+}
 
-    if (!tft_framebuffer24_allocated)
+void HALSDL2::unlockFrameBuffer()
+{
+    if (!TileRenderer::holdsFrameBufferLock())
     {
-        tft_framebuffer24 = new uint8_t[HALSDL2__FRAME_BUFFER_WIDTH * HALSDL2__FRAME_BUFFER_HEIGHT * 3];
-        tft_framebuffer24_allocated = true;
+        HAL::unlockFrameBuffer();
     }
-    uint8_t* buffer = reinterpret_cast<uint8_t*>(src);
-    uint8_t* dst = tft_framebuffer24;
+}
+
+static Rect dirty(0, 0, 0, 0);
+
+static int bitsPerPixel(Bitmap::BitmapFormat format)
+{
     switch (format)
     {
     case Bitmap::BW:
-        for (int srcY = 0; srcY < HALSDL2__FRAME_BUFFER_HEIGHT; srcY++)
+        return 1;
+    case Bitmap::GRAY2:
+        return 2;
+    case Bitmap::GRAY4:
+        return 4;
+    case Bitmap::ARGB2222:
+    case Bitmap::ABGR2222:
+    case Bitmap::RGBA2222:
+    case Bitmap::BGRA2222:
+        return 8;
+    case Bitmap::RGB565:
+        return 16;
+    case Bitmap::RGB888:
+        return 24;
+    case Bitmap::ARGB8888:
+        return 32;
+    case Bitmap::BW_RLE:
+    case Bitmap::L8:
+    default:
+        assert(0 && "unsupported screen depth");
+        return 0;
+    }
+}
+
+// Builds the 24bpp color of every 2222 pixel value, red, green and blue are found at the given shifts
+static void build2222Table(uint8_t table[256][3], int redShift, int greenShift, int blueShift)
+{
+    for (int pixel = 0; pixel < 256; pixel++)
+    {
+        table[pixel][0] = ((pixel >> blueShift) & 0x3) * 0x55;
+        table[pixel][1] = ((pixel >> greenShift) & 0x3) * 0x55;
+        table[pixel][2] = ((pixel >> redShift) & 0x3) * 0x55;
+    }
+}
+
+// Converts count pixels starting at column x of a line of gray pixels packed in bytes to 24bpp.
+// Each byte is expanded through a table of the 24bpp colors of its pixels.
+template <int BITS, bool MSB_FIRST>
+static void convertGrayLineTo24bpp(uint8_t* dst, const uint8_t* line, int x, int count)
+{
+    static const int PIXELS_PER_BYTE = 8 / BITS;
+    static uint8_t table[256][PIXELS_PER_BYTE * 3];
+    static bool tableBuilt = false;
+    if (!tableBuilt)
+    {
+        const int mask = (1 << BITS) - 1;
+        for (int value = 0; value < 256; value++)
         {
-            for (int srcXbyte = 0; srcXbyte < HALSDL2__FRAME_BUFFER_WIDTH / 8; srcXbyte++)
-            {
-                uint8_t bufbyte = *buffer++;
-                for (int srcXpixel = 0; srcXpixel < 8; srcXpixel++)
-                {
-                    uint8_t pixel = ((bufbyte << srcXpixel) & 0xFF) >> 7;
-                    uint8_t pixelByte = pixel * 0xFF;
-                    *dst++ = pixelByte;
-                    *dst++ = pixelByte;
-                    *dst++ = pixelByte;
-                }
-            }
-            // Check if there is a partial byte left
-            if (HALSDL2__FRAME_BUFFER_WIDTH % 8 != 0)
+            for (int pixel = 0; pixel < PIXELS_PER_BYTE; pixel++)
             {
-                uint8_t bufbyte = *buffer++;
-                for (int srcXpixel = 0; srcXpixel < HALSDL2__FRAME_BUFFER_WIDTH % 8; srcXpixel++)
-                {
-                    uint8_t pixel = ((bufbyte << srcXpixel) & 0xFF) >> 7;
-                    uint8_t pixelByte = pixel * 0xFF;
-                    *dst++ = pixelByte;
-                    *dst++ = pixelByte;
-                    *dst++ = pixelByte;
-                }
+                const int shift = MSB_FIRST ? 8 - BITS * (pixel + 1) : BITS * pixel;
+                const uint8_t pixelByte = ((value >> shift) & mask) * (0xFF / mask);
+                table[value][pixel * 3 + 0] = pixelByte;
+                table[value][pixel * 3 + 1] = pixelByte;
+                table[value][pixel * 3 + 2] = pixelByte;
             }
         }
+        tableBuilt = true;
+    }
+
+    const uint8_t* src = line + x / PIXELS_PER_BYTE;
+    const int first = x % PIXELS_PER_BYTE;
+    if (first != 0 && count > 0)
+    {
+        // The area starts inside a byte
+        const int pixels = MIN(count, PIXELS_PER_BYTE - first);
+        memcpy(dst, table[*src++] + first * 3, pixels * 3);
+        dst += pixels * 3;
+        count -= pixels;
+    }
+    for (; count >= PIXELS_PER_BYTE; count -= PIXELS_PER_BYTE)
+    {
+        memcpy(dst, table[*src++], PIXELS_PER_BYTE * 3);
+        dst += PIXELS_PER_BYTE * 3;
+    }
+    if (count > 0)
+    {
+        memcpy(dst, table[*src], count * 3);
+    }
+}
+
+// Converts count pixels starting at column x of a framebuffer line to 24bpp
+static void convertLineTo24bpp(uint8_t* dst, const uint8_t* line, int x, int count, Bitmap::BitmapFormat format, const uint8_t table[256][3])
+{
+    switch (format)
+    {
+    case Bitmap::BW:
+        convertGrayLineTo24bpp<1, true>(dst, line, x, count);
         break;
 
     case Bitmap::GRAY2:
-        for (int srcY = 0; srcY < HALSDL2__FRAME_BUFFER_HEIGHT; srcY++)
-        {
-            for (int srcXbyte = 0; srcXbyte < (HALSDL2__FRAME_BUFFER_WIDTH * 2) / 8; srcXbyte++)
-            {
-                uint8_t bufbyte = *buffer++;
-                for (int srcXpixel = 0; srcXpixel < 4; srcXpixel++)
-                {
-                    uint8_t pixel = bufbyte & 3;
-                    bufbyte >>= 2;
-                    uint8_t pixelByte = pixel * 0x55;
-                    *dst++ = pixelByte;
-                    *dst++ = pixelByte;
-                    *dst++ = pixelByte;
-                }
-            }
-            // Check if there is a partial byte left
-            if ((HALSDL2__FRAME_BUFFER_WIDTH * 2) % 8 != 0)
-            {
-                uint8_t bufbyte = *buffer++;
-                for (int srcXpixel = 0; srcXpixel < ((HALSDL2__FRAME_BUFFER_WIDTH * 2) % 8) / 2; srcXpixel++)
-                {
-                    uint8_t pixel = bufbyte & 3;
-                    bufbyte >>= 2;
-                    uint8_t pixelByte = pixel * 0x55;
-                    *dst++ = pixelByte;
-                    *dst++ = pixelByte;
-                    *dst++ = pixelByte;
-                }
-            }
-        }
+        convertGrayLineTo24bpp<2, false>(dst, line, x, count);
         break;
 
     case Bitmap::GRAY4:
-        for (int srcY = 0; srcY < HALSDL2__FRAME_BUFFER_HEIGHT; srcY++)
-        {
-            for (int srcXbyte = 0; srcXbyte < (HALSDL2__FRAME_BUFFER_WIDTH * 4) / 8; srcXbyte++)
-            {
-                uint8_t bufbyte = *buffer++;
-                for (int srcXpixel = 0; srcXpixel < 2; srcXpixel++)
-                {
-                    uint8_t pixel = bufbyte & 0xF;
-                    bufbyte >>= 4;
-                    uint8_t pixelByte = pixel * 0x11;
-                    *dst++ = pixelByte;
-                    *dst++ = pixelByte;
-                    *dst++ = pixelByte;
-                }
-            }
-            // Check if there is a partial byte left
-            if ((HALSDL2__FRAME_BUFFER_WIDTH * 4) % 8 != 0)
-            {
-                uint8_t bufbyte = *buffer++;
-                for (int srcXpixel = 0; srcXpixel < ((HALSDL2__FRAME_BUFFER_WIDTH * 4) % 8) / 4; srcXpixel++)
-                {
-                    uint8_t pixel = bufbyte & 0xF;
-                    bufbyte >>= 4;
-                    uint8_t pixelByte = pixel * 0x11;
-                    *dst++ = pixelByte;
-                    *dst++ = pixelByte;
-                    *dst++ = pixelByte;
-                }
-            }
-        }
+        convertGrayLineTo24bpp<4, false>(dst, line, x, count);
         break;
 
     case Bitmap::ARGB2222:
-        for (int srcY = 0; srcY < HALSDL2__FRAME_BUFFER_HEIGHT; srcY++)
-        {
-            for (int srcX = 0; srcX < HALSDL2__FRAME_BUFFER_WIDTH; srcX++)
-            {
-                uint16_t bufword = *buffer++;
-                uint8_t r = (bufword >> 4) & 0x3;
-                uint8_t g = (bufword >> 2) & 0x3;
-                uint8_t b = bufword & 0x3;
-                *dst++ = b * 0x55;
-                *dst++ = g * 0x55;
-                *dst++ = r * 0x55;
-            }
-        }
-        break;
-
     case Bitmap::ABGR2222:
-        for (int srcY = 0; srcY < HALSDL2__FRAME_BUFFER_HEIGHT; srcY++)
+    case Bitmap::RGBA2222:
+    case Bitmap::BGRA2222:
+        for (int i = x; i < x + count; i++)
         {
-            for (int srcX = 0; srcX < HALSDL2__FRAME_BUFFER_WIDTH; srcX++)
-            {
-                uint16_t bufword = *buffer++;
-                uint8_t r = bufword & 0x3;
-                uint8_t g = (bufword >> 2) & 0x3;
-                uint8_t b = (bufword >> 4) & 0x3;
-                *dst++ = b * 0x55;
-                *dst++ = g * 0x55;
-                *dst++ = r * 0x55;
-            }
+            const uint8_t* color = table[line[i]];
+            *dst++ = color[0];
+            *dst++ = color[1];
+            *dst++ = color[2];
         }
         break;
 
-    case Bitmap::RGBA2222:
-        for (int srcY = 0; srcY < HALSDL2__FRAME_BUFFER_HEIGHT; srcY++)
+    case Bitmap::RGB565:
         {
-            for (int srcX = 0; srcX < HALSDL2__FRAME_BUFFER_WIDTH; srcX++)
+            // Red and blue come from one byte of the pixel each, and the bits of green from
+            // either byte are expanded independently, so the color is looked up per byte
+            static uint32_t lowByteTable[256];
+            static uint32_t highByteTable[256];
+            static bool tableBuilt = false;
+            if (!tableBuilt)
             {
-                uint16_t bufword = *buffer++;
-                uint8_t r = (bufword >> 6) & 0x3;
-                uint8_t g = (bufword >> 4) & 0x3;
-                uint8_t b = (bufword >> 2) & 0x3;
-                *dst++ = b * 0x55;
-                *dst++ = g * 0x55;
-                *dst++ = r * 0x55;
+                for (int value = 0; value < 256; value++)
+                {
+                    lowByteTable[value] = Color::rgb565toXrgb8888((uint16_t)value);
+                    highByteTable[value] = Color::rgb565toXrgb8888((uint16_t)(value << 8));
+                }
+                tableBuilt = true;
             }
-        }
-        break;
-
-    case Bitmap::BGRA2222:
-        for (int srcY = 0; srcY < HALSDL2__FRAME_BUFFER_HEIGHT; srcY++)
-        {
-            for (int srcX = 0; srcX < HALSDL2__FRAME_BUFFER_WIDTH; srcX++)
+            // Each pixel is stored as 4 bytes (blue, green, red on little endian hosts) and
+            // the next pixel overwrites the fourth, except for the last pixel
+            const uint8_t* src = line + x * 2;
+            for (int i = 0; i < count - 1; i++)
             {
-                uint16_t bufword = *buffer++;
-                uint8_t r = (bufword >> 2) & 0x3;
-                uint8_t g = (bufword >> 4) & 0x3;
-                uint8_t b = (bufword >> 6) & 0x3;
-                *dst++ = b * 0x55;
-                *dst++ = g * 0x55;
-                *dst++ = r * 0x55;
+                const uint32_t color = lowByteTable[src[0]] | highByteTable[src[1]];
+                memcpy(dst, &color, 4);
+                dst += 3;
+                src += 2;
             }
-        }
-        break;
-
-    case Bitmap::RGB565:
-        for (int srcY = 0; srcY < HALSDL2__FRAME_BUFFER_HEIGHT; srcY++)
-        {
-            for (int srcX = 0; srcX < HALSDL2__FRAME_BUFFER_WIDTH; srcX++)
+            if (count > 0)
             {
-                uint16_t bufword = *src++;
-                *dst++ = Color::getBlueFromRGB565(bufword);
-                *dst++ = Color::getGreenFromRGB565(bufword);
-                *dst++ = Color::getRedFromRGB565(bufword);
+                const uint32_t color = lowByteTable[src[0]] | highByteTable[src[1]];
+                memcpy(dst, &color, 3);
             }
         }
         break;
 
     case Bitmap::ARGB8888:
         {
-            uint32_t* src32 = reinterpret_cast<uint32_t*>(src);
-            for (int srcY = 0; srcY < HALSDL2__FRAME_BUFFER_HEIGHT; srcY++)
+            const uint32_t* src32 = reinterpret_cast<const uint32_t*>(line) + x;
+            for (int i = 0; i < count; i++)
             {
-                for (int srcX = 0; srcX < HALSDL2__FRAME_BUFFER_WIDTH; srcX++)
-                {
-                    uint32_t pixel = *src32++;
-                    uint8_t b = pixel & 0xFF;
-                    uint8_t g = (pixel >> 8) & 0xFF;
-                    uint8_t r = (pixel >> 16) & 0xFF;
-                    *dst++ = b;
-                    *dst++ = g;
-                    *dst++ = r;
-                }
+                const uint32_t pixel = src32[i];
+                dst[i * 3 + 0] = pixel & 0xFF;
+                dst[i * 3 + 1] = (pixel >> 8) & 0xFF;
+                dst[i * 3 + 2] = (pixel >> 16) & 0xFF;
             }
         }
         break;
+
     case Bitmap::BW_RLE:
     case Bitmap::RGB888:
     case Bitmap::L8:
@@ -992,11 +1238,70 @@ uint8_t* HALSDL2::scaleTo24bpp(uint16_t* src, Bitmap::BitmapFormat format)
         assert(0 && "unsupported screen depth");
         break;
     }
+}
+
+uint8_t* HALSDL2::scaleTo24bpp(uint16_t* src, Bitmap::BitmapFormat format)
+{
+    return scaleTo24bpp(src, format, Rect(0, 0, HALSDL2__FRAME_BUFFER_WIDTH, HALSDL2__FRAME_BUFFER_HEIGHT));
+}
+
+uint8_t* HALSDL2::scaleTo24bpp(uint16_t* src, Bitmap::BitmapFormat format, const Rect& area)
+{
+    if (format == Bitmap::RGB888)
+    {
+        if (tft_framebuffer24_allocated)
+        {
+            delete tft_framebuffer24;
+            tft_framebuffer24_allocated = false;
+        }
+        tft_framebuffer24 = reinterpret_cast<uint8_t*>(src);
+        return tft_framebuffer24;
+    }
+
+    if (!tft_framebuffer24_allocated)
+    {
+        tft_framebuffer24 = new uint8_t[HALSDL2__FRAME_BUFFER_WIDTH * HALSDL2__FRAME_BUFFER_HEIGHT * 3];
+        tft_framebuffer24_allocated = true;
+    }
+
+    uint8_t table[256][3];
+    switch (format)
+    {
+    case Bitmap::ARGB2222:
+        build2222Table(table, 4, 2, 0);
+        break;
+    case Bitmap::ABGR2222:
+        build2222Table(table, 0, 2, 4);
+        break;
+    case Bitmap::RGBA2222:
+        build2222Table(table, 6, 4, 2);
+        break;
+    case Bitmap::BGRA2222:
+        build2222Table(table, 2, 4, 6);
+        break;
+    default:
+        break;
+    }
+
+    // Only the pixels in the area are converted, the rest is left from earlier conversions
+    const Rect rect = area & Rect(0, 0, HALSDL2__FRAME_BUFFER_WIDTH, HALSDL2__FRAME_BUFFER_HEIGHT);
+    const uint32_t stride = (HALSDL2__FRAME_BUFFER_WIDTH * bitsPerPixel(format) + 7) / 8;
+    const uint8_t* buffer = reinterpret_cast<const uint8_t*>(src);
+    for (int srcY = rect.y; srcY < rect.bottom(); srcY++)
+    {
+        uint8_t* dst = tft_framebuffer24 + (srcY * HALSDL2__FRAME_BUFFER_WIDTH + rect.x) * 3;
+        convertLineTo24bpp(dst, buffer + srcY * stride, rect.x, rect.width, format, table);
+    }
 
     return tft_framebuffer24;
 }
 
 uint8_t* HALSDL2::doRotate(uint8_t* src)
+{
+    return doRotate(src, Rect(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT));
+}
+
+uint8_t* HALSDL2::doRotate(uint8_t* src, const Rect& area)
 {
     if (DISPLAY_ROTATION == rotate0 && DISPLAY_WIDTH == HALSDL2__FRAME_BUFFER_WIDTH)
     {
@@ -1008,32 +1313,28 @@ uint8_t* HALSDL2::doRotate(uint8_t* src)
         tft_display24 = new uint8_t[DISPLAY_WIDTH * DISPLAY_HEIGHT * 3]; // 24bpp, hence *3
         tft_display24_allocated = true;
     }
+    const Rect rect = area & Rect(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT);
     switch (DISPLAY_ROTATION)
     {
     case rotate0:
-        for (int16_t y = 0; y < DISPLAY_HEIGHT; y++)
+        for (int16_t y = rect.y; y < rect.bottom(); y++)
         {
-            for (int16_t x = 0; x < DISPLAY_WIDTH; x++)
-            {
-                for (int i = 0; i < 3; i++)
-                {
-                    tft_display24[(x + y * DISPLAY_WIDTH) * 3 + i] = src[(x + y * HALSDL2__FRAME_BUFFER_WIDTH) * 3 + i];
-                }
-            }
+            memcpy(tft_display24 + (rect.x + y * DISPLAY_WIDTH) * 3, src + (rect.x + y * HALSDL2__FRAME_BUFFER_WIDTH) * 3, rect.width * 3);
         }
         return tft_display24;
 
     case rotate90:
-        for (int16_t dstY = 0; dstY < DISPLAY_HEIGHT; dstY++)
+        for (int16_t dstY = rect.y; dstY < rect.bottom(); dstY++)
         {
             const int16_t srcX = dstY;
-            for (int16_t dstX = 0; dstX < DISPLAY_WIDTH; dstX++)
+            uint8_t* dst = tft_display24 + (rect.x + dstY * DISPLAY_WIDTH) * 3;
+            for (int16_t dstX = rect.x; dstX < rect.right(); dstX++)
             {
                 const int16_t srcY = (HALSDL2__FRAME_BUFFER_HEIGHT - 1) - dstX;
-                for (int i = 0; i < 3; i++)
-                {
-                    tft_display24[(dstX + dstY * DISPLAY_WIDTH) * 3 + i] = src[(srcX + srcY * HALSDL2__FRAME_BUFFER_WIDTH) * 3 + i];
-                }
+                const uint8_t* pixel = src + (srcX + srcY * HALSDL2__FRAME_BUFFER_WIDTH) * 3;
+                *dst++ = pixel[0];
+                *dst++ = pixel[1];
+                *dst++ = pixel[2];
             }
         }
         return tft_display24;
@@ -1066,7 +1367,6 @@ void HALSDL2::setTFTFrameBuffer(uint16_t* adr)
     {
         // Save current framebuffer address
         tft = adr;
-        renderLCD_FrameBufferToMemory(dirty, doRotate(scaleTo24bpp(adr, lcd().framebufferFormat())));
     }
     else
     {
@@ -1075,9 +1375,21 @@ void HALSDL2::setTFTFrameBuffer(uint16_t* adr)
         {
             FrameBufferAllocatorWaitOnTransfer();
         }
-
         // Always use the original tft buffer as screen memory GRAM
-        renderLCD_FrameBufferToMemory(dirty, doRotate(scaleTo24bpp(tft, lcd().framebufferFormat())));
+    }
+
+    if (headless)
+    {
+        // Nothing to show, the framebuffer is only converted when a frame is saved
+        headlessFrameChanged = true;
+    }
+    else
+    {
+        // Only the area drawn since the last update is converted, in partial framebuffer mode
+        // the blocks transferred to tft are all done by now
+        Rect frameBufferRect = dirty;
+        DisplayTransformation::transformDisplayToFrameBuffer(frameBufferRect);
+        renderLCD_FrameBufferToMemory(dirty, doRotate(scaleTo24bpp(tft, lcd().framebufferFormat(), frameBufferRect), dirty));
     }
     dirty = Rect(0, 0, 0, 0);
 }
@@ -1107,15 +1419,12 @@ static int transferThreadFunc(void* ptr)
             {
             case Bitmap::RGB565:
                 {
-                    const uint16_t* src16 = (const uint16_t*)src;
                     uint16_t* dst16 = tft + transfer_rect.y * HALSDL2__FRAME_BUFFER_WIDTH + transfer_rect.x;
                     for (int srcY = 0; srcY < transfer_rect.height; srcY++)
                     {
-                        for (int srcX = 0; srcX < transfer_rect.width; srcX++)
-                        {
-                            *dst16++ = *src16++;
-                        }
-                        dst16 += HALSDL2__FRAME_BUFFER_WIDTH - transfer_rect.width;
+                        memcpy(dst16, src, transfer_rect.width * 2);
+                        src += transfer_rect.width * 2;
+                        dst16 += HALSDL2__FRAME_BUFFER_WIDTH;
                     }
 
                     break;
@@ -1125,13 +1434,9 @@ static int transferThreadFunc(void* ptr)
                     uint8_t* dst = (uint8_t*)tft + (transfer_rect.y * HALSDL2__FRAME_BUFFER_WIDTH + transfer_rect.x) * 3;
                     for (int srcY = 0; srcY < transfer_rect.height; srcY++)
                     {
-                        for (int srcX = 0; srcX < transfer_rect.width; srcX++)
-                        {
-                            *dst++ = *src++;
-                            *dst++ = *src++;
-                            *dst++ = *src++;
-                        }
-                        dst += (HALSDL2__FRAME_BUFFER_WIDTH - transfer_rect.width) * 3;
+                        memcpy(dst, src, transfer_rect.width * 3);
+                        src += transfer_rect.width * 3;
+                        dst += HALSDL2__FRAME_BUFFER_WIDTH * 3;
                     }
 
                     break;
@@ -1141,12 +1446,12 @@ static int transferThreadFunc(void* ptr)
                 break;
             }
             fbAllocator->freeBlockAfterTransfer();
-        }
 
-        // Signal drawing part
-        if (SDL_SemValue(sem_transfer_done) == 0)
-        {
-            SDL_SemPost(sem_transfer_done);
+            // Signal drawing part as soon as memory is freed, a ring allocator may be waiting for this block
+            if (SDL_SemValue(sem_transfer_done) == 0)
+            {
+                SDL_SemPost(sem_transfer_done);
+            }
         }
     }
 }
@@ -1185,12 +1490,11 @@ void HALSDL2::flushFrameBuffer(const Rect& rect)
         SDL_RenderPresent(simulatorRenderer);
     }
 
-    if (getFrameRefreshStrategy() != REFRESH_STRATEGY_PARTIAL_FRAMEBUFFER)
-    {
-        dirty.expandToFit(rect);
-    }
-    else
+    headlessFrameChanged = true;
+    dirty.expandToFit(rect);
+    if (getFrameRefreshStrategy() == REFRESH_STRATEGY_PARTIAL_FRAMEBUFFER)
     {
+        // The block holds the area, which is copied to tft by the transfer thread
         frameBufferAllocator->markBlockReadyForTransfer();
         // For testing during transfers.
         // renderLCD_FrameBufferToMemory(dirty, doRotate(scaleTo24bpp(tft, lcd().framebufferFormat())));
@@ -0,0 +1,443 @@
+/******************************************************************************
+* Copyright (c) 2018(-2021) STMicroelectronics.
+* All rights reserved.
+*
+* This file is part of the TouchGFX 4.18.1 distribution.
+*
+* This software is licensed under terms that can be found in the LICENSE file in
+* the root directory of this software component.
+* If no LICENSE file comes with this software, it is provided AS-IS.
+*
+*******************************************************************************/
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string.h>
+#include <thread>
+#include <typeinfo>
+#include <touchgfx/BitmapCache.hpp>
+#include <touchgfx/Utils.hpp>
+#include <touchgfx/canvas_widget_renderer/CanvasWidgetRenderer.hpp>
+#include <touchgfx/containers/Container.hpp>
+#include <touchgfx/hal/HAL.hpp>
+#include <touchgfx/lcd/LCD.hpp>
+#include <touchgfx/widgets/Box.hpp>
+#include <touchgfx/widgets/BoxWithBorder.hpp>
+#include <touchgfx/widgets/Button.hpp>
+#include <touchgfx/widgets/ButtonWithIcon.hpp>
+#include <touchgfx/widgets/ButtonWithLabel.hpp>
+#include <touchgfx/widgets/Image.hpp>
+#include <touchgfx/widgets/RadioButton.hpp>
+#include <touchgfx/widgets/TextArea.hpp>
+#include <touchgfx/widgets/TextAreaWithWildcard.hpp>
+#include <touchgfx/widgets/TiledImage.hpp>
+#include <touchgfx/widgets/ToggleButton.hpp>
+#include <platform/hal/simulator/sdl2/TileRenderer.hpp>
+
+namespace touchgfx
+{
+uint16_t TileRenderer::workers = 1;
+uint16_t TileRenderer::tileWidth = 64;
+uint16_t TileRenderer::tileHeight = 64;
+bool TileRenderer::verify = false;
+uint32_t TileRenderer::reportInterval = 0;
+TileRenderer::Statistics TileRenderer::statistics = { 0, 0, 0, 0, 0, 0 };
+
+static const uint16_t MAX_WORKERS = 64;
+
+namespace
+{
+const int MAX_TILES = 4096;
+
+Rect tiles[MAX_TILES];
+uint16_t tileWorkers[MAX_TILES];
+int numberOfTiles = 0;
+
+thread_local bool drawingFrame = false;
+
+/** Taken by the workers around every drawable not known to draw without changing any state. */
+std::mutex serialMutex;
+
+/**
+ * The threads of every worker but the first. They are started once, and wait for the next
+ * frame between frames. The pool is never deleted, so the threads are not torn down while
+ * waiting when the simulator exits.
+ */
+struct WorkerPool
+{
+    std::mutex mutex;
+    std::condition_variable frameStarted;
+    std::condition_variable frameDone;
+    std::thread* threads[MAX_WORKERS];
+    uint16_t numberOfThreads;
+    uint32_t frame;                     ///< Incremented when a frame is started
+    uint16_t busyThreads;               ///< Number of threads still drawing the frame
+    bool stopping;                      ///< True when the threads should exit
+    unsigned canvasBufferSize;          ///< Size of the CanvasWidgetRenderer buffer of each thread
+    GenericCallback<const Rect&>* draw; ///< Draws a tile of the frame
+    uint64_t workerNs[MAX_WORKERS];     ///< Time spent by each worker drawing the frame
+};
+
+WorkerPool* pool = 0;
+uint8_t* verifyBefore = 0;
+uint8_t* verifyTiled = 0;
+uint32_t verifySize = 0;
+
+uint64_t now()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int16_t alignDown(int16_t value, uint16_t tile)
+{
+    return value - value % tile;
+}
+
+int countTiles(const Rect* areas, uint16_t count, uint16_t width, uint16_t height)
+{
+    int tilesNeeded = 0;
+    for (uint16_t i = 0; i < count; i++)
+    {
+        const Rect& area = areas[i];
+        const int columns = (area.right() - alignDown(area.x, width) + width - 1) / width;
+        const int rows = (area.bottom() - alignDown(area.y, height) + height - 1) / height;
+        tilesNeeded += columns * rows;
+    }
+    return tilesNeeded;
+}
+
+/** Split the areas on a grid, giving each tile to the worker with the fewest pixels so far. */
+void splitIntoTiles(const Rect* areas, uint16_t count, uint16_t width, uint16_t height, uint16_t workers)
+{
+    while (countTiles(areas, count, width, height) > MAX_TILES)
+    {
+        width *= 2;
+        height *= 2;
+    }
+
+    uint32_t load[MAX_WORKERS] = { 0 };
+    numberOfTiles = 0;
+    for (uint16_t i = 0; i < count; i++)
+    {
+        const Rect& area = areas[i];
+        for (int16_t y = alignDown(area.y, height); y < area.bottom(); y += height)
+        {
+            for (int16_t x = alignDown(area.x, width); x < area.right(); x += width)
+            {
+                const Rect tile = Rect(x, y, width, height) & area;
+                if (tile.isEmpty())
+                {
+                    continue;
+                }
+                uint16_t worker = 0;
+                for (uint16_t w = 1; w < workers; w++)
+                {
+                    if (load[w] < load[worker])
+                    {
+                        worker = w;
+                    }
+                }
+                load[worker] += tile.area();
+                tiles[numberOfTiles] = tile;
+                tileWorkers[numberOfTiles] = worker;
+                numberOfTiles++;
+            }
+        }
+    }
+}
+
+/**
+ * Widgets of the framework drawing from their own fields and the LCD only, which several
+ * workers may draw at once. Classes derived from these may keep state of their own, so the
+ * type must match exactly.
+ */
+bool drawsInParallel(const Drawable& drawable)
+{
+    const std::type_info& type = typeid(drawable);
+    return type == typeid(Box) || type == typeid(BoxWithBorder) || type == typeid(Image) || type == typeid(TiledImage)
+           || type == typeid(TextArea) || type == typeid(TextAreaWithOneWildcard) || type == typeid(TextAreaWithTwoWildcards)
+           || type == typeid(Button) || type == typeid(ButtonWithLabel) || type == typeid(ButtonWithIcon)
+           || type == typeid(ToggleButton) || type == typeid(RadioButton);
+}
+
+/** Use fewer workers than requested when there are fewer hardware threads to run them. */
+uint16_t usableWorkers(uint16_t requested, bool verifying)
+{
+    const unsigned hardwareThreads = std::thread::hardware_concurrency();
+    if (verifying || hardwareThreads == 0)
+    {
+        return requested;
+    }
+    return (uint16_t)MIN(requested, hardwareThreads);
+}
+
+void drawTiles(uint16_t worker, GenericCallback<const Rect&>& draw)
+{
+    for (int i = 0; i < numberOfTiles; i++)
+    {
+        if (tileWorkers[i] == worker)
+        {
+            draw.execute(tiles[i]);
+        }
+    }
+}
+
+void runWorker(uint16_t worker, uint32_t frame)
+{
+    CanvasWidgetRenderer::Context context;
+    CanvasWidgetRenderer::setContext(&context);
+    uint8_t* canvasBuffer = 0;
+    unsigned canvasBufferSize = 0;
+    drawingFrame = true;
+
+    std::unique_lock<std::mutex> lock(pool->mutex);
+    for (;;)
+    {
+        pool->frameStarted.wait(lock, [frame]() { return pool->stopping || pool->frame != frame; });
+        if (pool->stopping)
+        {
+            break;
+        }
+        frame = pool->frame;
+        if (canvasBufferSize != pool->canvasBufferSize)
+        {
+            delete[] canvasBuffer;
+            canvasBufferSize = pool->canvasBufferSize;
+            canvasBuffer = new uint8_t[canvasBufferSize];
+            CanvasWidgetRenderer::setupBuffer(canvasBuffer, canvasBufferSize);
+        }
+        GenericCallback<const Rect&>& draw = *pool->draw;
+        lock.unlock();
+
+        const uint64_t start = now();
+        drawTiles(worker, draw);
+        const uint64_t elapsed = now() - start;
+
+        lock.lock();
+        pool->workerNs[worker] = elapsed;
+        if (--pool->busyThreads == 0)
+        {
+            pool->frameDone.notify_one();
+        }
+    }
+    lock.unlock();
+    CanvasWidgetRenderer::setContext(0);
+    delete[] canvasBuffer;
+}
+
+void stopWorkers()
+{
+    if (!pool)
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        pool->stopping = true;
+    }
+    pool->frameStarted.notify_all();
+    for (uint16_t i = 0; i < pool->numberOfThreads; i++)
+    {
+        pool->threads[i]->join();
+        delete pool->threads[i];
+    }
+    pool->numberOfThreads = 0;
+    pool->stopping = false;
+}
+
+void startWorkers(uint16_t workers)
+{
+    if (!pool)
+    {
+        pool = new WorkerPool;
+        pool->numberOfThreads = 0;
+        pool->frame = 0;
+        pool->busyThreads = 0;
+        pool->stopping = false;
+        pool->canvasBufferSize = 0;
+        pool->draw = 0;
+    }
+    if (pool->numberOfThreads == workers - 1)
+    {
+        return;
+    }
+    stopWorkers();
+    for (uint16_t w = 1; w < workers; w++)
+    {
+        pool->threads[pool->numberOfThreads++] = new std::thread(runWorker, w, pool->frame);
+    }
+}
+
+void allocateVerifyBuffers(uint32_t frameBufferSize)
+{
+    if (frameBufferSize > verifySize)
+    {
+        delete[] verifyBefore;
+        delete[] verifyTiled;
+        verifyBefore = new uint8_t[frameBufferSize];
+        verifyTiled = new uint8_t[frameBufferSize];
+        verifySize = frameBufferSize;
+    }
+}
+} // namespace
+
+void TileRenderer::setWorkers(uint16_t numberOfWorkers)
+{
+    workers = MAX(1, MIN(numberOfWorkers, MAX_WORKERS));
+}
+
+void TileRenderer::setTileSize(uint16_t width, uint16_t height)
+{
+    assert(width > 0 && height > 0 && "Tile size must be at least 1x1");
+    tileWidth = width;
+    tileHeight = height;
+}
+
+bool TileRenderer::isEnabled()
+{
+    return workers > 1;
+}
+
+void TileRenderer::drawContainer(Container& container, const Rect& invalidatedArea)
+{
+    // Same walk as Container::draw(), descending into plain containers
+    if (!container.isVisible())
+    {
+        return;
+    }
+    for (Drawable* d = container.getFirstChild(); d; d = d->getNextSibling())
+    {
+        if (!d->isVisible())
+        {
+            continue;
+        }
+        Rect drawableRegion = invalidatedArea & d->getRect();
+        if (drawableRegion.isEmpty())
+        {
+            continue;
+        }
+        drawableRegion.x -= d->getX();
+        drawableRegion.y -= d->getY();
+        if (typeid(*d) == typeid(Container))
+        {
+            drawContainer(*static_cast<Container*>(d), drawableRegion);
+        }
+        else if (!drawingFrame || drawsInParallel(*d))
+        {
+            d->draw(drawableRegion);
+        }
+        else
+        {
+            std::lock_guard<std::mutex> lock(serialMutex);
+            d->draw(drawableRegion);
+        }
+    }
+}
+
+bool TileRenderer::holdsFrameBufferLock()
+{
+    return drawingFrame;
+}
+
+void TileRenderer::printStatistics()
+{
+    if (statistics.frames == 0)
+    {
+        return;
+    }
+    const bool measured = statistics.serialNs > 0;
+    const uint64_t serialNs = measured ? statistics.serialNs : statistics.workerNs;
+    touchgfx_printf("TileRenderer: %u frames, %u workers, %u tiles/frame, %.2f ms/frame, speedup %.2fx (%s), %u mismatched frames\n",
+                    (unsigned)statistics.frames, (unsigned)workers, (unsigned)(statistics.tiles / statistics.frames),
+                    statistics.wallNs / 1e6 / statistics.frames,
+                    statistics.wallNs ? (double)serialNs / statistics.wallNs : 1.0,
+                    measured ? "measured" : "estimated from worker time",
+                    (unsigned)statistics.mismatchedFrames);
+    memset(&statistics, 0, sizeof(statistics));
+}
+
+bool TileRenderer::render(const Rect* areas, uint16_t count, GenericCallback<const Rect&>& drawTile, GenericCallback<const Rect&>& drawArea)
+{
+    // Tiles of formats below 8 bpp would share the bytes at their edges, and the cached
+    // bitmaps are moved around by the first worker drawing a bitmap not in the cache
+    const uint16_t frameWorkers = usableWorkers(workers, verify);
+    if (frameWorkers <= 1 || HAL::lcd().bitDepth() < 8 || BitmapCache::isEnabled())
+    {
+        stopWorkers();
+        for (uint16_t i = 0; i < count; i++)
+        {
+            drawArea.execute(areas[i]);
+        }
+        return false;
+    }
+
+    // The framebuffer is locked until the frame is drawn and verified, the threads drawing
+    // tiles do not lock it again
+    HAL* hal = HAL::getInstance();
+    uint8_t* const frameBuffer = reinterpret_cast<uint8_t*>(hal->lockFrameBuffer());
+    const uint32_t frameBufferSize = HAL::lcd().framebufferStride() * HAL::FRAME_BUFFER_HEIGHT;
+    drawingFrame = true;
+
+    startWorkers(frameWorkers);
+    splitIntoTiles(areas, count, tileWidth, tileHeight, frameWorkers);
+    if (verify)
+    {
+        allocateVerifyBuffers(frameBufferSize);
+        memcpy(verifyBefore, frameBuffer, frameBufferSize);
+    }
+
+    const uint64_t start = now();
+    {
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        pool->draw = &drawTile;
+        pool->canvasBufferSize = CanvasWidgetRenderer::getBufferSize();
+        pool->busyThreads = pool->numberOfThreads;
+        pool->frame++;
+    }
+    pool->frameStarted.notify_all();
+
+    const uint64_t workerStart = now();
+    drawTiles(0, drawTile);
+    uint64_t workerNs = now() - workerStart;
+    {
+        std::unique_lock<std::mutex> lock(pool->mutex);
+        pool->frameDone.wait(lock, []() { return pool->busyThreads == 0; });
+        for (uint16_t w = 1; w < frameWorkers; w++)
+        {
+            workerNs += pool->workerNs[w];
+        }
+    }
+
+    statistics.wallNs += now() - start;
+    statistics.workerNs += workerNs;
+    statistics.tiles += numberOfTiles;
+    statistics.frames++;
+
+    if (verify)
+    {
+        // Draw the frame again the normal way, leaving that in the framebuffer
+        memcpy(verifyTiled, frameBuffer, frameBufferSize);
+        memcpy(frameBuffer, verifyBefore, frameBufferSize);
+        const uint64_t serialStart = now();
+        for (uint16_t i = 0; i < count; i++)
+        {
+            drawArea.execute(areas[i]);
+        }
+        statistics.serialNs += now() - serialStart;
+        if (memcmp(frameBuffer, verifyTiled, frameBufferSize) != 0)
+        {
+            statistics.mismatchedFrames++;
+        }
+    }
+
+    drawingFrame = false;
+    hal->unlockFrameBuffer();
+
+    if (reportInterval > 0 && statistics.frames >= reportInterval)
+    {
+        printStatistics();
+    }
+    return !verify;
+}
+} // namespace touchgfx
@@ -0,0 +1,242 @@
+/******************************************************************************
+* Copyright (c) 2018(-2021) STMicroelectronics.
+* All rights reserved.
+*
+* This file is part of the TouchGFX 4.18.1 distribution.
+*
+* This software is licensed under terms that can be found in the LICENSE file in
+* the root directory of this software component.
+* If no LICENSE file comes with this software, it is provided AS-IS.
+*
+*******************************************************************************/
+
+#include <string.h>
+#include <touchgfx/BitmapCache.hpp>
+#include <touchgfx/hal/HAL.hpp>
+
+namespace touchgfx
+{
+BitmapCache::Entry* BitmapCache::entries = 0;
+uint16_t BitmapCache::numberOfBitmaps = 0;
+uint32_t BitmapCache::cacheSize = 0;
+uint32_t BitmapCache::frame = 1;
+BitmapCache::Policy BitmapCache::policy = BitmapCache::LEAST_RECENTLY_USED;
+bool BitmapCache::fragmented = false;
+bool BitmapCache::pendingLoads = false;
+BitmapCache::Statistics BitmapCache::statistics = { 0, 0, 0, 0, 0 };
+
+namespace
+{
+/** Number of frames between halving the use counts, so old popularity fades. */
+const uint32_t AGING_FRAMES = 256;
+} // namespace
+
+void BitmapCache::registerBitmapDatabase(const Bitmap::BitmapData* data, uint16_t n, uint16_t* cachep, uint32_t csize,
+                                         uint32_t numberOfDynamicBitmaps, Policy cachePolicy)
+{
+    // The use table is placed first, aligned for its 32 bit fields
+    uint8_t* const memory = reinterpret_cast<uint8_t*>(cachep);
+    const uint32_t padding = (4 - reinterpret_cast<uintptr_t>(memory) % 4) % 4;
+    const uint32_t tableSize = (n * sizeof(Entry) + 3) & ~3u;
+    assert(cachep && csize > padding + tableSize && "Bitmap cache too small for the bitmap use table");
+
+    entries = reinterpret_cast<Entry*>(memory + padding);
+    memset(entries, 0, n * sizeof(Entry));
+    numberOfBitmaps = n;
+    cacheSize = csize - padding - tableSize;
+    frame = 1;
+    policy = cachePolicy;
+    fragmented = false;
+    pendingLoads = false;
+    resetStatistics();
+
+    Bitmap::registerBitmapDatabase(data, n, reinterpret_cast<uint16_t*>(memory + padding + tableSize), cacheSize, numberOfDynamicBitmaps);
+}
+
+void BitmapCache::disable()
+{
+    entries = 0;
+    numberOfBitmaps = 0;
+}
+
+void BitmapCache::nextFrame()
+{
+    if (!entries)
+    {
+        return;
+    }
+
+    frame++;
+    if (frame % AGING_FRAMES == 0)
+    {
+        for (uint16_t id = 0; id < numberOfBitmaps; id++)
+        {
+            entries[id].uses >>= 1;
+        }
+    }
+
+    if (!fragmented && !pendingLoads)
+    {
+        return;
+    }
+
+    // Nothing is drawn between frames, but the DMA may still be reading cached bitmaps
+    HAL::getInstance()->flushDMA();
+    if (fragmented)
+    {
+        Bitmap::compactCache();
+        statistics.compactions++;
+        fragmented = false;
+    }
+    if (pendingLoads)
+    {
+        pendingLoads = false;
+        for (uint16_t id = 0; id < numberOfBitmaps; id++)
+        {
+            if (entries[id].pending)
+            {
+                entries[id].pending = 0;
+                if (!Bitmap::cacheIsCached(id) && !load(id))
+                {
+                    statistics.failures++;
+                }
+            }
+        }
+    }
+}
+
+void BitmapCache::resetStatistics()
+{
+    memset(&statistics, 0, sizeof(statistics));
+}
+
+void BitmapCache::touch(BitmapId id)
+{
+    Entry& entry = entries[id];
+    if (entry.lastUse != frame)
+    {
+        entry.lastUse = frame;
+        if (entry.uses < 0xFFFF)
+        {
+            entry.uses++;
+        }
+    }
+
+    if (Bitmap::cacheIsCached(id))
+    {
+        statistics.hits++;
+        return;
+    }
+    statistics.misses++;
+    if (entry.pending)
+    {
+        return;
+    }
+
+    if (Bitmap::dynamicBitmapGetNumberOfBitmaps() > 0)
+    {
+        // A dynamic bitmap may be the target being drawn into, which compaction would move
+        entry.pending = 1;
+        pendingLoads = true;
+        return;
+    }
+
+    // Compaction moves cached bitmaps that queued DMA operations may still be reading
+    HAL::getInstance()->flushDMA();
+    if (!load(id))
+    {
+        statistics.failures++;
+    }
+}
+
+bool BitmapCache::load(BitmapId id)
+{
+    if (estimateSize(id) > cacheSize)
+    {
+        // Do not empty the cache for a bitmap that will never fit
+        return false;
+    }
+    while (!Bitmap::cache(id))
+    {
+        if (!evict())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BitmapCache::evict()
+{
+    BitmapId victim = BITMAP_INVALID;
+    for (BitmapId id = 0; id < numberOfBitmaps; id++)
+    {
+        const Entry& entry = entries[id];
+        if (entry.lastUse == frame || !Bitmap::cacheIsCached(id))
+        {
+            continue;
+        }
+        if (victim == BITMAP_INVALID)
+        {
+            victim = id;
+            continue;
+        }
+        const Entry& best = entries[victim];
+        const bool older = entry.lastUse < best.lastUse;
+        if (policy == LEAST_FREQUENTLY_USED ? (entry.uses < best.uses || (entry.uses == best.uses && older)) : older)
+        {
+            victim = id;
+        }
+    }
+
+    if (victim == BITMAP_INVALID)
+    {
+        return false;
+    }
+    Bitmap::cacheRemoveBitmap(victim);
+    statistics.evictions++;
+    fragmented = true;
+    return true;
+}
+
+uint32_t BitmapCache::estimateSize(BitmapId id)
+{
+    const Bitmap bitmap(id);
+    uint32_t bitsPerPixel = 0;
+    switch (bitmap.getFormat())
+    {
+    case Bitmap::RGB565:
+        bitsPerPixel = 16;
+        break;
+    case Bitmap::RGB888:
+        bitsPerPixel = 24;
+        break;
+    case Bitmap::ARGB8888:
+        bitsPerPixel = 32;
+        break;
+    case Bitmap::BW:
+        bitsPerPixel = 1;
+        break;
+    case Bitmap::GRAY2:
+        bitsPerPixel = 2;
+        break;
+    case Bitmap::GRAY4:
+    case Bitmap::A4:
+        bitsPerPixel = 4;
+        break;
+    case Bitmap::ARGB2222:
+    case Bitmap::ABGR2222:
+    case Bitmap::RGBA2222:
+    case Bitmap::BGRA2222:
+    case Bitmap::L8:
+        bitsPerPixel = 8;
+        break;
+    case Bitmap::BW_RLE:
+    case Bitmap::CUSTOM:
+        // Compressed or unknown, leave it to Bitmap::cache()
+        break;
+    }
+    // A lower bound, the alpha channel of RGB565 and the palette of L8 come on top
+    return (uint32_t)bitmap.getWidth() * bitmap.getHeight() * bitsPerPixel / 8;
+}
+} // namespace touchgfx
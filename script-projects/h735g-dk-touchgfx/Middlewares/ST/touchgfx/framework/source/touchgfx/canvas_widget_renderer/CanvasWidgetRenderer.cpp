@@ -0,0 +1,254 @@
+/******************************************************************************
+* Copyright (c) 2018(-2021) STMicroelectronics.
+* All rights reserved.
+*
+* This file is part of the TouchGFX 4.18.1 distribution.
+*
+* This software is licensed under terms that can be found in the LICENSE file in
+* the root directory of this software component.
+* If no LICENSE file comes with this software, it is provided AS-IS.
+*
+*******************************************************************************/
+
+#include <assert.h>
+#include <touchgfx/Utils.hpp>
+#include <touchgfx/canvas_widget_renderer/CanvasWidgetRenderer.hpp>
+
+namespace touchgfx
+{
+CanvasWidgetRenderer::Context CanvasWidgetRenderer::defaultContext;
+TOUCHGFX_CWR_THREAD_LOCAL CanvasWidgetRenderer::Context* CanvasWidgetRenderer::currentContext = 0;
+bool CanvasWidgetRenderer::reportBufferSizes = false;
+#ifdef SIMULATOR
+bool CanvasWidgetRenderer::writeReport = false;
+#endif
+
+namespace
+{
+unsigned alignTo32Bit(unsigned size)
+{
+    return (size + 3) & ~3U;
+}
+
+/** Bytes used by the scanline buffers for the given width, which come before the Outline cells. */
+unsigned scanlineBufferSize(unsigned width)
+{
+    return alignTo32Bit(width) + 2 * alignTo32Bit((width + 1) & ~1U);
+}
+
+const CanvasWidgetRenderer::MemoryReport emptyReport = { 0, 0, 0, 0, 0 };
+} // namespace
+
+CanvasWidgetRenderer::Context::Context()
+    : memoryBuffer(0),
+      memoryBufferSize(0),
+      scanlineWidth(0),
+      scanlineCovers(0),
+      scanlineStartIndices(0),
+      scanlineCounts(0),
+      outlineBuffer(0),
+      outlineBufferSize(0),
+      lastOutlineCells(0),
+      report(emptyReport)
+#ifdef SIMULATOR
+      ,
+      scanlineSize(0),
+      maxCellsUsed(0),
+      maxCellsMissing(0)
+#endif
+{
+}
+
+void CanvasWidgetRenderer::setupBuffer(uint8_t* buffer, unsigned bufferSize)
+{
+    Context& context = getContext();
+    context.memoryBuffer = buffer;
+    context.memoryBufferSize = bufferSize;
+    context.scanlineWidth = 0;
+    context.scanlineCovers = 0;
+#ifdef SIMULATOR
+    context.scanlineSize = 0;
+    context.maxCellsUsed = 0;
+    context.maxCellsMissing = 0;
+#endif
+}
+
+bool CanvasWidgetRenderer::setScanlineWidth(unsigned width)
+{
+    Context& context = getContext();
+    if (width == context.scanlineWidth && context.scanlineCovers == context.memoryBuffer)
+    {
+        // Buffers already set up for this width
+        return context.outlineBufferSize >= 2 * sizeof(Cell);
+    }
+
+    context.scanlineWidth = width;
+    if (context.memoryBufferSize < scanlineBufferSize(width) + 2 * sizeof(Cell))
+    {
+        // Not enough memory allocated for CWR to draw this wide
+        context.scanlineCovers = 0;
+        context.scanlineStartIndices = 0;
+        context.scanlineCounts = 0;
+        context.outlineBuffer = 0;
+        context.outlineBufferSize = 0;
+        return false;
+    }
+
+    // Allocate a part of the buffer, keeping the next part 32 bit aligned
+    uint8_t* buffer = context.memoryBuffer;
+    context.scanlineCovers = buffer;
+    buffer += alignTo32Bit(width);
+    const unsigned size = (width + 1) & ~1U;
+    context.scanlineStartIndices = buffer;
+    buffer += alignTo32Bit(size);
+    context.scanlineCounts = buffer;
+    buffer += alignTo32Bit(size);
+#ifdef SIMULATOR
+    context.scanlineSize = width + 2 * size;
+#endif
+
+    context.outlineBuffer = reinterpret_cast<Cell*>(buffer);
+    context.outlineBufferSize = context.memoryBufferSize - scanlineBufferSize(width);
+    return true;
+}
+
+bool CanvasWidgetRenderer::hasBuffer()
+{
+    const Context& context = getContext();
+    return context.memoryBuffer != 0 && context.memoryBufferSize != 0;
+}
+
+unsigned CanvasWidgetRenderer::getScanlineWidth()
+{
+    return getContext().scanlineWidth;
+}
+
+void* CanvasWidgetRenderer::getScanlineCovers()
+{
+    return getContext().scanlineCovers;
+}
+
+void* CanvasWidgetRenderer::getScanlineStartIndices()
+{
+    return getContext().scanlineStartIndices;
+}
+
+void* CanvasWidgetRenderer::getScanlineCounts()
+{
+    return getContext().scanlineCounts;
+}
+
+Cell* CanvasWidgetRenderer::getOutlineBuffer()
+{
+    return getContext().outlineBuffer;
+}
+
+unsigned int CanvasWidgetRenderer::getOutlineBufferSize()
+{
+    return getContext().outlineBufferSize;
+}
+
+unsigned CanvasWidgetRenderer::getCellCapacity(unsigned width)
+{
+    const Context& context = getContext();
+    const unsigned scanlineSize = scanlineBufferSize(width);
+    if (context.memoryBufferSize < scanlineSize + 2 * sizeof(Cell))
+    {
+        return 0;
+    }
+    return (context.memoryBufferSize - scanlineSize) / sizeof(Cell);
+}
+
+void CanvasWidgetRenderer::registerOutline(unsigned width, unsigned cells, unsigned maxCellsPerLine)
+{
+    Context& context = getContext();
+    if (isMemoryReportEnabled())
+    {
+        const unsigned scanlineSize = scanlineBufferSize(width);
+        // Outline needs room for one Cell more than it registers
+        context.report.unsplitBufferSize = MAX(context.report.unsplitBufferSize, scanlineSize + (cells + 1) * (unsigned)sizeof(Cell));
+        context.report.minimumBufferSize = MAX(context.report.minimumBufferSize, scanlineSize + (maxCellsPerLine + 1) * (unsigned)sizeof(Cell));
+    }
+    context.report.outlines++;
+    context.lastOutlineCells = cells;
+}
+
+unsigned CanvasWidgetRenderer::getLastOutlineCells()
+{
+    return getContext().lastOutlineCells;
+}
+
+void CanvasWidgetRenderer::registerRetry()
+{
+    getContext().report.retries++;
+}
+
+void CanvasWidgetRenderer::registerSkippedLine()
+{
+    getContext().report.skippedLines++;
+}
+
+void CanvasWidgetRenderer::resetMemoryReport()
+{
+    getContext().report = emptyReport;
+}
+
+bool CanvasWidgetRenderer::isMemoryReportEnabled()
+{
+#ifdef SIMULATOR
+    return reportBufferSizes || writeReport;
+#else
+    return reportBufferSizes;
+#endif
+}
+
+#ifdef SIMULATOR
+void CanvasWidgetRenderer::setWriteMemoryUsageReport(bool writeUsageReport)
+{
+    writeReport = writeUsageReport;
+}
+
+bool CanvasWidgetRenderer::getWriteMemoryUsageReport()
+{
+    return writeReport;
+}
+
+void CanvasWidgetRenderer::numCellsUsed(unsigned used)
+{
+    Context& context = getContext();
+    if (used > context.maxCellsUsed)
+    {
+        context.maxCellsUsed = used;
+        if (writeReport)
+        {
+            touchgfx_printf("CWR requires %u bytes\n", getUsedBufferSize());
+        }
+    }
+}
+
+void CanvasWidgetRenderer::numCellsMissing(unsigned missing)
+{
+    Context& context = getContext();
+    if (missing > context.maxCellsMissing)
+    {
+        context.maxCellsMissing = missing;
+        if (writeReport)
+        {
+            const unsigned missingBytes = missing * sizeof(Cell);
+            touchgfx_printf("CWR requires %u bytes (%u bytes missing)\n", getUsedBufferSize() + missingBytes, missingBytes);
+        }
+    }
+}
+
+unsigned CanvasWidgetRenderer::getUsedBufferSize()
+{
+    const Context& context = getContext();
+    return ((context.scanlineSize + 3) & ~3U) + (context.maxCellsUsed + 1) * (unsigned)sizeof(Cell);
+}
+
+unsigned CanvasWidgetRenderer::getMissingBufferSize()
+{
+    return getContext().maxCellsMissing * sizeof(Cell);
+}
+#endif
+} // namespace touchgfx
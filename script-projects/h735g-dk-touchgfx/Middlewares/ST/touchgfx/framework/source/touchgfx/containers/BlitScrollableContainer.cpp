@@ -0,0 +1,57 @@
+/******************************************************************************
+* Copyright (c) 2018(-2021) STMicroelectronics.
+* All rights reserved.
+*
+* This file is part of the TouchGFX 4.18.1 distribution.
+*
+* This software is licensed under terms that can be found in the LICENSE file in
+* the root directory of this software component.
+* If no LICENSE file comes with this software, it is provided AS-IS.
+*
+*******************************************************************************/
+
+#include <touchgfx/hal/Types.hpp>
+#include <touchgfx/Application.hpp>
+#include <touchgfx/containers/BlitScrollableContainer.hpp>
+
+namespace touchgfx
+{
+void BlitScrollableContainer::handleTickEvent()
+{
+    // ScrollableContainer unregisters once on every tick without an animation
+    if (animate)
+    {
+        ScrollableContainer::handleTickEvent();
+    }
+    if (blitterTicking)
+    {
+        const Drawable* const fixed[] = { &xSlider, &ySlider };
+        if (!blitter.update(*this, fixed, 2))
+        {
+            blitterTicking = false;
+            Application::getInstance()->unregisterTimerWidget(this);
+        }
+    }
+}
+
+void BlitScrollableContainer::moveChildrenRelative(int16_t deltaX, int16_t deltaY)
+{
+    blitter.beginMove();
+    ScrollableContainer::moveChildrenRelative(deltaX, deltaY);
+    const Drawable* const fixed[] = { &xSlider, &ySlider };
+    if (blitter.endMove(*this, deltaX, deltaY, fixed, 2) && !blitterTicking)
+    {
+        blitterTicking = true;
+        Application::getInstance()->registerTimerWidget(this);
+    }
+}
+
+void BlitScrollableContainer::invalidateRect(Rect& invalidatedArea) const
+{
+    if (!blitter.isMoving())
+    {
+        blitter.invalidatedByChild(invalidatedArea);
+        ScrollableContainer::invalidateRect(invalidatedArea);
+    }
+}
+} // namespace touchgfx
@@ -0,0 +1,97 @@
+/******************************************************************************
+* Copyright (c) 2018(-2021) STMicroelectronics.
+* All rights reserved.
+*
+* This file is part of the TouchGFX 4.18.1 distribution.
+*
+* This software is licensed under terms that can be found in the LICENSE file in
+* the root directory of this software component.
+* If no LICENSE file comes with this software, it is provided AS-IS.
+*
+*******************************************************************************/
+
+#include <touchgfx/hal/Types.hpp>
+#include <touchgfx/containers/CachedGeometryContainer.hpp>
+
+namespace touchgfx
+{
+uint32_t CachedGeometryContainer::version = 1;
+const CachedGeometryContainer* CachedGeometryContainer::lastTranslated = 0;
+
+void CachedGeometryContainer::invalidateRect(Rect& invalidatedArea) const
+{
+    updateGeometry();
+    if (!outermost)
+    {
+        Container::invalidateRect(invalidatedArea);
+        return;
+    }
+    // The CachedGeometryContainers in between would only have moved and clipped the area
+    invalidatedArea.x += outermostX;
+    invalidatedArea.y += outermostY;
+    invalidatedArea &= outermostClip;
+    if (!invalidatedArea.isEmpty())
+    {
+        outermost->Container::invalidateRect(invalidatedArea);
+    }
+}
+
+void CachedGeometryContainer::getVisibleRect(Rect& rect) const
+{
+    updateGeometry();
+    rect.x += offsetX;
+    rect.y += offsetY;
+    rect &= visibleArea;
+}
+
+void CachedGeometryContainer::translateRectToAbsolute(Rect& r) const
+{
+    updateGeometry();
+    r.x += offsetX;
+    r.y += offsetY;
+    lastTranslated = this;
+}
+
+void CachedGeometryContainer::updateGeometry() const
+{
+    if (geometryVersion == version && cachedParent == parent)
+    {
+        return;
+    }
+
+    // Drawable passes the rectangles on to the parent, which answers at once if it is a
+    // CachedGeometryContainer with an up to date geometry
+    Rect absolute(0, 0, 0, 0);
+    lastTranslated = 0;
+    Drawable::translateRectToAbsolute(absolute);
+    offsetX = absolute.x;
+    offsetY = absolute.y;
+    visibleArea = Rect(0, 0, getWidth(), getHeight());
+    Drawable::getVisibleRect(visibleArea);
+
+    // The parent answered last if it is a CachedGeometryContainer, as a Drawable asks its parent
+    const CachedGeometryContainer* cachedGeometryParent = (lastTranslated == parent) ? lastTranslated : 0;
+    outermost = 0;
+    if (cachedGeometryParent)
+    {
+        outermostX = getX();
+        outermostY = getY();
+        outermostClip = getRect();
+        outermost = cachedGeometryParent->outermost;
+        if (outermost)
+        {
+            outermostX += cachedGeometryParent->outermostX;
+            outermostY += cachedGeometryParent->outermostY;
+            outermostClip.x += cachedGeometryParent->outermostX;
+            outermostClip.y += cachedGeometryParent->outermostY;
+            outermostClip &= cachedGeometryParent->outermostClip;
+        }
+        else
+        {
+            outermost = cachedGeometryParent;
+        }
+    }
+    cachedParent = parent;
+    geometryVersion = version;
+}
+} // namespace touchgfx
@@ -0,0 +1,433 @@
+/******************************************************************************
+* Copyright (c) 2018(-2021) STMicroelectronics.
+* All rights reserved.
+*
+* This file is part of the TouchGFX 4.18.1 distribution.
+*
+* This software is licensed under terms that can be found in the LICENSE file in
+* the root directory of this software component.
+* If no LICENSE file comes with this software, it is provided AS-IS.
+*
+*******************************************************************************/
+
+#include <touchgfx/hal/Types.hpp>
+#include <touchgfx/containers/IndexedContainer.hpp>
+#include <touchgfx/hal/HAL.hpp>
+
+namespace touchgfx
+{
+namespace
+{
+/** Children covering more cells than this are kept in the list of large children. */
+const uint32_t MAX_CELLS_PER_CHILD = 16;
+/** The smallest cell chosen automatically. */
+const int16_t MIN_CELL_SIZE = 8;
+
+uint32_t squareRoot(uint32_t value)
+{
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30;
+    while (bit > value)
+    {
+        bit >>= 2;
+    }
+    while (bit != 0)
+    {
+        if (value >= root + bit)
+        {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+/** Gets the index of the single bit set in a word. */
+uint8_t bitIndex(uint32_t bit)
+{
+    static const uint8_t deBruijnBits[32] = { 0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+                                              31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9 };
+    return deBruijnBits[(uint32_t)(bit * 0x077CB531UL) >> 27];
+}
+
+/** The cells covered by an area inside the grid. */
+struct CellRange
+{
+    CellRange(const Rect& area, const Rect& bounds, int16_t cellSize)
+        : firstColumn((area.x - bounds.x) / cellSize),
+          lastColumn((area.right() - 1 - bounds.x) / cellSize),
+          firstRow((area.y - bounds.y) / cellSize),
+          lastRow((area.bottom() - 1 - bounds.y) / cellSize)
+    {
+    }
+
+    uint32_t size() const
+    {
+        return (uint32_t)(lastColumn - firstColumn + 1) * (lastRow - firstRow + 1);
+    }
+
+    uint16_t firstColumn;
+    uint16_t lastColumn;
+    uint16_t firstRow;
+    uint16_t lastRow;
+};
+} // namespace
+
+void IndexedContainer::add(Drawable& d)
+{
+    Container::add(d);
+    invalidateIndex();
+}
+
+void IndexedContainer::remove(Drawable& d)
+{
+    Container::remove(d);
+    invalidateIndex();
+}
+
+void IndexedContainer::removeAll()
+{
+    Container::removeAll();
+    invalidateIndex();
+}
+
+void IndexedContainer::unlink()
+{
+    Container::unlink();
+    invalidateIndex();
+}
+
+void IndexedContainer::insert(Drawable* previous, Drawable& d)
+{
+    Container::insert(previous, d);
+    invalidateIndex();
+}
+
+void IndexedContainer::draw(const Rect& invalidatedArea) const
+{
+    if (!updateIndex())
+    {
+        Container::draw(invalidatedArea);
+        return;
+    }
+    if (!isVisible())
+    {
+        return;
+    }
+
+    uint16_t word = 0;
+    const uint16_t words = markChildren(invalidatedArea);
+    for (Drawable* d = nextMarkedChild(word, words); d; d = nextMarkedChild(word, words))
+    {
+        if (d->isVisible())
+        {
+            Rect drawableRegion = invalidatedArea & d->getRect();
+            if (!drawableRegion.isEmpty())
+            {
+                drawableRegion.x -= d->getX();
+                drawableRegion.y -= d->getY();
+                d->draw(drawableRegion);
+            }
+        }
+    }
+}
+
+void IndexedContainer::getLastChild(int16_t x, int16_t y, Drawable** last)
+{
+    if (!updateIndex())
+    {
+        Container::getLastChild(x, y, last);
+        return;
+    }
+    if (isTouchable())
+    {
+        *last = this;
+    }
+
+    uint16_t word = 0;
+    const uint16_t words = markChildren(Rect(x, y, 1, 1));
+    for (Drawable* d = nextMarkedChild(word, words); d; d = nextMarkedChild(word, words))
+    {
+        if (d->isVisible() && d->getRect().intersect(x, y))
+        {
+            d->getLastChild(x - d->getX(), y - d->getY(), last);
+        }
+    }
+}
+
+void IndexedContainer::getLastChildNear(int16_t x, int16_t y, Drawable** last, int16_t* fingerAdjustmentX, int16_t* fingerAdjustmentY)
+{
+    // Same as Container::getLastChildNear(), which only samples through Container::getLastChild()
+    const int fingerSize = HAL::getInstance()->getFingerSize();
+    *fingerAdjustmentX = 0;
+    *fingerAdjustmentY = 0;
+
+    *last = 0;
+    IndexedContainer::getLastChild(x, y, last);
+
+    const int fingerSizeDistance = 3; // Up to this number is not multi-sampled
+    if (fingerSize > fingerSizeDistance)
+    {
+        const Rect meAbsRect = getAbsoluteRect();
+
+        uint32_t bestDistance = 0xFFFFFFFF;
+        Drawable* previous = 0; // Speed up calculations if we hit the same drawable on next sample
+        if (*last)
+        {
+            // Touched a drawable, but perhaps there is a better alternative
+            previous = *last;
+            Rect absRect = (*last)->getAbsoluteRect();
+            int dx = (x + meAbsRect.x) - (absRect.x + (absRect.width / 2));
+            int dy = (y + meAbsRect.y) - (absRect.y + (absRect.height / 2));
+            bestDistance = dx * dx + dy * dy;
+        }
+
+        const int samplePoints[2][4][2] = { { { 0, -1 }, { -1, 0 }, { 1, 0 }, { 0, 1 } },     // above, left, right, below
+                                            { { -1, -1 }, { 1, -1 }, { -1, 1 }, { 1, 1 } } }; // up-left, up-right, down-left and down-right
+        const int maxRings = 3;
+        const int numRings = MIN(maxRings, (fingerSize - 1) / fingerSizeDistance);
+        for (int ring = 0; ring < numRings; ring++)
+        {
+            // For each 'ring' "distance" increases up to "fingerSize":
+            int distance = fingerSize * (ring + 1) / numRings;
+            for (int sampleIndex = 0; sampleIndex < 4; sampleIndex++)
+            {
+                const int* xy = samplePoints[ring % 2][sampleIndex];
+                int16_t deltaX = xy[0] * distance;
+                int16_t deltaY = xy[1] * distance;
+                if (rect.intersect(x + deltaX, y + deltaY))
+                {
+                    Drawable* drawable = 0;
+                    IndexedContainer::getLastChild(x + deltaX, y + deltaY, &drawable);
+                    if (drawable && drawable != previous)
+                    {
+                        previous = drawable;
+                        Rect absRect = drawable->getAbsoluteRect();
+                        // Find distance to center of drawable
+                        int dx = (x + meAbsRect.x) - (absRect.x + (absRect.width / 2));
+                        int dy = (y + meAbsRect.y) - (absRect.y + (absRect.height / 2));
+                        uint32_t dist = dx * dx + dy * dy;
+                        // Check if this drawable center is closer than the previous
+                        if (dist < bestDistance)
+                        {
+                            bestDistance = dist;
+                            *last = drawable;
+                            *fingerAdjustmentX = deltaX;
+                            *fingerAdjustmentY = deltaY;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void IndexedContainer::moveChildrenRelative(int16_t deltaX, int16_t deltaY)
+{
+    Container::moveChildrenRelative(deltaX, deltaY);
+    // The grid moves with the children
+    bounds.x += deltaX;
+    bounds.y += deltaY;
+}
+
+void IndexedContainer::setupDrawChain(const Rect& invalidatedArea, Drawable** nextPreviousElement)
+{
+    if (!updateIndex())
+    {
+        Container::setupDrawChain(invalidatedArea, nextPreviousElement);
+        return;
+    }
+    if (!isVisible())
+    {
+        return;
+    }
+
+    uint16_t word = 0;
+    const uint16_t words = markChildren(invalidatedArea);
+    for (Drawable* d = nextMarkedChild(word, words); d; d = nextMarkedChild(word, words))
+    {
+        if (d->isVisible())
+        {
+            // Only drawables intersecting with the specified invalidated area will be added.
+            Rect drawableRegion = invalidatedArea & d->getRect();
+            if (!drawableRegion.isEmpty())
+            {
+                drawableRegion.x -= d->getX();
+                drawableRegion.y -= d->getY();
+                d->setupDrawChain(drawableRegion, nextPreviousElement);
+            }
+        }
+    }
+}
+
+bool IndexedContainer::updateIndex() const
+{
+    if (indexValid)
+    {
+        return indexed;
+    }
+    indexValid = true;
+    indexed = false;
+    if (buffer == 0)
+    {
+        return false;
+    }
+
+    // The grid covers all the children, with cells holding about one child each
+    uint32_t count = 0;
+    bounds = getContainedArea();
+    for (Drawable* d = firstChild; d; d = d->nextSibling)
+    {
+        count++;
+    }
+    if (count == 0 || count > 0xFFFF || bounds.isEmpty())
+    {
+        return false;
+    }
+    numberOfChildren = (uint16_t)count;
+    cellSize = requestedCellSize;
+    if (cellSize <= 0)
+    {
+        cellSize = (int16_t)MAX(squareRoot((uint32_t)bounds.width * bounds.height / numberOfChildren), (uint32_t)MIN_CELL_SIZE);
+    }
+    const uint32_t columnCount = (bounds.width + cellSize - 1) / cellSize;
+    const uint32_t rowCount = (bounds.height + cellSize - 1) / cellSize;
+    const uint32_t lists = columnCount * rowCount + 1; // The large children are the last list
+    const uint32_t words = (numberOfChildren + 31) / 32;
+    const uint32_t fixedSize = numberOfChildren * sizeof(Drawable*) + words * sizeof(uint32_t) + (lists + 1) * sizeof(uint16_t);
+    if (lists > 0xFFFF || fixedSize > bufferSize)
+    {
+        return false;
+    }
+    columns = (uint16_t)columnCount;
+    rows = (uint16_t)rowCount;
+    children = reinterpret_cast<Drawable**>(buffer);
+    marks = reinterpret_cast<uint32_t*>(buffer + numberOfChildren * sizeof(Drawable*));
+    cellStart = reinterpret_cast<uint16_t*>(marks + words);
+    entries = cellStart + lists + 1;
+
+    // Count the children in each list, placed one list later
+    for (uint32_t i = 0; i <= lists; i++)
+    {
+        cellStart[i] = 0;
+    }
+    uint32_t total = 0;
+    uint16_t index = 0;
+    for (Drawable* d = firstChild; d; d = d->nextSibling, index++)
+    {
+        children[index] = d;
+        const Rect childRect = d->getRect();
+        if (childRect.isEmpty())
+        {
+            // Never drawn or touched
+            continue;
+        }
+        const CellRange range(childRect, bounds, cellSize);
+        if (range.size() > MAX_CELLS_PER_CHILD)
+        {
+            cellStart[lists]++;
+            total++;
+            continue;
+        }
+        for (uint16_t row = range.firstRow; row <= range.lastRow; row++)
+        {
+            for (uint16_t column = range.firstColumn; column <= range.lastColumn; column++)
+            {
+                cellStart[row * columns + column + 1]++;
+            }
+        }
+        total += range.size();
+    }
+    if (total > 0xFFFF || fixedSize + total * sizeof(uint16_t) > bufferSize)
+    {
+        return false;
+    }
+
+    // Fill in the children in order, moving the start of every list to the end of the list
+    for (uint32_t i = 1; i <= lists; i++)
+    {
+        cellStart[i] += cellStart[i - 1];
+    }
+    for (index = 0; index < numberOfChildren; index++)
+    {
+        const Rect childRect = children[index]->getRect();
+        if (childRect.isEmpty())
+        {
+            continue;
+        }
+        const CellRange range(childRect, bounds, cellSize);
+        if (range.size() > MAX_CELLS_PER_CHILD)
+        {
+            entries[cellStart[lists - 1]++] = index;
+            continue;
+        }
+        for (uint16_t row = range.firstRow; row <= range.lastRow; row++)
+        {
+            for (uint16_t column = range.firstColumn; column <= range.lastColumn; column++)
+            {
+                entries[cellStart[row * columns + column]++] = index;
+            }
+        }
+    }
+    for (uint32_t i = lists; i > 0; i--)
+    {
+        cellStart[i] = cellStart[i - 1];
+    }
+    cellStart[0] = 0;
+    for (uint32_t i = 0; i < words; i++)
+    {
+        marks[i] = 0;
+    }
+    indexed = true;
+    return true;
+}
+
+uint16_t IndexedContainer::markChildren(const Rect& area) const
+{
+    uint16_t words = 0;
+    const uint32_t cells = (uint32_t)columns * rows;
+    for (uint16_t entry = cellStart[cells]; entry < cellStart[cells + 1]; entry++)
+    {
+        const uint16_t index = entries[entry];
+        marks[index >> 5] |= 1UL << (index & 31);
+        words = MAX(words, (uint16_t)((index >> 5) + 1));
+    }
+    const Rect gridArea = area & bounds;
+    if (gridArea.isEmpty())
+    {
+        return words;
+    }
+    const CellRange range(gridArea, bounds, cellSize);
+    for (uint16_t row = range.firstRow; row <= range.lastRow; row++)
+    {
+        const uint16_t* const rowStart = cellStart + row * columns;
+        for (uint16_t entry = rowStart[range.firstColumn]; entry < rowStart[range.lastColumn + 1]; entry++)
+        {
+            const uint16_t index = entries[entry];
+            marks[index >> 5] |= 1UL << (index & 31);
+            words = MAX(words, (uint16_t)((index >> 5) + 1));
+        }
+    }
+    return words;
+}
+
+Drawable* IndexedContainer::nextMarkedChild(uint16_t& word, uint16_t words) const
+{
+    for (; word < words; word++)
+    {
+        const uint32_t bits = marks[word];
+        if (bits != 0)
+        {
+            const uint32_t bit = bits & (0U - bits);
+            marks[word] = bits ^ bit;
+            return children[word * 32 + bitIndex(bit)];
+        }
+    }
+    return 0;
+}
+} // namespace touchgfx
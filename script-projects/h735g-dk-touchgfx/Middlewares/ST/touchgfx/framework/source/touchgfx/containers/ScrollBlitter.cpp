@@ -0,0 +1,261 @@
+/******************************************************************************
+* Copyright (c) 2018(-2021) STMicroelectronics.
+* All rights reserved.
+*
+* This file is part of the TouchGFX 4.18.1 distribution.
+*
+* This software is licensed under terms that can be found in the LICENSE file in
+* the root directory of this software component.
+* If no LICENSE file comes with this software, it is provided AS-IS.
+*
+*******************************************************************************/
+
+#include <string.h>
+#include <touchgfx/hal/Types.hpp>
+#include <touchgfx/Bitmap.hpp>
+#include <touchgfx/Utils.hpp>
+#include <touchgfx/containers/ScrollBlitter.hpp>
+#include <touchgfx/hal/HAL.hpp>
+#include <touchgfx/lcd/LCD.hpp>
+#include <touchgfx/transforms/DisplayTransformation.hpp>
+
+namespace touchgfx
+{
+void ScrollBlitter::beginMove()
+{
+    moving = canCopyPixels();
+}
+
+bool ScrollBlitter::endMove(Drawable& container, int16_t deltaX, int16_t deltaY, const Drawable* const* fixed, int numFixed)
+{
+    positionX += deltaX;
+    positionY += deltaY;
+    if (!moving)
+    {
+        // The children invalidated themselves as usual
+        clientValid = false;
+        tftValid = false;
+        return false;
+    }
+    moving = false;
+    followFrameBuffers();
+    if (!pendingArea.isEmpty())
+    {
+        pendingArea.x += deltaX;
+        pendingArea.y += deltaY;
+    }
+    bringUpToDate(container, fixed, numFixed);
+    return !(tftValid && tftX == positionX && tftY == positionY);
+}
+
+bool ScrollBlitter::update(Drawable& container, const Drawable* const* fixed, int numFixed)
+{
+    if (!canCopyPixels())
+    {
+        clientValid = false;
+        tftValid = false;
+        return false;
+    }
+    followFrameBuffers();
+    bringUpToDate(container, fixed, numFixed);
+    return !(tftValid && tftX == positionX && tftY == positionY);
+}
+
+void ScrollBlitter::invalidatedByChild(const Rect& area)
+{
+    if (!updating)
+    {
+        followFrameBuffers();
+        pendingArea.expandToFit(area);
+    }
+}
+
+void ScrollBlitter::followFrameBuffers()
+{
+    const uint16_t* tft = HAL::getInstance()->getTFTFrameBuffer();
+    if (tft == tftFrameBuffer)
+    {
+        return;
+    }
+    if (tftFrameBuffer)
+    {
+        // The framebuffer drawn in the last frame is now shown, and the other will be drawn
+        const bool valid = tftValid;
+        const int32_t x = tftX;
+        const int32_t y = tftY;
+        tftValid = clientValid;
+        tftX = clientX;
+        tftY = clientY;
+        clientValid = valid;
+        clientX = x;
+        clientY = y;
+    }
+    tftFrameBuffer = tft;
+    pendingArea = Rect();
+}
+
+void ScrollBlitter::bringUpToDate(Drawable& container, const Drawable* const* fixed, int numFixed)
+{
+    if (clientValid && clientX == positionX && clientY == positionY)
+    {
+        return;
+    }
+
+    Rect viewport(0, 0, container.getWidth(), container.getHeight());
+    container.getVisibleRect(viewport);
+    for (const Drawable* d = &container; d; d = d->getParent())
+    {
+        if (!d->isVisible())
+        {
+            viewport = Rect();
+        }
+    }
+    if (viewport.isEmpty())
+    {
+        // Nothing is shown, and the container is drawn again when it is shown
+        clientValid = false;
+        tftValid = false;
+        return;
+    }
+
+    const int32_t shiftX = positionX - tftX;
+    const int32_t shiftY = positionY - tftY;
+    Rect overlays[MAX_OVERLAYS];
+    int numOverlays = 0;
+    const bool copy = tftValid && abs(shiftX) < viewport.width && abs(shiftY) < viewport.height
+                      && findOverlays(container, viewport, fixed, numFixed, overlays, numOverlays);
+
+    updating = true;
+    if (copy)
+    {
+        Rect destination(viewport.x + (int16_t)shiftX, viewport.y + (int16_t)shiftY, viewport.width, viewport.height);
+        destination &= viewport;
+        copyPixels(Rect(destination.x - (int16_t)shiftX, destination.y - (int16_t)shiftY, destination.width, destination.height), destination);
+
+        // The strips uncovered by the move
+        if (shiftX > 0)
+        {
+            invalidateAbsolute(container, Rect(viewport.x, viewport.y, (int16_t)shiftX, viewport.height));
+        }
+        else if (shiftX < 0)
+        {
+            invalidateAbsolute(container, Rect(viewport.right() + (int16_t)shiftX, viewport.y, (int16_t)-shiftX, viewport.height));
+        }
+        if (shiftY > 0)
+        {
+            invalidateAbsolute(container, Rect(viewport.x, viewport.y, viewport.width, (int16_t)shiftY));
+        }
+        else if (shiftY < 0)
+        {
+            invalidateAbsolute(container, Rect(viewport.x, viewport.bottom() + (int16_t)shiftY, viewport.width, (int16_t)-shiftY));
+        }
+
+        // The drawables on top were copied along with the content
+        for (int i = 0; i < numOverlays; i++)
+        {
+            invalidateAbsolute(container, overlays[i]);
+            invalidateAbsolute(container, Rect(overlays[i].x + (int16_t)shiftX, overlays[i].y + (int16_t)shiftY, overlays[i].width, overlays[i].height));
+        }
+
+        // Areas changed in this frame before the move were copied from the old pixels
+        if (!pendingArea.isEmpty())
+        {
+            Rect pending = pendingArea;
+            container.invalidateRect(pending);
+        }
+    }
+    else
+    {
+        invalidateAbsolute(container, viewport);
+    }
+    updating = false;
+
+    clientValid = true;
+    clientX = positionX;
+    clientY = positionY;
+}
+
+bool ScrollBlitter::findOverlays(Drawable& container, const Rect& viewport, const Drawable* const* fixed, int numFixed, Rect* overlays, int& numOverlays)
+{
+    for (int i = 0; i < numFixed; i++)
+    {
+        if (fixed[i]->isVisible())
+        {
+            Rect area = fixed[i]->getAbsoluteRect() & viewport;
+            if (!area.isEmpty())
+            {
+                if (numOverlays == MAX_OVERLAYS)
+                {
+                    return false;
+                }
+                overlays[numOverlays++] = area;
+            }
+        }
+    }
+
+    // Drawables added after the container, or after one of its ancestors, are drawn on top
+    for (Drawable* d = &container; d->getParent(); d = d->getParent())
+    {
+        for (Drawable* sibling = d->getNextSibling(); sibling; sibling = sibling->getNextSibling())
+        {
+            if (sibling->isVisible())
+            {
+                Rect area = sibling->getAbsoluteRect() & viewport;
+                if (!area.isEmpty())
+                {
+                    if (numOverlays == MAX_OVERLAYS)
+                    {
+                        return false;
+                    }
+                    overlays[numOverlays++] = area;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void ScrollBlitter::invalidateAbsolute(Drawable& container, const Rect& area)
+{
+    const Rect absolute = container.getAbsoluteRect();
+    Rect invalid(area.x - absolute.x, area.y - absolute.y, area.width, area.height);
+    container.invalidateRect(invalid);
+}
+
+void ScrollBlitter::copyPixels(const Rect& source, const Rect& destination)
+{
+    Rect src = source;
+    Rect dst = destination;
+    DisplayTransformation::transformDisplayToFrameBuffer(src);
+    DisplayTransformation::transformDisplayToFrameBuffer(dst);
+
+    HAL* hal = HAL::getInstance();
+    const int bytesPerPixel = HAL::lcd().bitDepth() / 8;
+    const int stride = HAL::FRAME_BUFFER_WIDTH * bytesPerPixel;
+    const uint8_t* tft = reinterpret_cast<const uint8_t*>(hal->getTFTFrameBuffer()) + src.y * stride + src.x * bytesPerPixel;
+    if (hal->getBlitCaps() & BLIT_OP_COPY)
+    {
+        const Bitmap::BitmapFormat format = HAL::lcd().framebufferFormat();
+        hal->blitCopy(reinterpret_cast<const uint16_t*>(tft), dst.x, dst.y, dst.width, dst.height, HAL::FRAME_BUFFER_WIDTH, 255, false, HAL::FRAME_BUFFER_WIDTH, format, format, false);
+        return;
+    }
+
+    uint8_t* client = reinterpret_cast<uint8_t*>(hal->lockFrameBuffer()) + dst.y * stride + dst.x * bytesPerPixel;
+    const int rowBytes = dst.width * bytesPerPixel;
+    for (int16_t y = 0; y < dst.height; y++)
+    {
+        memcpy(client, tft, rowBytes);
+        client += stride;
+        tft += stride;
+    }
+    hal->unlockFrameBuffer();
+}
+
+bool ScrollBlitter::canCopyPixels()
+{
+    HAL* hal = HAL::getInstance();
+    const uint8_t bitDepth = HAL::lcd().bitDepth();
+    return HAL::USE_DOUBLE_BUFFERING && hal->getFrameBufferAllocator() == 0 && hal->getTFTFrameBuffer() != 0
+           && bitDepth >= 8 && (bitDepth & 7) == 0;
+}
+} // namespace touchgfx
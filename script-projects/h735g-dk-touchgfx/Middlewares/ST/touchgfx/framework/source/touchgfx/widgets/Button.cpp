@@ -11,6 +11,7 @@
 *******************************************************************************/
 
 #include <touchgfx/Bitmap.hpp>
+#include <touchgfx/BitmapCache.hpp>
 #include <touchgfx/Drawable.hpp>
 #include <touchgfx/hal/HAL.hpp>
 #include <touchgfx/lcd/LCD.hpp>
@@ -27,6 +28,7 @@ void Button::draw(const Rect& invalidatedArea) const
     {
         Rect r;
         translateRectToAbsolute(r);
+        BitmapCache::use(bmp.getId());
         HAL::lcd().drawPartialBitmap(bmp, r.x, r.y, dirty, alpha);
     }
 }
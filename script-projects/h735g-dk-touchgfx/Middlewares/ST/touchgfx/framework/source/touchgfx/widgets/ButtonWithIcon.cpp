@@ -11,6 +11,7 @@
 *******************************************************************************/
 
 #include <touchgfx/Bitmap.hpp>
+#include <touchgfx/BitmapCache.hpp>
 #include <touchgfx/Drawable.hpp>
 #include <touchgfx/hal/HAL.hpp>
 #include <touchgfx/lcd/LCD.hpp>
@@ -53,6 +54,7 @@ void ButtonWithIcon::draw(const Rect& invalidatedArea) const
         translateRectToAbsolute(r);
         dirty.x -= iconX;
         dirty.y -= iconY;
+        BitmapCache::use(bmp.getId());
         HAL::lcd().drawPartialBitmap(bmp, r.x + iconX, r.y + iconY, dirty, alpha);
     }
 }
@@ -0,0 +1,231 @@
+/******************************************************************************
+* Copyright (c) 2018(-2021) STMicroelectronics.
+* All rights reserved.
+*
+* This file is part of the TouchGFX 4.18.1 distribution.
+*
+* This software is licensed under terms that can be found in the LICENSE file in
+* the root directory of this software component.
+* If no LICENSE file comes with this software, it is provided AS-IS.
+*
+*******************************************************************************/
+
+#include <touchgfx/hal/Types.hpp>
+#include <touchgfx/hal/HAL.hpp>
+#include <touchgfx/lcd/LCD.hpp>
+#include <touchgfx/widgets/CachedTextArea.hpp>
+
+namespace touchgfx
+{
+/**
+ * An LCD that draws nothing, but records the glyphs drawn by LCD::drawString() into the
+ * buffer of a GlyphRunCache. When drawing, a full buffer is drawn and emptied, so text with
+ * more glyphs than the buffer holds is still drawn from a layout of the whole text.
+ */
+class CachedTextArea::GlyphRunRecorder : public LCD
+{
+public:
+    GlyphRunRecorder(GlyphRunCache::Glyph* glyphs, uint16_t capacity)
+        : glyphs(glyphs), capacity(capacity), numberOfGlyphs(0), overflow(false),
+          drawing(false), widgetArea(), area(), color(0), alpha(0)
+    {
+    }
+
+    virtual void drawPartialBitmap(const Bitmap& bitmap, int16_t x, int16_t y, const Rect& rect, uint8_t alpha = 255, bool useOptimized = true)
+    {
+    }
+
+    virtual void blitCopy(const uint16_t* sourceData, const Rect& source, const Rect& blitRect, uint8_t alpha, bool hasTransparentPixels)
+    {
+    }
+
+    virtual void blitCopy(const uint8_t* sourceData, Bitmap::BitmapFormat sourceFormat, const Rect& source, const Rect& blitRect, uint8_t alpha, bool hasTransparentPixels)
+    {
+    }
+
+    virtual uint16_t* copyFrameBufferRegionToMemory(const Rect& visRegion, const Rect& absRegion, const BitmapId bitmapId)
+    {
+        return 0;
+    }
+
+    virtual void fillRect(const Rect& rect, colortype color, uint8_t alpha = 255)
+    {
+    }
+
+    virtual void fillBuffer(uint8_t* const destination, uint16_t pixelStride, const Rect& rect, const colortype color, const uint8_t alpha)
+    {
+    }
+
+    virtual uint8_t bitDepth() const
+    {
+        return HAL::lcd().bitDepth();
+    }
+
+    virtual Bitmap::BitmapFormat framebufferFormat() const
+    {
+        return HAL::lcd().framebufferFormat();
+    }
+
+    virtual uint16_t framebufferStride() const
+    {
+        return HAL::lcd().framebufferStride();
+    }
+
+    /**
+     * Draws the recorded glyphs that intersect an invalidated area whenever the buffer is
+     * full, and when finish() is called.
+     */
+    void drawGlyphsInto(const Rect& absoluteWidgetArea, const Rect& invalidatedArea, colortype textColor, uint8_t textAlpha)
+    {
+        drawing = true;
+        widgetArea = absoluteWidgetArea;
+        area = invalidatedArea;
+        color = textColor;
+        alpha = textAlpha;
+    }
+
+    void finish()
+    {
+        if (drawing)
+        {
+            CachedTextArea::drawGlyphs(glyphs, numberOfGlyphs, widgetArea, area, color, alpha);
+            numberOfGlyphs = 0;
+        }
+    }
+
+    uint16_t getNumberOfGlyphs() const
+    {
+        return numberOfGlyphs;
+    }
+
+    bool hasOverflow() const
+    {
+        return overflow;
+    }
+
+protected:
+    virtual void drawGlyph(uint16_t* wbuf16, Rect widgetArea, int16_t x, int16_t y, uint16_t offsetX, uint16_t offsetY, const Rect& invalidatedArea, const GlyphNode* glyph, const uint8_t* glyphData, uint8_t byteAlignRow, colortype color, uint8_t bitsPerPixel, uint8_t alpha, TextRotation rotation)
+    {
+        if (numberOfGlyphs == capacity)
+        {
+            overflow = true;
+            if (!drawing)
+            {
+                return;
+            }
+            finish();
+        }
+        GlyphRunCache::Glyph& cached = glyphs[numberOfGlyphs++];
+        cached.node = *glyph;
+        cached.data = glyphData;
+        cached.x = x - offsetX;
+        cached.y = y - offsetY;
+        cached.bitsPerPixel = bitsPerPixel;
+        cached.byteAlignRow = byteAlignRow;
+    }
+
+private:
+    GlyphRunCache::Glyph* glyphs;
+    uint16_t capacity;
+    uint16_t numberOfGlyphs;
+    bool overflow;
+    bool drawing;
+    Rect widgetArea;
+    Rect area;
+    colortype color;
+    uint8_t alpha;
+};
+
+void CachedTextArea::draw(const Rect& area) const
+{
+    if (typedText.hasValidId())
+    {
+        const Font* fontToDraw = typedText.getFont();
+        if (fontToDraw != 0)
+        {
+            LCD::StringVisuals visuals(fontToDraw, color, alpha, typedText.getAlignment(), linespace, rotation, typedText.getTextDirection(), indentation, wideTextAction);
+            if (glyphRunCache && drawGlyphRuns(area, visuals))
+            {
+                return;
+            }
+            HAL::lcd().drawString(getAbsoluteRect(), area, visuals, typedText.getText(), 0, 0);
+        }
+    }
+}
+
+bool CachedTextArea::drawGlyphRuns(const Rect& area, const LCD::StringVisuals& visuals) const
+{
+    // Rotated text is laid out in rotated coordinates, only unrotated text is cached
+    if (visuals.rotation != TEXT_ROTATE_0)
+    {
+        return false;
+    }
+    if (visuals.alpha == 0)
+    {
+        return true;
+    }
+
+    GlyphRunCache& cache = *glyphRunCache;
+    const Unicode::UnicodeChar* text = typedText.getText();
+    if (cache.text != text || cache.font != visuals.font || cache.width != getWidth() || cache.height != getHeight()
+            || cache.linespace != visuals.linespace || cache.alignment != visuals.alignment || cache.textDirection != visuals.textDirection
+            || cache.indentation != visuals.indentation || cache.wideTextAction != visuals.wideTextAction)
+    {
+        // Lay out the whole text, solid, so the glyphs do not depend on the invalidated area or alpha
+        GlyphRunRecorder recorder(cache.glyphs, cache.capacity);
+        layoutText(recorder, visuals);
+
+        cache.numberOfGlyphs = recorder.getNumberOfGlyphs();
+        cache.overflow = recorder.hasOverflow();
+        cache.text = text;
+        cache.font = visuals.font;
+        cache.width = getWidth();
+        cache.height = getHeight();
+        cache.linespace = visuals.linespace;
+        cache.alignment = visuals.alignment;
+        cache.textDirection = visuals.textDirection;
+        cache.indentation = visuals.indentation;
+        cache.wideTextAction = visuals.wideTextAction;
+    }
+
+    const Rect widgetArea = getAbsoluteRect();
+    if (cache.overflow)
+    {
+        // Lay out the whole text again, drawing the glyphs a buffer at a time
+        GlyphRunRecorder recorder(cache.glyphs, cache.capacity);
+        recorder.drawGlyphsInto(widgetArea, area, visuals.color, visuals.alpha);
+        layoutText(recorder, visuals);
+        recorder.finish();
+        cache.numberOfGlyphs = 0;
+        return true;
+    }
+    drawGlyphs(cache.glyphs, cache.numberOfGlyphs, widgetArea, area, visuals.color, visuals.alpha);
+    return true;
+}
+
+void CachedTextArea::layoutText(LCD& recorder, const LCD::StringVisuals& visuals) const
+{
+    LCD::StringVisuals layout(visuals);
+    layout.alpha = 255;
+    const Rect textArea(0, 0, getWidth(), getHeight());
+    recorder.drawString(textArea, textArea, layout, typedText.getText(), 0, 0);
+}
+
+void CachedTextArea::drawGlyphs(const GlyphRunCache::Glyph* glyphs, uint16_t numberOfGlyphs, const Rect& widgetArea, const Rect& area, colortype color, uint8_t alpha)
+{
+    LCD& lcd = HAL::lcd();
+    for (uint16_t i = 0; i < numberOfGlyphs; i++)
+    {
+        const GlyphRunCache::Glyph& glyph = glyphs[i];
+        const Rect glyphArea(glyph.x + glyph.node.left, glyph.y, glyph.node.width(), glyph.node.height());
+        if (!glyphArea.intersect(area))
+        {
+            continue;
+        }
+        // Clip the glyph to the invalidated area the same way LCD::drawString() does
+        const uint16_t offsetX = MAX(area.x - glyph.x, 0);
+        const uint16_t offsetY = MAX(area.y - glyph.y, 0);
+        lcd.drawGlyph(0, widgetArea, glyph.x + offsetX, glyph.y + offsetY, offsetX, offsetY, area, &glyph.node, glyph.data, glyph.byteAlignRow, color, glyph.bitsPerPixel, alpha, TEXT_ROTATE_0);
+    }
+}
+} // namespace touchgfx
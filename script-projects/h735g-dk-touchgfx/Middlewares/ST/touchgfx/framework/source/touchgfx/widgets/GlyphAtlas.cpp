@@ -0,0 +1,165 @@
+/******************************************************************************
+* Copyright (c) 2018(-2021) STMicroelectronics.
+* All rights reserved.
+*
+* This file is part of the TouchGFX 4.18.1 distribution.
+*
+* This software is licensed under terms that can be found in the LICENSE file in
+* the root directory of this software component.
+* If no LICENSE file comes with this software, it is provided AS-IS.
+*
+*******************************************************************************/
+
+#include <string.h>
+#include <touchgfx/hal/Types.hpp>
+#include <touchgfx/widgets/GlyphAtlas.hpp>
+
+namespace touchgfx
+{
+namespace
+{
+/** Reads the coverage of a glyph pixel, at the bit depth of the glyph. */
+uint8_t glyphPixel(const uint8_t* data, uint8_t bitsPerPixel, uint8_t byteAlignRow, uint16_t width, uint16_t x, uint16_t y)
+{
+    if (bitsPerPixel == 8)
+    {
+        return data[y * width + x];
+    }
+    const uint32_t nibble = byteAlignRow ? y * ((width + 1) & ~1U) + x : y * width + x;
+    return (data[nibble >> 1] >> ((nibble & 1) * 4)) & 0xF;
+}
+} // namespace
+
+bool GlyphAtlas::create(const Font* atlasFont, const char* atlasCharacters)
+{
+    destroy();
+    if (atlasFont == 0 || (atlasFont->getBitsPerPixel() != 4 && atlasFont->getBitsPerPixel() != 8))
+    {
+        return false;
+    }
+
+    // Find the glyphs and the smallest cell holding all of them
+    GlyphNode glyphs[MAX_CHARACTERS];
+    const uint8_t* glyphData[MAX_CHARACTERS];
+    const int16_t fontHeight = atlasFont->getFontHeight();
+    int16_t left = 0x7FFF;
+    int16_t right = -0x7FFF;
+    int16_t top = 0x7FFF;
+    int16_t bottom = -0x7FFF;
+    numberOfCharacters = 0;
+    for (; *atlasCharacters && numberOfCharacters < MAX_CHARACTERS; atlasCharacters++)
+    {
+        const Unicode::UnicodeChar character = (uint8_t)*atlasCharacters;
+        const uint8_t* data = 0;
+        uint8_t bitsPerPixel = 0;
+        const GlyphNode* glyph = atlasFont->getGlyph(character, data, bitsPerPixel);
+        if (glyph == 0 || indexOf(character) >= 0)
+        {
+            continue;
+        }
+        if (bitsPerPixel != atlasFont->getBitsPerPixel() || glyph->advance() > 0xFF)
+        {
+            return false;
+        }
+        characters[numberOfCharacters] = character;
+        advances[numberOfCharacters] = (uint8_t)glyph->advance();
+        glyphs[numberOfCharacters] = *glyph; // A font may reuse the GlyphNode it returns
+        glyphData[numberOfCharacters] = data;
+        numberOfCharacters++;
+        if (glyph->width() > 0 && glyph->height() > 0)
+        {
+            left = MIN(left, glyph->left);
+            right = MAX(right, glyph->left + glyph->width());
+            top = MIN(top, fontHeight - glyph->top());
+            bottom = MAX(bottom, fontHeight - glyph->top() + glyph->height());
+        }
+    }
+    if (numberOfCharacters == 0)
+    {
+        return false;
+    }
+    if (right < left)
+    {
+        // Only blank glyphs
+        left = 0;
+        right = 0;
+        top = 0;
+        bottom = 0;
+    }
+
+    // The cells are drawn in sequence without kerning, and a glyph rising above the font
+    // height makes LCD::drawString() move the line down
+    for (uint8_t i = 0; i < numberOfCharacters; i++)
+    {
+        for (uint8_t j = 0; j < numberOfCharacters; j++)
+        {
+            if (atlasFont->getKerning(characters[j], &glyphs[i]) != 0)
+            {
+                return false;
+            }
+        }
+    }
+    const int16_t cellWidth = (right - left + 1) & ~1;
+    const int16_t cellHeight = bottom - top;
+    if (top < 0 || left < -128 || cellWidth > 0xFF || cellHeight > 0xFF)
+    {
+        return false;
+    }
+
+    cell._width = (uint8_t)cellWidth;
+    cell._height = (uint8_t)cellHeight;
+    cell.left = (int8_t)left;
+    cellTop = top;
+    font = atlasFont;
+    if (cellWidth > 0 && cellHeight > 0)
+    {
+        // There is no A8 bitmap format, 8 bit coverage is kept in a format with one byte per
+        // pixel and no palette, the atlas is never drawn as a bitmap
+        bitmapId = Bitmap::dynamicBitmapCreate(cellWidth, cellHeight * numberOfCharacters, font->getBitsPerPixel() == 4 ? Bitmap::A4 : Bitmap::ARGB2222);
+    }
+    if (bitmapId == BITMAP_INVALID)
+    {
+        font = 0;
+        return false;
+    }
+
+    uint8_t* const pixels = Bitmap::dynamicBitmapGetAddress(bitmapId);
+    const uint16_t stride = getCellStride();
+    memset(pixels, 0, stride * cellHeight * numberOfCharacters);
+    for (uint8_t i = 0; i < numberOfCharacters; i++)
+    {
+        const GlyphNode* glyph = &glyphs[i];
+        const int16_t x0 = glyph->left - left;
+        const int16_t y0 = fontHeight - glyph->top() - top;
+        uint8_t* const cellPixels = pixels + i * cellHeight * stride;
+        for (uint16_t y = 0; y < glyph->height(); y++)
+        {
+            uint8_t* const row = cellPixels + (y0 + y) * stride;
+            for (uint16_t x = 0; x < glyph->width(); x++)
+            {
+                const uint8_t coverage = glyphPixel(glyphData[i], font->getBitsPerPixel(), font->getByteAlignRow(), glyph->width(), x, y);
+                if (font->getBitsPerPixel() == 8)
+                {
+                    row[x0 + x] = coverage;
+                }
+                else
+                {
+                    row[(x0 + x) >> 1] |= coverage << (((x0 + x) & 1) * 4);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void GlyphAtlas::destroy()
+{
+    if (bitmapId != BITMAP_INVALID)
+    {
+        Bitmap::dynamicBitmapDelete(bitmapId);
+        bitmapId = BITMAP_INVALID;
+    }
+    font = 0;
+    numberOfCharacters = 0;
+}
+} // namespace touchgfx
@@ -12,6 +12,7 @@
 
 #include <touchgfx/hal/Types.hpp>
 #include <touchgfx/Bitmap.hpp>
+#include <touchgfx/BitmapCache.hpp>
 #include <touchgfx/Drawable.hpp>
 #include <touchgfx/hal/HAL.hpp>
 #include <touchgfx/lcd/LCD.hpp>
@@ -36,6 +37,7 @@ void Image::draw(const Rect& invalidatedArea) const
 
     if (!dirtyBitmapArea.isEmpty())
     {
+        BitmapCache::use(bitmap.getId());
         HAL::lcd().drawPartialBitmap(bitmap, meAbs.x, meAbs.y, dirtyBitmapArea, alpha);
     }
 }
@@ -0,0 +1,211 @@
+/******************************************************************************
+* Copyright (c) 2018(-2021) STMicroelectronics.
+* All rights reserved.
+*
+* This file is part of the TouchGFX 4.18.1 distribution.
+*
+* This software is licensed under terms that can be found in the LICENSE file in
+* the root directory of this software component.
+* If no LICENSE file comes with this software, it is provided AS-IS.
+*
+*******************************************************************************/
+
+#include <touchgfx/hal/HAL.hpp>
+#include <touchgfx/hal/Types.hpp>
+#include <touchgfx/lcd/LCD.hpp>
+#include <touchgfx/widgets/NumericTextArea.hpp>
+
+namespace touchgfx
+{
+namespace
+{
+/** Invalidates a run of changed cells inside the widget, and empties the run. */
+void invalidateRun(const Drawable& widget, Rect& run)
+{
+    run &= Rect(0, 0, widget.getWidth(), widget.getHeight());
+    if (!run.isEmpty())
+    {
+        widget.invalidateRect(run);
+    }
+    run = Rect();
+}
+
+/** Adds a changed cell to a run of adjacent cells, invalidating the run when a gap is reached. */
+void addChangedCell(const Drawable& widget, Rect& run, const Rect& cell)
+{
+    if (!run.isEmpty() && cell.x > run.right())
+    {
+        invalidateRun(widget, run);
+    }
+    run.expandToFit(cell);
+}
+} // namespace
+
+void NumericTextArea::draw(const Rect& area) const
+{
+    const Unicode::UnicodeChar* text = getWildcard();
+    if (!canDrawFromAtlas(text))
+    {
+        TextAreaWithOneWildcard::draw(area);
+        return;
+    }
+    if (alpha == 0)
+    {
+        return;
+    }
+
+    const colortype textColor = color;
+    const uint8_t bitsPerPixel = glyphAtlas->getBitsPerPixel();
+    const BlitOperations operation = bitsPerPixel == 4 ? BLIT_OP_COPY_A4 : BLIT_OP_COPY_A8;
+    const bool useDMA = HAL::DISPLAY_ROTATION == rotate0 && (HAL::getInstance()->getBlitCaps() & operation) != 0;
+    const Rect widgetArea = getAbsoluteRect();
+    int16_t pen = getFirstPen(text);
+    for (; *text != 0; text++)
+    {
+        const int16_t index = glyphAtlas->indexOf(*text);
+        const Rect cellArea = getCellRect(pen);
+        const Rect part = cellArea & area;
+        if (!part.isEmpty())
+        {
+            const uint8_t* cellData = glyphAtlas->getCellData(index);
+            const int16_t column = part.x - cellArea.x;
+            // A4 data can only be copied from the start of a byte, and whole bytes per row
+            if (useDMA && (bitsPerPixel == 8 || ((column | part.width) & 1) == 0))
+            {
+                const uint8_t* src = cellData + (part.y - cellArea.y) * glyphAtlas->getCellStride() + column * bitsPerPixel / 8;
+                HAL::getInstance()->blitCopyGlyph(src, widgetArea.x + part.x, widgetArea.y + part.y, part.width, part.height, glyphAtlas->getCellWidth(), textColor, alpha, operation, false);
+            }
+            else
+            {
+                // Clip the cell to the invalidated area the same way LCD::drawString() does
+                const uint16_t offsetX = MAX(area.x - pen, 0);
+                const uint16_t offsetY = MAX(area.y - cellArea.y, 0);
+                HAL::lcd().drawGlyph(0, widgetArea, pen + offsetX, cellArea.y + offsetY, offsetX, offsetY, area, glyphAtlas->getCellGlyph(), cellData, 1, textColor, bitsPerPixel, alpha, TEXT_ROTATE_0);
+            }
+        }
+        pen += glyphAtlas->getAdvance(index);
+    }
+}
+
+void NumericTextArea::setValue(int32_t newValue, uint8_t newDecimals)
+{
+    Unicode::UnicodeChar previous[MAX_CHARACTERS + 1];
+    const bool wasDrawnFromAtlas = canDrawFromAtlas(getWildcard());
+    if (wasDrawnFromAtlas)
+    {
+        Unicode::strncpy(previous, getWildcard(), MAX_CHARACTERS + 1);
+    }
+
+    value = newValue;
+    decimals = MIN(newDecimals, 9);
+
+    // Digits in reverse order, with at least one digit before the decimal point
+    Unicode::UnicodeChar digits[MAX_CHARACTERS];
+    uint8_t numberOfDigits = 0;
+    uint32_t magnitude = newValue < 0 ? 0U - (uint32_t)newValue : (uint32_t)newValue;
+    do
+    {
+        digits[numberOfDigits++] = (Unicode::UnicodeChar)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0 || numberOfDigits <= decimals);
+
+    uint8_t length = 0;
+    if (newValue < 0)
+    {
+        buffer[length++] = '-';
+    }
+    while (numberOfDigits > 0)
+    {
+        if (numberOfDigits == decimals)
+        {
+            buffer[length++] = '.';
+        }
+        buffer[length++] = digits[--numberOfDigits];
+    }
+    buffer[length] = 0;
+    setWildcard(buffer);
+
+    if (wasDrawnFromAtlas && canDrawFromAtlas(buffer))
+    {
+        invalidateChangedCharacters(previous);
+    }
+    else
+    {
+        invalidate();
+    }
+}
+
+bool NumericTextArea::canDrawFromAtlas(const Unicode::UnicodeChar* text) const
+{
+    if (glyphAtlas == 0 || !glyphAtlas->isValid() || text == 0 || !typedText.hasValidId())
+    {
+        return false;
+    }
+    const Unicode::UnicodeChar* format = typedText.getText();
+    if (format == 0 || format[0] != 0x02 || format[1] != 0 || typedText.getFont() != glyphAtlas->getFont()
+            || rotation != TEXT_ROTATE_0 || typedText.getTextDirection() != TEXT_DIRECTION_LTR || wideTextAction != WIDE_TEXT_NONE)
+    {
+        return false;
+    }
+    for (; *text != 0; text++)
+    {
+        if (glyphAtlas->indexOf(*text) < 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+int16_t NumericTextArea::getFirstPen(const Unicode::UnicodeChar* text) const
+{
+    const Alignment alignment = typedText.getAlignment();
+    if (alignment == LEFT)
+    {
+        return indentation;
+    }
+    int16_t textWidth = 0;
+    for (; *text != 0; text++)
+    {
+        textWidth += glyphAtlas->getAdvance(glyphAtlas->indexOf(*text));
+    }
+    if (alignment == CENTER)
+    {
+        return (getWidth() - textWidth) / 2;
+    }
+    return getWidth() - indentation - textWidth;
+}
+
+void NumericTextArea::invalidateChangedCharacters(const Unicode::UnicodeChar* previous) const
+{
+    // Walk both texts from left to right, a character is unchanged if the other text has the
+    // same character at the same pen position
+    const Unicode::UnicodeChar* current = getWildcard();
+    int16_t previousPen = getFirstPen(previous);
+    int16_t currentPen = getFirstPen(current);
+    Rect run;
+    while (*previous != 0 || *current != 0)
+    {
+        if (*current != 0 && (*previous == 0 || currentPen < previousPen))
+        {
+            addChangedCell(*this, run, getCellRect(currentPen));
+            currentPen += glyphAtlas->getAdvance(glyphAtlas->indexOf(*current++));
+        }
+        else if (*previous != 0 && (*current == 0 || previousPen < currentPen))
+        {
+            addChangedCell(*this, run, getCellRect(previousPen));
+            previousPen += glyphAtlas->getAdvance(glyphAtlas->indexOf(*previous++));
+        }
+        else
+        {
+            if (*previous != *current)
+            {
+                addChangedCell(*this, run, getCellRect(currentPen));
+            }
+            previousPen += glyphAtlas->getAdvance(glyphAtlas->indexOf(*previous++));
+            currentPen += glyphAtlas->getAdvance(glyphAtlas->indexOf(*current++));
+        }
+    }
+    invalidateRun(*this, run);
+}
+} // namespace touchgfx
@@ -11,6 +11,7 @@
 *******************************************************************************/
 
 #include <touchgfx/Bitmap.hpp>
+#include <touchgfx/BitmapCache.hpp>
 #include <touchgfx/Drawable.hpp>
 #include <touchgfx/events/ClickEvent.hpp>
 #include <touchgfx/hal/HAL.hpp>
@@ -32,6 +33,7 @@ void RadioButton::draw(const Rect& invalidatedArea) const
 
         if (!dirtyBitmapArea.isEmpty())
         {
+            BitmapCache::use(bitmap.getId());
             HAL::lcd().drawPartialBitmap(bitmap, meAbs.x, meAbs.y, dirtyBitmapArea, alpha);
         }
     }
@@ -12,6 +12,7 @@
 
 #include <touchgfx/hal/Types.hpp>
 #include <touchgfx/Bitmap.hpp>
+#include <touchgfx/BitmapCache.hpp>
 #include <touchgfx/Drawable.hpp>
 #include <touchgfx/Utils.hpp>
 #include <touchgfx/hal/HAL.hpp>
@@ -113,6 +114,7 @@ void ScalableImage::draw(const Rect& invalidatedArea) const
     {
         return;
     }
+    BitmapCache::use(bitmap.getId());
     uint16_t* fb = 0;
 
     float triangleXs[4];
@@ -13,6 +13,7 @@
 #include <math.h>
 #include <touchgfx/hal/Types.hpp>
 #include <touchgfx/Bitmap.hpp>
+#include <touchgfx/BitmapCache.hpp>
 #include <touchgfx/Drawable.hpp>
 #include <touchgfx/Math3D.hpp>
 #include <touchgfx/TextureMapTypes.hpp>
@@ -199,6 +200,7 @@ void TextureMapper::draw(const Rect& invalidatedArea) const
     {
         return;
     }
+    BitmapCache::use(bitmap.getId());
     uint16_t* fb = 0;
 
     // Setup texture coordinates
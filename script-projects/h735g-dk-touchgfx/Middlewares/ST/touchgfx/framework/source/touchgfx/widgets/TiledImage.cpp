@@ -12,6 +12,7 @@
 
 #include <touchgfx/hal/Types.hpp>
 #include <touchgfx/Bitmap.hpp>
+#include <touchgfx/BitmapCache.hpp>
 #include <touchgfx/Drawable.hpp>
 #include <touchgfx/hal/HAL.hpp>
 #include <touchgfx/lcd/LCD.hpp>
@@ -79,6 +80,7 @@ void TiledImage::draw(const Rect& invalidatedArea) const
 
     Rect meAbs;
     translateRectToAbsolute(meAbs);
+    BitmapCache::use(bitmap.getId());
 
     const int16_t minX = ((invalidatedArea.x + xOffset) / bitmapWidth) * bitmapWidth - xOffset;
     const int16_t maxX = (((invalidatedArea.right() + xOffset) - 1) / bitmapWidth) * bitmapWidth;
@@ -229,6 +229,7 @@ bool Canvas::render(uint8_t customAlpha)
     }
 
     close();
+    registerOutline();
 
     widget->getPainter().setAreaOffset(offsetX /*+widget->getX()*/, offsetY /*+widget->getY()*/);
     widget->getPainter().setWidgetAlpha(alpha);
@@ -236,6 +237,28 @@ bool Canvas::render(uint8_t customAlpha)
     return ras.render(renderer);
 }
 
+void Canvas::registerOutline()
+{
+    // Sorting the cells closes the outline, which may add a cell
+    const Cell* cells = ras.getCells();
+    const unsigned numCells = ras.getNumCells();
+    unsigned maxCellsPerLine = 0;
+    if (CanvasWidgetRenderer::isMemoryReportEnabled())
+    {
+        // Only the memory report needs the cells of the longest line
+        unsigned lineStart = 0;
+        for (unsigned i = 1; i <= numCells; i++)
+        {
+            if (i == numCells || cells[i].y != cells[lineStart].y)
+            {
+                maxCellsPerLine = MAX(maxCellsPerLine, i - lineStart);
+                lineStart = i;
+            }
+        }
+    }
+    CanvasWidgetRenderer::registerOutline(CanvasWidgetRenderer::getScanlineWidth(), numCells, maxCellsPerLine);
+}
+
 uint8_t Canvas::isOutside(const CWRUtil::Q5& x, const CWRUtil::Q5& y, const CWRUtil::Q5& width, const CWRUtil::Q5& height) const
 {
     uint8_t outside = 0;
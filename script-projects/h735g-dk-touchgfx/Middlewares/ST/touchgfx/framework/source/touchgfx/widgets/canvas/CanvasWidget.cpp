@@ -20,10 +20,16 @@
 
 namespace touchgfx
 {
+namespace
+{
+// Cells an outline may need besides the predicted cells, e.g. when it is closed
+const unsigned SPARE_CELLS = 1;
+} // namespace
+
 CanvasWidget::CanvasWidget()
     : Widget(),
       canvasPainter(0),
-      maxRenderLines(0x7FFF),
+      cellsPerLine(0),
       alpha(255)
 {
 }
@@ -41,88 +47,126 @@ AbstractPainter& CanvasWidget::getPainter() const
 
 void CanvasWidget::draw(const Rect& invalidatedArea) const
 {
-    Rect area = invalidatedArea;
+    const Rect area = invalidatedArea & getMinimalRect();
+    if (area.isEmpty())
+    {
+        return;
+    }
 
-    int16_t* offset;
-    int16_t* lines;
-    int16_t* width;
-    int16_t* height;
+    // Scanlines run along the framebuffer, which is rotated compared to the display for rotate90
+    const bool rotated = HAL::DISPLAY_ROTATION == rotate90;
+    const int16_t length = rotated ? area.height : area.width;
 
-    int16_t wantedRenderLines;
+    // If the scanline buffers for the entire width do not fit, draw the area in columns
+    int16_t columnLength = length;
+    while (columnLength > 1 && CanvasWidgetRenderer::getCellCapacity(columnLength) <= SPARE_CELLS)
+    {
+        columnLength = (columnLength + 1) / 2;
+    }
 
-    switch (HAL::DISPLAY_ROTATION)
+    for (int16_t column = 0; column < length; column += columnLength)
     {
-    default:
-    case rotate0:
-        offset = &area.y;
-        lines = &area.height;
-        width = &area.width;
-        height = &wantedRenderLines;
-        break;
-    case rotate90:
-        offset = &area.x;
-        lines = &area.width;
-        width = &wantedRenderLines;
-        height = &area.height;
-        break;
+        const int16_t columnWidth = MIN(columnLength, length - column);
+        drawBands(rotated ? Rect(area.x, area.y + column, area.width, columnWidth)
+                          : Rect(area.x + column, area.y, columnWidth, area.height));
     }
+}
 
-    Rect minimalRect = getMinimalRect();
+void CanvasWidget::drawBands(const Rect& area) const
+{
+    const bool rotated = HAL::DISPLAY_ROTATION == rotate90;
+    const int16_t length = rotated ? area.height : area.width;
+    const int16_t lines = rotated ? area.width : area.height;
+    const unsigned capacity = CanvasWidgetRenderer::getCellCapacity(length);
 
-    bool failedAtLeastOnce = false;
-    while (*lines)
+    int16_t line = 0;
+    while (line < lines)
     {
-        wantedRenderLines = MIN(maxRenderLines, *lines);
-
-        while (wantedRenderLines > 0)
+        int16_t bandLines = MIN(predictRenderLines(capacity), lines - line);
+        while (bandLines > 0)
         {
-            Rect smallArea(area.x, area.y, *width, *height);
-            if (!smallArea.intersect(minimalRect))
+            const Rect band = rotated ? Rect(area.x + line, area.y, bandLines, area.height)
+                                      : Rect(area.x, area.y + line, area.width, bandLines);
+            const unsigned outlines = CanvasWidgetRenderer::getMemoryReport().outlines;
+            if (drawCanvasWidget(band))
             {
+                if (CanvasWidgetRenderer::getMemoryReport().outlines != outlines)
+                {
+                    // Predict the next draw from the density of this outline
+                    const unsigned cells = CanvasWidgetRenderer::getLastOutlineCells();
+                    cellsPerLine = (uint16_t)MIN((cells + bandLines - 1) / bandLines + 1, 0xFFFFU);
+                }
                 break;
             }
-            if (drawCanvasWidget(smallArea))
+
+            // The outline was denser than predicted
+            CanvasWidgetRenderer::registerRetry();
+            cellsPerLine = (uint16_t)MAX((unsigned)cellsPerLine, MIN(capacity / bandLines + 1, 0xFFFFU));
+            if (bandLines == 1)
             {
+                drawSplitLine(band);
                 break;
             }
 #ifdef SIMULATOR
             if (CanvasWidgetRenderer::getWriteMemoryUsageReport())
             {
-                if (wantedRenderLines > 1)
-                {
-                    touchgfx_printf("CWR will split draw into multiple draws due to limited memory.\n");
-                }
-                else
-                {
-                    touchgfx_printf("CWR was unable to complete a draw operation due to limited memory.\n");
-                }
+                touchgfx_printf("CWR will split draw into multiple draws due to limited memory.\n");
             }
 #endif
-            wantedRenderLines >>= 1;
-            failedAtLeastOnce = true;
+            bandLines >>= 1;
         }
-        if (wantedRenderLines == 0)
+        line += bandLines;
+    }
+}
+
+void CanvasWidget::drawSplitLine(const Rect& line) const
+{
+    const bool rotated = HAL::DISPLAY_ROTATION == rotate90;
+    const int16_t length = rotated ? line.height : line.width;
+    if (length <= 1)
+    {
+        CanvasWidgetRenderer::registerSkippedLine();
+#ifdef SIMULATOR
+        if (CanvasWidgetRenderer::getWriteMemoryUsageReport())
         {
-            // We did not manage to draw anything. Set wantedHeight to
-            // one to skip a single raster line and try to render the
-            // rest of the CanvasWidget.
-            wantedRenderLines = 1;
+            touchgfx_printf("CWR was unable to complete a draw operation due to limited memory.\n");
         }
-        else
+#endif
+        return;
+    }
+
+    // Draw each half of the scanline on its own, splitting again if needed
+    const int16_t half = length / 2;
+    const Rect parts[2] = { rotated ? Rect(line.x, line.y, line.width, half) : Rect(line.x, line.y, half, line.height),
+                            rotated ? Rect(line.x, line.y + half, line.width, length - half) : Rect(line.x + half, line.y, length - half, line.height) };
+    for (int i = 0; i < 2; i++)
+    {
+        if (!drawCanvasWidget(parts[i]))
         {
-            if (failedAtLeastOnce && maxRenderLines == 0x7FFF)
-            {
-                // Only adjust maxRenderLines if it is the first draw for the CanvasWidget
-                maxRenderLines = wantedRenderLines;
-            }
+            CanvasWidgetRenderer::registerRetry();
+            drawSplitLine(parts[i]);
         }
-        *offset += wantedRenderLines;
-        *lines -= wantedRenderLines;
     }
-    if (maxRenderLines == 0x7FFF)
+}
+
+int16_t CanvasWidget::predictRenderLines(unsigned capacity) const
+{
+    unsigned density = cellsPerLine;
+    if (density == 0)
+    {
+        // First draw. Every scanline of a closed outline crosses at least two edges, and
+        // the edges cover the width of the shape twice over its height
+        const Rect shape = getMinimalRect();
+        const bool rotated = HAL::DISPLAY_ROTATION == rotate90;
+        const unsigned width = MAX(rotated ? shape.height : shape.width, 1);
+        const unsigned height = MAX(rotated ? shape.width : shape.height, 1);
+        density = 2 + (2 * width + height - 1) / height;
+    }
+    if (capacity <= SPARE_CELLS + density)
     {
-        maxRenderLines--; // 0x7FFF means first draw
+        return 1;
     }
+    return (int16_t)MIN((capacity - SPARE_CELLS) / density, 0x7FFFU);
 }
 
 void CanvasWidget::invalidate() const
@@ -144,6 +188,6 @@ Rect CanvasWidget::getSolidRect() const
 
 void CanvasWidget::resetMaxRenderLines()
 {
-    maxRenderLines = 0x7FFF;
+    cellsPerLine = 0;
 }
 } // namespace touchgfx
@@ -16,6 +16,7 @@
 #include <touchgfx/lcd/LCD.hpp>
 #include <touchgfx/transforms/DisplayTransformation.hpp>
 #include <touchgfx/widgets/canvas/PainterRGB888Bitmap.hpp>
+#include <string.h>
 
 namespace touchgfx
 {
@@ -77,31 +78,32 @@ void PainterRGB888Bitmap::render(uint8_t* ptr, int x, int xAdjust, int y, unsign
         {
             do
             {
-                const unsigned length = MIN(available, count);
-                const uint8_t* const p_chunkend = p + length * 3;
+                unsigned length = MIN(available, count);
                 count -= length;
                 do
                 {
-                    // Use alpha from covers directly
-                    const uint8_t alpha = *covers++;
-                    if (alpha == 0xFF)
+                    // Copy runs of solid pixels in one go, blend the rest
+                    const unsigned solid = solidSpanLength(covers, length);
+                    if (solid)
                     {
-                        // Solid pixel
-                        *p++ = *bitmapRGB888Pointer++;
-                        *p++ = *bitmapRGB888Pointer++;
-                        *p++ = *bitmapRGB888Pointer++;
+                        memcpy(p, bitmapRGB888Pointer, solid * 3);
+                        p += solid * 3;
+                        bitmapRGB888Pointer += solid * 3;
+                        covers += solid;
+                        length -= solid;
                     }
                     else
                     {
-                        const uint8_t ialpha = 0xFF - alpha;
-                        *p = LCD::div255(*bitmapRGB888Pointer++ * alpha + *p * ialpha);
-                        p++;
-                        *p = LCD::div255(*bitmapRGB888Pointer++ * alpha + *p * ialpha);
-                        p++;
-                        *p = LCD::div255(*bitmapRGB888Pointer++ * alpha + *p * ialpha);
-                        p++;
+                        const uint8_t alpha = *covers++;
+                        if (alpha)
+                        {
+                            blendPixel(p, bitmapRGB888Pointer[0] | (bitmapRGB888Pointer[1] << 8) | (bitmapRGB888Pointer[2] << 16), alpha);
+                        }
+                        p += 3;
+                        bitmapRGB888Pointer += 3;
+                        length--;
                     }
-                } while (p < p_chunkend);
+                } while (length);
                 bitmapRGB888Pointer = rgb888_linestart;
                 available = bitmapRectToFrameBuffer.width;
             } while (p < p_lineend);
@@ -116,13 +118,12 @@ void PainterRGB888Bitmap::render(uint8_t* ptr, int x, int xAdjust, int y, unsign
                 do
                 {
                     const uint8_t alpha = LCD::div255((*covers++) * widgetAlpha);
-                    const uint8_t ialpha = 0xFF - alpha;
-                    *p = LCD::div255(*bitmapRGB888Pointer++ * alpha + *p * ialpha);
-                    p++;
-                    *p = LCD::div255(*bitmapRGB888Pointer++ * alpha + *p * ialpha);
-                    p++;
-                    *p = LCD::div255(*bitmapRGB888Pointer++ * alpha + *p * ialpha);
-                    p++;
+                    if (alpha)
+                    {
+                        blendPixel(p, bitmapRGB888Pointer[0] | (bitmapRGB888Pointer[1] << 8) | (bitmapRGB888Pointer[2] << 16), alpha);
+                    }
+                    p += 3;
+                    bitmapRGB888Pointer += 3;
                 } while (p < p_chunkend);
                 bitmapRGB888Pointer = rgb888_linestart;
                 available = bitmapRectToFrameBuffer.width;
@@ -141,30 +142,21 @@ void PainterRGB888Bitmap::render(uint8_t* ptr, int x, int xAdjust, int y, unsign
                 count -= length;
                 do
                 {
-                    const uint8_t srcAlpha = (*bitmapARGB8888Pointer) >> 24;
-                    const uint8_t alpha = LCD::div255((*covers++) * srcAlpha);
+                    const uint32_t argb8888 = *bitmapARGB8888Pointer++;
+                    const uint8_t alpha = LCD::div255((*covers++) * (argb8888 >> 24));
                     if (alpha == 0xFF)
                     {
                         // Solid pixel
-                        *p++ = (*bitmapARGB8888Pointer);       // Blue
-                        *p++ = (*bitmapARGB8888Pointer) >> 8;  // Green
-                        *p++ = (*bitmapARGB8888Pointer) >> 16; // Red
+                        p[0] = argb8888;       // Blue
+                        p[1] = argb8888 >> 8;  // Green
+                        p[2] = argb8888 >> 16; // Red
                     }
-                    else
+                    else if (alpha)
                     {
                         // Non-Transparent pixel
-                        const uint8_t ialpha = 0xFF - alpha;
-                        uint8_t cByte = (*bitmapARGB8888Pointer);
-                        *p = LCD::div255(cByte * alpha + *p * ialpha);
-                        p++;
-                        cByte = (*bitmapARGB8888Pointer) >> 8;
-                        *p = LCD::div255(cByte * alpha + *p * ialpha);
-                        p++;
-                        cByte = (*bitmapARGB8888Pointer) >> 16;
-                        *p = LCD::div255(cByte * alpha + *p * ialpha);
-                        p++;
+                        blendPixel(p, argb8888, alpha);
                     }
-                    bitmapARGB8888Pointer++;
+                    p += 3;
                 } while (p < p_chunkend);
                 bitmapARGB8888Pointer = argb8888_linestart;
                 available = bitmapRectToFrameBuffer.width;
@@ -179,26 +171,13 @@ void PainterRGB888Bitmap::render(uint8_t* ptr, int x, int xAdjust, int y, unsign
                 count -= length;
                 do
                 {
-                    const uint8_t srcAlpha = (*bitmapARGB8888Pointer) >> 24;
-                    const uint8_t alpha = LCD::div255((*covers++) * LCD::div255(srcAlpha * widgetAlpha));
+                    const uint32_t argb8888 = *bitmapARGB8888Pointer++;
+                    const uint8_t alpha = LCD::div255((*covers++) * LCD::div255((argb8888 >> 24) * widgetAlpha));
                     if (alpha)
                     {
-                        const uint8_t ialpha = 0xFF - alpha;
-                        uint8_t cByte = (*bitmapARGB8888Pointer);
-                        *p = LCD::div255(cByte * alpha + *p * ialpha);
-                        p++;
-                        cByte = (*bitmapARGB8888Pointer) >> 8;
-                        *p = LCD::div255(cByte * alpha + *p * ialpha);
-                        p++;
-                        cByte = (*bitmapARGB8888Pointer) >> 16;
-                        *p = LCD::div255(cByte * alpha + *p * ialpha);
-                        p++;
-                    }
-                    else
-                    {
-                        p += 3;
+                        blendPixel(p, argb8888, alpha);
                     }
-                    bitmapARGB8888Pointer++;
+                    p += 3;
                 } while (p < p_chunkend);
                 bitmapARGB8888Pointer = argb8888_linestart;
                 available = bitmapRectToFrameBuffer.width;
@@ -93,13 +93,11 @@ void PainterRGB888L8Bitmap::render(uint8_t* ptr, int x, int xAdjust, int y, unsi
                     }
                     else
                     {
-                        const uint8_t ialpha = 0xFF - alpha;
-                        *p = LCD::div255(*src++ * alpha + *p * ialpha);
-                        p++;
-                        *p = LCD::div255(*src++ * alpha + *p * ialpha);
-                        p++;
-                        *p = LCD::div255(*src * alpha + *p * ialpha);
-                        p++;
+                        if (alpha)
+                        {
+                            blendPixel(p, src[0] | (src[1] << 8) | (src[2] << 16), alpha);
+                        }
+                        p += 3;
                     }
                 } while (p < p_chunkend);
                 bitmapPointer = l8_linestart;
@@ -117,13 +115,11 @@ void PainterRGB888L8Bitmap::render(uint8_t* ptr, int x, int xAdjust, int y, unsi
                 {
                     const uint8_t* src = &bitmapExtraPointer[*bitmapPointer++ * 3];
                     const uint8_t alpha = LCD::div255((*covers++) * widgetAlpha);
-                    const uint8_t ialpha = 0xFF - alpha;
-                    *p = LCD::div255(*src++ * alpha + *p * ialpha);
-                    p++;
-                    *p = LCD::div255(*src++ * alpha + *p * ialpha);
-                    p++;
-                    *p = LCD::div255(*src * alpha + *p * ialpha);
-                    p++;
+                    if (alpha)
+                    {
+                        blendPixel(p, src[0] | (src[1] << 8) | (src[2] << 16), alpha);
+                    }
+                    p += 3;
                 } while (p < p_chunkend);
                 bitmapPointer = l8_linestart;
                 available = bitmapRectToFrameBuffer.width;
@@ -153,14 +149,12 @@ void PainterRGB888L8Bitmap::render(uint8_t* ptr, int x, int xAdjust, int y, unsi
                     }
                     else
                     {
-                        // Non-Transparent pixel
-                        const uint8_t ialpha = 0xFF - alpha;
-                        *p = LCD::div255((src & 0xFF) * alpha + *p * ialpha);
-                        p++;
-                        *p = LCD::div255(((src >> 8) & 0xFF) * alpha + *p * ialpha);
-                        p++;
-                        *p = LCD::div255(((src >> 16) & 0xFF) * alpha + *p * ialpha);
-                        p++;
+                        if (alpha)
+                        {
+                            // Non-Transparent pixel
+                            blendPixel(p, src, alpha);
+                        }
+                        p += 3;
                     }
                 } while (p < p_chunkend);
                 bitmapPointer = l8_linestart;
@@ -181,18 +175,9 @@ void PainterRGB888L8Bitmap::render(uint8_t* ptr, int x, int xAdjust, int y, unsi
                     const uint8_t alpha = LCD::div255((*covers++) * LCD::div255(srcAlpha * widgetAlpha));
                     if (alpha)
                     {
-                        const uint8_t ialpha = 0xFF - alpha;
-                        *p = LCD::div255((src & 0xFF) * alpha + *p * ialpha);
-                        p++;
-                        *p = LCD::div255(((src >> 8) & 0xFF) * alpha + *p * ialpha);
-                        p++;
-                        *p = LCD::div255(((src >> 16) & 0xFF) * alpha + *p * ialpha);
-                        p++;
-                    }
-                    else
-                    {
-                        p += 3;
+                        blendPixel(p, src, alpha);
                     }
+                    p += 3;
                 } while (p < p_chunkend);
                 bitmapPointer = l8_linestart;
                 available = bitmapRectToFrameBuffer.width;
@@ -0,0 +1,83 @@
+#include <BenchmarkHAL.hpp>
+#include <touchgfx/lcd/LCD.hpp>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace touchgfx
+{
+// Normally provided by the SDL2 HAL, used by touchgfx_printf()
+void simulator_printf(const char* format, va_list pArg)
+{
+    vfprintf(stderr, format, pArg);
+}
+
+BenchmarkHAL::BenchmarkHAL(DMA_Interface& dma, LCD& display, TouchController& tc, uint16_t width, uint16_t height)
+    : HAL(dma, display, tc, width, height),
+      frameBuffer(0),
+      doubleBuffer(0),
+      frameBufferSize(0),
+      tftFrameBuffer(0)
+{
+    frameBufferSize = (uint32_t)width * height * display.bitDepth() / 8;
+    frameBuffer = new uint8_t[frameBufferSize];
+    clearFrameBuffer();
+    setFrameBufferStartAddresses(frameBuffer, 0, 0);
+}
+
+BenchmarkHAL::~BenchmarkHAL()
+{
+    delete[] frameBuffer;
+    delete[] doubleBuffer;
+}
+
+void BenchmarkHAL::clearFrameBuffer()
+{
+    // A non-uniform background makes sure blending actually reads the destination
+    for (uint32_t i = 0; i < frameBufferSize; i++)
+    {
+        frameBuffer[i] = (uint8_t)(i * 7 + (i >> 8));
+    }
+}
+
+uint32_t BenchmarkHAL::hashFrameBuffer() const
+{
+    uint32_t hash = 2166136261u;
+    for (uint32_t i = 0; i < frameBufferSize; i++)
+    {
+        hash ^= frameBuffer[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void BenchmarkHAL::enableDoubleBuffering()
+{
+    if (!doubleBuffer)
+    {
+        doubleBuffer = new uint8_t[frameBufferSize];
+    }
+    clearFrameBuffer();
+    memcpy(doubleBuffer, frameBuffer, frameBufferSize);
+    setFrameBufferStartAddresses(frameBuffer, doubleBuffer, 0);
+    setTFTFrameBuffer(reinterpret_cast<uint16_t*>(frameBuffer));
+}
+
+void BenchmarkHAL::disableDoubleBuffering()
+{
+    setFrameBufferStartAddresses(frameBuffer, 0, 0);
+    setTFTFrameBuffer(reinterpret_cast<uint16_t*>(frameBuffer));
+}
+
+uint32_t BenchmarkHAL::hashTFTFrameBuffer() const
+{
+    const uint8_t* const shown = reinterpret_cast<const uint8_t*>(getTFTFrameBuffer());
+    uint32_t hash = 2166136261u;
+    for (uint32_t i = 0; i < frameBufferSize; i++)
+    {
+        hash ^= shown[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+} // namespace touchgfx
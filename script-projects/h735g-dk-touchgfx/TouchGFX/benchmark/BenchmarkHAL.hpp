@@ -0,0 +1,134 @@
+#ifndef BENCHMARKHAL_HPP
+#define BENCHMARKHAL_HPP
+
+#include <touchgfx/hal/HAL.hpp>
+#include <platform/hal/simulator/sdl2/TileRenderer.hpp>
+
+namespace touchgfx
+{
+/**
+ * Headless HAL used by the render benchmark.
+ *
+ * The HAL owns a single off-screen framebuffer, or two with double buffering,
+ * and has no display, vsync or event loop attached. Widgets are drawn directly by the benchmark runner.
+ */
+class BenchmarkHAL : public HAL
+{
+public:
+    /**
+     * Initializes a new instance of the BenchmarkHAL class.
+     *
+     * @param [in] dma     Reference to the DMA interface.
+     * @param [in] display Reference to the LCD.
+     * @param [in] tc      Reference to the touch controller.
+     * @param      width   The width of the framebuffer.
+     * @param      height  The height of the framebuffer.
+     */
+    BenchmarkHAL(DMA_Interface& dma, LCD& display, TouchController& tc, uint16_t width, uint16_t height);
+
+    virtual ~BenchmarkHAL();
+
+    /**
+     * Gets the framebuffer the benchmark renders into.
+     *
+     * @return The framebuffer.
+     */
+    uint8_t* getFrameBuffer() const
+    {
+        return frameBuffer;
+    }
+
+    /**
+     * Gets the size of the framebuffer in bytes.
+     *
+     * @return The framebuffer size.
+     */
+    uint32_t getFrameBufferSize() const
+    {
+        return frameBufferSize;
+    }
+
+    /** Fills the framebuffer with a fixed pattern so every run starts from the same content. */
+    void clearFrameBuffer();
+
+    /**
+     * Calculates a 32 bit FNV-1a hash of the framebuffer content.
+     *
+     * @return The hash value.
+     */
+    uint32_t hashFrameBuffer() const;
+
+    /**
+     * Adds a second framebuffer, like double buffering on the target. Both framebuffers are
+     * filled with the pattern of clearFrameBuffer(), the first is shown and the framework
+     * draws into the other until showClientFrameBuffer() is called.
+     */
+    void enableDoubleBuffering();
+
+    /** Goes back to drawing directly into the single framebuffer. */
+    void disableDoubleBuffering();
+
+    /** Shows the framebuffer drawn in this frame, like the display does at the end of a frame. */
+    void showClientFrameBuffer()
+    {
+        setTFTFrameBuffer(getClientFrameBuffer());
+    }
+
+    /**
+     * Calculates a 32 bit FNV-1a hash of the framebuffer being shown.
+     *
+     * @return The hash value.
+     */
+    uint32_t hashTFTFrameBuffer() const;
+
+    virtual uint16_t* getTFTFrameBuffer() const
+    {
+        return tftFrameBuffer;
+    }
+
+    /** Locks the framebuffer, unless TileRenderer holds the lock for the calling thread, like HALSDL2. */
+    virtual uint16_t* lockFrameBuffer()
+    {
+        return TileRenderer::holdsFrameBufferLock() ? getClientFrameBuffer() : HAL::lockFrameBuffer();
+    }
+
+    /** Unlocks the framebuffer, unless TileRenderer holds the lock for the calling thread. */
+    virtual void unlockFrameBuffer()
+    {
+        if (!TileRenderer::holdsFrameBufferLock())
+        {
+            HAL::unlockFrameBuffer();
+        }
+    }
+
+protected:
+    virtual void setTFTFrameBuffer(uint16_t* addr)
+    {
+        tftFrameBuffer = addr;
+    }
+
+    virtual void configureInterrupts()
+    {
+    }
+
+    virtual void enableInterrupts()
+    {
+    }
+
+    virtual void disableInterrupts()
+    {
+    }
+
+    virtual void enableLCDControllerInterrupt()
+    {
+    }
+
+private:
+    uint8_t* frameBuffer;
+    uint8_t* doubleBuffer;
+    uint32_t frameBufferSize;
+    uint16_t* tftFrameBuffer;
+};
+} // namespace touchgfx
+
+#endif // BENCHMARKHAL_HPP
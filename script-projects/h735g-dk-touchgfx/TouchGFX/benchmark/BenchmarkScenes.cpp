@@ -0,0 +1,378 @@
+#include <BenchmarkScenes.hpp>
+#include <BitmapDatabase.hpp>
+#include <touchgfx/Color.hpp>
+#include <touchgfx/FontManager.hpp>
+#include <touchgfx/hal/HAL.hpp>
+#include <touchgfx/lcd/LCD.hpp>
+#include <touchgfx/widgets/Image.hpp>
+#include <touchgfx/widgets/TiledImage.hpp>
+#include <touchgfx/widgets/Widget.hpp>
+#include <touchgfx/widgets/canvas/Circle.hpp>
+#include <touchgfx/widgets/canvas/Line.hpp>
+#include <touchgfx/widgets/canvas/PainterRGB888.hpp>
+#include <touchgfx/widgets/canvas/PainterRGB888Bitmap.hpp>
+#include <touchgfx/widgets/canvas/SpanPainter.hpp>
+
+namespace touchgfx
+{
+BenchmarkScene::BenchmarkScene(const char* sceneName, const char* painterName, const char* formatName)
+    : Container(),
+      name(sceneName),
+      painter(painterName),
+      format(formatName)
+{
+    setPosition(0, 0, HAL::DISPLAY_WIDTH, HAL::DISPLAY_HEIGHT);
+}
+
+namespace
+{
+/** A full-screen bitmap, tiled to cover the framebuffer. Exercises LCD::drawPartialBitmap(). */
+class TiledBitmapScene : public BenchmarkScene
+{
+public:
+    TiledBitmapScene(const char* sceneName, const char* formatName, BitmapId bitmapId, uint8_t alpha)
+        : BenchmarkScene(sceneName, "LCD24bpp::blitCopy", formatName)
+    {
+        image.setBitmap(Bitmap(bitmapId));
+        image.setPosition(0, 0, getWidth(), getHeight());
+        image.setAlpha(alpha);
+        add(image);
+    }
+
+private:
+    TiledImage image;
+};
+
+/** A grid of alpha-blended icons covering the framebuffer. */
+class IconGridScene : public BenchmarkScene
+{
+public:
+    IconGridScene(const char* sceneName, uint8_t alpha)
+        : BenchmarkScene(sceneName, "LCD24bpp::blitCopyARGB8888", "ARGB8888")
+    {
+        const Bitmap icon(BITMAP_BLUE_ICONS_ADD_NEW_32_ID);
+        const int16_t step = icon.getWidth() + 3;
+        const int columns = MIN(getWidth() / step, MAX_COLUMNS);
+        const int rows = MIN(getHeight() / step, MAX_ROWS);
+        for (int row = 0; row < rows; row++)
+        {
+            for (int column = 0; column < columns; column++)
+            {
+                Image& image = icons[row][column];
+                image.setBitmap(icon);
+                image.setXY(column * step, row * step);
+                image.setAlpha(alpha);
+                add(image);
+            }
+        }
+    }
+
+private:
+    static const int MAX_COLUMNS = 16;
+    static const int MAX_ROWS = 9;
+    Image icons[MAX_ROWS][MAX_COLUMNS];
+};
+
+/** An anti-aliased circle (filled or ring) drawn with either a color or a bitmap painter. */
+class CircleScene : public BenchmarkScene
+{
+public:
+    CircleScene(const char* sceneName, uint8_t alpha, int lineWidth)
+        : BenchmarkScene(sceneName, "PainterRGB888", "color"),
+          colorPainter(Color::getColorFromRGB(0xF0, 0x80, 0x20)),
+          bitmapPainter()
+    {
+        setup(colorPainter, alpha, lineWidth);
+    }
+
+    CircleScene(const char* sceneName, const char* formatName, BitmapId bitmapId, uint8_t alpha, int lineWidth)
+        : BenchmarkScene(sceneName, "PainterRGB888Bitmap", formatName),
+          colorPainter(),
+          bitmapPainter(Bitmap(bitmapId))
+    {
+        bitmapPainter.setTiled(true);
+        setup(bitmapPainter, alpha, lineWidth);
+    }
+
+private:
+    void setup(AbstractPainter& painter, uint8_t alpha, int lineWidth)
+    {
+        circle.setPosition(0, 0, getWidth(), getHeight());
+        circle.setCircle(getWidth() / 2, getHeight() / 2, getHeight() / 2 - 8);
+        circle.setLineWidth(lineWidth);
+        circle.setPainter(painter);
+        circle.setAlpha(alpha);
+        add(circle);
+    }
+
+    Circle circle;
+    PainterRGB888 colorPainter;
+    PainterRGB888Bitmap bitmapPainter;
+};
+
+/** Gradient painter going through the per-pixel virtual renderNext() of AbstractPainterRGB888. */
+class VirtualGradientPainter : public AbstractPainterRGB888
+{
+public:
+    SpanSourceLinearGradient& getSource()
+    {
+        return source;
+    }
+
+protected:
+    virtual bool renderInit()
+    {
+        unsigned skip = 0;
+        unsigned count = 1;
+        return source.renderInit(currentX, currentY, skip, count);
+    }
+
+    virtual bool renderNext(uint8_t& red, uint8_t& green, uint8_t& blue, uint8_t& alpha)
+    {
+        uint32_t color;
+        alpha = source.renderNext(color);
+        red = color >> 16;
+        green = color >> 8;
+        blue = color;
+        return true;
+    }
+
+private:
+    SpanSourceLinearGradient source;
+};
+
+/**
+ * An anti-aliased circle filled with a gradient, either by a custom painter overriding
+ * renderNext() or by a SpanPainter. Both must produce the same pixels.
+ */
+class GradientCircleScene : public BenchmarkScene
+{
+public:
+    GradientCircleScene(const char* sceneName, bool useSpanPainter, uint8_t alpha)
+        : BenchmarkScene(sceneName, useSpanPainter ? "SpanPainter<LinearGradient,RGB888>" : "AbstractPainterRGB888", "gradient")
+    {
+        const colortype left = Color::getColorFromRGB(0x10, 0x40, 0xF0);
+        const colortype right = Color::getColorFromRGB(0xF0, 0xC0, 0x20);
+        virtualPainter.getSource().setGradient(left, right, getWidth());
+        spanPainter.getSource().setGradient(left, right, getWidth());
+
+        circle.setPosition(0, 0, getWidth(), getHeight());
+        circle.setCircle(getWidth() / 2, getHeight() / 2, getHeight() / 2 - 8);
+        circle.setLineWidth(0);
+        circle.setPainter(useSpanPainter ? static_cast<AbstractPainter&>(spanPainter) : static_cast<AbstractPainter&>(virtualPainter));
+        circle.setAlpha(alpha);
+        add(circle);
+    }
+
+private:
+    Circle circle;
+    VirtualGradientPainter virtualPainter;
+    SpanPainter<SpanSourceLinearGradient, SpanDestinationRGB888> spanPainter;
+};
+
+/** A fan of anti-aliased lines spanning the framebuffer. */
+class LineFanScene : public BenchmarkScene
+{
+public:
+    LineFanScene(const char* sceneName, uint8_t alpha)
+        : BenchmarkScene(sceneName, "PainterRGB888", "color"),
+          painter(Color::getColorFromRGB(0x20, 0xC0, 0xF0))
+    {
+        for (int i = 0; i < NUMBER_OF_LINES; i++)
+        {
+            Line& line = lines[i];
+            line.setPosition(0, 0, getWidth(), getHeight());
+            line.setStart(0, getHeight() / 2);
+            line.setEnd(getWidth() - 1, (getHeight() - 1) * i / (NUMBER_OF_LINES - 1));
+            line.setLineWidth(3);
+            line.setLineEndingStyle(Line::ROUND_CAP_ENDING);
+            line.setPainter(painter);
+            line.setAlpha(alpha);
+            add(line);
+        }
+    }
+
+private:
+    static const int NUMBER_OF_LINES = 16;
+    Line lines[NUMBER_OF_LINES];
+    PainterRGB888 painter;
+};
+
+/** Widget drawing a string directly through LCD::drawString() with a given font. */
+class TextRun : public Widget
+{
+public:
+    TextRun()
+        : Widget(), visuals(), text(0)
+    {
+    }
+
+    void setText(const Unicode::UnicodeChar* str, FontId fontId, colortype color)
+    {
+        text = str;
+        visuals = LCD::StringVisuals(FontManager::getFont(fontId), color, 255, LEFT, 0, TEXT_ROTATE_0, TEXT_DIRECTION_LTR, 0, WIDE_TEXT_WORDWRAP);
+    }
+
+    virtual void draw(const Rect& invalidatedArea) const
+    {
+        HAL::lcd().drawString(getAbsoluteRect(), invalidatedArea, visuals, text);
+    }
+
+    virtual Rect getSolidRect() const
+    {
+        return Rect();
+    }
+
+private:
+    LCD::StringVisuals visuals;
+    const Unicode::UnicodeChar* text;
+};
+
+/** Word-wrapped text runs in each of the generated fonts. */
+class TextRunScene : public BenchmarkScene
+{
+public:
+    TextRunScene(const char* sceneName)
+        : BenchmarkScene(sceneName, "LCD24bpp::drawGlyph", "A4")
+    {
+        // The generated fonts only contain the glyphs of "New Text"
+        static const char* const paragraph = "New Text Next Tew wet Test text New Text Next Tew wet Test text New Text Next Tew wet Test text";
+        Unicode::strncpy(buffer, paragraph, BUFFER_SIZE);
+
+        const FontId fonts[NUMBER_OF_RUNS] = { 2, 0, 1 };
+        int16_t y = 0;
+        for (int i = 0; i < NUMBER_OF_RUNS; i++)
+        {
+            const int16_t height = (i == NUMBER_OF_RUNS - 1) ? getHeight() - y : getHeight() / 4;
+            runs[i].setPosition(0, y, getWidth(), height);
+            runs[i].setText(buffer, fonts[i], Color::getColorFromRGB(0xFF, 0xFF, 0xFF));
+            add(runs[i]);
+            y += height;
+        }
+    }
+
+private:
+    static const int NUMBER_OF_RUNS = 3;
+    static const uint16_t BUFFER_SIZE = 128;
+    Unicode::UnicodeChar buffer[BUFFER_SIZE];
+    TextRun runs[NUMBER_OF_RUNS];
+};
+
+BenchmarkScene* createBitmapFullscreen()
+{
+    return new TiledBitmapScene("bitmap_fullscreen", "RGB888", BITMAP_DARK_BACKGROUNDS_MAIN_BG_TEXTURE_320X240PX_ID, 255);
+}
+
+BenchmarkScene* createBitmapFullscreenAlpha()
+{
+    return new TiledBitmapScene("bitmap_fullscreen_alpha", "RGB888", BITMAP_DARK_BACKGROUNDS_MAIN_BG_TEXTURE_320X240PX_ID, 128);
+}
+
+BenchmarkScene* createIconGrid()
+{
+    return new IconGridScene("icon_grid", 255);
+}
+
+BenchmarkScene* createIconGridAlpha()
+{
+    return new IconGridScene("icon_grid_alpha", 128);
+}
+
+BenchmarkScene* createCircleColor()
+{
+    return new CircleScene("circle_color", 255, 0);
+}
+
+BenchmarkScene* createCircleColorAlpha()
+{
+    return new CircleScene("circle_color_alpha", 128, 0);
+}
+
+BenchmarkScene* createRingColor()
+{
+    return new CircleScene("ring_color", 255, 24);
+}
+
+BenchmarkScene* createCircleBitmapRGB888()
+{
+    return new CircleScene("circle_bitmap_rgb888", "RGB888", BITMAP_DARK_BACKGROUNDS_MAIN_BG_TEXTURE_320X240PX_ID, 255, 0);
+}
+
+BenchmarkScene* createCircleBitmapRGB888Alpha()
+{
+    return new CircleScene("circle_bitmap_rgb888_alpha", "RGB888", BITMAP_DARK_BACKGROUNDS_MAIN_BG_TEXTURE_320X240PX_ID, 128, 0);
+}
+
+BenchmarkScene* createCircleBitmapARGB8888()
+{
+    return new CircleScene("circle_bitmap_argb8888", "ARGB8888", BITMAP_BLUE_BUTTONS_ROUND_LARGE_ID, 255, 0);
+}
+
+BenchmarkScene* createCircleBitmapARGB8888Alpha()
+{
+    return new CircleScene("circle_bitmap_argb8888_alpha", "ARGB8888", BITMAP_BLUE_BUTTONS_ROUND_LARGE_ID, 128, 0);
+}
+
+BenchmarkScene* createCircleGradientVirtual()
+{
+    return new GradientCircleScene("circle_gradient_virtual", false, 255);
+}
+
+BenchmarkScene* createCircleGradientSpan()
+{
+    return new GradientCircleScene("circle_gradient_span", true, 255);
+}
+
+BenchmarkScene* createCircleGradientVirtualAlpha()
+{
+    return new GradientCircleScene("circle_gradient_virtual_alpha", false, 128);
+}
+
+BenchmarkScene* createCircleGradientSpanAlpha()
+{
+    return new GradientCircleScene("circle_gradient_span_alpha", true, 128);
+}
+
+BenchmarkScene* createLineFan()
+{
+    return new LineFanScene("line_fan", 255);
+}
+
+BenchmarkScene* createLineFanAlpha()
+{
+    return new LineFanScene("line_fan_alpha", 128);
+}
+
+BenchmarkScene* createTextRuns()
+{
+    return new TextRunScene("text_runs");
+}
+
+const BenchmarkSceneFactory sceneFactories[] = {
+    createBitmapFullscreen,
+    createBitmapFullscreenAlpha,
+    createIconGrid,
+    createIconGridAlpha,
+    createCircleColor,
+    createCircleColorAlpha,
+    createRingColor,
+    createCircleBitmapRGB888,
+    createCircleBitmapRGB888Alpha,
+    createCircleBitmapARGB8888,
+    createCircleBitmapARGB8888Alpha,
+    createCircleGradientVirtual,
+    createCircleGradientSpan,
+    createCircleGradientVirtualAlpha,
+    createCircleGradientSpanAlpha,
+    createLineFan,
+    createLineFanAlpha,
+    createTextRuns
+};
+} // namespace
+
+const BenchmarkSceneFactory* getBenchmarkScenes(int& count)
+{
+    count = sizeof(sceneFactories) / sizeof(sceneFactories[0]);
+    return sceneFactories;
+}
+} // namespace touchgfx
@@ -0,0 +1,77 @@
+#ifndef BENCHMARKSCENES_HPP
+#define BENCHMARKSCENES_HPP
+
+#include <touchgfx/containers/Container.hpp>
+#include <touchgfx/hal/Types.hpp>
+
+namespace touchgfx
+{
+/**
+ * A canonical scene rendered by the benchmark runner.
+ *
+ * A scene is a container filling the framebuffer. The runner repeatedly calls
+ * Container::draw() with the area returned by getRenderArea() and measures the
+ * time spent. Scenes are created after the HAL is initialized, since painters
+ * verify the framebuffer format in their constructors.
+ */
+class BenchmarkScene : public Container
+{
+public:
+    /**
+     * Initializes a new instance of the BenchmarkScene class.
+     *
+     * @param  sceneName   Name of the scene, used on the command line and in reports.
+     * @param  painterName Name of the painter or blitter exercised by the scene.
+     * @param  formatName  Name of the source pixel format.
+     */
+    BenchmarkScene(const char* sceneName, const char* painterName, const char* formatName);
+
+    virtual ~BenchmarkScene()
+    {
+    }
+
+    const char* getName() const
+    {
+        return name;
+    }
+
+    const char* getPainterName() const
+    {
+        return painter;
+    }
+
+    const char* getFormatName() const
+    {
+        return format;
+    }
+
+    /**
+     * Gets the area drawn each iteration, relative to the scene.
+     *
+     * @return The render area. Default is the entire scene.
+     */
+    virtual Rect getRenderArea() const
+    {
+        return Rect(0, 0, getWidth(), getHeight());
+    }
+
+private:
+    const char* name;
+    const char* painter;
+    const char* format;
+};
+
+/** Signature of the functions creating the benchmark scenes. */
+typedef BenchmarkScene* (*BenchmarkSceneFactory)();
+
+/**
+ * Gets the table of registered scene factories.
+ *
+ * @param [out] count The number of entries in the table.
+ *
+ * @return The scene factories.
+ */
+const BenchmarkSceneFactory* getBenchmarkScenes(int& count);
+} // namespace touchgfx
+
+#endif // BENCHMARKSCENES_HPP
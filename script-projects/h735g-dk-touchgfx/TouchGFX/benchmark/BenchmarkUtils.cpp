@@ -0,0 +1,42 @@
+#include <BenchmarkUtils.hpp>
+#include <stdio.h>
+
+namespace
+{
+uint32_t randomState = 1;
+} // namespace
+
+void seedRandom(uint32_t seed)
+{
+    randomState = seed;
+}
+
+uint32_t nextRandom()
+{
+    randomState = randomState * 1664525u + 1013904223u;
+    return randomState >> 8;
+}
+
+int randomBetween(int low, int high)
+{
+    return low + (int)(nextRandom() % (uint32_t)(high - low + 1));
+}
+
+double elapsedNs(std::chrono::steady_clock::time_point start)
+{
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void printThroughput(const char* key, const char* name, double elapsedNs, uint64_t pixels, bool json, bool first)
+{
+    const double pixelsPerSecond = elapsedNs > 0 ? pixels * 1e9 / elapsedNs : 0;
+    if (json)
+    {
+        printf("%s\n    {\"%s\": \"%s\", \"elapsed_ns\": %.0f, \"pixels_per_second\": %.0f}",
+               first ? "" : ",", key, name, elapsedNs, pixelsPerSecond);
+    }
+    else
+    {
+        printf("%-30s %10.2f Mpx/s\n", name, pixelsPerSecond / 1e6);
+    }
+}
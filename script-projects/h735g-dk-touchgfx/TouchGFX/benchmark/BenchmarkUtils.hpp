@@ -0,0 +1,54 @@
+#ifndef BENCHMARKUTILS_HPP
+#define BENCHMARKUTILS_HPP
+
+#include <chrono>
+#include <stdint.h>
+
+/**
+ * Restarts the random numbers of nextRandom(), so a benchmark draws the same
+ * scenes on every run and in every mode it compares.
+ *
+ * @param seed The first state of the generator.
+ */
+void seedRandom(uint32_t seed);
+
+/**
+ * Gets the next number of a linear congruential generator.
+ *
+ * @return A random number of 24 bits.
+ */
+uint32_t nextRandom();
+
+/**
+ * Gets a random number in a range.
+ *
+ * @param low  The lowest number returned.
+ * @param high The highest number returned, at least low.
+ *
+ * @return A random number from low to high, both included.
+ */
+int randomBetween(int low, int high);
+
+/**
+ * Gets the time passed since a point in time.
+ *
+ * @param start The point in time, from std::chrono::steady_clock::now().
+ *
+ * @return The time passed in nanoseconds.
+ */
+double elapsedNs(std::chrono::steady_clock::time_point start);
+
+/**
+ * Prints the throughput of a timed loop, as a line of text or as a JSON
+ * object of an array.
+ *
+ * @param key       The JSON key of the name, such as "blend".
+ * @param name      The name of the loop.
+ * @param elapsedNs The time taken in nanoseconds.
+ * @param pixels    The number of pixels drawn in that time.
+ * @param json      Print a JSON object.
+ * @param first     The object is the first of its array, so no comma goes before it.
+ */
+void printThroughput(const char* key, const char* name, double elapsedNs, uint64_t pixels, bool json, bool first);
+
+#endif // BENCHMARKUTILS_HPP
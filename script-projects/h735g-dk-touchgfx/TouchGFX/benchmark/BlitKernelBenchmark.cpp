@@ -0,0 +1,429 @@
+#include <BlitKernelBenchmark.hpp>
+#include <BenchmarkUtils.hpp>
+#include <platform/driver/lcd/LCD24bpp.hpp>
+#include <platform/driver/lcd/LCD24bppSpecialized.hpp>
+#include <touchgfx/Bitmap.hpp>
+#include <touchgfx/FontManager.hpp>
+#include <touchgfx/Unicode.hpp>
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+using namespace touchgfx;
+
+namespace
+{
+/** Odd sized bitmaps for the comparison, large ones for the timing. */
+const uint16_t SMALL_WIDTH = 97;
+const uint16_t SMALL_HEIGHT = 61;
+const uint16_t LARGE_WIDTH = 240;
+const uint16_t LARGE_HEIGHT = 136;
+const int TRIALS = 200;
+/** Timed rounds of each kernel, alternating between LCD24bpp and LCD24bppSpecialized. */
+const int ROUNDS = 5;
+
+struct SourceFormat
+{
+    const char* name;
+    Bitmap::BitmapFormat format;
+    Bitmap::ClutFormat clut;
+    bool alphaChannel;
+    bool blitCopy; ///< Can be given to LCD::blitCopy()
+    bool enabled;  ///< Has a kernel in LCD24bppBlitConfig.hpp
+};
+
+const SourceFormat FORMATS[] = {
+    { "RGB565", Bitmap::RGB565, Bitmap::CLUT_FORMAT_L8_RGB565, false, true, LCD24BPP_BLIT_RGB565 != 0 },
+    { "RGB565+A", Bitmap::RGB565, Bitmap::CLUT_FORMAT_L8_RGB565, true, false, LCD24BPP_BLIT_RGB565 != 0 },
+    { "RGB888", Bitmap::RGB888, Bitmap::CLUT_FORMAT_L8_RGB565, false, true, LCD24BPP_BLIT_RGB888 != 0 },
+    { "ARGB8888", Bitmap::ARGB8888, Bitmap::CLUT_FORMAT_L8_RGB565, false, true, LCD24BPP_BLIT_ARGB8888 != 0 },
+    { "L8_RGB888", Bitmap::L8, Bitmap::CLUT_FORMAT_L8_RGB888, false, false, LCD24BPP_BLIT_L8_RGB888 != 0 },
+    { "L8_ARGB8888", Bitmap::L8, Bitmap::CLUT_FORMAT_L8_ARGB8888, false, false, LCD24BPP_BLIT_L8_ARGB8888 != 0 },
+};
+const int NUMBER_OF_FORMATS = sizeof(FORMATS) / sizeof(FORMATS[0]);
+/** Glyph kernels are listed after the bitmap kernels, as one more format. */
+const int GLYPHS = NUMBER_OF_FORMATS;
+const int NUMBER_OF_KERNELS = (NUMBER_OF_FORMATS + 1) * 4;
+
+const int NUMBER_OF_FONTS = 3;
+/** The generated fonts only contain the glyphs of "New Text". */
+const char* const PARAGRAPH = "New Text Next Tew wet Test text New Text Next Tew wet Test text New Text Next Tew wet Test text ";
+const int PARAGRAPH_REPEATS = 6;
+const uint16_t TEXT_SIZE = 640;
+
+/** Alpha values of which a third is transparent and a third is solid. */
+uint8_t randomAlpha()
+{
+    const uint32_t r = nextRandom() % 3;
+    return r == 0 ? 0 : (r == 1 ? 0xFF : (uint8_t)nextRandom());
+}
+
+/** Pixels and extra data of a synthetic bitmap, in 32 bit words to align them. */
+struct BitmapStorage
+{
+    std::vector<uint32_t> data;
+    std::vector<uint32_t> extraData;
+};
+
+void fill(std::vector<uint32_t>& words, uint32_t bytes)
+{
+    words.resize((bytes + 3) / 4);
+    for (size_t i = 0; i < words.size(); i++)
+    {
+        words[i] = nextRandom() ^ (nextRandom() << 16);
+    }
+}
+
+void createBitmap(const SourceFormat& format, uint16_t width, uint16_t height, BitmapStorage& storage)
+{
+    const uint32_t pixels = width * height;
+    switch (format.format)
+    {
+    case Bitmap::RGB565:
+        fill(storage.data, pixels * 2);
+        if (format.alphaChannel)
+        {
+            fill(storage.extraData, pixels);
+            uint8_t* const alpha = reinterpret_cast<uint8_t*>(&storage.extraData[0]);
+            for (uint32_t i = 0; i < pixels; i++)
+            {
+                alpha[i] = randomAlpha();
+            }
+        }
+        break;
+    case Bitmap::RGB888:
+        fill(storage.data, pixels * 3);
+        break;
+    case Bitmap::ARGB8888:
+        fill(storage.data, pixels * 4);
+        for (uint32_t i = 0; i < pixels; i++)
+        {
+            storage.data[i] = (storage.data[i] & 0xFFFFFF) | (randomAlpha() << 24);
+        }
+        break;
+    default:
+        {
+            fill(storage.data, pixels);
+            const uint32_t bytesPerColor = format.clut == Bitmap::CLUT_FORMAT_L8_RGB565 ? 2 : (format.clut == Bitmap::CLUT_FORMAT_L8_RGB888 ? 3 : 4);
+            fill(storage.extraData, 4 + 256 * bytesPerColor);
+            uint16_t* const header = reinterpret_cast<uint16_t*>(&storage.extraData[0]);
+            header[0] = (uint16_t)format.clut;
+            header[1] = 256;
+            if (format.clut == Bitmap::CLUT_FORMAT_L8_ARGB8888)
+            {
+                for (int i = 0; i < 256; i++)
+                {
+                    storage.extraData[1 + i] = (storage.extraData[1 + i] & 0xFFFFFF) | (randomAlpha() << 24);
+                }
+            }
+        }
+        break;
+    }
+}
+
+/** Switches between the native display orientation and a display rotated by 90 degrees. */
+void setRotation(DisplayRotation rotation)
+{
+    if (HAL::DISPLAY_ROTATION != rotation)
+    {
+        const uint16_t width = HAL::DISPLAY_WIDTH;
+        HAL::DISPLAY_WIDTH = HAL::DISPLAY_HEIGHT;
+        HAL::DISPLAY_HEIGHT = width;
+        HAL::DISPLAY_ROTATION = rotation;
+    }
+}
+
+/** A kernel: source format, global alpha and rotation. */
+struct Kernel
+{
+    int format;
+    bool globalAlpha;
+    bool rotated;
+    uint32_t trials;
+    uint32_t mismatches;
+};
+
+/** True if LCD24bppSpecialized draws with its own kernel, false if it passes the drawing on to LCD24bpp. */
+bool drawnByKernel(const Kernel& kernel)
+{
+    if (kernel.format == GLYPHS)
+    {
+        return LCD24BPP_BLIT_A4 && !kernel.rotated;
+    }
+    const SourceFormat& format = FORMATS[kernel.format];
+    // Opaque RGB565 is drawn faster by LCD24bpp
+    return format.enabled && (format.format != Bitmap::RGB565 || kernel.globalAlpha);
+}
+
+int kernelIndex(int format, bool globalAlpha, bool rotated)
+{
+    return (format * 2 + (globalAlpha ? 1 : 0)) * 2 + (rotated ? 1 : 0);
+}
+
+/** Draws a random part of a bitmap at a random position, or blits it with blitCopy(). */
+struct Draw
+{
+    BitmapId id;
+    int16_t x;
+    int16_t y;
+    Rect rect;
+    uint8_t alpha;
+    int method;
+};
+
+void draw(LCD& lcd, const Draw& d, const SourceFormat& format)
+{
+    const Bitmap bitmap(d.id);
+    switch (d.method)
+    {
+    case 0:
+        lcd.drawPartialBitmap(bitmap, d.x, d.y, d.rect, d.alpha);
+        break;
+    case 1:
+        lcd.blitCopy(bitmap.getData(), format.format, Rect(d.x, d.y, bitmap.getWidth(), bitmap.getHeight()), d.rect, d.alpha, false);
+        break;
+    default:
+        lcd.blitCopy(reinterpret_cast<const uint16_t*>(bitmap.getData()), Rect(d.x, d.y, bitmap.getWidth(), bitmap.getHeight()), d.rect, d.alpha, false);
+        break;
+    }
+}
+
+double timeDraws(BenchmarkHAL& hal, LCD& lcd, const Draw& d, const SourceFormat& format, int iterations)
+{
+    hal.clearFrameBuffer();
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        draw(lcd, d, format);
+    }
+    return elapsedNs(start);
+}
+
+/** Word-wrapped text drawn through LCD::drawString(), which draws the glyphs. */
+struct Text
+{
+    Rect widget;
+    Rect invalidated; ///< Relative to the widget
+    FontId font;
+    colortype color;
+    uint8_t alpha;
+};
+
+void drawText(LCD& lcd, const Text& t, const Unicode::UnicodeChar* text)
+{
+    const LCD::StringVisuals visuals(FontManager::getFont(t.font), t.color, t.alpha, LEFT, 0, TEXT_ROTATE_0, TEXT_DIRECTION_LTR, 0, WIDE_TEXT_WORDWRAP);
+    lcd.drawString(t.widget, t.invalidated, visuals, text);
+}
+
+/** Times a screen of paragraphs on a background, so the glyphs are blended. */
+double timeText(BenchmarkHAL& hal, LCD& lcd, const Text& t, const Unicode::UnicodeChar* text, int iterations)
+{
+    hal.clearFrameBuffer();
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        drawText(lcd, t, text);
+    }
+    return elapsedNs(start);
+}
+} // namespace
+
+bool runBlitKernelBenchmark(BenchmarkHAL& hal, int iterations, bool json)
+{
+    seedRandom(1);
+    BitmapStorage storage[NUMBER_OF_FORMATS * 2];
+    std::vector<Bitmap::BitmapData> database;
+    database.reserve(NUMBER_OF_FORMATS * 2);
+    for (int i = 0; i < NUMBER_OF_FORMATS * 2; i++)
+    {
+        const SourceFormat& format = FORMATS[i % NUMBER_OF_FORMATS];
+        const uint16_t width = i < NUMBER_OF_FORMATS ? SMALL_WIDTH : LARGE_WIDTH;
+        const uint16_t height = i < NUMBER_OF_FORMATS ? SMALL_HEIGHT : LARGE_HEIGHT;
+        createBitmap(format, width, height, storage[i]);
+        const uint8_t* const extraData = storage[i].extraData.empty() ? 0 : reinterpret_cast<const uint8_t*>(&storage[i].extraData[0]);
+        const Bitmap::BitmapData data = { reinterpret_cast<const uint8_t*>(&storage[i].data[0]), extraData, width, height, 0, 0, 0,
+                                          (uint16_t)(((uint8_t)format.format) >> 3), 0, (uint16_t)(((uint8_t)format.format) & 0x7) };
+        database.push_back(data);
+    }
+    Bitmap::registerBitmapDatabase(&database[0], (uint16_t)database.size());
+
+    LCD24bpp reference;
+    LCD24bppSpecialized specialized;
+    Kernel kernels[NUMBER_OF_KERNELS];
+    for (int f = 0; f <= GLYPHS; f++)
+    {
+        for (int k = 0; k < 4; k++)
+        {
+            Kernel& kernel = kernels[kernelIndex(f, k & 2, k & 1)];
+            kernel.format = f;
+            kernel.globalAlpha = k & 2;
+            kernel.rotated = k & 1;
+            kernel.trials = 0;
+            kernel.mismatches = 0;
+        }
+    }
+
+    // Compare random draws
+    for (int rotated = 0; rotated < 2; rotated++)
+    {
+        setRotation(rotated ? rotate90 : rotate0);
+        for (int f = 0; f < NUMBER_OF_FORMATS; f++)
+        {
+            const SourceFormat& format = FORMATS[f];
+            for (int trial = 0; trial < TRIALS; trial++)
+            {
+                Draw d;
+                d.id = (BitmapId)f;
+                d.method = format.blitCopy ? nextRandom() % (format.format == Bitmap::RGB888 ? 3 : 2) : 0;
+                d.x = (int16_t)(nextRandom() % (HAL::DISPLAY_WIDTH - SMALL_WIDTH + 1));
+                d.y = (int16_t)(nextRandom() % (HAL::DISPLAY_HEIGHT - SMALL_HEIGHT + 1));
+                d.rect.x = (int16_t)(nextRandom() % SMALL_WIDTH);
+                d.rect.y = (int16_t)(nextRandom() % SMALL_HEIGHT);
+                d.rect.width = (int16_t)(1 + nextRandom() % (SMALL_WIDTH - d.rect.x));
+                d.rect.height = (int16_t)(1 + nextRandom() % (SMALL_HEIGHT - d.rect.y));
+                d.alpha = trial % 2 ? 0xFF : (uint8_t)(nextRandom() % 0xFF);
+
+                hal.clearFrameBuffer();
+                draw(reference, d, format);
+                const uint32_t expected = hal.hashFrameBuffer();
+                hal.clearFrameBuffer();
+                draw(specialized, d, format);
+                Kernel& kernel = kernels[kernelIndex(f, d.alpha < 0xFF, rotated)];
+                kernel.trials++;
+                if (hal.hashFrameBuffer() != expected)
+                {
+                    if (kernel.mismatches++ == 0)
+                    {
+                        fprintf(stderr, "%s%s%s differs: method %d at %d,%d rect %d,%d %dx%d alpha %d\n", format.name, d.alpha < 0xFF ? " alpha" : "",
+                                rotated ? " rotated" : "", d.method, d.x, d.y, d.rect.x, d.rect.y, d.rect.width, d.rect.height, d.alpha);
+                    }
+                }
+            }
+        }
+    }
+
+    // Compare paragraphs in random fonts, colors and parts of the display
+    Unicode::UnicodeChar text[TEXT_SIZE];
+    for (int i = 0; i < PARAGRAPH_REPEATS; i++)
+    {
+        Unicode::strncpy(text + Unicode::strlen(PARAGRAPH) * i, PARAGRAPH, TEXT_SIZE - Unicode::strlen(PARAGRAPH) * i);
+    }
+    for (int rotated = 0; rotated < 2; rotated++)
+    {
+        setRotation(rotated ? rotate90 : rotate0);
+        for (int trial = 0; trial < TRIALS; trial++)
+        {
+            Text t;
+            t.widget.x = (int16_t)(nextRandom() % (HAL::DISPLAY_WIDTH - 40));
+            t.widget.y = (int16_t)(nextRandom() % (HAL::DISPLAY_HEIGHT - 20));
+            t.widget.width = (int16_t)(40 + nextRandom() % (HAL::DISPLAY_WIDTH - t.widget.x - 40 + 1));
+            t.widget.height = (int16_t)(20 + nextRandom() % (HAL::DISPLAY_HEIGHT - t.widget.y - 20 + 1));
+            t.invalidated.x = (int16_t)(nextRandom() % t.widget.width);
+            t.invalidated.y = (int16_t)(nextRandom() % t.widget.height);
+            t.invalidated.width = (int16_t)(1 + nextRandom() % (t.widget.width - t.invalidated.x));
+            t.invalidated.height = (int16_t)(1 + nextRandom() % (t.widget.height - t.invalidated.y));
+            t.font = (FontId)(nextRandom() % NUMBER_OF_FONTS);
+            t.color = nextRandom() & 0xFFFFFF;
+            t.alpha = trial % 2 ? 0xFF : (uint8_t)(1 + nextRandom() % 0xFE);
+
+            hal.clearFrameBuffer();
+            drawText(reference, t, text);
+            const uint32_t expected = hal.hashFrameBuffer();
+            hal.clearFrameBuffer();
+            drawText(specialized, t, text);
+            Kernel& kernel = kernels[kernelIndex(GLYPHS, t.alpha < 0xFF, rotated)];
+            kernel.trials++;
+            if (hal.hashFrameBuffer() != expected)
+            {
+                if (kernel.mismatches++ == 0)
+                {
+                    fprintf(stderr, "A4%s%s differs: font %d in %d,%d %dx%d invalidated %d,%d %dx%d alpha %d\n", t.alpha < 0xFF ? " alpha" : "",
+                            rotated ? " rotated" : "", t.font, t.widget.x, t.widget.y, t.widget.width, t.widget.height,
+                            t.invalidated.x, t.invalidated.y, t.invalidated.width, t.invalidated.height, t.alpha);
+                }
+            }
+        }
+    }
+
+    if (json)
+    {
+        printf("{\"iterations\": %d, \"results\": [", iterations);
+    }
+    else
+    {
+        printf("%-12s %-7s %-7s %-9s %14s %14s %8s\n", "format", "alpha", "rotate", "drawn by", "LCD24bpp", "specialized", "speedup");
+    }
+    bool ok = true;
+    for (int k = 0; k < NUMBER_OF_KERNELS; k++)
+    {
+        const Kernel& kernel = kernels[k];
+        setRotation(kernel.rotated ? rotate90 : rotate0);
+        const char* name = "A4";
+        double referenceNs;
+        double specializedNs;
+        double pixels;
+        if (kernel.format == GLYPHS)
+        {
+            // Throughput of the text area
+            Text t;
+            t.widget = Rect(0, 0, HAL::DISPLAY_WIDTH, HAL::DISPLAY_HEIGHT);
+            t.invalidated = Rect(0, 0, HAL::DISPLAY_WIDTH, HAL::DISPLAY_HEIGHT);
+            t.font = 0;
+            t.color = 0xFFFFFF;
+            t.alpha = kernel.globalAlpha ? 128 : 0xFF;
+            referenceNs = 0;
+            specializedNs = 0;
+            for (int round = 0; round < ROUNDS; round++)
+            {
+                const double roundReferenceNs = timeText(hal, reference, t, text, iterations);
+                const double roundSpecializedNs = timeText(hal, specialized, t, text, iterations);
+                referenceNs = round == 0 ? roundReferenceNs : MIN(referenceNs, roundReferenceNs);
+                specializedNs = round == 0 ? roundSpecializedNs : MIN(specializedNs, roundSpecializedNs);
+            }
+            pixels = (double)HAL::DISPLAY_WIDTH * HAL::DISPLAY_HEIGHT * iterations;
+        }
+        else
+        {
+            const SourceFormat& format = FORMATS[kernel.format];
+            name = format.name;
+            Draw d;
+            d.id = (BitmapId)(NUMBER_OF_FORMATS + kernel.format);
+            d.method = 0;
+            d.x = 0;
+            d.y = 0;
+            d.rect = Rect(0, 0, LARGE_WIDTH, LARGE_HEIGHT);
+            d.alpha = kernel.globalAlpha ? 128 : 0xFF;
+            referenceNs = 0;
+            specializedNs = 0;
+            for (int round = 0; round < ROUNDS; round++)
+            {
+                const double roundReferenceNs = timeDraws(hal, reference, d, format, iterations);
+                const double roundSpecializedNs = timeDraws(hal, specialized, d, format, iterations);
+                referenceNs = round == 0 ? roundReferenceNs : MIN(referenceNs, roundReferenceNs);
+                specializedNs = round == 0 ? roundSpecializedNs : MIN(specializedNs, roundSpecializedNs);
+            }
+            pixels = (double)LARGE_WIDTH * LARGE_HEIGHT * iterations;
+        }
+        ok = ok && kernel.mismatches == 0;
+        if (json)
+        {
+            printf("%s\n  {\"format\": \"%s\", \"global_alpha\": %s, \"rotated\": %s, \"kernel\": %s, \"reference_mpx_per_s\": %.2f, "
+                   "\"specialized_mpx_per_s\": %.2f, \"speedup\": %.2f, \"trials\": %u, \"mismatches\": %u}",
+                   k ? "," : "", name, kernel.globalAlpha ? "true" : "false", kernel.rotated ? "true" : "false", drawnByKernel(kernel) ? "true" : "false",
+                   pixels * 1e3 / referenceNs, pixels * 1e3 / specializedNs, referenceNs / specializedNs, kernel.trials, kernel.mismatches);
+        }
+        else
+        {
+            printf("%-12s %-7s %-7s %-9s %8.2f Mpx/s %8.2f Mpx/s %7.2fx  %u/%u %s\n", name, kernel.globalAlpha ? "global" : "opaque",
+                   kernel.rotated ? "90" : "0", drawnByKernel(kernel) ? "kernel" : "LCD24bpp", pixels * 1e3 / referenceNs, pixels * 1e3 / specializedNs, referenceNs / specializedNs,
+                   kernel.trials - kernel.mismatches, kernel.trials, kernel.mismatches ? "MISMATCH" : "ok");
+        }
+    }
+    if (json)
+    {
+        printf("\n]}\n");
+    }
+    setRotation(rotate0);
+    return ok;
+}
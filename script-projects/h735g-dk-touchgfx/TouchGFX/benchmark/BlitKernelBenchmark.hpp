@@ -0,0 +1,30 @@
+#ifndef BLITKERNELBENCHMARK_HPP
+#define BLITKERNELBENCHMARK_HPP
+
+#include <BenchmarkHAL.hpp>
+
+/**
+ * Draw synthetic bitmaps of every source format through LCD24bpp and
+ * through LCD24bppSpecialized, with and without global alpha, on a display
+ * in its native orientation and rotated by 90 degrees. Random parts of the
+ * bitmaps are drawn at random positions by both, and the framebuffers are
+ * compared. Word-wrapped paragraphs in the generated 4bpp fonts are compared
+ * the same way, in random colors and clipped to random areas. Reports the
+ * throughput of each kernel against LCD24bpp, for the glyphs that of a
+ * display filled with paragraphs, as the fastest of alternating rounds.
+ * Combinations passed on to LCD24bpp by LCD24bppSpecialized are marked,
+ * their speedup only shows the noise of the host.
+ *
+ * Replaces the bitmap database of the benchmark with the synthetic
+ * bitmaps.
+ *
+ * @param hal        The initialized benchmark HAL.
+ * @param iterations Number of timed draws of each kernel.
+ * @param json       Write the result as JSON.
+ *
+ * @return True if every framebuffer drawn by LCD24bppSpecialized matches
+ *         the framebuffer drawn by LCD24bpp.
+ */
+bool runBlitKernelBenchmark(touchgfx::BenchmarkHAL& hal, int iterations, bool json);
+
+#endif // BLITKERNELBENCHMARK_HPP
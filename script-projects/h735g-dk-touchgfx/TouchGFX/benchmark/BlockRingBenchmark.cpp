@@ -0,0 +1,325 @@
+#include <BlockRingBenchmark.hpp>
+#include <BenchmarkUtils.hpp>
+#include <touchgfx/hal/FrameBufferAllocator.hpp>
+#include <touchgfx/hal/RingBlockAllocator.hpp>
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+
+using namespace touchgfx;
+
+namespace
+{
+const int WIDTH = 480;
+const int HEIGHT = 272;
+const uint32_t BYTES_PER_PIXEL = 3;
+const uint32_t MEMORY_SIZE = 24 * 1024;
+const int AREAS_PER_FRAME = 12;
+/** Transfer time per byte, about a 4 bit 50 MHz quad SPI display. */
+const double TRANSFER_NS_PER_BYTE = 40.0;
+/** Time to set the window of a block on the display before its pixels are sent. */
+const double TRANSFER_NS_PER_BLOCK = 20000.0;
+/** Drawing time per byte, widgets drawn with a little blending. */
+const double DRAW_NS_PER_BYTE = 30.0;
+
+typedef RingBlockAllocator<MEMORY_SIZE, 8, BYTES_PER_PIXEL> Ring;
+/** 2^32 is 16 bytes more than a multiple of this size, a ring wrapping wrong overlaps its newest block. */
+const uint32_t WRAP_MEMORY_SIZE = 24940;
+typedef RingBlockAllocator<WRAP_MEMORY_SIZE, 8, BYTES_PER_PIXEL> WrapRing;
+typedef ManyBlockAllocator<MEMORY_SIZE / 2, 2, BYTES_PER_PIXEL> TwoBlocks;
+
+typedef std::chrono::steady_clock Clock;
+
+uint8_t pattern(int x, int y, int c, uint32_t seed)
+{
+    return (uint8_t)(x * 7 + y * 13 + c * 101 + seed);
+}
+
+/** The display side, copying transferred blocks to the framebuffer. */
+struct Transfer
+{
+    FrameBufferAllocator* allocator;
+    uint8_t* framebuffer;
+    std::atomic<uint32_t> transferred;
+    std::atomic<bool> stop;
+    double idleNs;
+};
+
+/** Keeps the calling thread busy until the given time has passed since start. */
+void busyUntil(const Clock::time_point& start, double ns)
+{
+    while (elapsedNs(start) < ns)
+    {
+        std::this_thread::yield();
+    }
+}
+
+void transferLoop(Transfer& transfer)
+{
+    FrameBufferAllocator& allocator = *transfer.allocator;
+    Clock::time_point idleStart = Clock::now();
+    bool idle = true;
+    while (!transfer.stop)
+    {
+        if (!allocator.hasBlockReadyForTransfer())
+        {
+            if (!idle)
+            {
+                idle = true;
+                idleStart = Clock::now();
+            }
+            std::this_thread::yield();
+            continue;
+        }
+        if (idle)
+        {
+            idle = false;
+            transfer.idleNs += elapsedNs(idleStart);
+        }
+
+        Rect rect;
+        const uint8_t* src = allocator.getBlockForTransfer(rect);
+        const Clock::time_point start = Clock::now();
+        const uint32_t stride = rect.width * BYTES_PER_PIXEL;
+        uint8_t* dst = transfer.framebuffer + (rect.y * WIDTH + rect.x) * BYTES_PER_PIXEL;
+        for (int line = 0; line < rect.height; line++)
+        {
+            memcpy(dst, src, stride);
+            src += stride;
+            dst += WIDTH * BYTES_PER_PIXEL;
+        }
+        // The display interface is busy until the whole block is sent, the drawing side may run
+        busyUntil(start, TRANSFER_NS_PER_BLOCK + stride * rect.height * TRANSFER_NS_PER_BYTE);
+        allocator.freeBlockAfterTransfer();
+        transfer.transferred++;
+    }
+}
+
+struct Result
+{
+    double frameNs;
+    double allocateNs;
+    double transferIdleNs;
+    uint32_t blocks;
+    uint64_t lines;
+    bool ok;
+};
+
+/** The areas of a frame, mostly widget sized with a full screen redraw every 16 frames. */
+Rect frameArea(int frame, int area, uint32_t& random)
+{
+    if (frame % 16 == 0 && area == 0)
+    {
+        return Rect(0, 0, WIDTH, HEIGHT);
+    }
+    random = random * 1664525u + 1013904223u;
+    const int width = 8 + (random >> 8) % (area % 4 == 0 ? WIDTH - 8 : 160);
+    const int height = 4 + (random >> 20) % (area % 3 == 0 ? HEIGHT - 4 : 80);
+    random = random * 1664525u + 1013904223u;
+    const int x = (random >> 8) % (WIDTH - width + 1);
+    const int y = (random >> 20) % (HEIGHT - height + 1);
+    return Rect(x, y, width, height);
+}
+
+Result runAllocator(FrameBufferAllocator& allocator, int iterations)
+{
+    uint8_t* const framebuffer = new uint8_t[WIDTH * HEIGHT * BYTES_PER_PIXEL];
+    uint8_t* const reference = new uint8_t[WIDTH * HEIGHT * BYTES_PER_PIXEL];
+    memset(framebuffer, 0, WIDTH * HEIGHT * BYTES_PER_PIXEL);
+    memset(reference, 0, WIDTH * HEIGHT * BYTES_PER_PIXEL);
+
+    Transfer transfer;
+    transfer.allocator = &allocator;
+    transfer.framebuffer = framebuffer;
+    transfer.transferred = 0;
+    transfer.stop = false;
+    transfer.idleNs = 0;
+    std::thread display(transferLoop, std::ref(transfer));
+
+    Result result = { 0, 0, 0, 0, 0, true };
+    uint32_t random = 12345;
+    const Clock::time_point start = Clock::now();
+    for (int frame = 0; frame < iterations; frame++)
+    {
+        for (int area = 0; area < AREAS_PER_FRAME; area++)
+        {
+            const Rect rect = frameArea(frame, area, random);
+            const uint32_t seed = frame * AREAS_PER_FRAME + area;
+            int y = rect.y;
+            while (y < rect.bottom())
+            {
+                uint8_t* block;
+                const Clock::time_point allocateStart = Clock::now();
+                const uint16_t lines = allocator.allocateBlock(rect.x, y, rect.width, rect.bottom() - y, &block);
+                result.allocateNs += elapsedNs(allocateStart);
+                const Clock::time_point drawStart = Clock::now();
+                for (int line = y; line < y + lines; line++)
+                {
+                    uint8_t* const ref = reference + (line * WIDTH + rect.x) * BYTES_PER_PIXEL;
+                    for (int x = 0; x < rect.width; x++)
+                    {
+                        for (uint32_t c = 0; c < BYTES_PER_PIXEL; c++)
+                        {
+                            *block++ = ref[x * BYTES_PER_PIXEL + c] = pattern(rect.x + x, line, c, seed);
+                        }
+                    }
+                }
+                busyUntil(drawStart, rect.width * BYTES_PER_PIXEL * lines * DRAW_NS_PER_BYTE);
+                allocator.markBlockReadyForTransfer();
+                result.blocks++;
+                result.lines += lines;
+                y += lines;
+            }
+        }
+
+        // End of frame, wait for the display before comparing
+        while (transfer.transferred != result.blocks)
+        {
+            std::this_thread::yield();
+        }
+        result.ok = result.ok && !memcmp(framebuffer, reference, WIDTH * HEIGHT * BYTES_PER_PIXEL);
+    }
+    result.frameNs = elapsedNs(start) / iterations;
+
+    transfer.stop = true;
+    display.join();
+    result.transferIdleNs = transfer.idleNs;
+    delete[] framebuffer;
+    delete[] reference;
+    return result;
+}
+
+/**
+ * Allocates, transfers and frees blocks on one thread until the counters of bytes have
+ * wrapped past 2^32, keeping most of the ring waiting for transfer. A new block must never
+ * overlap a block waiting for transfer, nor leave the ring.
+ */
+bool checkWrap(WrapRing& ring)
+{
+    // Six blocks and the padding before one of them fill at most 7/10 of the ring, so the
+    // next block always fits and the single thread never waits for itself
+    const int IN_FLIGHT = 6;
+    const uint32_t maxBlockSize = WRAP_MEMORY_SIZE / 10;
+    const uint64_t bytes = (1ull << 32) + 16 * WRAP_MEMORY_SIZE;
+    uint32_t random = 54321;
+    const uint8_t* base = 0;
+    const uint8_t* inFlight[IN_FLIGHT] = { 0 };
+    uint32_t inFlightSize[IN_FLIGHT] = { 0 };
+    uint64_t allocated = 0;
+    for (uint32_t n = 0; allocated < bytes; n++)
+    {
+        random = random * 1664525u + 1013904223u;
+        const uint16_t width = 1 + (random >> 8) % 160;
+        const uint32_t stride = width * BYTES_PER_PIXEL;
+        const uint16_t height = maxBlockSize / stride;
+        uint8_t* block;
+        const uint16_t lines = ring.allocateBlock(0, 0, width, height, &block);
+        if (base == 0)
+        {
+            base = block;
+        }
+        const uint32_t size = lines * stride;
+        if (lines == 0 || block < base || block + size > base + WRAP_MEMORY_SIZE)
+        {
+            return false;
+        }
+        for (int i = 0; i < IN_FLIGHT; i++)
+        {
+            if (inFlight[i] && block < inFlight[i] + inFlightSize[i] && inFlight[i] < block + size)
+            {
+                return false;
+            }
+        }
+        ring.markBlockReadyForTransfer();
+        allocated += size;
+
+        // Transfer the oldest block, the newest stay in flight
+        if (inFlight[n % IN_FLIGHT])
+        {
+            Rect rect;
+            ring.getBlockForTransfer(rect);
+            ring.freeBlockAfterTransfer();
+        }
+        inFlight[n % IN_FLIGHT] = block;
+        inFlightSize[n % IN_FLIGHT] = size;
+    }
+    return true;
+}
+
+void printResult(const char* name, const Result& result, int iterations, const Ring::Statistics* ring, bool json, bool last)
+{
+    if (json)
+    {
+        printf("  {\"allocator\": \"%s\", \"frame_ns\": %.0f, \"blocks\": %u, \"lines_per_block\": %.1f, "
+               "\"allocate_ns\": %.0f, \"transfer_idle_ns\": %.0f",
+               name, result.frameNs, result.blocks, result.blocks ? (double)result.lines / result.blocks : 0,
+               result.allocateNs / iterations, result.transferIdleNs / iterations);
+        if (ring)
+        {
+            printf(", \"short_blocks\": %u, \"max_bytes_in_use\": %u, \"draw_stalls\": %u, \"draw_stall_ns\": %llu, "
+                   "\"transfer_stalls\": %u, \"transfer_stall_ns\": %llu",
+                   ring->shortBlocks, ring->maxBytesInUse, ring->drawStalls, (unsigned long long)ring->drawStallTime,
+                   ring->transferStalls, (unsigned long long)ring->transferStallTime);
+        }
+        printf(", \"ok\": %s}%s\n", result.ok ? "true" : "false", last ? "" : ",");
+    }
+    else
+    {
+        printf("%-10s %.2f ms/frame, %u blocks of %.1f lines, allocate %.3f ms/frame, transfer idle %.3f ms/frame, %s\n",
+               name, result.frameNs / 1e6, result.blocks, result.blocks ? (double)result.lines / result.blocks : 0,
+               result.allocateNs / 1e6 / iterations, result.transferIdleNs / 1e6 / iterations, result.ok ? "ok" : "MISMATCH");
+        if (ring)
+        {
+            printf("           %u short blocks, %u of %u bytes in use, %u draw stalls (%.3f ms), %u transfer stalls (%.3f ms)\n",
+                   ring->shortBlocks, ring->maxBytesInUse, MEMORY_SIZE, ring->drawStalls, ring->drawStallTime / 1e6,
+                   ring->transferStalls, ring->transferStallTime / 1e6);
+        }
+    }
+}
+} // namespace
+
+namespace touchgfx
+{
+void FrameBufferAllocatorWaitOnTransfer()
+{
+    std::this_thread::yield();
+}
+
+void FrameBufferAllocatorSignalBlockDrawn()
+{
+}
+} // namespace touchgfx
+
+bool runBlockRingBenchmark(int iterations, bool json)
+{
+    // Too large for the stack
+    Ring* ring = new Ring();
+    TwoBlocks* twoBlocks = new TwoBlocks();
+
+    const Result ringResult = runAllocator(*ring, iterations);
+    const Result twoBlocksResult = runAllocator(*twoBlocks, iterations);
+    WrapRing* wrapRing = new WrapRing();
+    const bool wrapped = checkWrap(*wrapRing);
+    delete wrapRing;
+
+    if (json)
+    {
+        printf("{\"memory\": %u, \"iterations\": %d, \"results\": [\n", MEMORY_SIZE, iterations);
+    }
+    printResult("ring", ringResult, iterations, &ring->getStatistics(), json, false);
+    printResult("two_blocks", twoBlocksResult, iterations, 0, json, true);
+    if (json)
+    {
+        printf("], \"wrap_ok\": %s}\n", wrapped ? "true" : "false");
+    }
+    else
+    {
+        printf("ring wrapped past 2^32 bytes: %s\n", wrapped ? "ok" : "OVERLAP");
+    }
+
+    delete ring;
+    delete twoBlocks;
+    return ringResult.ok && twoBlocksResult.ok && wrapped;
+}
@@ -0,0 +1,25 @@
+#ifndef BLOCKRINGBENCHMARK_HPP
+#define BLOCKRINGBENCHMARK_HPP
+
+/**
+ * Hand the areas of a partial framebuffer display from a drawing thread to a
+ * transfer thread, once through a RingBlockAllocator and once through a
+ * ManyBlockAllocator with the same memory. The drawing thread fills the
+ * blocks of areas of varying size with a pattern, the transfer thread copies
+ * them to a framebuffer at the speed of a simulated display interface, and
+ * every frame is compared with the framebuffer drawn directly. Drawing and
+ * transfer take simulated time per byte, and each transferred block also
+ * pays for setting its window on the display. Reports the time per frame,
+ * the blocks and lines per block, and the time each side waited for the
+ * other. Then runs a ring until its counters of bytes wrap past 2^32,
+ * checking that no block overlaps a block waiting for transfer.
+ *
+ * @param iterations Number of frames.
+ * @param json       Write the result as JSON.
+ *
+ * @return True if every transferred frame matches the directly drawn frame,
+ *         and no block overlaps a block waiting for transfer.
+ */
+bool runBlockRingBenchmark(int iterations, bool json);
+
+#endif // BLOCKRINGBENCHMARK_HPP
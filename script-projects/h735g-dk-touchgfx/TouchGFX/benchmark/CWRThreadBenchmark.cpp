@@ -0,0 +1,175 @@
+#include <CWRThreadBenchmark.hpp>
+#include <BenchmarkUtils.hpp>
+#include <touchgfx/Color.hpp>
+#include <touchgfx/canvas_widget_renderer/CanvasWidgetRenderer.hpp>
+#include <touchgfx/containers/Container.hpp>
+#include <touchgfx/widgets/canvas/Circle.hpp>
+#include <touchgfx/widgets/canvas/Line.hpp>
+#include <touchgfx/widgets/canvas/PainterRGB888.hpp>
+#include <chrono>
+#include <stdio.h>
+#include <thread>
+
+using namespace touchgfx;
+
+namespace
+{
+const int MAX_THREADS = 64;
+
+/** Many small and a few large shapes, in the style of a gauge dashboard. */
+class ShapeField : public Container
+{
+public:
+    ShapeField(int16_t width, int16_t height)
+        : Container(),
+          ringPainter(Color::getColorFromRGB(0xF0, 0x80, 0x20)),
+          dotPainter(Color::getColorFromRGB(0x20, 0xC0, 0xF0)),
+          linePainter(Color::getColorFromRGB(0xE0, 0xE0, 0x40))
+    {
+        setPosition(0, 0, width, height);
+        for (int i = 0; i < NUMBER_OF_CIRCLES; i++)
+        {
+            const int radius = 6 + (i * 7) % 40;
+            Circle& circle = circles[i];
+            circle.setPosition(0, 0, width, height);
+            circle.setCircle((i * 61) % width, (i * 37) % height, radius);
+            circle.setLineWidth(i % 3 ? 0 : 3);
+            circle.setArc(0, i % 4 ? 360 : 270);
+            circle.setPainter(i % 2 ? ringPainter : dotPainter);
+            circle.setAlpha(i % 5 ? 255 : 160);
+            add(circle);
+        }
+        for (int i = 0; i < NUMBER_OF_LINES; i++)
+        {
+            Line& line = lines[i];
+            line.setPosition(0, 0, width, height);
+            line.setStart((i * 53) % width, 0);
+            line.setEnd(width - 1 - (i * 29) % width, height - 1);
+            line.setLineWidth(1 + i % 4);
+            line.setLineEndingStyle(i % 2 ? Line::ROUND_CAP_ENDING : Line::BUTT_CAP_ENDING);
+            line.setPainter(linePainter);
+            add(line);
+        }
+    }
+
+private:
+    static const int NUMBER_OF_CIRCLES = 48;
+    static const int NUMBER_OF_LINES = 24;
+    Circle circles[NUMBER_OF_CIRCLES];
+    Line lines[NUMBER_OF_LINES];
+    PainterRGB888 ringPainter;
+    PainterRGB888 dotPainter;
+    PainterRGB888 linePainter;
+};
+
+/** What a thread draws, and the context it draws with. */
+struct Worker
+{
+    ShapeField* field;
+    Rect band;
+    CanvasWidgetRenderer::Context context;
+    uint8_t* buffer;
+    unsigned bufferSize;
+    CanvasWidgetRenderer::MemoryReport report;
+};
+
+void drawBand(Worker& worker, int iterations)
+{
+    CanvasWidgetRenderer::setContext(&worker.context);
+    CanvasWidgetRenderer::setupBuffer(worker.buffer, worker.bufferSize);
+    for (int i = 0; i < iterations; i++)
+    {
+        worker.field->draw(worker.band);
+    }
+    worker.report = CanvasWidgetRenderer::getMemoryReport();
+    CanvasWidgetRenderer::setContext(0);
+}
+
+double drawThreaded(Worker* workers, int threads, int iterations)
+{
+    std::thread* running[MAX_THREADS];
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int t = 1; t < threads; t++)
+    {
+        running[t] = new std::thread(drawBand, std::ref(workers[t]), iterations);
+    }
+    drawBand(workers[0], iterations);
+    for (int t = 1; t < threads; t++)
+    {
+        running[t]->join();
+        delete running[t];
+    }
+    return elapsedNs(start);
+}
+} // namespace
+
+bool runCWRThreadBenchmark(BenchmarkHAL& hal, int threads, int iterations, unsigned bufferSize, bool json)
+{
+    threads = MAX(1, MIN(threads, MAX_THREADS));
+    const int16_t width = HAL::DISPLAY_WIDTH;
+    const int16_t height = HAL::DISPLAY_HEIGHT;
+
+    Worker* workers = new Worker[threads];
+    for (int t = 0; t < threads; t++)
+    {
+        const int16_t top = height * t / threads;
+        const int16_t bottom = height * (t + 1) / threads;
+        workers[t].field = new ShapeField(width, height);
+        workers[t].band = Rect(0, top, width, bottom - top);
+        workers[t].buffer = new uint8_t[bufferSize];
+        workers[t].bufferSize = bufferSize;
+    }
+
+    // Serial reference, every band drawn by the calling thread with its default context
+    hal.clearFrameBuffer();
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        for (int t = 0; t < threads; t++)
+        {
+            workers[t].field->draw(workers[t].band);
+        }
+    }
+    const double serialNs = elapsedNs(start);
+    const uint32_t serialHash = hal.hashFrameBuffer();
+
+    hal.clearFrameBuffer();
+    const double threadedNs = drawThreaded(workers, threads, iterations);
+    const uint32_t threadedHash = hal.hashFrameBuffer();
+
+    bool ok = threadedHash == serialHash;
+    unsigned minimumBytes = 0;
+    unsigned unsplitBytes = 0;
+    unsigned retries = 0;
+    for (int t = 0; t < threads; t++)
+    {
+        ok = ok && workers[t].report.skippedLines == 0;
+        minimumBytes = MAX(minimumBytes, workers[t].report.minimumBufferSize);
+        unsplitBytes = MAX(unsplitBytes, workers[t].report.unsplitBufferSize);
+        retries += workers[t].report.retries;
+    }
+
+    if (json)
+    {
+        printf("{\"threads\": %d, \"iterations\": %d, \"serial_ns\": %.0f, \"threaded_ns\": %.0f, "
+               "\"speedup\": %.2f, \"cwr_minimum_bytes\": %u, \"cwr_unsplit_bytes\": %u, \"cwr_retries\": %u, "
+               "\"hash\": \"%08x\", \"threaded_hash\": \"%08x\"}\n",
+               threads, iterations, serialNs, threadedNs, threadedNs > 0 ? serialNs / threadedNs : 0,
+               minimumBytes, unsplitBytes, retries, serialHash, threadedHash);
+    }
+    else
+    {
+        printf("CWR threads %d: serial %.2f ms, threaded %.2f ms, speedup %.2fx, %u-%u CWR bytes per context, %u retries, %08x %s\n",
+               threads, serialNs / 1e6 / iterations, threadedNs / 1e6 / iterations,
+               threadedNs > 0 ? serialNs / threadedNs : 0, minimumBytes, unsplitBytes, retries, threadedHash,
+               ok ? "ok" : "MISMATCH");
+    }
+
+    for (int t = 0; t < threads; t++)
+    {
+        delete workers[t].field;
+        delete[] workers[t].buffer;
+    }
+    delete[] workers;
+    return ok;
+}
@@ -0,0 +1,24 @@
+#ifndef CWRTHREADBENCHMARK_HPP
+#define CWRTHREADBENCHMARK_HPP
+
+#include <BenchmarkHAL.hpp>
+
+/**
+ * Rasterize a field of Circle and Line widgets from several threads at the
+ * same time. The framebuffer is split into horizontal bands, one per thread,
+ * and every thread draws its band with its own widgets, painters and
+ * CanvasWidgetRenderer context. The same bands are first drawn one after
+ * the other using the default context, and the framebuffers are compared.
+ *
+ * @param hal        The initialized benchmark HAL.
+ * @param threads    Number of threads.
+ * @param iterations Number of timed renders.
+ * @param bufferSize Size of the CWR buffer of each thread in bytes.
+ * @param json       Write the result as JSON.
+ *
+ * @return True if the threaded framebuffer matches the serial framebuffer
+ *         and no scanline was left undrawn for lack of CWR memory.
+ */
+bool runCWRThreadBenchmark(touchgfx::BenchmarkHAL& hal, int threads, int iterations, unsigned bufferSize, bool json);
+
+#endif // CWRTHREADBENCHMARK_HPP
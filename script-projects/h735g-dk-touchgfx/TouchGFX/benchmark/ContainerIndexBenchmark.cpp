@@ -0,0 +1,377 @@
+#include <ContainerIndexBenchmark.hpp>
+#include <BenchmarkUtils.hpp>
+#include <touchgfx/containers/IndexedContainer.hpp>
+#include <touchgfx/hal/HAL.hpp>
+#include <touchgfx/widgets/Widget.hpp>
+#include <chrono>
+#include <stdio.h>
+#include <vector>
+
+using namespace touchgfx;
+
+namespace
+{
+// Order sensitive hash of what the children are asked to do
+uint32_t traceHash = 2166136261U;
+uint32_t traceCount = 0;
+
+void trace(uint32_t value)
+{
+    traceHash = (traceHash ^ value) * 16777619U;
+}
+
+void trace(int id, const Rect& area, uint32_t what)
+{
+    trace(what);
+    trace((uint32_t)id);
+    trace((uint32_t)(uint16_t)area.x | ((uint32_t)(uint16_t)area.y << 16));
+    trace((uint32_t)(uint16_t)area.width | ((uint32_t)(uint16_t)area.height << 16));
+    traceCount++;
+}
+
+/** A child recording its draws and its place in the draw chain. */
+class Probe : public Widget
+{
+public:
+    Probe()
+        : id(0)
+    {
+    }
+
+    virtual void draw(const Rect& invalidatedArea) const
+    {
+        trace(id, invalidatedArea, 1);
+    }
+
+    virtual Rect getSolidRect() const
+    {
+        return Rect(0, 0, getWidth(), getHeight());
+    }
+
+    int id;
+
+protected:
+    virtual void setupDrawChain(const Rect& invalidatedArea, Drawable** nextPreviousElement)
+    {
+        trace(id, invalidatedArea, 2);
+        Widget::setupDrawChain(invalidatedArea, nextPreviousElement);
+    }
+};
+
+/** Gives access to the draw chain and the scrolling of a container. */
+template <class C>
+class List : public C
+{
+public:
+    void chain(const Rect& invalidatedArea)
+    {
+        Drawable* previous = 0;
+        C::setupDrawChain(invalidatedArea, &previous);
+    }
+
+    void scroll(int16_t deltaX, int16_t deltaY)
+    {
+        C::moveChildrenRelative(deltaX, deltaY);
+    }
+};
+
+// Size of the display of the board, and the tiles of the list
+const int WIDTH = 480;
+const int HEIGHT = 272;
+const int COLUMNS = 10;
+const int TILE_WIDTH = WIDTH / COLUMNS;
+const int TILE_HEIGHT = 24;
+
+const int TOUCHES = 16;
+const int AREAS = 8;
+const int RECTS_PER_FRAME = 8;
+
+/** The same children in a Container and an IndexedContainer. */
+class Lists
+{
+public:
+    Lists(int tiles)
+        : pool(tiles + tiles / 2 + 1), plainProbes(pool), indexedProbes(pool), added(pool, false), buffer(4 * pool + 4096)
+    {
+        plain.setPosition(0, 0, WIDTH, HEIGHT);
+        indexed.setPosition(0, 0, WIDTH, HEIGHT);
+        indexed.setIndexBuffer(&buffer[0], (uint32_t)(buffer.size() * sizeof(buffer[0])));
+        for (int i = 0; i < pool; i++)
+        {
+            plainProbes[i].id = i;
+            indexedProbes[i].id = i;
+        }
+        // The background behind the whole list, then a tile for every child
+        const int rows = (tiles + COLUMNS - 1) / COLUMNS;
+        setPosition(0, 0, 0, WIDTH, rows * TILE_HEIGHT);
+        add(0);
+        for (int i = 1; i <= tiles; i++)
+        {
+            setPosition(i, ((i - 1) % COLUMNS) * TILE_WIDTH, ((i - 1) / COLUMNS) * TILE_HEIGHT, TILE_WIDTH - 2, TILE_HEIGHT - 2);
+            add(i);
+        }
+        contentHeight = rows * TILE_HEIGHT;
+        scrollY = 0;
+    }
+
+    void setPosition(int i, int x, int y, int width, int height)
+    {
+        plainProbes[i].setPosition(x, y, width, height);
+        indexedProbes[i].setPosition(x, y, width, height);
+    }
+
+    void add(int i)
+    {
+        plain.add(plainProbes[i]);
+        indexed.add(indexedProbes[i]);
+        added[i] = true;
+    }
+
+    /** Makes a random change to both containers. */
+    void change()
+    {
+        const int i = randomBetween(0, pool - 1);
+        switch (nextRandom() % 7)
+        {
+        case 0:
+            if (added[i])
+            {
+                plain.remove(plainProbes[i]);
+                indexed.remove(indexedProbes[i]);
+                added[i] = false;
+            }
+            else
+            {
+                randomPlace(i);
+                add(i);
+            }
+            break;
+        case 1:
+            if (!added[i])
+            {
+                const int previous = randomBetween(-1, pool - 1);
+                randomPlace(i);
+                if (previous < 0 || !added[previous])
+                {
+                    plain.insert(0, plainProbes[i]);
+                    indexed.insert(0, indexedProbes[i]);
+                }
+                else
+                {
+                    plain.insert(&plainProbes[previous], plainProbes[i]);
+                    indexed.insert(&indexedProbes[previous], indexedProbes[i]);
+                }
+                added[i] = true;
+            }
+            break;
+        case 2:
+            // Moved by the application, which must tell the IndexedContainer
+            randomPlace(i);
+            indexed.invalidateIndex();
+            break;
+        case 3:
+            plainProbes[i].setVisible(!plainProbes[i].isVisible());
+            indexedProbes[i].setVisible(plainProbes[i].isVisible());
+            break;
+        case 4:
+            plainProbes[i].setTouchable(!plainProbes[i].isTouchable());
+            indexedProbes[i].setTouchable(plainProbes[i].isTouchable());
+            break;
+        case 5:
+            plain.setTouchable(!plain.isTouchable());
+            indexed.setTouchable(plain.isTouchable());
+            break;
+        default:
+            {
+                // Scroll, keeping some of the list on the display
+                const int deltaY = MAX(-contentHeight, MIN(0, scrollY + randomBetween(-HEIGHT, HEIGHT))) - scrollY;
+                const int deltaX = randomBetween(-4, 4);
+                plain.scroll(deltaX, deltaY);
+                indexed.scroll(deltaX, deltaY);
+                scrollY += deltaY;
+            }
+            break;
+        }
+    }
+
+    /** Places a child somewhere in the list, possibly empty or covering many tiles. */
+    void randomPlace(int i)
+    {
+        const int x = randomBetween(-TILE_WIDTH, WIDTH);
+        const int y = scrollY + randomBetween(-TILE_HEIGHT, contentHeight);
+        switch (nextRandom() % 8)
+        {
+        case 0:
+            setPosition(i, x, y, 0, randomBetween(0, TILE_HEIGHT));
+            break;
+        case 1:
+            setPosition(i, x, y, randomBetween(WIDTH / 2, WIDTH), randomBetween(HEIGHT / 2, HEIGHT));
+            break;
+        default:
+            setPosition(i, x, y, randomBetween(1, 2 * TILE_WIDTH), randomBetween(1, 2 * TILE_HEIGHT));
+            break;
+        }
+    }
+
+    /** Compares the children found by a touch. */
+    bool compareTouch(int16_t x, int16_t y, uint8_t fingerSize)
+    {
+        HAL::getInstance()->setFingerSize(fingerSize);
+        Drawable* plainLast = 0;
+        Drawable* indexedLast = 0;
+        plain.getLastChild(x, y, &plainLast);
+        indexed.getLastChild(x, y, &indexedLast);
+        if (idOf(plainLast, plain) != idOf(indexedLast, indexed))
+        {
+            return false;
+        }
+        int16_t plainX = 0;
+        int16_t plainY = 0;
+        int16_t indexedX = 0;
+        int16_t indexedY = 0;
+        plain.getLastChildNear(x, y, &plainLast, &plainX, &plainY);
+        indexed.getLastChildNear(x, y, &indexedLast, &indexedX, &indexedY);
+        return idOf(plainLast, plain) == idOf(indexedLast, indexed) && plainX == indexedX && plainY == indexedY;
+    }
+
+    /** Compares the draw chains and draws of an invalidated area. */
+    bool compareArea(const Rect& area)
+    {
+        traceHash = 2166136261U;
+        traceCount = 0;
+        plain.chain(area);
+        plain.draw(area);
+        const uint32_t plainHash = traceHash;
+        const uint32_t plainCount = traceCount;
+        traceHash = 2166136261U;
+        traceCount = 0;
+        indexed.chain(area);
+        indexed.draw(area);
+        return plainHash == traceHash && plainCount == traceCount;
+    }
+
+    bool compare()
+    {
+        bool ok = indexed.isIndexed();
+        for (int i = 0; i < TOUCHES; i++)
+        {
+            const uint8_t fingerSizes[3] = { 1, 9, 15 };
+            ok = compareTouch(randomBetween(-10, WIDTH + 10), randomBetween(-10, HEIGHT + 10), fingerSizes[nextRandom() % 3]) && ok;
+        }
+        for (int i = 0; i < AREAS; i++)
+        {
+            const Rect area(randomBetween(-20, WIDTH), randomBetween(-20, HEIGHT), randomBetween(1, 120), randomBetween(1, 120));
+            ok = compareArea(area) && ok;
+        }
+        return ok;
+    }
+
+    int idOf(Drawable* d, Drawable& container)
+    {
+        return d == 0 ? -2 : d == &container ? -1 : static_cast<Probe*>(d)->id;
+    }
+
+    int pool;
+    std::vector<Probe> plainProbes;
+    std::vector<Probe> indexedProbes;
+    std::vector<bool> added;
+    std::vector<uint32_t> buffer;
+    List<Container> plain;
+    List<IndexedContainer> indexed;
+    int contentHeight;
+    int scrollY;
+};
+
+/** Time per touch sampled around a finger of 9 pixels. */
+template <class C>
+double timeTouches(C& container, int iterations)
+{
+    HAL::getInstance()->setFingerSize(9);
+    seedRandom(777);
+    uint32_t found = 0;
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        Drawable* last = 0;
+        int16_t fingerX = 0;
+        int16_t fingerY = 0;
+        container.getLastChildNear(randomBetween(0, WIDTH - 1), randomBetween(0, HEIGHT - 1), &last, &fingerX, &fingerY);
+        found += last ? 1 : 0;
+    }
+    const double ns = elapsedNs(start);
+    trace(found);
+    return ns / iterations;
+}
+
+/** Time per frame of small invalidated areas, setting up the draw chain of each. */
+template <class C>
+double timeFrames(C& container, int iterations)
+{
+    seedRandom(888);
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        for (int j = 0; j < RECTS_PER_FRAME; j++)
+        {
+            container.chain(Rect(randomBetween(0, WIDTH - 60), randomBetween(0, HEIGHT - 40), 60, 40));
+        }
+    }
+    return elapsedNs(start) / iterations;
+}
+} // namespace
+
+bool runContainerIndexBenchmark(int iterations, bool json)
+{
+    const int childCounts[] = { 50, 100, 200, 500, 1000 };
+    const uint8_t fingerSize = HAL::getInstance()->getFingerSize();
+    bool ok = true;
+
+    if (json)
+    {
+        printf("{\"scene\": \"container_index\", \"iterations\": %d, \"results\": [", iterations);
+    }
+    else
+    {
+        printf("%-30s %8s %12s %12s %12s %12s  %s\n", "container_index", "children", "touch ns", "indexed", "frame ns", "indexed", "");
+    }
+    for (unsigned i = 0; i < sizeof(childCounts) / sizeof(childCounts[0]); i++)
+    {
+        const int tiles = childCounts[i];
+
+        // The containers must agree after every random change
+        seedRandom(12345 + tiles);
+        bool same = true;
+        {
+            Lists lists(tiles);
+            same = lists.compare();
+            for (int j = 0; j < iterations; j++)
+            {
+                lists.change();
+                same = lists.compare() && same;
+            }
+        }
+
+        Lists lists(tiles);
+        const double plainTouchNs = timeTouches(lists.plain, iterations * 100);
+        const double indexedTouchNs = timeTouches(lists.indexed, iterations * 100);
+        const double plainFrameNs = timeFrames(lists.plain, iterations * 10);
+        const double indexedFrameNs = timeFrames(lists.indexed, iterations * 10);
+        ok = ok && same;
+
+        if (json)
+        {
+            printf("%s\n  {\"children\": %d, \"touch_ns\": %.1f, \"indexed_touch_ns\": %.1f, \"frame_ns\": %.1f, \"indexed_frame_ns\": %.1f, \"ok\": %s}",
+                   i == 0 ? "" : ",", tiles + 1, plainTouchNs, indexedTouchNs, plainFrameNs, indexedFrameNs, same ? "true" : "false");
+        }
+        else
+        {
+            printf("%-30s %8d %12.1f %12.1f %12.1f %12.1f  %s\n", "", tiles + 1, plainTouchNs, indexedTouchNs, plainFrameNs, indexedFrameNs, same ? "ok" : "FAILED");
+        }
+    }
+    if (json)
+    {
+        printf("\n]}\n");
+    }
+    HAL::getInstance()->setFingerSize(fingerSize);
+    return ok;
+}
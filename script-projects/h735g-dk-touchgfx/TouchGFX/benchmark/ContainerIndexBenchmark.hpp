@@ -0,0 +1,21 @@
+#ifndef CONTAINERINDEXBENCHMARK_HPP
+#define CONTAINERINDEXBENCHMARK_HPP
+
+/**
+ * Fill a Container and an IndexedContainer with the same list screen of
+ * tiles, from 50 to 1000 children over a full-size background, with some
+ * children hidden, overlapping, empty or touchable. After random adds,
+ * inserts, removals, moves and scrolls, random touches must find the same
+ * child through getLastChild() and getLastChildNear(), and random
+ * invalidated areas must give the same draw chain and draws, in the same
+ * order. Reports the time per touch and per frame of invalidated areas
+ * against the number of children.
+ *
+ * @param iterations Number of random changes for every number of children.
+ * @param json       Write the result as JSON.
+ *
+ * @return True if the IndexedContainer always matches the Container.
+ */
+bool runContainerIndexBenchmark(int iterations, bool json);
+
+#endif // CONTAINERINDEXBENCHMARK_HPP
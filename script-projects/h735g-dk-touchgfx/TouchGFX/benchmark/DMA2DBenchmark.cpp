@@ -0,0 +1,201 @@
+#include <DMA2DBenchmark.hpp>
+#include <BenchmarkUtils.hpp>
+#include <DMA2DCommandList.hpp>
+#include <MockDMA2D.hpp>
+#include <touchgfx/Bitmap.hpp>
+#include <chrono>
+#include <stdio.h>
+
+using namespace touchgfx;
+
+namespace
+{
+/** Gives access to the consumer side of the queue, which DMA_Interface normally drives. */
+class BenchmarkCommandList : public DMA2DCommandList
+{
+public:
+    BenchmarkCommandList(Command* mem, atomic_t n)
+        : DMA2DCommandList(mem, n)
+    {
+    }
+
+    const BlitOp& firstOp()
+    {
+        return *first();
+    }
+
+    void completed()
+    {
+        pop();
+    }
+};
+
+/** Same layout as the CLUTs of generated L8 bitmaps: format, size, then the colors. */
+struct Clut
+{
+    uint16_t format;
+    uint16_t size;
+    uint32_t data[16];
+};
+
+const Clut clutA = { Bitmap::CLUT_FORMAT_L8_ARGB8888, 16, { 0 } };
+const Clut clutB = { Bitmap::CLUT_FORMAT_L8_RGB888, 16, { 0 } };
+// Colors change every frame at the same address, like the CLUT of a dynamic bitmap
+Clut dynamicClut = { Bitmap::CLUT_FORMAT_L8_ARGB8888, 16, { 0 } };
+
+// Never read or written, only their addresses end up in the registers
+uint16_t sourceBuffer[64 * 64];
+uint16_t frameBuffer[480 * 272 * 3 / 2];
+
+const int OPS_PER_FRAME = 64;
+
+/**
+ * A frame of BlitOps resembling a screen with a background, icons, text and
+ * L8 images sharing a few CLUTs.
+ */
+void buildFrame(BlitOp* ops, int& l8Ops)
+{
+    l8Ops = 0;
+    for (int i = 0; i < OPS_PER_FRAME; i++)
+    {
+        BlitOp& op = ops[i];
+        op = BlitOp();
+        op.pSrc = sourceBuffer;
+        op.pDst = frameBuffer + (i % 16) * 480 * 3 / 2;
+        op.nSteps = 32;
+        op.nLoops = 32;
+        op.srcLoopStride = 32;
+        op.dstLoopStride = 480;
+        op.alpha = 255;
+        op.dstFormat = Bitmap::RGB888;
+        op.srcFormat = Bitmap::RGB888;
+
+        if (i == 0)
+        {
+            op.operation = BLIT_OP_FILL;
+            op.nSteps = 480;
+            op.nLoops = 272;
+            op.color = 0x203040;
+        }
+        else if (i < 8)
+        {
+            op.operation = BLIT_OP_COPY_ARGB8888;
+            op.srcFormat = Bitmap::ARGB8888;
+        }
+        else if (i < 40)
+        {
+            // Runs of L8 images using the same CLUT, the first and last using the dynamic CLUT
+            op.operation = BLIT_OP_COPY_L8;
+            op.srcFormat = Bitmap::L8;
+            op.pClut = reinterpret_cast<const uint8_t*>(i < 16 || i >= 32 ? &dynamicClut : ((i / 8) % 2 ? &clutB : &clutA));
+            op.alpha = (i % 3) ? 255 : 128;
+            l8Ops++;
+        }
+        else if (i < 60)
+        {
+            op.operation = BLIT_OP_COPY_A4;
+            op.srcFormat = Bitmap::A4;
+            op.color = 0xFFFFFF;
+            op.nSteps = 12;
+            op.nLoops = 16;
+        }
+        else
+        {
+            op.operation = BLIT_OP_FILL_WITH_ALPHA;
+            op.color = 0x000000;
+            op.alpha = 96;
+        }
+    }
+}
+
+/** The colors of the dynamic CLUT loaded by the DMA2D, and the transfers which used older colors. */
+struct ClutCheck
+{
+    uint32_t loadedColors;
+    uint32_t staleTransfers;
+};
+
+/** Let the mock make progress, doing what the DMA2D interrupt handler does. */
+void service(BenchmarkCommandList& list, MockDMA2D& dma2d, bool& running, ClutCheck& check)
+{
+    switch (dma2d.step())
+    {
+    case MockDMA2D::CLUT_LOADED:
+        // The CLUT was loaded for the first BlitOp in the queue
+        check.loadedColors = list.firstOp().pClut == reinterpret_cast<const uint8_t*>(&dynamicClut) ? dynamicClut.data[0] : ~0u;
+        list.clutLoaded(DMA2D);
+        break;
+    case MockDMA2D::TRANSFER_COMPLETE:
+        if (list.firstOp().pClut == reinterpret_cast<const uint8_t*>(&dynamicClut) && check.loadedColors != dynamicClut.data[0])
+        {
+            check.staleTransfers++;
+        }
+        list.completed();
+        running = !list.isEmpty();
+        if (running)
+        {
+            list.start(list.firstOp(), DMA2D);
+        }
+        break;
+    case MockDMA2D::IDLE:
+        break;
+    }
+}
+} // namespace
+
+bool runDMA2DBenchmark(int iterations, bool json)
+{
+    static DMA2DCommandList::Command storage[96];
+    BenchmarkCommandList list(storage, sizeof(storage) / sizeof(storage[0]));
+    MockDMA2D dma2d;
+
+    BlitOp ops[OPS_PER_FRAME];
+    int l8Ops = 0;
+    buildFrame(ops, l8Ops);
+
+    bool running = false;
+    ClutCheck check = { ~0u, 0 };
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        // New colors at the same address, announced at the start of the frame like TouchGFXHAL::beginFrame() does
+        dynamicClut.data[0] = i;
+        list.clutChanged();
+        for (int j = 0; j < OPS_PER_FRAME; j++)
+        {
+            while (list.isFull())
+            {
+                service(list, dma2d, running, check);
+            }
+            list.pushCopyOf(ops[j]);
+            if (!running)
+            {
+                running = true;
+                list.start(list.firstOp(), DMA2D);
+            }
+        }
+        while (running)
+        {
+            service(list, dma2d, running, check);
+        }
+    }
+    const double totalNs = elapsedNs(start);
+
+    const uint64_t totalOps = (uint64_t)OPS_PER_FRAME * iterations;
+    const bool ok = dma2d.getTransfers() == totalOps && dma2d.getErrors() == 0 && check.staleTransfers == 0;
+
+    if (json)
+    {
+        printf("{\"scene\": \"dma2d_command_list\", \"iterations\": %d, \"blitops\": %llu, \"l8_blitops\": %llu, "
+               "\"clut_loads\": %u, \"stale_clut_blitops\": %u, \"ns_per_blitop\": %.1f, \"ok\": %s, \"hash\": \"%08x\"}\n",
+               iterations, (unsigned long long)totalOps, (unsigned long long)l8Ops * iterations,
+               dma2d.getClutLoads(), (unsigned)check.staleTransfers, totalNs / totalOps, ok ? "true" : "false", dma2d.getHash());
+    }
+    else
+    {
+        printf("%-30s %8llu blitops %8llu L8 %8u CLUT loads %6u stale %8.1f ns/blitop  %s  %08x\n",
+               "dma2d_command_list", (unsigned long long)totalOps, (unsigned long long)l8Ops * iterations,
+               dma2d.getClutLoads(), (unsigned)check.staleTransfers, totalNs / totalOps, ok ? "ok" : "FAILED", dma2d.getHash());
+    }
+    return ok;
+}
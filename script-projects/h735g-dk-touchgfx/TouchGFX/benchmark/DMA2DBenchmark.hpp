@@ -0,0 +1,19 @@
+#ifndef DMA2DBENCHMARK_HPP
+#define DMA2DBENCHMARK_HPP
+
+/**
+ * Push a mix of BlitOps through DMA2DCommandList, completing them on
+ * MockDMA2D, and report the CPU time spent per BlitOp together with the
+ * number of CLUT loads. One of the CLUTs gets new colors at the same address
+ * every frame, announced with DMA2DCommandList::clutChanged().
+ *
+ * @param iterations Number of times the BlitOp mix is queued.
+ * @param json       Write the result as JSON.
+ *
+ * @return True if every BlitOp was transferred, no transfer was started
+ *         before its CLUT was loaded and none used the colors of an older
+ *         frame.
+ */
+bool runDMA2DBenchmark(int iterations, bool json);
+
+#endif // DMA2DBENCHMARK_HPP
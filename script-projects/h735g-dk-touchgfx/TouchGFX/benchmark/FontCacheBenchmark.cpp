@@ -0,0 +1,524 @@
+#include <FontCacheBenchmark.hpp>
+#include <BenchmarkUtils.hpp>
+#include <gui/common/IndexedCachedFont.hpp>
+#include <gui/common/IndexedFontCache.hpp>
+#include <gui/common/KerningLookup.hpp>
+#include <texts/TextKeysAndLanguages.hpp>
+#include <chrono>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace touchgfx;
+
+namespace
+{
+const int NUMBER_OF_GLYPHS = 5000;
+const Unicode::UnicodeChar FIRST_UNICODE = 0x4E00;
+const int GLYPH_WIDTH = 8;
+const int GLYPH_HEIGHT = 8;
+const int GLYPH_SIZE = GLYPH_WIDTH * GLYPH_HEIGHT / 2; // 4bpp, as the fonts of the text database
+const uint32_t CACHE_SIZE = 512 * 1024;
+// A cached glyph is stored as a 16 byte GlyphNode, a link and the pixel data
+const int CACHED_GLYPH_SIZE = 16 + 4 + GLYPH_SIZE;
+// Time to set up a read, as for a command to an SD card
+const int READ_LATENCY_US = 20;
+
+// The first glyphs have kerning pairs, as many as the 11 bit kerning table position allows
+const int KERNED_GLYPHS = 128;
+const int PAIRS_PER_GLYPH = 16;
+
+// Layout of the binary font read by FontCache
+const uint32_t OFFSET_TO_TABLE = 64;
+const uint32_t OFFSET_TO_KERNING = OFFSET_TO_TABLE + NUMBER_OF_GLYPHS * sizeof(GlyphNode);
+const uint32_t OFFSET_TO_GLYPHS = OFFSET_TO_KERNING + KERNED_GLYPHS * PAIRS_PER_GLYPH * sizeof(KerningNode);
+
+uint8_t pixel(int glyph, int index)
+{
+    return (uint8_t)(glyph * 31 + index * 7);
+}
+
+/** The j'th kerning pair of a kerned glyph, sorted by the previous character. */
+KerningNode kerningPair(int glyph, int j)
+{
+    KerningNode pair;
+    pair.unicodePrevChar = FIRST_UNICODE + (Unicode::UnicodeChar)(glyph % 7 + j * 300);
+    pair.distance = (int8_t)(-1 - (glyph + j) % 5);
+    return pair;
+}
+
+std::vector<uint8_t> buildFont()
+{
+    std::vector<uint8_t> data(OFFSET_TO_GLYPHS + NUMBER_OF_GLYPHS * GLYPH_SIZE);
+    BinaryFontData header;
+    memset(&header, 0, sizeof(header));
+    header.sizeOfFontData = (uint32_t)data.size();
+    header.offsetToTable = OFFSET_TO_TABLE;
+    header.offsetToKerning = OFFSET_TO_KERNING;
+    header.offsetToGlyphs = OFFSET_TO_GLYPHS;
+    header.numberOfGlyphs = NUMBER_OF_GLYPHS;
+    header.height = GLYPH_HEIGHT;
+    header.bitsPerPixel = 4;
+    memcpy(&data[0], &header, sizeof(header));
+
+    for (int i = 0; i < NUMBER_OF_GLYPHS; i++)
+    {
+        GlyphNode node;
+        memset(&node, 0, sizeof(node));
+        node.dataOffset = i * GLYPH_SIZE;
+        node.unicode = FIRST_UNICODE + i;
+        node._width = GLYPH_WIDTH;
+        node._height = GLYPH_HEIGHT;
+        node._advance = GLYPH_WIDTH + 1;
+        if (i < KERNED_GLYPHS)
+        {
+            const int position = i * PAIRS_PER_GLYPH;
+            node._kerningTablePos = position & 0xFF;
+            node.flags = (position >> 8) & GLYPH_DATA_KERNINGTABLEPOS_BIT8_10;
+            node.kerningTableSize = PAIRS_PER_GLYPH;
+            for (int j = 0; j < PAIRS_PER_GLYPH; j++)
+            {
+                const KerningNode pair = kerningPair(i, j);
+                memcpy(&data[OFFSET_TO_KERNING + (position + j) * sizeof(KerningNode)], &pair, sizeof(pair));
+            }
+        }
+        memcpy(&data[OFFSET_TO_TABLE + i * sizeof(GlyphNode)], &node, sizeof(node));
+        for (int j = 0; j < GLYPH_SIZE; j++)
+        {
+            data[OFFSET_TO_GLYPHS + i * GLYPH_SIZE + j] = pixel(i, j);
+        }
+    }
+    return data;
+}
+
+/** Serves a binary font from memory, as a FontDataReader reading memory mapped flash would. */
+class MemoryFontDataReader : public FontDataReader
+{
+public:
+    MemoryFontDataReader(const std::vector<uint8_t>& font)
+        : data(font), position(0)
+    {
+    }
+
+    virtual void open()
+    {
+    }
+
+    virtual void close()
+    {
+    }
+
+    virtual void setPosition(uint32_t newPosition)
+    {
+        position = newPosition;
+    }
+
+    virtual void readData(void* out, uint32_t numberOfBytes)
+    {
+        memcpy(out, &data[position], numberOfBytes);
+        position += numberOfBytes;
+    }
+
+private:
+    const std::vector<uint8_t>& data;
+    uint32_t position;
+};
+
+/**
+ * Reads a binary font from a file, as a FontDataReader reading an SD card would. Every read
+ * waits READ_LATENCY_US first. Asynchronous reads are done on a thread.
+ */
+class FileFontDataReader : public AsyncFontDataReader
+{
+public:
+    FileFontDataReader(const char* fileName, bool asynchronous)
+        : name(fileName), async(asynchronous), fd(-1), position(0), reads(0), seeks(0), failed(false), thread(0)
+    {
+    }
+
+    virtual void open()
+    {
+        fd = ::open(name, O_RDONLY);
+        failed = failed || fd < 0;
+    }
+
+    virtual void close()
+    {
+        ::close(fd);
+        fd = -1;
+    }
+
+    virtual void setPosition(uint32_t newPosition)
+    {
+        seeks++;
+        position = newPosition;
+    }
+
+    virtual void readData(void* out, uint32_t numberOfBytes)
+    {
+        read(out, numberOfBytes, position);
+        position += numberOfBytes;
+    }
+
+    virtual void startReadData(void* out, uint32_t numberOfBytes)
+    {
+        if (!async)
+        {
+            readData(out, numberOfBytes);
+            return;
+        }
+        thread = new std::thread(&FileFontDataReader::read, this, out, numberOfBytes, position);
+        position += numberOfBytes;
+    }
+
+    virtual void waitForData()
+    {
+        if (thread)
+        {
+            thread->join();
+            delete thread;
+            thread = 0;
+        }
+    }
+
+    const char* name;
+    bool async;
+    int fd;
+    uint32_t position;
+    uint32_t reads;
+    uint32_t seeks;
+    bool failed;
+
+private:
+    void read(void* out, uint32_t numberOfBytes, uint32_t offset)
+    {
+        reads++;
+        std::this_thread::sleep_for(std::chrono::microseconds(READ_LATENCY_US));
+        failed = failed || pread(fd, out, numberOfBytes, offset) != (ssize_t)numberOfBytes;
+    }
+
+    std::thread* thread;
+};
+
+/** Checks that every step'th glyph, and no other, is cached with its own data. */
+bool verifyCache(const IndexedFontCache& cache, FontId fontId, int step)
+{
+    for (int i = 0; i < NUMBER_OF_GLYPHS; i++)
+    {
+        const GlyphNode* node = cache.getGlyph(FIRST_UNICODE + i, fontId);
+        if (i % step != 0)
+        {
+            if (node)
+            {
+                return false;
+            }
+            continue;
+        }
+        if (!node || node->unicode != FIRST_UNICODE + i || !IndexedFontCache::isCached(node))
+        {
+            return false;
+        }
+        for (int j = 0; j < GLYPH_SIZE; j++)
+        {
+            if (IndexedFontCache::getPixelData(node)[j] != pixel(i, j))
+            {
+                return false;
+            }
+        }
+    }
+    return cache.getGlyph(FIRST_UNICODE + NUMBER_OF_GLYPHS, fontId) == 0 && cache.getGlyph(FIRST_UNICODE, fontId + 1) == 0;
+}
+
+/** Makes a string of every step'th glyph in a scrambled order. */
+std::vector<Unicode::UnicodeChar> makeString(int step)
+{
+    std::vector<Unicode::UnicodeChar> string;
+    for (int i = 0; i < NUMBER_OF_GLYPHS; i++)
+    {
+        const int glyph = (i * 2039) % NUMBER_OF_GLYPHS;
+        if (glyph % step == 0)
+        {
+            string.push_back(FIRST_UNICODE + (Unicode::UnicodeChar)glyph);
+        }
+    }
+    string.push_back(0);
+    return string;
+}
+
+/** Finds a glyph by walking the glyphs in the order they were cached, as the old per font lists did. */
+const GlyphNode* findLinear(const uint8_t* first, const uint8_t* top, Unicode::UnicodeChar unicode)
+{
+    for (const uint8_t* p = first; p < top; p += CACHED_GLYPH_SIZE)
+    {
+        const GlyphNode* node = reinterpret_cast<const GlyphNode*>(p);
+        if (node->unicode == unicode)
+        {
+            return node;
+        }
+    }
+    return 0;
+}
+
+/** Finds a kerning pair by scanning the pairs of the glyph, as the fonts did. */
+int8_t scanKerning(Unicode::UnicodeChar prevChar, const GlyphNode* glyph, const KerningNode* kerningData)
+{
+    const KerningNode* kerndata = kerningData + glyph->kerningTablePos();
+    for (uint16_t i = glyph->kerningTableSize; i > 0; i--, kerndata++)
+    {
+        if (prevChar == kerndata->unicodePrevChar)
+        {
+            return kerndata->distance;
+        }
+        if (prevChar < kerndata->unicodePrevChar)
+        {
+            break;
+        }
+    }
+    return 0;
+}
+
+/** Looks up every kerning pair of the kerned glyphs, and as many pairs not in the font. */
+template <class Lookup>
+double timeKerning(int iterations, const GlyphNode* const* glyphs, Lookup lookup, int& sum)
+{
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int n = 0; n < iterations; n++)
+    {
+        for (int i = 0; i < KERNED_GLYPHS; i++)
+        {
+            for (int j = 0; j < PAIRS_PER_GLYPH; j++)
+            {
+                const Unicode::UnicodeChar prevChar = kerningPair(i, j).unicodePrevChar;
+                sum += lookup(prevChar, glyphs[i]) + lookup(prevChar + 1, glyphs[i]);
+            }
+        }
+    }
+    return elapsedNs(start) / ((double)iterations * KERNED_GLYPHS * PAIRS_PER_GLYPH * 2);
+}
+
+struct ScanLookup
+{
+    const KerningNode* kerning;
+    int8_t operator()(Unicode::UnicodeChar prevChar, const GlyphNode* glyph) const
+    {
+        return scanKerning(prevChar, glyph, kerning);
+    }
+};
+
+struct FontLookup
+{
+    const Font* font;
+    int8_t operator()(Unicode::UnicodeChar prevChar, const GlyphNode* glyph) const
+    {
+        return font->getKerning(prevChar, glyph);
+    }
+};
+
+struct TableLookup
+{
+    const KerningLookup* lookup;
+    const KerningNode* kerning;
+    int8_t operator()(Unicode::UnicodeChar prevChar, const GlyphNode* glyph) const
+    {
+        return lookup->getKerning(prevChar, glyph, kerning);
+    }
+};
+
+/**
+ * Caches the kerned glyphs for an IndexedCachedFont, loading the kerning table into the
+ * cache, checks the kerning of every pair, and times the lookup.
+ */
+bool runKerning(const std::vector<uint8_t>& font, int iterations, uint8_t* memory, bool json)
+{
+    MemoryFontDataReader reader(font);
+    IndexedFontCache cache;
+    cache.setReader(&reader);
+    cache.setMemory(memory, CACHE_SIZE);
+    const TypedText text(T___SINGLEUSE_FZ10);
+    IndexedCachedFont cachedFont;
+    cache.initializeCachedFont(text, &cachedFont, false, true);
+
+    std::vector<Unicode::UnicodeChar> string;
+    for (int i = 0; i < KERNED_GLYPHS; i++)
+    {
+        string.push_back(FIRST_UNICODE + (Unicode::UnicodeChar)i);
+    }
+    string.push_back(0);
+    bool ok = cache.cacheString(text, &string[0]);
+
+    // The kerning pairs of the font, in a hash table
+    const GlyphNode* table = reinterpret_cast<const GlyphNode*>(&font[OFFSET_TO_TABLE]);
+    const KerningNode* kerning = reinterpret_cast<const KerningNode*>(&font[OFFSET_TO_KERNING]);
+    std::vector<uint32_t> hashMemory(KerningLookup::getMemorySize(KERNED_GLYPHS * PAIRS_PER_GLYPH) / sizeof(uint32_t) + 1);
+    KerningLookup hash;
+    ok = ok && hash.setup(reinterpret_cast<uint8_t*>(&hashMemory[0]), (uint32_t)hashMemory.size() * sizeof(uint32_t), KERNED_GLYPHS * PAIRS_PER_GLYPH);
+    for (int i = 0; i < NUMBER_OF_GLYPHS; i++)
+    {
+        hash.add(table[i].unicode, kerning + table[i].kerningTablePos(), table[i].kerningTableSize);
+    }
+
+    const GlyphNode* glyphs[KERNED_GLYPHS];
+    for (int i = 0; i < KERNED_GLYPHS && ok; i++)
+    {
+        glyphs[i] = cache.getGlyph(FIRST_UNICODE + i, text.getFontId());
+        ok = glyphs[i] != 0;
+        for (int j = 0; j < PAIRS_PER_GLYPH && ok; j++)
+        {
+            const KerningNode pair = kerningPair(i, j);
+            ok = cachedFont.getKerning(pair.unicodePrevChar, glyphs[i]) == pair.distance
+                 && cachedFont.getKerning(pair.unicodePrevChar + 1, glyphs[i]) == 0
+                 && hash.getKerning(pair.unicodePrevChar, glyphs[i], 0) == pair.distance
+                 && hash.getKerning(pair.unicodePrevChar + 1, glyphs[i], 0) == 0;
+        }
+    }
+    if (!ok)
+    {
+        printf("%-30s FAILED\n", "kerning");
+        return false;
+    }
+
+    int sum[4] = { 0, 0, 0, 0 };
+    const KerningLookup unhashed;
+    const ScanLookup scan = { kerning };
+    const TableLookup search = { &unhashed, kerning };
+    const TableLookup hashed = { &hash, 0 };
+    const FontLookup cached = { &cachedFont };
+    const double scanNs = timeKerning(iterations, glyphs, scan, sum[0]);
+    const double searchNs = timeKerning(iterations, glyphs, search, sum[1]);
+    const double hashNs = timeKerning(iterations, glyphs, hashed, sum[2]);
+    const double cachedNs = timeKerning(iterations, glyphs, cached, sum[3]);
+    ok = sum[0] == sum[1] && sum[0] == sum[2] && sum[0] == sum[3];
+
+    if (json)
+    {
+        printf(", \"kerning_pairs\": %d, \"kerning_scan_ns\": %.1f, \"kerning_search_ns\": %.1f, \"kerning_hash_ns\": %.1f, \"kerning_cached_font_ns\": %.1f",
+               KERNED_GLYPHS * PAIRS_PER_GLYPH, scanNs, searchNs, hashNs, cachedNs);
+    }
+    else
+    {
+        printf("%-30s %8.1f ns/pair\n", "kerning_linear_scan", scanNs);
+        printf("%-30s %8.1f ns/pair\n", "kerning_search", searchNs);
+        printf("%-30s %8.1f ns/pair\n", "kerning_hash", hashNs);
+        printf("%-30s %8.1f ns/pair  %s\n", "kerning_cached_font", cachedNs, ok ? "ok" : "FAILED");
+    }
+    return ok;
+}
+
+bool runLoad(const char* name, const char* fileName, bool async, int step, uint8_t* memory, bool json, bool& first)
+{
+    FileFontDataReader reader(fileName, async);
+    IndexedFontCache cache;
+    cache.setReader(&reader);
+    cache.setMemory(memory, CACHE_SIZE);
+    const TypedText text(T___SINGLEUSE_FZ10);
+    const std::vector<Unicode::UnicodeChar> string = makeString(step);
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    bool ok = cache.cacheString(text, &string[0]);
+    const double cacheNs = elapsedNs(start);
+    ok = ok && !reader.failed && verifyCache(cache, text.getFontId(), step);
+
+    if (json)
+    {
+        printf("%s\n  {\"name\": \"%s\", \"glyphs\": %d, \"cache_ms\": %.3f, \"reads\": %u, \"seeks\": %u, \"memory_usage\": %u, \"ok\": %s}",
+               first ? "" : ",", name, (int)string.size() - 1, cacheNs / 1e6, reader.reads, reader.seeks, cache.getMemoryUsage(), ok ? "true" : "false");
+    }
+    else
+    {
+        printf("%-30s %8d glyphs  %8.3f ms  %6u reads  %6u seeks  %8u bytes  %s\n",
+               name, (int)string.size() - 1, cacheNs / 1e6, reader.reads, reader.seeks, cache.getMemoryUsage(), ok ? "ok" : "FAILED");
+    }
+    first = false;
+    return ok;
+}
+} // namespace
+
+bool runFontCacheBenchmark(int iterations, bool json)
+{
+    const std::vector<uint8_t> font = buildFont();
+    std::vector<uint8_t> memory(CACHE_SIZE);
+
+    char fileName[] = "/tmp/touchgfx_fontXXXXXX";
+    const int fd = mkstemp(fileName);
+    bool ok = fd >= 0 && write(fd, &font[0], font.size()) == (ssize_t)font.size();
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+
+    if (json)
+    {
+        printf("{\"scene\": \"font_cache\", \"loads\": [");
+    }
+    bool first = true;
+    ok = ok && runLoad("load_all", fileName, false, 1, &memory[0], json, first);
+    ok = ok && runLoad("load_all_async", fileName, true, 1, &memory[0], json, first);
+    ok = ok && runLoad("load_every_third", fileName, false, 3, &memory[0], json, first);
+    ok = ok && runLoad("load_every_third_async", fileName, true, 3, &memory[0], json, first);
+    unlink(fileName);
+
+    // Look up all glyphs cached from memory
+    MemoryFontDataReader reader(font);
+    IndexedFontCache cache;
+    cache.setReader(&reader);
+    cache.setMemory(&memory[0], CACHE_SIZE);
+    const TypedText text(T___SINGLEUSE_FZ10);
+    const FontId fontId = text.getFontId();
+    const std::vector<Unicode::UnicodeChar> order = makeString(1);
+    ok = ok && cache.cacheString(text, &order[0]) && verifyCache(cache, fontId, 1);
+
+    const uint8_t* firstGlyph = 0;
+    const uint8_t* top = 0;
+    for (int i = 0; i < NUMBER_OF_GLYPHS && ok; i++)
+    {
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(cache.getGlyph(FIRST_UNICODE + i, fontId));
+        firstGlyph = (firstGlyph == 0 || p < firstGlyph) ? p : firstGlyph;
+        top = (p + CACHED_GLYPH_SIZE > top) ? p + CACHED_GLYPH_SIZE : top;
+    }
+
+    const double lookups = (double)iterations * NUMBER_OF_GLYPHS;
+    uint32_t found = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        for (int j = 0; j < NUMBER_OF_GLYPHS; j++)
+        {
+            found += cache.getGlyph(order[j], fontId) != 0;
+        }
+    }
+    const double indexNs = elapsedNs(start) / lookups;
+    ok = ok && found == (uint32_t)lookups;
+
+    found = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        for (int j = 0; j < NUMBER_OF_GLYPHS; j++)
+        {
+            found += findLinear(firstGlyph, top, order[j]) != 0;
+        }
+    }
+    const double linearNs = elapsedNs(start) / lookups;
+    ok = ok && found == (uint32_t)lookups;
+
+    if (json)
+    {
+        printf("\n], \"index_ns_per_lookup\": %.1f, \"linear_ns_per_lookup\": %.1f", indexNs, linearNs);
+    }
+    else
+    {
+        printf("%-30s %8.1f ns/lookup\n", "lookup_hash_index", indexNs);
+        printf("%-30s %8.1f ns/lookup  %s\n", "lookup_linear_walk", linearNs, ok ? "ok" : "FAILED");
+    }
+
+    ok = runKerning(font, iterations, &memory[0], json) && ok;
+    if (json)
+    {
+        printf(", \"ok\": %s}\n", ok ? "true" : "false");
+    }
+    return ok;
+}
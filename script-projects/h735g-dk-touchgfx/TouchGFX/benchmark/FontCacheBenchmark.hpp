@@ -0,0 +1,21 @@
+#ifndef FONTCACHEBENCHMARK_HPP
+#define FONTCACHEBENCHMARK_HPP
+
+/**
+ * Cache glyphs of a synthetic 5000 glyph binary font in an IndexedFontCache
+ * and in the generated FontCache. The font is written to a temporary file
+ * and loaded through a file backed FontDataReader, reading synchronously and
+ * with asynchronous reads on a thread, reporting the time and the number of
+ * reads and seeks. The cached glyphs are then looked up with getGlyph() of
+ * both caches, and the kerning pairs with IndexedCachedFont and
+ * KerningLookup. Verifies the GlyphNode and pixel data of every cached
+ * glyph.
+ *
+ * @param iterations Number of lookups of every glyph.
+ * @param json       Write the result as JSON.
+ *
+ * @return True if every glyph was cached and found with the right data.
+ */
+bool runFontCacheBenchmark(int iterations, bool json);
+
+#endif // FONTCACHEBENCHMARK_HPP
@@ -0,0 +1,280 @@
+#include <GlyphRunBenchmark.hpp>
+#include <BenchmarkUtils.hpp>
+#include <touchgfx/Texts.hpp>
+#include <touchgfx/transforms/DisplayTransformation.hpp>
+#include <touchgfx/TypedText.hpp>
+#include <touchgfx/Unicode.hpp>
+#include <touchgfx/widgets/GlyphRunCache.hpp>
+#include <touchgfx/widgets/CachedTextArea.hpp>
+#include <algorithm>
+#include <chrono>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+using namespace touchgfx;
+
+namespace
+{
+const int TRIALS = 200;
+/** Parts of the TextArea drawn in each trial, after drawing all of it. */
+const int PARTS = 4;
+const int NUMBER_OF_FONTS = 3;
+/** The generated fonts only hold the fallback glyph '?', which every character is drawn with. */
+const char* const PARAGRAPH = "New Text Next Tew wet Test text New Text Next Tew wet Test text New Text Next Tew wet Test text ";
+const int PARAGRAPH_REPEATS = 6;
+const uint16_t TEXT_SIZE = 640;
+const uint16_t CACHE_CAPACITY = 1024;
+/** A cache too small for the paragraph, drawn from a new layout every time. */
+const uint16_t SMALL_CAPACITY = 16;
+/** A widget moving across the text, redrawing where it was and where it is. */
+const int16_t CURSOR_SIZE = 48;
+const int16_t CURSOR_STEP = 8;
+/** Timings are the median of this many rounds, alternating between TextArea and CachedTextArea. */
+const int ROUNDS = 15;
+
+/** Switches between the native display orientation and a display rotated by 90 degrees. */
+void setRotation(DisplayRotation rotation)
+{
+    if (HAL::DISPLAY_ROTATION != rotation)
+    {
+        const uint16_t width = HAL::DISPLAY_WIDTH;
+        HAL::DISPLAY_WIDTH = HAL::DISPLAY_HEIGHT;
+        HAL::DISPLAY_HEIGHT = width;
+        HAL::DISPLAY_ROTATION = rotation;
+    }
+}
+
+/**
+ * A translation in the layout installed by Texts::setTranslation(), with
+ * the paragraph as the only text and a TypedText using the given font and
+ * alignment.
+ */
+struct Translation
+{
+    uint32_t offsetToTexts;
+    uint32_t offsetToIndices;
+    uint32_t offsetToTypedText;
+    uint32_t index;
+    uint32_t typedText;
+    Unicode::UnicodeChar text[TEXT_SIZE];
+};
+
+void setTypedText(Translation& translation, FontId font, Alignment alignment)
+{
+    const TypedText::TypedTextData data = { (unsigned char)font, alignment, TEXT_DIRECTION_LTR };
+    memcpy(&translation.typedText, &data, sizeof(data));
+    Texts::setLanguage(0);
+}
+
+/** Copies the pixels of an area of the display between framebuffers. */
+void copyArea(uint8_t* destination, const uint8_t* source, Rect area)
+{
+    DisplayTransformation::transformDisplayToFrameBuffer(area);
+    for (int16_t y = area.y; y < area.bottom(); y++)
+    {
+        const uint32_t offset = (y * HAL::FRAME_BUFFER_WIDTH + area.x) * 3;
+        memcpy(destination + offset, source + offset, area.width * 3);
+    }
+}
+
+double timeDraws(const TextArea& textArea, const Rect* areas, int numberOfAreas, int iterations)
+{
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        textArea.draw(areas[i % numberOfAreas]);
+    }
+    return elapsedNs(start) / iterations;
+}
+
+double median(std::vector<double>& values)
+{
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+/** The median time of a draw, with TextArea and CachedTextArea timed in alternating rounds after a warm-up. */
+void timeRounds(BenchmarkHAL& hal, const TextArea& plain, const TextArea& cached, const Rect* areas, int numberOfAreas, int iterations, double& plainNs, double& cachedNs)
+{
+    hal.clearFrameBuffer();
+    timeDraws(plain, areas, numberOfAreas, numberOfAreas);
+    timeDraws(cached, areas, numberOfAreas, numberOfAreas);
+    std::vector<double> plainRounds;
+    std::vector<double> cachedRounds;
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        plainRounds.push_back(timeDraws(plain, areas, numberOfAreas, iterations));
+        cachedRounds.push_back(timeDraws(cached, areas, numberOfAreas, iterations));
+    }
+    plainNs = median(plainRounds);
+    cachedNs = median(cachedRounds);
+}
+} // namespace
+
+bool runGlyphRunBenchmark(BenchmarkHAL& hal, int iterations, bool json)
+{
+    seedRandom(1);
+    static Translation translation;
+    translation.offsetToTexts = offsetof(Translation, text);
+    translation.offsetToIndices = offsetof(Translation, index);
+    translation.offsetToTypedText = offsetof(Translation, typedText);
+    translation.index = 0;
+    for (int i = 0; i < PARAGRAPH_REPEATS; i++)
+    {
+        Unicode::strncpy(translation.text + Unicode::strlen(PARAGRAPH) * i, PARAGRAPH, TEXT_SIZE - Unicode::strlen(PARAGRAPH) * i);
+    }
+    Texts::setTranslation(0, &translation);
+
+    static GlyphRunCache::Glyph glyphs[CACHE_CAPACITY];
+    GlyphRunCache cache(glyphs, CACHE_CAPACITY);
+    GlyphRunCache smallCache(glyphs, SMALL_CAPACITY);
+    TextArea plain;
+    CachedTextArea cached;
+
+    // Compare random TextAreas, drawn whole and in parts
+    uint32_t trials = 0;
+    uint32_t mismatches = 0;
+    uint32_t overflows = 0;
+    uint32_t inconsistentParts = 0;
+    for (int rotated = 0; rotated < 2; rotated++)
+    {
+        setRotation(rotated ? rotate90 : rotate0);
+        for (int trial = 0; trial < TRIALS; trial++)
+        {
+            const FontId font = (FontId)(nextRandom() % NUMBER_OF_FONTS);
+            const Alignment alignment = (Alignment)(nextRandom() % 3);
+            setTypedText(translation, font, alignment);
+            const int16_t x = (int16_t)(nextRandom() % (HAL::DISPLAY_WIDTH - 40));
+            const int16_t y = (int16_t)(nextRandom() % (HAL::DISPLAY_HEIGHT - 20));
+            const int16_t width = (int16_t)(40 + nextRandom() % (HAL::DISPLAY_WIDTH - x - 40 + 1));
+            const int16_t height = (int16_t)(20 + nextRandom() % (HAL::DISPLAY_HEIGHT - y - 20 + 1));
+            const WideTextAction wideTextAction = (WideTextAction)(nextRandom() % 4);
+            const int16_t linespace = (int16_t)(nextRandom() % 10) - 3;
+            const uint8_t indentation = (uint8_t)(nextRandom() % 12);
+            const colortype color = nextRandom() & 0xFFFFFF;
+            const uint8_t alpha = trial % 2 ? 0xFF : (uint8_t)(nextRandom() % 0xFF);
+            TextArea* const textAreas[2] = { &plain, &cached };
+            for (int i = 0; i < 2; i++)
+            {
+                TextArea& t = *textAreas[i];
+                t.setPosition(x, y, width, height);
+                t.setTypedText(TypedText(0));
+                t.setWideTextAction(wideTextAction);
+                t.setLinespacing(linespace);
+                t.setIndentation(indentation);
+                t.setColor(color);
+                t.setAlpha(alpha);
+            }
+            // The cache follows the changes above by itself, every tenth trial uses a cache which overflows
+            GlyphRunCache* const glyphRunCache = trial % 10 == 9 ? &smallCache : &cache;
+            if (cached.getGlyphRunCache() != glyphRunCache)
+            {
+                cached.setGlyphRunCache(glyphRunCache);
+            }
+
+            for (int part = 0; part <= PARTS; part++)
+            {
+                Rect area(0, 0, width, height);
+                if (part > 0)
+                {
+                    area.x = (int16_t)(nextRandom() % width);
+                    area.y = (int16_t)(nextRandom() % height);
+                    area.width = (int16_t)(1 + nextRandom() % (width - area.x));
+                    area.height = (int16_t)(1 + nextRandom() % (height - area.y));
+                }
+                // What drawing all of the TextArea leaves inside the area, and what drawing only the area leaves
+                const Rect absolute(x + area.x, y + area.y, area.width, area.height);
+                hal.clearFrameBuffer();
+                std::vector<uint8_t> whole(hal.getFrameBuffer(), hal.getFrameBuffer() + hal.getFrameBufferSize());
+                plain.draw(Rect(0, 0, width, height));
+                copyArea(&whole[0], hal.getFrameBuffer(), absolute);
+                hal.clearFrameBuffer();
+                plain.draw(area);
+                // LCD::drawString() may choose the lines to draw by the invalidated area
+                if (memcmp(hal.getFrameBuffer(), &whole[0], whole.size()) != 0)
+                {
+                    inconsistentParts++;
+                }
+                hal.clearFrameBuffer();
+                cached.draw(area);
+                trials++;
+                if (memcmp(hal.getFrameBuffer(), &whole[0], whole.size()) != 0)
+                {
+                    if (mismatches++ == 0)
+                    {
+                        fprintf(stderr, "Glyph runs differ: font %d alignment %d wide %d linespace %d indentation %d%s in %d,%d %dx%d area %d,%d %dx%d alpha %d\n",
+                                font, alignment, wideTextAction, linespace, indentation, rotated ? " rotated" : "", x, y, width, height,
+                                area.x, area.y, area.width, area.height, alpha);
+                    }
+                }
+            }
+            if (cached.getGlyphRunCache()->hasOverflow())
+            {
+                overflows++;
+            }
+        }
+    }
+    setRotation(rotate0);
+
+    // Time a screen of text, redrawn where a cursor was and where it is, and drawn whole
+    setTypedText(translation, 0, LEFT);
+    TextArea* const textAreas[2] = { &plain, &cached };
+    for (int i = 0; i < 2; i++)
+    {
+        TextArea& t = *textAreas[i];
+        t.setPosition(0, 0, HAL::DISPLAY_WIDTH, HAL::DISPLAY_HEIGHT);
+        t.setWideTextAction(WIDE_TEXT_WORDWRAP);
+        t.setLinespacing(0);
+        t.setIndentation(0);
+        t.setColor(0xFFFFFF);
+        t.setAlpha(0xFF);
+    }
+    cached.setGlyphRunCache(&cache);
+    const int numberOfCursors = (HAL::DISPLAY_WIDTH - CURSOR_SIZE) / CURSOR_STEP;
+    Rect* const cursors = new Rect[numberOfCursors * 2];
+    for (int i = 0; i < numberOfCursors; i++)
+    {
+        const int16_t cursorY = (int16_t)((HAL::DISPLAY_HEIGHT - CURSOR_SIZE) * i / numberOfCursors);
+        cursors[i * 2] = Rect((int16_t)(i * CURSOR_STEP), cursorY, CURSOR_SIZE, CURSOR_SIZE);
+        cursors[i * 2 + 1] = Rect((int16_t)((i + 1) * CURSOR_STEP), cursorY, CURSOR_SIZE, CURSOR_SIZE);
+    }
+    const Rect screen(0, 0, HAL::DISPLAY_WIDTH, HAL::DISPLAY_HEIGHT);
+    struct Timing
+    {
+        const char* name;
+        double plainNs;
+        double cachedNs;
+    } timings[2] = { { "cursor", 0, 0 }, { "screen", 0, 0 } };
+    timeRounds(hal, plain, cached, cursors, numberOfCursors * 2, iterations, timings[0].plainNs, timings[0].cachedNs);
+    timeRounds(hal, plain, cached, &screen, 1, iterations, timings[1].plainNs, timings[1].cachedNs);
+    delete[] cursors;
+    const uint16_t screenGlyphs = cache.getNumberOfGlyphs();
+
+    const bool ok = mismatches == 0;
+    if (json)
+    {
+        printf("{\"iterations\": %d, \"rounds\": %d, \"trials\": %u, \"mismatches\": %u, \"overflows\": %u, \"inconsistent_drawstring_parts\": %u, \"screen_glyphs\": %u, \"results\": [",
+               iterations, ROUNDS, trials, mismatches, overflows, inconsistentParts, screenGlyphs);
+        for (int i = 0; i < 2; i++)
+        {
+            printf("%s\n  {\"draw\": \"%s\", \"drawstring_us\": %.2f, \"glyph_runs_us\": %.2f, \"speedup\": %.2f}", i ? "," : "", timings[i].name,
+                   timings[i].plainNs / 1e3, timings[i].cachedNs / 1e3, timings[i].plainNs / timings[i].cachedNs);
+        }
+        printf("\n]}\n");
+    }
+    else
+    {
+        printf("%-8s %14s %14s %8s   median of %d rounds of %d draws\n", "draw", "drawString", "glyph runs", "speedup", ROUNDS, iterations);
+        for (int i = 0; i < 2; i++)
+        {
+            printf("%-8s %11.2f us %11.2f us %7.2fx\n", timings[i].name, timings[i].plainNs / 1e3,
+                   timings[i].cachedNs / 1e3, timings[i].plainNs / timings[i].cachedNs);
+        }
+        printf("%u glyphs on the screen, %u trials with an overflowing cache\n", screenGlyphs, overflows);
+        printf("CachedTextArea: %u/%u parts drawn as drawing it whole %s\n", trials - mismatches, trials, ok ? "ok" : "MISMATCH");
+        printf("TextArea:       %u/%u parts drawn as drawing it whole, LCD::drawString() draws other lines in the rest\n", trials - inconsistentParts, trials);
+    }
+    return ok;
+}
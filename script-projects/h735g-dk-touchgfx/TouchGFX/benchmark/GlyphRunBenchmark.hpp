@@ -0,0 +1,29 @@
+#ifndef GLYPHRUNBENCHMARK_HPP
+#define GLYPHRUNBENCHMARK_HPP
+
+#include <BenchmarkHAL.hpp>
+
+/**
+ * Draw a word-wrapped paragraph in a CachedTextArea with a GlyphRunCache and
+ * in a TextArea, in random fonts, alignments, sizes, line spaces, wide text
+ * actions, colors and alphas, on a display in its native orientation and
+ * rotated by 90 degrees. Random parts of the CachedTextArea are drawn from
+ * the cache and compared with what drawing all of the TextArea leaves
+ * inside the part. Counts the parts where LCD::drawString(), drawing only the
+ * part, leaves something else. Reports the time to redraw small parts of
+ * a screen filled with text, as when a widget moves across a static label,
+ * and the time to draw the whole screen.
+ *
+ * Installs a translation with the paragraph as the text of the single
+ * TypedText of the text database.
+ *
+ * @param hal        The initialized benchmark HAL.
+ * @param iterations Number of timed redraws.
+ * @param json       Write the result as JSON.
+ *
+ * @return True if every part drawn from the cache matches the TextArea
+ *         drawn whole by LCD::drawString().
+ */
+bool runGlyphRunBenchmark(touchgfx::BenchmarkHAL& hal, int iterations, bool json);
+
+#endif // GLYPHRUNBENCHMARK_HPP
@@ -0,0 +1,312 @@
+#include <NestedGeometryBenchmark.hpp>
+#include <BenchmarkUtils.hpp>
+#include <touchgfx/Application.hpp>
+#include <touchgfx/Screen.hpp>
+#include <touchgfx/containers/BlitScrollableContainer.hpp>
+#include <touchgfx/containers/CachedGeometryContainer.hpp>
+#include <touchgfx/hal/HAL.hpp>
+#include <touchgfx/widgets/Widget.hpp>
+#include <chrono>
+#include <stdio.h>
+#include <vector>
+
+using namespace touchgfx;
+
+namespace
+{
+// Order sensitive hash of the invalidated areas, the draws and the touches
+uint32_t traceHash = 2166136261U;
+
+void trace(uint32_t value)
+{
+    traceHash = (traceHash ^ value) * 16777619U;
+}
+
+void trace(const Rect& area)
+{
+    trace((uint32_t)(uint16_t)area.x | ((uint32_t)(uint16_t)area.y << 16));
+    trace((uint32_t)(uint16_t)area.width | ((uint32_t)(uint16_t)area.height << 16));
+}
+
+/** Records the areas invalidated on the current screen, and makes a screen current. */
+class RecordingApplication : public Application
+{
+public:
+    RecordingApplication()
+        : Application(), previousInstance(instance), previousScreen(currentScreen)
+    {
+        instance = this;
+    }
+
+    virtual ~RecordingApplication()
+    {
+        instance = previousInstance;
+        currentScreen = previousScreen;
+    }
+
+    void show(Screen& screen)
+    {
+        currentScreen = &screen;
+    }
+
+    using Application::draw;
+
+    /** Where the root container of the current screen sends invalidated areas. */
+    virtual void draw(Rect& rect)
+    {
+        trace(1);
+        trace(rect);
+    }
+
+private:
+    Application* previousInstance;
+    Screen* previousScreen;
+};
+
+/** A solid widget recording its draws. */
+class Probe : public Widget
+{
+public:
+    Probe()
+        : id(0)
+    {
+    }
+
+    virtual void draw(const Rect& invalidatedArea) const
+    {
+        trace(2);
+        trace((uint32_t)id);
+        trace(invalidatedArea);
+    }
+
+    virtual Rect getSolidRect() const
+    {
+        return Rect(0, 0, getWidth(), getHeight());
+    }
+
+    int id;
+};
+
+/** A BlitScrollableContainer recording the areas its children invalidate. */
+class RecordingScrollableContainer : public BlitScrollableContainer
+{
+public:
+    virtual void invalidateRect(Rect& invalidatedArea) const
+    {
+        trace(4);
+        trace(invalidatedArea);
+        BlitScrollableContainer::invalidateRect(invalidatedArea);
+    }
+};
+
+const int LEAVES = 6;
+const int AREAS = 4;
+const int TOUCHES = 4;
+const int MAX_SCROLL = 40;
+
+/**
+ * A screen of nested containers of type C, each holding a few widgets and the next level,
+ * either directly on the screen or inside a BlitScrollableContainer, which must see the areas
+ * invalidated by the children.
+ */
+template <class C>
+class NestedScreen
+{
+public:
+    NestedScreen(int depth, bool scrollable)
+        : levels(depth), probes(depth * LEAVES), scrollX(0), scrollY(0)
+    {
+        seedRandom(4242);
+        Container* parent = &screen.getRootContainer();
+        if (scrollable)
+        {
+            scrollableContainer.setPosition(0, 0, parent->getWidth(), parent->getHeight());
+            scrollableContainer.setScrollbarsVisible(false);
+            parent->add(scrollableContainer);
+            parent = &scrollableContainer;
+        }
+        for (int i = 0; i < depth; i++)
+        {
+            C& level = levels[i];
+            const int16_t inset = i == 0 ? 0 : 3;
+            level.setPosition(inset, inset, parent->getWidth() - 2 * inset, parent->getHeight() - 2 * inset);
+            parent->add(level);
+            for (int j = 0; j < LEAVES; j++)
+            {
+                Probe& probe = probes[i * LEAVES + j];
+                probe.id = i * LEAVES + j;
+                probe.setPosition(randomBetween(-8, level.getWidth() - 8), randomBetween(-8, level.getHeight() - 8), randomBetween(4, 60), randomBetween(4, 40));
+                probe.setTouchable(true);
+                level.add(probe);
+            }
+            parent = &level;
+        }
+    }
+
+    /** Scrolls the second level inside the first, and sometimes resizes a level. */
+    void scroll(int frame)
+    {
+        seedRandom(frame * 7919 + 1);
+        const int16_t deltaX = MAX(-MAX_SCROLL, MIN(MAX_SCROLL, scrollX + randomBetween(-3, 3))) - scrollX;
+        const int16_t deltaY = MAX(-MAX_SCROLL, MIN(MAX_SCROLL, scrollY + randomBetween(-3, 3))) - scrollY;
+        levels[levels.size() > 1 ? 1 : 0].moveRelative(deltaX, deltaY);
+        scrollX += deltaX;
+        scrollY += deltaY;
+        if (frame % 8 == 0)
+        {
+            C& level = levels[randomBetween(0, (int)levels.size() - 1)];
+            level.setWidth(level.getWidth() + (frame % 16 == 0 ? 1 : -1));
+        }
+    }
+
+    void invalidateLeaves()
+    {
+        for (unsigned i = 0; i < probes.size(); i++)
+        {
+            probes[i].invalidate();
+        }
+    }
+
+    void drawAreas(int frame)
+    {
+        seedRandom(frame * 7919 + 2);
+        const Container& root = screen.getRootContainer();
+        for (int i = 0; i < AREAS; i++)
+        {
+            screen.startSMOC(Rect(randomBetween(0, root.getWidth() - 80), randomBetween(0, root.getHeight() - 60), 80, 60));
+        }
+    }
+
+    void touch(int frame)
+    {
+        seedRandom(frame * 7919 + 3);
+        Container& root = screen.getRootContainer();
+        for (int i = 0; i < TOUCHES; i++)
+        {
+            Drawable* last = 0;
+            int16_t fingerX = 0;
+            int16_t fingerY = 0;
+            root.getLastChildNear(randomBetween(0, root.getWidth() - 1), randomBetween(0, root.getHeight() - 1), &last, &fingerX, &fingerY);
+            trace(3);
+            trace(isProbe(last) ? (uint32_t)static_cast<Probe*>(last)->id : 0xFFFFFFFFU);
+            trace((uint32_t)(uint16_t)fingerX | ((uint32_t)(uint16_t)fingerY << 16));
+        }
+    }
+
+    void traceGeometry()
+    {
+        for (unsigned i = 0; i < probes.size(); i++)
+        {
+            trace(probes[i].getAbsoluteRect());
+            Rect visible(0, 0, probes[i].getWidth(), probes[i].getHeight());
+            probes[i].getVisibleRect(visible);
+            trace(visible);
+        }
+    }
+
+    bool isProbe(const Drawable* drawable) const
+    {
+        for (unsigned i = 0; i < probes.size(); i++)
+        {
+            if (drawable == &probes[i])
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    Screen screen;
+    RecordingScrollableContainer scrollableContainer;
+    std::vector<C> levels;
+    std::vector<Probe> probes;
+    int16_t scrollX;
+    int16_t scrollY;
+};
+
+struct Times
+{
+    double invalidateNs;
+    double drawNs;
+    double touchNs;
+    uint32_t hash;
+};
+
+/** Runs a frame on a screen, hashing everything it does, and adds the times of its parts. */
+template <class C>
+uint32_t runFrame(RecordingApplication& application, NestedScreen<C>& nested, int frame, Times& times)
+{
+    application.show(nested.screen);
+    traceHash = 2166136261U;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    nested.scroll(frame);
+    nested.invalidateLeaves();
+    times.invalidateNs += elapsedNs(start);
+    start = std::chrono::steady_clock::now();
+    nested.drawAreas(frame);
+    times.drawNs += elapsedNs(start);
+    start = std::chrono::steady_clock::now();
+    nested.touch(frame);
+    times.touchNs += elapsedNs(start);
+    nested.traceGeometry();
+    return traceHash;
+}
+} // namespace
+
+bool runNestedGeometryBenchmark(int iterations, bool json)
+{
+    const int depths[] = { 4, 8, 16, 32 };
+    const uint8_t fingerSize = HAL::getInstance()->getFingerSize();
+    HAL::getInstance()->setFingerSize(9);
+    RecordingApplication application;
+    bool ok = true;
+
+    if (json)
+    {
+        printf("{\"scene\": \"nested_geometry\", \"iterations\": %d, \"results\": [", iterations);
+    }
+    else
+    {
+        printf("%-30s %6s %12s %12s %12s %12s %12s %12s  %s\n", "nested_geometry", "depth", "invalid. ns", "cached", "draw ns", "cached", "touch ns", "cached", "");
+    }
+    for (unsigned i = 0; i < 2 * sizeof(depths) / sizeof(depths[0]); i++)
+    {
+        // The second half of the rows nests the containers in a BlitScrollableContainer
+        const int depth = depths[i % (sizeof(depths) / sizeof(depths[0]))];
+        const bool scrollable = i >= sizeof(depths) / sizeof(depths[0]);
+        NestedScreen<Container> plain(depth, scrollable);
+        NestedScreen<CachedGeometryContainer> cached(depth, scrollable);
+        Times plainTimes = { 0, 0, 0, 0 };
+        Times cachedTimes = { 0, 0, 0, 0 };
+        bool same = true;
+        for (int frame = 0; frame < iterations; frame++)
+        {
+            const uint32_t plainHash = runFrame(application, plain, frame, plainTimes);
+            const uint32_t cachedHash = runFrame(application, cached, frame, cachedTimes);
+            same = same && plainHash == cachedHash;
+        }
+        ok = ok && same;
+
+        if (json)
+        {
+            printf("%s\n  {\"depth\": %d, \"parent\": \"%s\", \"invalidate_ns\": %.1f, \"cached_invalidate_ns\": %.1f, \"draw_ns\": %.1f, \"cached_draw_ns\": %.1f, \"touch_ns\": %.1f, \"cached_touch_ns\": %.1f, \"ok\": %s}",
+                   i == 0 ? "" : ",", depth, scrollable ? "blit_scrollable_container" : "screen",
+                   plainTimes.invalidateNs / iterations, cachedTimes.invalidateNs / iterations,
+                   plainTimes.drawNs / iterations, cachedTimes.drawNs / iterations,
+                   plainTimes.touchNs / iterations, cachedTimes.touchNs / iterations, same ? "true" : "false");
+        }
+        else
+        {
+            printf("%-30s %6d %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f  %s\n", scrollable ? "  in BlitScrollableContainer" : "", depth,
+                   plainTimes.invalidateNs / iterations, cachedTimes.invalidateNs / iterations,
+                   plainTimes.drawNs / iterations, cachedTimes.drawNs / iterations,
+                   plainTimes.touchNs / iterations, cachedTimes.touchNs / iterations, same ? "ok" : "FAILED");
+        }
+    }
+    if (json)
+    {
+        printf("\n]}\n");
+    }
+    HAL::getInstance()->setFingerSize(fingerSize);
+    return ok;
+}
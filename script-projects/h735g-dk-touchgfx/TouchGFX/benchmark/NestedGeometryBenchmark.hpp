@@ -0,0 +1,22 @@
+#ifndef NESTEDGEOMETRYBENCHMARK_HPP
+#define NESTEDGEOMETRYBENCHMARK_HPP
+
+/**
+ * Build the same screen of 4 to 32 nested containers, with a few widgets
+ * at every level, from Containers and from CachedGeometryContainers. Every
+ * frame scrolls the second level like a ScrollableContainer, now and then
+ * resizes a level, invalidates every widget, draws random areas with the
+ * occlusion culling of the Screen and samples random touches with
+ * getLastChildNear(). The invalidated areas, the draws, the touched
+ * widgets and the absolute and visible rectangles of every widget must be
+ * the same for both screens. Reports the time per frame of invalidating,
+ * drawing and touching against the depth of the screen.
+ *
+ * @param iterations Number of frames for every depth.
+ * @param json       Write the result as JSON.
+ *
+ * @return True if the screens always match.
+ */
+bool runNestedGeometryBenchmark(int iterations, bool json);
+
+#endif // NESTEDGEOMETRYBENCHMARK_HPP
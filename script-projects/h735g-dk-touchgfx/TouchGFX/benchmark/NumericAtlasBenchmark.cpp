@@ -0,0 +1,481 @@
+#include <NumericAtlasBenchmark.hpp>
+#include <BenchmarkUtils.hpp>
+#include <BitmapDatabase.hpp>
+#include <fonts/GeneratedFont.hpp>
+#include <texts/TypedTextDatabase.hpp>
+#include <touchgfx/BitmapCache.hpp>
+#include <touchgfx/containers/Container.hpp>
+#include <touchgfx/lcd/LCD.hpp>
+#include <touchgfx/Texts.hpp>
+#include <touchgfx/transforms/DisplayTransformation.hpp>
+#include <touchgfx/TypedText.hpp>
+#include <touchgfx/Unicode.hpp>
+#include <touchgfx/widgets/GlyphAtlas.hpp>
+#include <touchgfx/widgets/NumericTextArea.hpp>
+#include <touchgfx/widgets/TextAreaWithWildcard.hpp>
+#include <chrono>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+using namespace touchgfx;
+
+namespace
+{
+const int TRIALS = 300;
+/** Parts of the NumericTextArea drawn in each trial, after drawing all of it. */
+const int PARTS = 4;
+/** The glyphs of the synthetic fonts, sorted by unicode. */
+const char* const GLYPHS = " -.0123456789";
+const uint16_t NUMBER_OF_GLYPHS = 13;
+const uint16_t FONT_HEIGHT = 18;
+const uint8_t PIXELS_BELOW_BASE = 4;
+const int NUMBER_OF_FONTS = 2;
+/** The 8bpp atlas has no '-', negative values are drawn by LCD::drawString(). */
+const char* const ATLAS_CHARACTERS[NUMBER_OF_FONTS] = { "0123456789-.", "0123456789." };
+const uint32_t BITMAP_CACHE_SIZE = 16 * 1024;
+/** A dashboard of numeric fields, all updated every tick. */
+const int FIELD_COLUMNS = 4;
+const int FIELD_ROWS = 6;
+const int NUMBER_OF_FIELDS = FIELD_COLUMNS * FIELD_ROWS;
+const int16_t FIELD_WIDTH = 110;
+const int16_t FIELD_HEIGHT = FONT_HEIGHT + 4;
+
+/** Switches between the native display orientation and a display rotated by 90 degrees. */
+void setRotation(DisplayRotation rotation)
+{
+    if (HAL::DISPLAY_ROTATION != rotation)
+    {
+        const uint16_t width = HAL::DISPLAY_WIDTH;
+        HAL::DISPLAY_WIDTH = HAL::DISPLAY_HEIGHT;
+        HAL::DISPLAY_HEIGHT = width;
+        HAL::DISPLAY_ROTATION = rotation;
+    }
+}
+
+/** A font with the glyphs of GLYPHS, of varying sizes and advances and random coverage. */
+struct DigitFont
+{
+    GlyphNode glyphs[NUMBER_OF_GLYPHS];
+    std::vector<uint8_t> data;
+    const uint8_t* table[1];
+};
+
+GeneratedFont* createFont(DigitFont& font, uint8_t bitsPerPixel)
+{
+    for (uint16_t i = 0; i < NUMBER_OF_GLYPHS; i++)
+    {
+        const char character = GLYPHS[i];
+        const int digit = character - '0';
+        uint8_t width = 0;
+        uint8_t height = 0;
+        uint8_t top = 0;
+        int8_t left = 0;
+        uint8_t advance = 5;
+        if (character == '-')
+        {
+            width = 6;
+            height = 2;
+            top = 7;
+            left = 1;
+            advance = 8;
+        }
+        else if (character == '.')
+        {
+            width = 3;
+            height = 3;
+            top = 3;
+            left = 1;
+        }
+        else if (character != ' ')
+        {
+            width = (uint8_t)(7 + digit % 3);
+            height = (uint8_t)(digit == 4 ? 14 : 13);
+            top = (uint8_t)(digit == 4 ? 14 : 13);
+            left = (int8_t)(digit % 4 - 1);
+            advance = (uint8_t)(9 + digit % 2);
+        }
+        const GlyphNode glyph = { (uint32_t)font.data.size(), (Unicode::UnicodeChar)character, width, height, top, left, advance, 0, 0, 0 };
+        font.glyphs[i] = glyph;
+        const uint32_t bytes = bitsPerPixel == 4 ? (uint32_t)((width + 1) / 2) * height : (uint32_t)width * height;
+        for (uint32_t b = 0; b < bytes; b++)
+        {
+            // A third of the pixels are empty and a third are solid
+            uint8_t pixels = 0;
+            for (int p = 0; p < 8 / bitsPerPixel; p++)
+            {
+                const uint32_t r = nextRandom() % 3;
+                const uint8_t coverage = r == 0 ? 0 : (r == 1 ? 0xFF : (uint8_t)nextRandom());
+                pixels |= (bitsPerPixel == 4 ? coverage >> 4 : coverage) << (p * 4);
+            }
+            font.data.push_back(pixels);
+        }
+    }
+    font.table[0] = &font.data[0];
+    return new GeneratedFont(font.glyphs, NUMBER_OF_GLYPHS, FONT_HEIGHT, PIXELS_BELOW_BASE, bitsPerPixel, bitsPerPixel == 4 ? 1 : 0, 1, 2, font.table, 0, 0, 0, 0, 0);
+}
+
+/**
+ * A translation in the layout installed by Texts::setTranslation(), with
+ * a single wildcard as the only text and a TypedText using the given font
+ * and alignment.
+ */
+struct Translation
+{
+    uint32_t offsetToTexts;
+    uint32_t offsetToIndices;
+    uint32_t offsetToTypedText;
+    uint32_t index;
+    uint32_t typedText;
+    Unicode::UnicodeChar text[2];
+};
+
+void setTypedText(Translation& translation, FontId font, Alignment alignment)
+{
+    const TypedText::TypedTextData data = { (unsigned char)font, alignment, TEXT_DIRECTION_LTR };
+    memcpy(&translation.typedText, &data, sizeof(data));
+    Texts::setLanguage(0);
+}
+
+/** Copies the pixels of an area of the display between framebuffers. */
+void copyArea(uint8_t* destination, const uint8_t* source, Rect area)
+{
+    DisplayTransformation::transformDisplayToFrameBuffer(area);
+    for (int16_t y = area.y; y < area.bottom(); y++)
+    {
+        const uint32_t offset = (y * HAL::FRAME_BUFFER_WIDTH + area.x) * 3;
+        memcpy(destination + offset, source + offset, area.width * 3);
+    }
+}
+
+/** A screen recording the areas invalidated by its children. */
+class InvalidationRecorder : public Container
+{
+public:
+    virtual void invalidateRect(Rect& invalidatedArea) const
+    {
+        areas.push_back(invalidatedArea);
+    }
+
+    mutable std::vector<Rect> areas;
+};
+
+/** Draws the areas invalidated in a widget, as the invalidated areas of a frame are. */
+void drawInvalidatedAreas(BenchmarkHAL& hal, const InvalidationRecorder& screen, const Drawable& widget, const uint8_t* background)
+{
+    for (size_t i = 0; i < screen.areas.size(); i++)
+    {
+        Rect area = screen.areas[i];
+        if (background)
+        {
+            copyArea(hal.getFrameBuffer(), background, area);
+        }
+        area.x -= widget.getX();
+        area.y -= widget.getY();
+        widget.draw(area);
+    }
+}
+
+/** A value of random magnitude, which is negative every fourth time. */
+int32_t randomValue()
+{
+    const int32_t magnitude = (int32_t)((nextRandom() ^ (nextRandom() << 16)) >> (nextRandom() % 32));
+    return nextRandom() % 4 == 0 ? -magnitude : magnitude;
+}
+} // namespace
+
+namespace touchgfx
+{
+void GlyphCopyDMA::addToQueue(const BlitOp& op)
+{
+    operations++;
+    if (!executing || (op.operation != BLIT_OP_COPY_A4 && op.operation != BLIT_OP_COPY_A8))
+    {
+        return;
+    }
+    const uint8_t* src = reinterpret_cast<const uint8_t*>(op.pSrc);
+    uint8_t* dst = reinterpret_cast<uint8_t*>(op.pDst);
+    const uint32_t color = op.color;
+    for (uint16_t y = 0; y < op.nLoops; y++)
+    {
+        for (uint16_t x = 0; x < op.nSteps; x++)
+        {
+            const uint8_t coverage = op.operation == BLIT_OP_COPY_A4 ? ((src[x >> 1] >> ((x & 1) * 4)) & 0xF) * 0x11 : src[x];
+            const uint8_t a = op.alpha == 0xFF ? coverage : LCD::div255(coverage * op.alpha);
+            if (a == 0)
+            {
+                continue;
+            }
+            uint8_t* const d = dst + x * 3;
+            const uint8_t ia = 0xFF - a;
+            d[0] = LCD::div255((color & 0xFF) * a + d[0] * ia);
+            d[1] = LCD::div255(((color >> 8) & 0xFF) * a + d[1] * ia);
+            d[2] = LCD::div255(((color >> 16) & 0xFF) * a + d[2] * ia);
+        }
+        // The strides are in pixels, as for the DMA2D
+        src += op.operation == BLIT_OP_COPY_A4 ? op.srcLoopStride / 2 : op.srcLoopStride;
+        dst += op.dstLoopStride * 3;
+    }
+}
+} // namespace touchgfx
+
+bool runNumericAtlasBenchmark(BenchmarkHAL& hal, GlyphCopyDMA& dma, int iterations, bool json)
+{
+    seedRandom(1);
+    static DigitFont digitFonts[NUMBER_OF_FONTS];
+    GeneratedFont* fonts[NUMBER_OF_FONTS] = { createFont(digitFonts[0], 4), createFont(digitFonts[1], 8) };
+    for (int i = 0; i < NUMBER_OF_FONTS; i++)
+    {
+        TypedTextDatabase::setFont((FontId)i, fonts[i]);
+    }
+
+    static Translation translation;
+    translation.offsetToTexts = offsetof(Translation, text);
+    translation.offsetToIndices = offsetof(Translation, index);
+    translation.offsetToTypedText = offsetof(Translation, typedText);
+    translation.index = 0;
+    translation.text[0] = 0x02;
+    translation.text[1] = 0;
+    Texts::setTranslation(0, &translation);
+
+    // The atlases are dynamic bitmaps in the bitmap cache
+    static uint16_t bitmapCache[BITMAP_CACHE_SIZE / 2];
+    BitmapCache::registerBitmapDatabase(BitmapDatabase::getInstance(), BitmapDatabase::getInstanceSize(), bitmapCache, BITMAP_CACHE_SIZE, NUMBER_OF_FONTS);
+    GlyphAtlas atlases[NUMBER_OF_FONTS];
+    for (int i = 0; i < NUMBER_OF_FONTS; i++)
+    {
+        if (!atlases[i].create(fonts[i], ATLAS_CHARACTERS[i]))
+        {
+            fprintf(stderr, "Could not create the %d bpp atlas\n", fonts[i]->getBitsPerPixel());
+            return false;
+        }
+    }
+
+    InvalidationRecorder screen;
+    screen.setPosition(0, 0, HAL::DISPLAY_WIDTH, HAL::DISPLAY_HEIGHT);
+    screen.areas.reserve(NUMBER_OF_FIELDS * 4);
+    TextAreaWithOneWildcard plain;
+    NumericTextArea numeric;
+    screen.add(numeric);
+
+    // Compare random NumericTextAreas with TextAreaWithOneWildcards, drawn whole and in parts
+    uint32_t trials = 0;
+    uint32_t mismatches = 0;
+    uint32_t inconsistentParts = 0;
+    uint32_t updates = 0;
+    uint32_t updateMismatches = 0;
+    uint64_t invalidatedPixels = 0;
+    uint64_t widgetPixels = 0;
+    for (int rotated = 0; rotated < 2; rotated++)
+    {
+        setRotation(rotated ? rotate90 : rotate0);
+        screen.setPosition(0, 0, HAL::DISPLAY_WIDTH, HAL::DISPLAY_HEIGHT);
+        for (int trial = 0; trial < TRIALS; trial++)
+        {
+            const FontId font = (FontId)(nextRandom() % NUMBER_OF_FONTS);
+            const Alignment alignment = (Alignment)(nextRandom() % 3);
+            setTypedText(translation, font, alignment);
+            const int16_t width = (int16_t)(20 + nextRandom() % 160);
+            const int16_t height = (int16_t)(FONT_HEIGHT + nextRandom() % 10);
+            const int16_t x = (int16_t)(nextRandom() % (HAL::DISPLAY_WIDTH - width));
+            const int16_t y = (int16_t)(nextRandom() % (HAL::DISPLAY_HEIGHT - height));
+            const uint8_t indentation = (uint8_t)(nextRandom() % 12);
+            const colortype color = nextRandom() & 0xFFFFFF;
+            const uint8_t alpha = trial % 3 ? 0xFF : (uint8_t)(nextRandom() % 0x100);
+            const uint8_t decimals = (uint8_t)(nextRandom() % 4);
+            dma.setExecuting(true);
+
+            numeric.setGlyphAtlas(&atlases[font]);
+            numeric.setValue(randomValue(), decimals);
+            plain.setWildcard(numeric.getWildcard());
+            TextArea* const textAreas[2] = { &plain, &numeric };
+            for (int i = 0; i < 2; i++)
+            {
+                TextArea& t = *textAreas[i];
+                t.setPosition(x, y, width, height);
+                t.setTypedText(TypedText(0));
+                t.setIndentation(indentation);
+                t.setColor(color);
+                t.setAlpha(alpha);
+            }
+
+            for (int part = 0; part <= PARTS; part++)
+            {
+                Rect area(0, 0, width, height);
+                if (part > 0)
+                {
+                    area.x = (int16_t)(nextRandom() % width);
+                    area.y = (int16_t)(nextRandom() % height);
+                    area.width = (int16_t)(1 + nextRandom() % (width - area.x));
+                    area.height = (int16_t)(1 + nextRandom() % (height - area.y));
+                }
+                // What drawing all of the TextAreaWithOneWildcard leaves inside the area, and what drawing only the area leaves
+                const Rect absolute(x + area.x, y + area.y, area.width, area.height);
+                // LCD::drawString() is drawn without the DMA, the software blending is the reference
+                dma.setEnabled(false);
+                hal.clearFrameBuffer();
+                std::vector<uint8_t> whole(hal.getFrameBuffer(), hal.getFrameBuffer() + hal.getFrameBufferSize());
+                plain.draw(Rect(0, 0, width, height));
+                copyArea(&whole[0], hal.getFrameBuffer(), absolute);
+                hal.clearFrameBuffer();
+                plain.draw(area);
+                if (memcmp(hal.getFrameBuffer(), &whole[0], whole.size()) != 0)
+                {
+                    inconsistentParts++;
+                }
+                dma.setEnabled(trial % 2 == 0);
+                hal.clearFrameBuffer();
+                numeric.draw(area);
+                trials++;
+                if (memcmp(hal.getFrameBuffer(), &whole[0], whole.size()) != 0)
+                {
+                    if (mismatches++ == 0)
+                    {
+                        fprintf(stderr, "Numeric text differs: value %d decimals %d font %d alignment %d indentation %d%s%s in %d,%d %dx%d area %d,%d %dx%d alpha %d\n",
+                                (int)numeric.getValue(), numeric.getDecimals(), font, alignment, indentation, rotated ? " rotated" : "", trial % 2 == 0 ? " dma" : "", x, y, width, height,
+                                area.x, area.y, area.width, area.height, alpha);
+                    }
+                }
+            }
+
+            // Redraw what setValue() invalidates, where the previous value was drawn
+            hal.clearFrameBuffer();
+            const std::vector<uint8_t> background(hal.getFrameBuffer(), hal.getFrameBuffer() + hal.getFrameBufferSize());
+            numeric.draw(Rect(0, 0, width, height));
+            const int32_t value = trial % 4 == 0 ? randomValue() : numeric.getValue() + (int32_t)(nextRandom() % 41) - 20;
+            screen.areas.clear();
+            numeric.setValue(value, trial % 8 == 0 ? (uint8_t)(nextRandom() % 4) : decimals);
+            drawInvalidatedAreas(hal, screen, numeric, &background[0]);
+            for (size_t i = 0; i < screen.areas.size(); i++)
+            {
+                invalidatedPixels += (uint32_t)screen.areas[i].width * screen.areas[i].height;
+            }
+            widgetPixels += (uint32_t)width * height;
+            const std::vector<uint8_t> updated(hal.getFrameBuffer(), hal.getFrameBuffer() + hal.getFrameBufferSize());
+            memcpy(hal.getFrameBuffer(), &background[0], background.size());
+            numeric.draw(Rect(0, 0, width, height));
+            updates++;
+            if (memcmp(hal.getFrameBuffer(), &updated[0], updated.size()) != 0)
+            {
+                if (updateMismatches++ == 0)
+                {
+                    fprintf(stderr, "Update to %d differs: font %d alignment %d%s\n", (int)value, font, alignment, rotated ? " rotated" : "");
+                }
+            }
+        }
+    }
+    setRotation(rotate0);
+    screen.setPosition(0, 0, HAL::DISPLAY_WIDTH, HAL::DISPLAY_HEIGHT);
+
+    // Time a dashboard of fields whose values drift a little every tick
+    setTypedText(translation, 0, RIGHT);
+    static TextAreaWithOneWildcard plainFields[NUMBER_OF_FIELDS];
+    static NumericTextArea numericFields[NUMBER_OF_FIELDS];
+    static Unicode::UnicodeChar plainBuffers[NUMBER_OF_FIELDS][NumericTextArea::MAX_CHARACTERS + 1];
+    screen.removeAll();
+    for (int i = 0; i < NUMBER_OF_FIELDS; i++)
+    {
+        const int16_t fieldX = (int16_t)(i % FIELD_COLUMNS * (FIELD_WIDTH + 4));
+        const int16_t fieldY = (int16_t)(i / FIELD_COLUMNS * (FIELD_HEIGHT + 4));
+        plainFields[i].setPosition(fieldX, fieldY, FIELD_WIDTH, FIELD_HEIGHT);
+        plainFields[i].setTypedText(TypedText(0));
+        plainFields[i].setColor(0xFFFFFF);
+        plainFields[i].setWildcard(plainBuffers[i]);
+        numericFields[i].setPosition(fieldX, fieldY, FIELD_WIDTH, FIELD_HEIGHT);
+        numericFields[i].setTypedText(TypedText(0));
+        numericFields[i].setColor(0xFFFFFF);
+        numericFields[i].setGlyphAtlas(&atlases[0]);
+        screen.add(plainFields[i]);
+        screen.add(numericFields[i]);
+    }
+    struct Timing
+    {
+        const char* name;
+        double ns;
+        uint64_t pixels;
+        uint32_t blits;
+    } timings[3] = {
+        { "snprintf+drawString", 0, 0, 0 },
+        { "atlas drawGlyph", 0, 0, 0 },
+        { "atlas DMA", 0, 0, 0 },
+    };
+    for (int mode = 0; mode < 3; mode++)
+    {
+        dma.setEnabled(mode == 2);
+        dma.setExecuting(false);
+        dma.resetOperations();
+        int32_t values[NUMBER_OF_FIELDS];
+        seedRandom(12345);
+        for (int i = 0; i < NUMBER_OF_FIELDS; i++)
+        {
+            values[i] = 1000 + (int32_t)(nextRandom() % 50000);
+            Unicode::snprintf(plainBuffers[i], NumericTextArea::MAX_CHARACTERS + 1, "%d", values[i]);
+            numericFields[i].setValue(values[i]);
+        }
+        hal.clearFrameBuffer();
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int tick = 0; tick < iterations; tick++)
+        {
+            for (int i = 0; i < NUMBER_OF_FIELDS; i++)
+            {
+                values[i] += (int32_t)(nextRandom() % 21) - 10;
+                screen.areas.clear();
+                if (mode == 0)
+                {
+                    Unicode::snprintf(plainBuffers[i], NumericTextArea::MAX_CHARACTERS + 1, "%d", values[i]);
+                    plainFields[i].invalidate();
+                    drawInvalidatedAreas(hal, screen, plainFields[i], 0);
+                }
+                else
+                {
+                    numericFields[i].setValue(values[i]);
+                    drawInvalidatedAreas(hal, screen, numericFields[i], 0);
+                }
+                for (size_t a = 0; a < screen.areas.size(); a++)
+                {
+                    timings[mode].pixels += (uint32_t)screen.areas[a].width * screen.areas[a].height;
+                }
+            }
+        }
+        timings[mode].ns = elapsedNs(start);
+        timings[mode].blits = dma.getOperations();
+    }
+    dma.setEnabled(false);
+    dma.setExecuting(true);
+
+    const double fieldUpdates = (double)iterations * NUMBER_OF_FIELDS;
+    const bool ok = mismatches == 0 && updateMismatches == 0;
+    if (json)
+    {
+        printf("{\"iterations\": %d, \"fields\": %d, \"trials\": %u, \"mismatches\": %u, \"inconsistent_drawstring_parts\": %u, "
+               "\"updates\": %u, \"update_mismatches\": %u, \"invalidated_fraction\": %.3f, \"results\": [",
+               iterations, NUMBER_OF_FIELDS, trials, mismatches, inconsistentParts, updates, updateMismatches,
+               widgetPixels ? (double)invalidatedPixels / widgetPixels : 0);
+        for (int i = 0; i < 3; i++)
+        {
+            printf("%s\n  {\"update\": \"%s\", \"us_per_field\": %.3f, \"pixels_per_field\": %.1f, \"blits_per_field\": %.2f, \"speedup\": %.2f}", i ? "," : "",
+                   timings[i].name, timings[i].ns / fieldUpdates / 1e3, timings[i].pixels / fieldUpdates, timings[i].blits / fieldUpdates, timings[0].ns / timings[i].ns);
+        }
+        printf("\n]}\n");
+    }
+    else
+    {
+        printf("%-20s %14s %14s %10s %8s\n", "update", "per field", "invalidated", "blits", "speedup");
+        for (int i = 0; i < 3; i++)
+        {
+            printf("%-20s %11.3f us %11.1f px %10.2f %7.2fx\n", timings[i].name, timings[i].ns / fieldUpdates / 1e3,
+                   timings[i].pixels / fieldUpdates, timings[i].blits / fieldUpdates, timings[0].ns / timings[i].ns);
+        }
+        printf("%u/%u parts ok, %u/%u updates ok, %.1f%% of the widget invalidated per update %s\n", trials - mismatches, trials,
+               updates - updateMismatches, updates, widgetPixels ? 100.0 * invalidatedPixels / widgetPixels : 0.0, ok ? "ok" : "MISMATCH");
+        printf("%u parts drawn by drawString() differ from drawing the whole TextAreaWithOneWildcard\n", inconsistentParts);
+    }
+    for (int i = 0; i < NUMBER_OF_FONTS; i++)
+    {
+        atlases[i].destroy();
+        TypedTextDatabase::resetFont((FontId)i);
+        delete fonts[i];
+    }
+    return ok;
+}
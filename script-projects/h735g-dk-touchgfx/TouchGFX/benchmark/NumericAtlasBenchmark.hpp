@@ -0,0 +1,103 @@
+#ifndef NUMERICATLASBENCHMARK_HPP
+#define NUMERICATLASBENCHMARK_HPP
+
+#include <BenchmarkHAL.hpp>
+#include <touchgfx/hal/BlitOp.hpp>
+#include <touchgfx/hal/DMA.hpp>
+
+namespace touchgfx
+{
+/**
+ * DMA supporting only BLIT_OP_COPY_A4 and BLIT_OP_COPY_A8 into a 24 bpp
+ * framebuffer. Every operation is carried out in software when it is
+ * queued, blending like LCD24bpp, or only counted, to measure the CPU time
+ * spent issuing the operations to a real DMA.
+ */
+class GlyphCopyDMA : public DMA_Interface
+{
+public:
+    GlyphCopyDMA()
+        : DMA_Interface(q), q(&b, 1), enabled(false), executing(true), operations(0)
+    {
+    }
+
+    virtual BlitOperations getBlitCaps()
+    {
+        return static_cast<BlitOperations>(enabled ? BLIT_OP_COPY_A4 | BLIT_OP_COPY_A8 : 0);
+    }
+
+    virtual void addToQueue(const BlitOp& op);
+
+    virtual void setupDataCopy(const BlitOp& blitOp)
+    {
+    }
+
+    virtual void setupDataFill(const BlitOp& blitOp)
+    {
+    }
+
+    virtual void signalDMAInterrupt()
+    {
+    }
+
+    virtual void flush()
+    {
+    }
+
+    /** Reports the glyph copies in the blit caps, or no operations at all. */
+    void setEnabled(bool enable)
+    {
+        enabled = enable;
+    }
+
+    /** Carries out the queued operations, or only counts them. */
+    void setExecuting(bool execute)
+    {
+        executing = execute;
+    }
+
+    uint32_t getOperations() const
+    {
+        return operations;
+    }
+
+    void resetOperations()
+    {
+        operations = 0;
+    }
+
+private:
+    LockFreeDMA_Queue q;
+    BlitOp b;
+    bool enabled;
+    bool executing;
+    uint32_t operations;
+};
+} // namespace touchgfx
+
+/**
+ * Show random values in NumericTextAreas drawing from a GlyphAtlas and in
+ * TextAreaWithOneWildcards, in synthetic 4bpp and 8bpp digit fonts, random
+ * alignments, colors and alphas, with and without DMA glyph copies, on a
+ * display in its native orientation and rotated by 90 degrees. Random parts
+ * of the NumericTextArea are compared with what drawing all of the
+ * TextAreaWithOneWildcard without the DMA leaves inside the part.
+ * Redrawing only the areas invalidated by setValue() must leave the same
+ * framebuffer as drawing the new value whole. Reports the time to update a dashboard of numeric
+ * fields, with Unicode::snprintf() and LCD::drawString(), with the atlas
+ * drawn by LCD::drawGlyph(), and with the atlas copied by the DMA.
+ *
+ * Replaces the fonts and the translation of the text database, and
+ * registers the bitmap database with a cache for the atlases.
+ *
+ * @param hal        The initialized benchmark HAL, using dma.
+ * @param dma        The DMA of the HAL.
+ * @param iterations Number of timed dashboard updates.
+ * @param json       Write the result as JSON.
+ *
+ * @return True if every NumericTextArea matches the TextAreaWithOneWildcard
+ *         and every update matches drawing the new value.
+ */
+bool runNumericAtlasBenchmark(touchgfx::BenchmarkHAL& hal, touchgfx::GlyphCopyDMA& dma, int iterations, bool json);
+
+#endif // NUMERICATLASBENCHMARK_HPP
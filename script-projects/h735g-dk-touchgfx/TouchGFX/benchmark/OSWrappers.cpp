@@ -0,0 +1,44 @@
+#include <assert.h>
+#include <touchgfx/hal/OSWrappers.hpp>
+
+// The benchmark renders without vsync, so the OS abstraction only needs to
+// track the framebuffer lock. Threads rendering canvas widgets concurrently
+// draw disjoint parts of the framebuffer, so the lock is tracked per thread.
+
+namespace touchgfx
+{
+static thread_local bool framebufferLocked = false;
+
+void OSWrappers::initialize()
+{
+    framebufferLocked = false;
+}
+
+void OSWrappers::takeFrameBufferSemaphore()
+{
+    assert(!framebufferLocked && "Framebuffers already locked");
+    framebufferLocked = true;
+}
+
+void OSWrappers::giveFrameBufferSemaphore()
+{
+    assert(framebufferLocked && "Framebuffers not previously locked");
+    framebufferLocked = false;
+}
+
+void OSWrappers::waitForVSync()
+{
+}
+
+void OSWrappers::tryTakeFrameBufferSemaphore()
+{
+}
+
+void OSWrappers::giveFrameBufferSemaphoreFromISR()
+{
+}
+
+void OSWrappers::taskYield()
+{
+}
+} // namespace touchgfx
@@ -0,0 +1,334 @@
+#include <PainterBenchmark.hpp>
+#include <BenchmarkUtils.hpp>
+#include <touchgfx/lcd/LCD.hpp>
+#include <touchgfx/widgets/canvas/AbstractPainterRGB888.hpp>
+#include <touchgfx/widgets/canvas/PainterRGB565.hpp>
+#include <touchgfx/widgets/canvas/PainterRGB888.hpp>
+#include <touchgfx/widgets/canvas/SpanPainter.hpp>
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+
+using namespace touchgfx;
+
+namespace
+{
+const int SPAN_LENGTH = 4096;
+const int PAINTER_SPANS = 64;
+const int PAINTER_TRIALS = 20000;
+const int PAINTER_ROUNDS = 7;
+
+/** Blends the colors the way the painters did before mixColors(), one channel at a time. */
+uint32_t mixChannels(uint32_t newpix, uint32_t bufpix, uint8_t alpha)
+{
+    const uint8_t ialpha = 0xFF - alpha;
+    return (LCD::div255(((newpix >> 16) & 0xFF) * alpha + ((bufpix >> 16) & 0xFF) * ialpha) << 16) |
+           (LCD::div255(((newpix >> 8) & 0xFF) * alpha + ((bufpix >> 8) & 0xFF) * ialpha) << 8) |
+           LCD::div255((newpix & 0xFF) * alpha + (bufpix & 0xFF) * ialpha);
+}
+
+uint32_t checkMixColors()
+{
+    uint32_t mismatches = 0;
+    for (uint32_t alpha = 0; alpha < 256; alpha++)
+    {
+        for (uint32_t n = 0; n < 256; n++)
+        {
+            for (uint32_t b = 0; b < 256; b++)
+            {
+                // Every channel sees every pair of new and buffer value, with different values in each channel
+                const uint32_t newpix = (n << 16) | (b << 8) | (n ^ 0xA5);
+                const uint32_t bufpix = ((b ^ 0x3C) << 16) | (n << 8) | b;
+                if (AbstractPainterRGB888::mixColors(newpix, bufpix, alpha) != mixChannels(newpix, bufpix, alpha))
+                {
+                    mismatches++;
+                }
+            }
+        }
+    }
+    return mismatches;
+}
+
+struct Span
+{
+    uint32_t newpix[SPAN_LENGTH];
+    uint32_t bufpix[SPAN_LENGTH];
+    uint8_t alpha[SPAN_LENGTH];
+    uint32_t result[SPAN_LENGTH];
+};
+
+template <uint32_t (*mix)(uint32_t, uint32_t, uint8_t)>
+double timeMix(Span& span, int iterations)
+{
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        for (int j = 0; j < SPAN_LENGTH; j++)
+        {
+            span.result[j] = mix(span.newpix[j], span.bufpix[(j + i) % SPAN_LENGTH], span.alpha[j]);
+        }
+    }
+    return elapsedNs(start);
+}
+
+/** Lets the benchmark set the widget alpha, as CanvasWidgetRenderer does. */
+template <class Painter>
+class BenchmarkPainter : public Painter
+{
+public:
+    void setAlpha(uint8_t alpha)
+    {
+        this->setWidgetAlpha(alpha);
+    }
+};
+
+/** The painter drawing its color through SpanRenderer instead of its own loop. */
+template <class Painter, class Destination>
+class SpanRendererPainter : public BenchmarkPainter<Painter>
+{
+public:
+    virtual void render(uint8_t* ptr, int x, int xAdjust, int y, unsigned count, const uint8_t* covers)
+    {
+        SpanSourceColor source(this->getColor());
+        SpanRenderer<SpanSourceColor, Destination>::render(source, ptr + (x + xAdjust) * Destination::BYTES_PER_PIXEL, x, y, count, covers, this->widgetAlpha);
+    }
+};
+
+/** PainterRGB888 as it rendered before SpanRenderer, with its own loop blending each channel. */
+class LoopPainterRGB888 : public BenchmarkPainter<PainterRGB888>
+{
+public:
+    virtual void render(uint8_t* ptr, int x, int xAdjust, int /*y*/, unsigned count, const uint8_t* covers)
+    {
+        uint8_t* p = ptr + (x + xAdjust) * 3;
+        const uint8_t* const p_lineend = p + 3 * count;
+        uint8_t pByte;
+        if (widgetAlpha == 0xFF)
+        {
+            do
+            {
+                const uint8_t alpha = *covers++;
+                if (alpha == 0xFF)
+                {
+                    *p++ = painterBlue;
+                    *p++ = painterGreen;
+                    *p++ = painterRed;
+                }
+                else
+                {
+                    const uint8_t ialpha = 0xFF - alpha;
+                    pByte = *p;
+                    *p++ = LCD::div255(painterBlue * alpha + pByte * ialpha);
+                    pByte = *p;
+                    *p++ = LCD::div255(painterGreen * alpha + pByte * ialpha);
+                    pByte = *p;
+                    *p++ = LCD::div255(painterRed * alpha + pByte * ialpha);
+                }
+            } while (p < p_lineend);
+        }
+        else
+        {
+            do
+            {
+                const uint8_t alpha = LCD::div255(*covers++ * widgetAlpha);
+                const uint8_t ialpha = 0xFF - alpha;
+                pByte = *p;
+                *p++ = LCD::div255(painterBlue * alpha + pByte * ialpha);
+                pByte = *p;
+                *p++ = LCD::div255(painterGreen * alpha + pByte * ialpha);
+                pByte = *p;
+                *p++ = LCD::div255(painterRed * alpha + pByte * ialpha);
+            } while (p < p_lineend);
+        }
+    }
+};
+
+/** Alpha values of which a third is transparent and a third is solid. */
+uint8_t randomAlpha()
+{
+    const uint32_t r = nextRandom() % 3;
+    return r == 0 ? 0 : (r == 1 ? 0xFF : (uint8_t)nextRandom());
+}
+
+/** A span of a shape: where it starts in a line of the framebuffer, its covers, color and widget alpha. */
+struct CoverSpan
+{
+    int x;
+    unsigned count;
+    uint8_t covers[SPAN_LENGTH];
+    colortype color;
+    uint8_t widgetAlpha;
+};
+
+void randomCoverSpan(CoverSpan& span, int maxCount, uint8_t widgetAlpha)
+{
+    span.count = 1 + nextRandom() % maxCount;
+    span.x = nextRandom() % (SPAN_LENGTH - span.count + 1);
+    for (unsigned i = 0; i < span.count; i++)
+    {
+        span.covers[i] = randomAlpha();
+    }
+    span.color = nextRandom() & 0xFFFFFF;
+    span.widgetAlpha = widgetAlpha;
+}
+
+/** A line of the framebuffer, large enough for SPAN_LENGTH pixels of any format. */
+struct Line
+{
+    uint8_t pixels[SPAN_LENGTH * 3];
+};
+
+void randomLine(Line& line)
+{
+    for (unsigned i = 0; i < sizeof(line.pixels); i++)
+    {
+        line.pixels[i] = (uint8_t)nextRandom();
+    }
+}
+
+template <class Painter>
+void renderSpan(Painter& painter, Line& line, const CoverSpan& span)
+{
+    painter.setColor(span.color);
+    painter.setAlpha(span.widgetAlpha);
+    painter.render(line.pixels, span.x, 0, 0, span.count, span.covers);
+}
+
+/** Draws the same random spans on the same random lines with the loop of a painter and through SpanRenderer, returns the spans drawn differently. */
+template <class PainterLoop, class PainterSpan>
+uint32_t checkPainter()
+{
+    PainterLoop painter;
+    PainterSpan spanPainter;
+    static CoverSpan span;
+    static Line line;
+    static Line spanLine;
+    uint32_t mismatches = 0;
+    for (int i = 0; i < PAINTER_TRIALS; i++)
+    {
+        randomCoverSpan(span, i % 2 ? 16 : SPAN_LENGTH, nextRandom() % 2 ? 0xFF : (uint8_t)nextRandom());
+        randomLine(line);
+        spanLine = line;
+        renderSpan(painter, line, span);
+        renderSpan(spanPainter, spanLine, span);
+        if (memcmp(line.pixels, spanLine.pixels, sizeof(line.pixels)))
+        {
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+template <class Painter>
+double timePainter(Painter& painter, const CoverSpan* spans, uint64_t& pixels, int iterations)
+{
+    static Line line;
+    randomLine(line);
+    pixels = 0;
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        for (int j = 0; j < PAINTER_SPANS; j++)
+        {
+            renderSpan(painter, line, spans[j]);
+            pixels += spans[j].count;
+        }
+    }
+    return elapsedNs(start);
+}
+
+/** Time of the loop of a painter and of SpanRenderer drawing its color, with and without widget alpha, in the fastest round. */
+struct PainterTimes
+{
+    double loopNs[2];
+    double spanNs[2];
+    uint64_t pixels[2];
+};
+
+template <class PainterLoop, class PainterSpan>
+void timeLoopAndSpan(PainterTimes& times, int iterations)
+{
+    // Spans as drawn by canvas widgets, mostly short edges with a few long interiors
+    static CoverSpan spans[PAINTER_SPANS];
+    PainterLoop painter;
+    PainterSpan spanPainter;
+    for (int alpha = 0; alpha < 2; alpha++)
+    {
+        for (int i = 0; i < PAINTER_SPANS; i++)
+        {
+            randomCoverSpan(spans[i], i % 4 ? 16 : 480, alpha ? 128 : 0xFF);
+        }
+        // Alternate the two in rounds and keep the fastest round of each, the host is noisy
+        times.loopNs[alpha] = 0;
+        times.spanNs[alpha] = 0;
+        for (int round = 0; round < PAINTER_ROUNDS; round++)
+        {
+            const double loopNs = timePainter(painter, spans, times.pixels[alpha], iterations);
+            const double spanNs = timePainter(spanPainter, spans, times.pixels[alpha], iterations);
+            times.loopNs[alpha] = round == 0 ? loopNs : MIN(times.loopNs[alpha], loopNs);
+            times.spanNs[alpha] = round == 0 ? spanNs : MIN(times.spanNs[alpha], spanNs);
+        }
+    }
+}
+} // namespace
+
+bool runPainterBenchmark(int iterations, bool json)
+{
+    seedRandom(1);
+    const uint32_t mismatches = checkMixColors();
+    const bool ok = mismatches == 0;
+
+    static Span span;
+    for (int i = 0; i < SPAN_LENGTH; i++)
+    {
+        span.newpix[i] = nextRandom() & 0xFFFFFF;
+        span.bufpix[i] = nextRandom() & 0xFFFFFF;
+        span.alpha[i] = (uint8_t)nextRandom();
+    }
+    const double channelsNs = timeMix<mixChannels>(span, iterations);
+    const double packedNs = timeMix<AbstractPainterRGB888::mixColors>(span, iterations);
+    const uint64_t mixedPixels = (uint64_t)SPAN_LENGTH * iterations;
+
+    // PainterRGB565 keeps its own loop, PainterRGB888 renders through SpanRenderer
+    typedef BenchmarkPainter<PainterRGB565> LoopPainterRGB565;
+    typedef SpanRendererPainter<PainterRGB565, SpanDestinationRGB565> SpanPainterRGB565;
+    typedef SpanRendererPainter<PainterRGB888, SpanDestinationRGB888> SpanPainterRGB888;
+    const uint32_t rgb565Mismatches = checkPainter<LoopPainterRGB565, SpanPainterRGB565>();
+    const uint32_t rgb888Mismatches = checkPainter<LoopPainterRGB888, SpanPainterRGB888>();
+    const bool spansOk = rgb565Mismatches == 0 && rgb888Mismatches == 0;
+
+    PainterTimes rgb565;
+    PainterTimes rgb888;
+    timeLoopAndSpan<LoopPainterRGB565, SpanPainterRGB565>(rgb565, iterations);
+    timeLoopAndSpan<LoopPainterRGB888, SpanPainterRGB888>(rgb888, iterations);
+
+    if (json)
+    {
+        printf("{\"scene\": \"painters\", \"iterations\": %d, \"mix_colors_inputs\": %u, \"mix_colors_mismatches\": %u, "
+               "\"painter_spans\": %d, \"rgb565_mismatches\": %u, \"rgb888_mismatches\": %u, \"ok\": %s, \"results\": [",
+               iterations, 1u << 24, (unsigned)mismatches, PAINTER_TRIALS, (unsigned)rgb565Mismatches, (unsigned)rgb888Mismatches, ok && spansOk ? "true" : "false");
+        printThroughput("blend", "div255_per_channel", channelsNs, mixedPixels, json, true);
+        printThroughput("blend", "mix_colors_packed", packedNs, mixedPixels, json, false);
+    }
+    else
+    {
+        printf("%-30s %8u inputs %8u mismatches  %s\n", "mix_colors_rgb888", 1u << 24, (unsigned)mismatches, ok ? "ok" : "FAILED");
+        printThroughput("blend", "div255_per_channel", channelsNs, mixedPixels, json, true);
+        printThroughput("blend", "mix_colors_packed", packedNs, mixedPixels, json, false);
+        printf("%-30s %8d spans  %8u mismatches  %s\n", "painter_rgb565", PAINTER_TRIALS, (unsigned)rgb565Mismatches, rgb565Mismatches == 0 ? "ok" : "FAILED");
+        printf("%-30s %8d spans  %8u mismatches  %s\n", "painter_rgb888", PAINTER_TRIALS, (unsigned)rgb888Mismatches, rgb888Mismatches == 0 ? "ok" : "FAILED");
+    }
+    printThroughput("blend", "loop_rgb565", rgb565.loopNs[0], rgb565.pixels[0], json, false);
+    printThroughput("blend", "span_renderer_rgb565", rgb565.spanNs[0], rgb565.pixels[0], json, false);
+    printThroughput("blend", "loop_rgb565_alpha", rgb565.loopNs[1], rgb565.pixels[1], json, false);
+    printThroughput("blend", "span_renderer_rgb565_alpha", rgb565.spanNs[1], rgb565.pixels[1], json, false);
+    printThroughput("blend", "loop_rgb888", rgb888.loopNs[0], rgb888.pixels[0], json, false);
+    printThroughput("blend", "span_renderer_rgb888", rgb888.spanNs[0], rgb888.pixels[0], json, false);
+    printThroughput("blend", "loop_rgb888_alpha", rgb888.loopNs[1], rgb888.pixels[1], json, false);
+    printThroughput("blend", "span_renderer_rgb888_alpha", rgb888.spanNs[1], rgb888.pixels[1], json, false);
+    if (json)
+    {
+        printf("\n]}\n");
+    }
+    return ok && spansOk;
+}
@@ -0,0 +1,27 @@
+#ifndef PAINTERBENCHMARK_HPP
+#define PAINTERBENCHMARK_HPP
+
+/**
+ * Blend every combination of new pixel, buffer pixel and alpha, 2^24 per
+ * color channel, with AbstractPainterRGB888::mixColors() and with each
+ * channel blended using LCD::div255(), and compare the results. Red and
+ * blue hold different values, so a carry between the two lanes of
+ * mixColors() shows up as a mismatch. Reports the throughput of both on
+ * spans of random pixels.
+ *
+ * Then fill random spans of a RGB565 and of a RGB888 framebuffer, with
+ * random covers, colors and widget alpha, through the own loop of
+ * PainterRGB565 and PainterRGB888 and through SpanRenderer, and compare
+ * the framebuffers. Reports the throughput of both with and without widget
+ * alpha, in the fastest of several alternating rounds. PainterRGB565 keeps
+ * its loop, PainterRGB888 renders through SpanRenderer.
+ *
+ * @param iterations Number of timed blends of each span.
+ * @param json       Write the result as JSON.
+ *
+ * @return True if mixColors() matches the per-channel blend for every input
+ *         and SpanRenderer draws the same pixels as the loops.
+ */
+bool runPainterBenchmark(int iterations, bool json);
+
+#endif // PAINTERBENCHMARK_HPP
@@ -0,0 +1,260 @@
+#include <RegionBenchmark.hpp>
+#include <BenchmarkUtils.hpp>
+#include <gui/common/DirtyRegion.hpp>
+#include <touchgfx/Application.hpp>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+using namespace touchgfx;
+
+namespace
+{
+/** Gives access to the dirty area bookkeeping of Application. */
+class ApplicationRegions : public Application
+{
+public:
+    void beginFrame()
+    {
+        cachedDirtyAreas.clear();
+    }
+
+    void invalidate(const Rect& area)
+    {
+        invalidateArea(area);
+    }
+
+    /** What Application::cacheDrawOperations(false) draws when double buffering. */
+    void endFrame()
+    {
+        const RectVector_t frame = cachedDirtyAreas;
+        for (uint16_t i = 0; i < lastRects.size(); i++)
+        {
+            invalidateArea(lastRects[i]);
+        }
+        drawn = cachedDirtyAreas;
+        lastRects = frame;
+    }
+
+    RectVector_t drawn;
+};
+
+// Size of the display of the board
+const int WIDTH = 480;
+const int HEIGHT = 272;
+
+const int MAX_INVALIDATIONS = 64;
+
+struct Frame
+{
+    Rect areas[MAX_INVALIDATIONS];
+    int count;
+};
+
+struct Totals
+{
+    uint64_t rects;
+    uint64_t drawnPixels;
+    double elapsedNs;
+};
+
+void addArea(Frame& frame, const Rect& area)
+{
+    if (frame.count < MAX_INVALIDATIONS && !area.isEmpty())
+    {
+        frame.areas[frame.count++] = area;
+    }
+}
+
+Rect needleArea(int centerX, int centerY, int radius, float angle)
+{
+    const int endX = centerX + (int)(cosf(angle) * radius);
+    const int endY = centerY - (int)(sinf(angle) * radius);
+    const int x = MIN(centerX, endX) - 2;
+    const int y = MIN(centerY, endY) - 2;
+    return Rect(x, y, abs(endX - centerX) + 5, abs(endY - centerY) + 5);
+}
+
+/**
+ * A dashboard with 24 numeric readouts, 4 bar gauges, 3 needle gauges and a
+ * clock, each updating independently.
+ */
+void buildFrame(Frame& frame, int index)
+{
+    static int barLevels[4] = { 50, 50, 50, 50 };
+    static float needleAngles[3] = { 0.5f, 1.5f, 2.5f };
+
+    frame.count = 0;
+    for (int i = 0; i < 24; i++)
+    {
+        if (nextRandom() % 2)
+        {
+            addArea(frame, Rect(16 + (i % 6) * 76, 20 + (i / 6) * 30, 56, 18));
+        }
+    }
+    for (int i = 0; i < 4; i++)
+    {
+        const int level = MAX(0, MIN(100, barLevels[i] + (int)(nextRandom() % 9) - 4));
+        if (level != barLevels[i])
+        {
+            const int top = 250 - MAX(level, barLevels[i]);
+            addArea(frame, Rect(20 + i * 24, top, 12, abs(level - barLevels[i])));
+            barLevels[i] = level;
+        }
+    }
+    for (int i = 0; i < 3; i++)
+    {
+        addArea(frame, needleArea(170 + i * 90, 210, 36, needleAngles[i]));
+        needleAngles[i] += 0.03f * (i + 1);
+        if (needleAngles[i] > 3.1f)
+        {
+            needleAngles[i] -= 3.1f;
+        }
+        addArea(frame, needleArea(170 + i * 90, 210, 36, needleAngles[i]));
+    }
+    if (index % 10 == 0)
+    {
+        addArea(frame, Rect(390, 236, 80, 24));
+    }
+}
+
+uint8_t needed[WIDTH * HEIGHT];
+uint8_t covered[WIDTH * HEIGHT];
+
+void fill(uint8_t* mask, const Rect& area)
+{
+    const Rect r = area & Rect(0, 0, WIDTH, HEIGHT);
+    for (int y = r.y; y < r.bottom(); y++)
+    {
+        for (int x = r.x; x < r.right(); x++)
+        {
+            mask[y * WIDTH + x]++;
+        }
+    }
+}
+
+/** Check that the region covers every needed pixel exactly once. */
+bool verify(const DirtyRegion& region)
+{
+    memset(covered, 0, sizeof(covered));
+    for (uint16_t i = 0; i < region.size(); i++)
+    {
+        fill(covered, region[i]);
+    }
+    for (int i = 0; i < WIDTH * HEIGHT; i++)
+    {
+        if (covered[i] > 1 || (needed[i] && !covered[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void printTotals(const char* name, const Totals& totals, uint64_t dirtyPixels, int iterations, bool json, bool first)
+{
+    const double rects = (double)totals.rects / iterations;
+    const double pixels = (double)totals.drawnPixels / iterations;
+    const double overdraw = dirtyPixels ? (double)totals.drawnPixels / dirtyPixels : 1.0;
+    const double cost = pixels + rects * DirtyRegion::DEFAULT_RECT_COST;
+    const double usPerFrame = totals.elapsedNs / 1000.0 / iterations;
+    if (json)
+    {
+        printf("%s\n    {\"engine\": \"%s\", \"rects_per_frame\": %.2f, \"drawn_pixels_per_frame\": %.0f, "
+               "\"overdraw\": %.3f, \"cost_per_frame\": %.0f, \"us_per_frame\": %.2f}",
+               first ? "" : ",", name, rects, pixels, overdraw, cost, usPerFrame);
+    }
+    else
+    {
+        printf("%-30s %6.2f rects %8.0f px %6.3f overdraw %8.0f cost %8.2f us/frame\n",
+               name, rects, pixels, overdraw, cost, usPerFrame);
+    }
+}
+} // namespace
+
+bool runRegionBenchmark(int iterations, bool json)
+{
+    seedRandom(1);
+    const Rect display(0, 0, WIDTH, HEIGHT);
+    ApplicationRegions application;
+    DirtyRegion dirtyRegion;
+    DirtyRegion lastRegion;
+    DirtyRegion frameRegion;
+    dirtyRegion.setBounds(display);
+
+    Totals vectorTotals = { 0, 0, 0 };
+    Totals regionTotals = { 0, 0, 0 };
+    uint64_t dirtyPixels = 0;
+    bool ok = true;
+
+    Frame frames[2];
+    for (int i = 0; i < iterations; i++)
+    {
+        Frame& frame = frames[i % 2];
+        const Frame& lastFrame = frames[(i + 1) % 2];
+        buildFrame(frame, i);
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        application.beginFrame();
+        for (int j = 0; j < frame.count; j++)
+        {
+            application.invalidate(frame.areas[j] & display);
+        }
+        application.endFrame();
+        vectorTotals.elapsedNs += elapsedNs(start);
+        vectorTotals.rects += application.drawn.size();
+        for (uint16_t j = 0; j < application.drawn.size(); j++)
+        {
+            vectorTotals.drawnPixels += application.drawn[j].area();
+        }
+
+        // Same steps as FrontendApplication::cacheDrawOperations()
+        start = std::chrono::steady_clock::now();
+        for (int j = 0; j < frame.count; j++)
+        {
+            dirtyRegion.add(frame.areas[j]);
+        }
+        frameRegion = dirtyRegion;
+        frameRegion.add(lastRegion);
+        lastRegion = dirtyRegion;
+        frameRegion.optimize();
+        dirtyRegion.clear();
+        regionTotals.elapsedNs += elapsedNs(start);
+        const DirtyRegion::Statistics statistics = frameRegion.getStatistics();
+        regionTotals.rects += statistics.rects;
+        regionTotals.drawnPixels += statistics.drawnPixels;
+
+        memset(needed, 0, sizeof(needed));
+        for (int j = 0; j < frame.count; j++)
+        {
+            fill(needed, frame.areas[j]);
+        }
+        for (int j = 0; i > 0 && j < lastFrame.count; j++)
+        {
+            fill(needed, lastFrame.areas[j]);
+        }
+        for (int j = 0; j < WIDTH * HEIGHT; j++)
+        {
+            dirtyPixels += needed[j] ? 1 : 0;
+        }
+        ok = ok && verify(frameRegion);
+    }
+
+    if (json)
+    {
+        printf("{\"scene\": \"dirty_regions\", \"iterations\": %d, \"dirty_pixels_per_frame\": %.0f, \"ok\": %s, \"results\": [",
+               iterations, (double)dirtyPixels / iterations, ok ? "true" : "false");
+    }
+    else
+    {
+        printf("%-30s %8.0f dirty px/frame  %s\n", "dirty_regions", (double)dirtyPixels / iterations, ok ? "ok" : "FAILED");
+    }
+    printTotals("application_vector8", vectorTotals, dirtyPixels, iterations, json, true);
+    printTotals("dirty_region", regionTotals, dirtyPixels, iterations, json, false);
+    if (json)
+    {
+        printf("\n]}\n");
+    }
+    return ok;
+}
@@ -0,0 +1,19 @@
+#ifndef REGIONBENCHMARK_HPP
+#define REGIONBENCHMARK_HPP
+
+/**
+ * Invalidate the areas of a dashboard with many small, independently
+ * updating widgets, and compare the areas Application would draw using its
+ * fixed vector of rectangles with the areas drawn using DirtyRegion. Reports
+ * rectangles, drawn pixels and overdraw per frame, including the areas of
+ * the previous frame as when double buffering.
+ *
+ * @param iterations Number of frames.
+ * @param json       Write the result as JSON.
+ *
+ * @return True if every DirtyRegion covered all dirty pixels without
+ *         drawing any pixel twice.
+ */
+bool runRegionBenchmark(int iterations, bool json);
+
+#endif // REGIONBENCHMARK_HPP
@@ -0,0 +1,424 @@
+#include <ScrollBlitBenchmark.hpp>
+#include <BenchmarkUtils.hpp>
+#include <touchgfx/Application.hpp>
+#include <touchgfx/Callback.hpp>
+#include <touchgfx/Color.hpp>
+#include <touchgfx/Screen.hpp>
+#include <touchgfx/containers/BlitScrollableContainer.hpp>
+#include <touchgfx/containers/Container.hpp>
+#include <touchgfx/containers/ScrollableContainer.hpp>
+#include <touchgfx/containers/scrollers/BlitScroller.hpp>
+#include <touchgfx/containers/scrollers/DrawableList.hpp>
+#include <touchgfx/containers/scrollers/ScrollList.hpp>
+#include <touchgfx/containers/scrollers/ScrollWheel.hpp>
+#include <touchgfx/events/ClickEvent.hpp>
+#include <touchgfx/events/DragEvent.hpp>
+#include <touchgfx/events/GestureEvent.hpp>
+#include <touchgfx/widgets/Box.hpp>
+#include <chrono>
+#include <stdio.h>
+#include <vector>
+
+using namespace touchgfx;
+
+namespace
+{
+/**
+ * Collects the areas invalidated on the current screen, and draws them like the Application
+ * does with double buffering.
+ */
+class FrameApplication : public Application
+{
+public:
+    FrameApplication()
+        : Application(), previousInstance(instance), previousScreen(currentScreen)
+    {
+        instance = this;
+    }
+
+    virtual ~FrameApplication()
+    {
+        instance = previousInstance;
+        currentScreen = previousScreen;
+    }
+
+    void show(Screen& screen)
+    {
+        currentScreen = &screen;
+        dirty.clear();
+        lastDirty.clear();
+    }
+
+    using Application::draw;
+
+    virtual void draw(Rect& rect)
+    {
+        const Rect area = rect & Rect(0, 0, HAL::DISPLAY_WIDTH, HAL::DISPLAY_HEIGHT);
+        if (!area.isEmpty())
+        {
+            dirty.push_back(area);
+        }
+    }
+
+    /**
+     * Draws the areas invalidated in this frame, and in the frame before as the other
+     * framebuffer has not seen them yet, and shows the framebuffer if anything was drawn.
+     *
+     * @return The number of pixels drawn.
+     */
+    uint32_t endFrame(BenchmarkHAL& hal)
+    {
+        uint32_t pixels = 0;
+        std::vector<Rect> areas(dirty);
+        areas.insert(areas.end(), lastDirty.begin(), lastDirty.end());
+        for (unsigned i = 0; i < areas.size(); i++)
+        {
+            currentScreen->startSMOC(areas[i]);
+            pixels += (uint32_t)areas[i].width * areas[i].height;
+        }
+        if (!areas.empty())
+        {
+            hal.showClientFrameBuffer();
+        }
+        lastDirty.swap(dirty);
+        dirty.clear();
+        return pixels;
+    }
+
+private:
+    Application* previousInstance;
+    Screen* previousScreen;
+    std::vector<Rect> dirty;
+    std::vector<Rect> lastDirty;
+};
+
+colortype rowColor(int index)
+{
+    return Color::getColorFromRGB((uint8_t)(index * 67 + 30), (uint8_t)(index * 131 + 40), (uint8_t)(index * 29 + 90));
+}
+
+/** A row of a scroller, a solid box with a blended stripe. */
+class Row : public Container
+{
+public:
+    Row()
+    {
+        add(background);
+        add(stripe);
+        stripe.setAlpha(140);
+    }
+
+    void setItem(int item)
+    {
+        background.setPosition(0, 0, getWidth(), getHeight());
+        background.setColor(rowColor(item));
+        stripe.setPosition(6 + (item * 23) % 50, getHeight() / 4, getWidth() / 3, getHeight() / 2);
+        stripe.setColor(rowColor(item + 7));
+    }
+
+private:
+    Box background;
+    Box stripe;
+};
+
+const int ROWS = 24;
+const int ITEMS = 30;
+const int CYCLE = 48;
+
+/**
+ * A screen with a scroller, a label on top of a corner of the scroller and a semi transparent
+ * box moving across the screen. Every frame changes a row now and then, scrolls, and moves
+ * the box. A cycle of frames presses, drags with pauses and a long jump, and releases with a
+ * swipe or an animation.
+ */
+class ScrollScene
+{
+public:
+    virtual ~ScrollScene()
+    {
+    }
+
+    void build()
+    {
+        Container& root = screen.getRootContainer();
+        background.setPosition(0, 0, root.getWidth(), root.getHeight());
+        background.setColor(Color::getColorFromRGB(40, 44, 52));
+        root.add(background);
+        addScroller(root);
+        const Drawable& scroller = getScroller();
+        label.setPosition(scroller.getRect().right() - 60, scroller.getY() - 8, 70, 24);
+        label.setColor(Color::getColorFromRGB(230, 230, 230));
+        root.add(label);
+        overlay.setPosition(0, 90, 48, 36);
+        overlay.setColor(Color::getColorFromRGB(250, 200, 40));
+        overlay.setAlpha(150);
+        root.add(overlay);
+        root.invalidate();
+    }
+
+    void frame(FrameApplication& application, int frame)
+    {
+        seedRandom(frame * 7919 + 1);
+        Drawable& scroller = getScroller();
+        if (application.getTimerWidgetCountForDrawable(&scroller) > 0)
+        {
+            scroller.handleTickEvent();
+        }
+        if (frame % 6 == 0)
+        {
+            changeRow(frame);
+        }
+
+        const int step = frame % CYCLE;
+        if (step == 0)
+        {
+            fingerX = scroller.getWidth() / 2;
+            fingerY = scroller.getHeight() / 2;
+            scroller.handleClickEvent(ClickEvent(ClickEvent::PRESSED, fingerX, fingerY));
+        }
+        else if (step < CYCLE / 2 && step != 10 && step != 11)
+        {
+            // Pauses let the framebuffers catch up, the jump is longer than the scroller
+            const int16_t deltaX = randomBetween(-3, 3);
+            const int16_t deltaY = step == 17 ? (randomBetween(0, 1) ? 250 : -250) : randomBetween(-9, 9);
+            scroller.handleDragEvent(DragEvent(DragEvent::DRAGGED, fingerX, fingerY, fingerX + deltaX, fingerY + deltaY));
+            fingerX += deltaX;
+            fingerY += deltaY;
+        }
+        else if (step == CYCLE / 2)
+        {
+            scroller.handleClickEvent(ClickEvent(ClickEvent::RELEASED, fingerX, fingerY));
+            release();
+        }
+
+        const int bounce = frame % 40 < 20 ? frame % 20 : 20 - frame % 20;
+        overlay.moveTo((int16_t)((frame * 5) % (screen.getRootContainer().getWidth() + 48) - 48), (int16_t)(90 + bounce * 4));
+    }
+
+    virtual const char* getName() const = 0;
+
+    Screen screen;
+
+protected:
+    ScrollScene()
+        : fingerX(0), fingerY(0)
+    {
+    }
+
+    virtual void addScroller(Container& root) = 0;
+    virtual Drawable& getScroller() = 0;
+    virtual void changeRow(int frame) = 0;
+    virtual void release() = 0;
+
+    Box background;
+    Box label;
+    Box overlay;
+    int16_t fingerX;
+    int16_t fingerY;
+};
+
+/** A ScrollableContainer, or a BlitScrollableContainer, of rows wider than the container. */
+template <class C>
+class ContainerScene : public ScrollScene
+{
+public:
+    virtual const char* getName() const
+    {
+        return "scrollable_container";
+    }
+
+protected:
+    virtual void addScroller(Container& root)
+    {
+        container.setPosition(40, 24, 320, 220);
+        for (int i = 0; i < ROWS; i++)
+        {
+            rows[i].setPosition(0, i * 44, 420, 44);
+            rows[i].setItem(i);
+            container.add(rows[i]);
+        }
+        root.add(container);
+    }
+
+    virtual Drawable& getScroller()
+    {
+        return container;
+    }
+
+    virtual void changeRow(int frame)
+    {
+        Row& row = rows[randomBetween(0, ROWS - 1)];
+        row.setItem(frame);
+        row.invalidate();
+    }
+
+    virtual void release()
+    {
+        const int velocity = randomBetween(8, 20);
+        container.handleGestureEvent(GestureEvent(GestureEvent::SWIPE_VERTICAL, randomBetween(0, 1) ? velocity : -velocity, fingerX, fingerY));
+    }
+
+    C container;
+    Row rows[ROWS];
+};
+
+void configure(ScrollList& list)
+{
+    list.setCircular(false);
+    list.setSnapping(false);
+}
+
+void configure(ScrollWheel& wheel)
+{
+    wheel.setCircular(true);
+    wheel.setSelectedItemOffset(92);
+}
+
+/** A ScrollList or a ScrollWheel, as is or as a BlitScroller, of rows. */
+template <class L>
+class ListScene : public ScrollScene
+{
+public:
+    ListScene(const char* sceneName)
+        : name(sceneName), updateItemCallback(this, &ListScene::updateItem)
+    {
+        for (int i = 0; i < ITEMS; i++)
+        {
+            versions[i] = i;
+        }
+    }
+
+    virtual const char* getName() const
+    {
+        return name;
+    }
+
+protected:
+    virtual void addScroller(Container& root)
+    {
+        list.setPosition(60, 20, 200, 232);
+        list.setHorizontal(false);
+        configure(list);
+        list.setNumberOfItems(ITEMS);
+        list.setDrawableSize(48, 0);
+        list.setDrawables(rows, updateItemCallback);
+        root.add(list);
+    }
+
+    virtual Drawable& getScroller()
+    {
+        return list;
+    }
+
+    virtual void changeRow(int frame)
+    {
+        const int item = randomBetween(0, ITEMS - 1);
+        versions[item] = frame;
+        list.itemChanged(item);
+    }
+
+    virtual void release()
+    {
+        list.animateToItem(randomBetween(0, ITEMS - 1), randomBetween(8, 20));
+    }
+
+    void updateItem(DrawableListItemsInterface* items, int16_t containerIndex, int16_t itemIndex)
+    {
+        rows[containerIndex].setItem(versions[itemIndex]);
+        rows[containerIndex].invalidate();
+    }
+
+    const char* name;
+    L list;
+    DrawableListItems<Row, 8> rows;
+    Callback<ListScene, DrawableListItemsInterface*, int16_t, int16_t> updateItemCallback;
+    int versions[ITEMS];
+};
+
+struct Run
+{
+    std::vector<uint32_t> hashes;
+    double frameNs;
+    double pixels;
+};
+
+/** Runs the frames of a scene from the same framebuffers, and hashes the shown framebuffer. */
+Run runScene(BenchmarkHAL& hal, FrameApplication& application, ScrollScene& scene, int iterations)
+{
+    Run run;
+    run.frameNs = 0;
+    run.pixels = 0;
+    hal.enableDoubleBuffering();
+    application.show(scene.screen);
+    scene.build();
+    application.endFrame(hal);
+    for (int frame = 0; frame < iterations; frame++)
+    {
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        scene.frame(application, frame);
+        run.pixels += application.endFrame(hal);
+        run.frameNs += elapsedNs(start);
+        run.hashes.push_back(hal.hashTFTFrameBuffer());
+    }
+    run.frameNs /= iterations;
+    run.pixels /= iterations;
+    return run;
+}
+} // namespace
+
+bool runScrollBlitBenchmark(BenchmarkHAL& hal, int iterations, bool json)
+{
+    FrameApplication application;
+    bool ok = true;
+
+    if (json)
+    {
+        printf("{\"scene\": \"scroll_blit\", \"iterations\": %d, \"results\": [", iterations);
+    }
+    else
+    {
+        printf("%-30s %12s %12s %12s %12s  %s\n", "scroll_blit", "frame ns", "blit", "pixels", "blit", "");
+    }
+    for (int i = 0; i < 3; i++)
+    {
+        ScrollScene* plain = 0;
+        ScrollScene* blit = 0;
+        if (i == 0)
+        {
+            plain = new ContainerScene<ScrollableContainer>();
+            blit = new ContainerScene<BlitScrollableContainer>();
+        }
+        else if (i == 1)
+        {
+            plain = new ListScene<ScrollList>("scroll_list");
+            blit = new ListScene<BlitScroller<ScrollList> >("scroll_list");
+        }
+        else
+        {
+            plain = new ListScene<ScrollWheel>("scroll_wheel");
+            blit = new ListScene<BlitScroller<ScrollWheel> >("scroll_wheel");
+        }
+        const Run plainRun = runScene(hal, application, *plain, iterations);
+        const Run blitRun = runScene(hal, application, *blit, iterations);
+        const bool same = plainRun.hashes == blitRun.hashes;
+        ok = ok && same;
+
+        if (json)
+        {
+            printf("%s\n  {\"name\": \"%s\", \"frame_ns\": %.1f, \"blit_frame_ns\": %.1f, \"pixels\": %.1f, \"blit_pixels\": %.1f, \"ok\": %s}",
+                   i == 0 ? "" : ",", plain->getName(), plainRun.frameNs, blitRun.frameNs, plainRun.pixels, blitRun.pixels, same ? "true" : "false");
+        }
+        else
+        {
+            printf("%-30s %12.1f %12.1f %12.1f %12.1f  %s\n", plain->getName(), plainRun.frameNs, blitRun.frameNs, plainRun.pixels, blitRun.pixels, same ? "ok" : "FAILED");
+        }
+        delete plain;
+        delete blit;
+    }
+    if (json)
+    {
+        printf("\n]}\n");
+    }
+    hal.disableDoubleBuffering();
+    return ok;
+}
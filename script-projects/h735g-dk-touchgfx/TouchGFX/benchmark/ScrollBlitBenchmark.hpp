@@ -0,0 +1,24 @@
+#ifndef SCROLLBLITBENCHMARK_HPP
+#define SCROLLBLITBENCHMARK_HPP
+
+#include <BenchmarkHAL.hpp>
+
+/**
+ * Scroll a ScrollableContainer, a ScrollList and a circular ScrollWheel of
+ * solid rows with blended stripes, under a moving semi transparent box, by
+ * dragging, swiping and jumping. Every scroller is built twice, as is and
+ * with scrolling by copying the pixels of the framebuffer, and drawn with
+ * double buffering like the Application does: the areas invalidated in a
+ * frame and in the frame before are drawn, and the framebuffer is shown.
+ * The shown framebuffer must be the same after every frame. Reports the time
+ * per frame and the pixels drawn per frame.
+ *
+ * @param [in] hal        The HAL, drawing with double buffering while the benchmark runs.
+ * @param      iterations Number of frames for every scroller.
+ * @param      json       Write the result as JSON.
+ *
+ * @return True if the shown framebuffers always match.
+ */
+bool runScrollBlitBenchmark(touchgfx::BenchmarkHAL& hal, int iterations, bool json);
+
+#endif // SCROLLBLITBENCHMARK_HPP
@@ -0,0 +1,615 @@
+#include <VideoDecodeBenchmark.hpp>
+#include <BenchmarkUtils.hpp>
+#include <FrameCacheMJPEGDecoder.hpp>
+#include <gui/common/DecodeAheadVideoController.hpp>
+#include <touchgfx/Application.hpp>
+#include <touchgfx/Screen.hpp>
+#include <touchgfx/hal/Types.hpp>
+#include <touchgfx/widgets/VideoWidget.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+#include <jpeglib.h>
+
+using namespace touchgfx;
+
+// The generated controller uses Bitmap unqualified
+#include <simulator/video/DirectFrameBufferVideoController.hpp>
+
+namespace
+{
+const uint16_t VIDEO_WIDTH = 480;
+const uint16_t VIDEO_HEIGHT = 272;
+const int VIDEO_FRAMES = 16;
+const int QUALITY = 85;
+/** The decoder draws RGB888, see VIDEO_DECODE_FORMAT. */
+const uint32_t BYTES_PER_PIXEL = 3;
+
+void putU32(std::vector<uint8_t>& data, uint32_t offset, uint32_t value)
+{
+    data[offset + 0] = (uint8_t)value;
+    data[offset + 1] = (uint8_t)(value >> 8);
+    data[offset + 2] = (uint8_t)(value >> 16);
+    data[offset + 3] = (uint8_t)(value >> 24);
+}
+
+void appendU32(std::vector<uint8_t>& data, uint32_t value)
+{
+    data.resize(data.size() + 4);
+    putU32(data, (uint32_t)data.size() - 4, value);
+}
+
+void appendFourCC(std::vector<uint8_t>& data, const char* fourcc)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        data.push_back((uint8_t)fourcc[i]);
+    }
+}
+
+/** Gradients, a moving box and a little noise, compressed with libjpeg. */
+std::vector<uint8_t> encodeFrame(int frame)
+{
+    std::vector<uint8_t> rgb(VIDEO_WIDTH * VIDEO_HEIGHT * 3);
+    for (int y = 0; y < VIDEO_HEIGHT; y++)
+    {
+        for (int x = 0; x < VIDEO_WIDTH; x++)
+        {
+            uint8_t* const pixel = &rgb[(y * VIDEO_WIDTH + x) * 3];
+            const bool inBox = ((x - frame * 17) & 255) < 96 && ((y + frame * 5) & 127) < 48;
+            const uint8_t noise = (uint8_t)(nextRandom() & 15);
+            pixel[0] = inBox ? 240 : (uint8_t)(x * 255 / VIDEO_WIDTH + noise);
+            pixel[1] = inBox ? 64 : (uint8_t)(y * 255 / VIDEO_HEIGHT + noise);
+            pixel[2] = (uint8_t)((x + y + frame * 8) & 255);
+        }
+    }
+
+    struct jpeg_compress_struct cinfo;
+    struct jpeg_error_mgr jerr;
+    cinfo.err = jpeg_std_error(&jerr);
+    jpeg_create_compress(&cinfo);
+    unsigned char* jpeg = 0;
+    unsigned long jpegLength = 0;
+    jpeg_mem_dest(&cinfo, &jpeg, &jpegLength);
+    cinfo.image_width = VIDEO_WIDTH;
+    cinfo.image_height = VIDEO_HEIGHT;
+    cinfo.input_components = 3;
+    cinfo.in_color_space = JCS_RGB;
+    jpeg_set_defaults(&cinfo);
+    jpeg_set_quality(&cinfo, QUALITY, TRUE);
+    jpeg_start_compress(&cinfo, TRUE);
+    while (cinfo.next_scanline < cinfo.image_height)
+    {
+        JSAMPROW row = &rgb[cinfo.next_scanline * VIDEO_WIDTH * 3];
+        jpeg_write_scanlines(&cinfo, &row, 1);
+    }
+    jpeg_finish_compress(&cinfo);
+    std::vector<uint8_t> result(jpeg, jpeg + jpegLength);
+    jpeg_destroy_compress(&cinfo);
+    free(jpeg);
+    return result;
+}
+
+/** An AVI with a header, the MJPEG frames in a movi list and an idx1 index, as read by SoftwareMJPEGDecoder. */
+std::vector<uint8_t> createMovie(std::vector<uint32_t>& frameLengths)
+{
+    seedRandom(1);
+    std::vector<uint8_t> movie;
+    appendFourCC(movie, "RIFF");
+    appendU32(movie, 0);
+    appendFourCC(movie, "AVI ");
+
+    appendFourCC(movie, "LIST");
+    appendU32(movie, 4 + 8 + 56);
+    appendFourCC(movie, "hdrl");
+    appendFourCC(movie, "avih");
+    appendU32(movie, 56);
+    const uint32_t avih = (uint32_t)movie.size();
+    movie.resize(movie.size() + 56, 0);
+    putU32(movie, avih, 40000);
+    putU32(movie, avih + 16, VIDEO_FRAMES);
+    putU32(movie, avih + 32, VIDEO_WIDTH);
+    putU32(movie, avih + 36, VIDEO_HEIGHT);
+
+    const uint32_t movi = (uint32_t)movie.size();
+    appendFourCC(movie, "LIST");
+    appendU32(movie, 0);
+    appendFourCC(movie, "movi");
+    std::vector<uint32_t> chunks;
+    for (int frame = 0; frame < VIDEO_FRAMES; frame++)
+    {
+        const std::vector<uint8_t> jpeg = encodeFrame(frame);
+        chunks.push_back((uint32_t)movie.size());
+        frameLengths.push_back((uint32_t)jpeg.size());
+        appendFourCC(movie, "00dc");
+        appendU32(movie, (uint32_t)jpeg.size());
+        movie.insert(movie.end(), jpeg.begin(), jpeg.end());
+        if (movie.size() & 1)
+        {
+            movie.push_back(0);
+        }
+    }
+    putU32(movie, movi + 4, (uint32_t)movie.size() - movi - 8);
+
+    appendFourCC(movie, "idx1");
+    appendU32(movie, VIDEO_FRAMES * 16);
+    for (int frame = 0; frame < VIDEO_FRAMES; frame++)
+    {
+        appendFourCC(movie, "00dc");
+        appendU32(movie, 0x10);
+        appendU32(movie, chunks[frame] - (movi + 8));
+        appendU32(movie, frameLengths[frame]);
+    }
+    putU32(movie, 4, (uint32_t)movie.size() - 8);
+    return movie;
+}
+
+/** The parts of a video widget of the given size around an opaque widget on top of it. */
+void getAreas(uint16_t width, uint16_t height, Rect* areas)
+{
+    areas[0] = Rect(0, 0, width, height / 4);
+    areas[1] = Rect(0, height / 4, width / 3, height / 2);
+    areas[2] = Rect(width - width / 3, height / 4, width / 3, height / 2);
+    areas[3] = Rect(0, height / 4 + height / 2, width, height - height / 4 - height / 2);
+}
+
+struct Run
+{
+    double frameNs;
+    std::vector<uint8_t> framebuffer;
+    uint32_t mismatches;
+};
+
+/** Plays the movie, drawing the areas of every frame like DirectFrameBufferVideoController::draw(). */
+void play(SoftwareMJPEGDecoder& decoder, const std::vector<uint8_t>& movie, const Rect* areas, int numAreas, int iterations, Run& run, Run* reference)
+{
+    decoder.setVideoData(movie.data(), (uint32_t)movie.size());
+    run.frameNs = 0;
+    run.mismatches = 0;
+    std::vector<uint8_t> referenceFramebuffer;
+    for (int frame = 0; frame < iterations; frame++)
+    {
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int i = 0; i < numAreas; i++)
+        {
+            decoder.decodeFrame(areas[i], run.framebuffer.data(), VIDEO_WIDTH);
+        }
+        run.frameNs += elapsedNs(start);
+        decoder.gotoNextFrame();
+
+        if (reference)
+        {
+            // Frames repeat with the movie, the reference keeps the framebuffer of every frame
+            const size_t size = run.framebuffer.size();
+            if (memcmp(run.framebuffer.data(), &reference->framebuffer[(frame % VIDEO_FRAMES) * size], size))
+            {
+                run.mismatches++;
+            }
+        }
+        else if (frame < VIDEO_FRAMES)
+        {
+            referenceFramebuffer.insert(referenceFramebuffer.end(), run.framebuffer.begin(), run.framebuffer.end());
+        }
+    }
+    run.frameNs /= iterations;
+    if (!reference)
+    {
+        run.framebuffer.swap(referenceFramebuffer);
+    }
+}
+
+/** The VideoController of the VideoWidgets, set by the playback benchmark. */
+VideoController* videoController = 0;
+
+/** Runs widgets on the screen shown, the benchmark draws the invalidated areas. */
+class PlaybackApplication : public Application
+{
+public:
+    PlaybackApplication()
+        : Application(), previousInstance(instance), previousScreen(currentScreen)
+    {
+        instance = this;
+    }
+
+    virtual ~PlaybackApplication()
+    {
+        instance = previousInstance;
+        currentScreen = previousScreen;
+    }
+
+    void show(Screen& screen)
+    {
+        currentScreen = &screen;
+        dirty.clear();
+    }
+
+    using Application::draw;
+
+    virtual void draw(Rect& rect)
+    {
+        dirty.push_back(rect);
+    }
+
+    std::vector<Rect> dirty;
+
+private:
+    Application* previousInstance;
+    Screen* previousScreen;
+};
+
+/** Takes at least the given time to decode a frame, like the software decoder on target. */
+class PacedDecoder : public MJPEGDecoder
+{
+public:
+    PacedDecoder(uint8_t* lineBuffer, uint32_t decodeNs)
+        : decoder(lineBuffer), decodeTime(decodeNs)
+    {
+    }
+
+    virtual void setVideoData(const uint8_t* movie, const uint32_t length)
+    {
+        decoder.setVideoData(movie, length);
+    }
+
+    virtual void setVideoData(VideoDataReader& reader)
+    {
+        decoder.setVideoData(reader);
+    }
+
+    virtual bool hasVideo()
+    {
+        return decoder.hasVideo();
+    }
+
+    virtual bool decodeNextFrame(uint8_t* buffer, uint16_t width, uint16_t height, uint32_t stride)
+    {
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        const bool hasMoreFrames = decoder.decodeNextFrame(buffer, width, height, stride);
+        std::this_thread::sleep_until(start + decodeTime);
+        return hasMoreFrames;
+    }
+
+    virtual bool gotoNextFrame()
+    {
+        return decoder.gotoNextFrame();
+    }
+
+    virtual bool decodeFrame(const Rect& area, uint8_t* frameBuffer, uint32_t framebufferStride)
+    {
+        // Paced for the part of the frame decoded
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        const bool decoded = decoder.decodeFrame(area, frameBuffer, framebufferStride);
+        std::this_thread::sleep_until(start + decodeTime * area.bottom() / VIDEO_HEIGHT);
+        return decoded;
+    }
+
+    virtual bool decodeThumbnail(uint32_t frameno, uint8_t* buffer, uint16_t width, uint16_t height)
+    {
+        return decoder.decodeThumbnail(frameno, buffer, width, height);
+    }
+
+    virtual void gotoFrame(uint32_t frameno)
+    {
+        decoder.gotoFrame(frameno);
+    }
+
+    virtual uint32_t getCurrentFrameNumber() const
+    {
+        return decoder.getCurrentFrameNumber();
+    }
+
+    virtual uint32_t getNumberOfFrames()
+    {
+        return decoder.getNumberOfFrames();
+    }
+
+    virtual void getVideoInfo(VideoInformation* data)
+    {
+        decoder.getVideoInfo(data);
+    }
+
+    virtual AVIErrors getLastError()
+    {
+        return decoder.getLastError();
+    }
+
+private:
+    SoftwareMJPEGDecoder decoder;
+    std::chrono::nanoseconds decodeTime;
+};
+
+typedef DirectFrameBufferVideoController<1, Bitmap::RGB888> DirectController;
+typedef DecodeAheadVideoController<1, VIDEO_WIDTH, VIDEO_HEIGHT, Bitmap::RGB888> DecodeAheadController;
+
+/** A DecodeAheadVideoController with the decoder task in a thread. */
+class DecoderTaskController : public DecodeAheadController
+{
+public:
+    DecoderTaskController()
+        : DecodeAheadController(), requests(0), stopping(false)
+    {
+        decoderTask = std::thread(&DecoderTaskController::decoderTaskEntry, this);
+    }
+
+    virtual ~DecoderTaskController()
+    {
+        {
+            std::lock_guard<std::mutex> lock(requestMutex);
+            stopping = true;
+        }
+        requestSignal.notify_one();
+        decoderTask.join();
+    }
+
+protected:
+    virtual void signalDecoderTask()
+    {
+        {
+            std::lock_guard<std::mutex> lock(requestMutex);
+            requests++;
+        }
+        requestSignal.notify_one();
+    }
+
+    virtual bool waitForDecodeRequest()
+    {
+        std::unique_lock<std::mutex> lock(requestMutex);
+        requestSignal.wait(lock, [this] { return requests > 0 || stopping; });
+        requests = 0;
+        return !stopping;
+    }
+
+    virtual void lockStreams()
+    {
+        streamMutex.lock();
+    }
+
+    virtual bool tryLockStreams()
+    {
+        return streamMutex.try_lock();
+    }
+
+    virtual void unlockStreams()
+    {
+        streamMutex.unlock();
+    }
+
+private:
+    std::thread decoderTask;
+    std::mutex requestMutex;
+    std::condition_variable requestSignal;
+    std::mutex streamMutex;
+    int requests;
+    bool stopping;
+};
+
+struct Playback
+{
+    double tickNs;          ///< UI time per tick, updating the video and drawing
+    double maxTickNs;       ///< Longest UI time of a tick
+    uint32_t missedVSyncs;  ///< VSYNCs passed while the UI was busy
+    uint32_t framesShown;   ///< Changes of the video frame shown
+    uint32_t mismatches;    ///< Ticks showing other pixels than the video frame number
+    bool hasStatistics;
+    DecodeAheadController::Statistics statistics;
+};
+
+/**
+ * Plays the movie in a VideoWidget covering the display at 60 UI frames per second, drawing
+ * the areas invalidated in every tick. The framebuffer must show the frame reported by the
+ * widget after every tick.
+ */
+Playback playAt60(BenchmarkHAL& hal, VideoController& controller, DecodeAheadController* decodeAhead, const std::vector<uint8_t>& movie,
+                  const std::vector<std::vector<uint8_t> >& frames, uint32_t videoFrameRate, int ticks)
+{
+    const std::chrono::nanoseconds vsync(1000000000 / 60);
+    PlaybackApplication application;
+    Screen screen;
+    application.show(screen);
+    videoController = &controller;
+    Playback playback;
+    memset(&playback, 0, sizeof(playback));
+    {
+        VideoWidget video;
+        video.setPosition(0, 0, VIDEO_WIDTH, VIDEO_HEIGHT);
+        screen.getRootContainer().add(video);
+        hal.clearFrameBuffer();
+        video.setVideoData(movie.data(), (uint32_t)movie.size());
+        video.setFrameRate(60, videoFrameRate);
+        video.setRepeat(true);
+        video.play();
+
+        uint32_t shownFrameNumber = 0;
+        std::chrono::steady_clock::time_point nextVSync = std::chrono::steady_clock::now();
+        for (int tick = 0; tick < ticks; tick++)
+        {
+            std::this_thread::sleep_until(nextVSync);
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            application.dirty.clear();
+            video.handleTickEvent();
+            for (size_t i = 0; i < application.dirty.size(); i++)
+            {
+                // The widget covers the display, absolute areas are areas of the widget
+                video.draw(application.dirty[i] & Rect(0, 0, VIDEO_WIDTH, VIDEO_HEIGHT));
+            }
+            const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+            const double tickNs = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+            playback.tickNs += tickNs;
+            playback.maxTickNs = MAX(playback.maxTickNs, tickNs);
+
+            // The next tick waits for the first VSYNC after the UI is done
+            nextVSync += vsync;
+            while (nextVSync < end)
+            {
+                nextVSync += vsync;
+                playback.missedVSyncs++;
+            }
+
+            const uint32_t frameNumber = video.getCurrentFrameNumber();
+            if (frameNumber != shownFrameNumber && !application.dirty.empty())
+            {
+                shownFrameNumber = frameNumber;
+                playback.framesShown++;
+            }
+            // Nothing is shown before the first frame is drawn
+            if (playback.framesShown > 0)
+            {
+                const std::vector<uint8_t>& frame = frames[(shownFrameNumber - 1) % VIDEO_FRAMES];
+                if (memcmp(hal.getFrameBuffer(), frame.data(), frame.size()))
+                {
+                    playback.mismatches++;
+                }
+            }
+        }
+        if (decodeAhead)
+        {
+            playback.hasStatistics = true;
+            playback.statistics = decodeAhead->getStatistics(0);
+        }
+        screen.getRootContainer().remove(video);
+    }
+    videoController = 0;
+    playback.tickNs /= MAX(ticks, 1);
+    return playback;
+}
+} // namespace
+
+VideoController& VideoController::getInstance()
+{
+    return *videoController;
+}
+
+bool runVideoDecodeBenchmark(int iterations, bool json)
+{
+    std::vector<uint32_t> frameLengths;
+    const std::vector<uint8_t> movie = createMovie(frameLengths);
+    std::vector<uint8_t> lineBuffer(VIDEO_WIDTH * BYTES_PER_PIXEL);
+    std::vector<uint8_t> frameCache(VIDEO_WIDTH * VIDEO_HEIGHT * BYTES_PER_PIXEL);
+    Rect areas[5];
+    getAreas(VIDEO_WIDTH, VIDEO_HEIGHT, areas);
+    // A widget wider than the video, the area right of the video draws nothing
+    areas[4] = Rect(VIDEO_WIDTH, 0, 16, VIDEO_HEIGHT);
+
+    // Playing at least every frame once gives the reference for every frame
+    const int frames = MAX(iterations, VIDEO_FRAMES);
+    SoftwareMJPEGDecoder streaming(lineBuffer.data());
+    FrameCacheMJPEGDecoder cached(lineBuffer.data());
+    cached.setFrameCacheBuffer(frameCache.data(), (uint32_t)frameCache.size());
+    Run streamingRun;
+    Run cachedRun;
+    streamingRun.framebuffer.assign(VIDEO_WIDTH * VIDEO_HEIGHT * BYTES_PER_PIXEL, 0);
+    cachedRun.framebuffer.assign(VIDEO_WIDTH * VIDEO_HEIGHT * BYTES_PER_PIXEL, 0);
+    // SoftwareMJPEGDecoder copies a negative width for areas right of the video
+    play(streaming, movie, areas, 4, frames, streamingRun, 0);
+    play(cached, movie, areas, 5, frames, cachedRun, &streamingRun);
+    const bool same = cachedRun.mismatches == 0;
+
+    char name[32];
+    snprintf(name, sizeof(name), "%dx%d", VIDEO_WIDTH, VIDEO_HEIGHT);
+    if (json)
+    {
+        printf("{\"scene\": \"video_decode\", \"iterations\": %d, \"video\": [%d, %d], \"results\": [\n", iterations, VIDEO_WIDTH, VIDEO_HEIGHT);
+        printf("  {\"name\": \"%s\", \"frame_ns\": %.1f, \"cached_frame_ns\": %.1f, \"ok\": %s}\n]}\n",
+               name, streamingRun.frameNs, cachedRun.frameNs, same ? "true" : "false");
+    }
+    else
+    {
+        printf("%-30s %12s %12s %8s  %s\n", "video_decode", "frame ns", "cached", "speedup", "");
+        printf("%-30s %12.1f %12.1f %7.2fx  %s\n", name, streamingRun.frameNs, cachedRun.frameNs, streamingRun.frameNs / cachedRun.frameNs, same ? "ok" : "FAILED");
+    }
+    return same;
+}
+
+bool runVideoPlaybackBenchmark(BenchmarkHAL& hal, int iterations, bool json)
+{
+    std::vector<uint32_t> frameLengths;
+    const std::vector<uint8_t> movie = createMovie(frameLengths);
+    std::vector<uint8_t> lineBuffer(VIDEO_WIDTH * BYTES_PER_PIXEL);
+    std::vector<uint8_t> videoBuffer(2 * VIDEO_WIDTH * VIDEO_HEIGHT * BYTES_PER_PIXEL);
+
+    // Every frame as decoded by the decoder, to compare with the framebuffer
+    std::vector<std::vector<uint8_t> > frames;
+    SoftwareMJPEGDecoder reference(lineBuffer.data());
+    reference.setVideoData(movie.data(), (uint32_t)movie.size());
+    for (int frame = 0; frame < VIDEO_FRAMES; frame++)
+    {
+        frames.push_back(std::vector<uint8_t>(VIDEO_WIDTH * VIDEO_HEIGHT * BYTES_PER_PIXEL));
+        reference.decodeNextFrame(frames.back().data(), VIDEO_WIDTH, VIDEO_HEIGHT, VIDEO_WIDTH * BYTES_PER_PIXEL);
+    }
+
+    const char* const controllers[] = { "direct", "decode_ahead", "decoder_task" };
+    // Video frame rates and decode times of a frame, the last decodes slower than the video plays
+    const uint32_t frameRates[] = { 30, 30, 60 };
+    const uint32_t decodeMs[] = { 4, 12, 24 };
+    bool ok = true;
+
+    if (json)
+    {
+        printf("{\"scene\": \"video_playback\", \"iterations\": %d, \"ui_fps\": 60, \"results\": [", iterations);
+    }
+    else
+    {
+        printf("%-30s %10s %10s %8s %8s %8s %8s %8s  %s\n", "video_playback", "tick ns", "max", "missed", "shown", "late", "dropped", "decoded", "");
+    }
+    for (int scenario = 0; scenario < 3; scenario++)
+    {
+        for (int c = 0; c < 3; c++)
+        {
+            PacedDecoder decoder(lineBuffer.data(), decodeMs[scenario] * 1000000);
+            DirectController direct;
+            DecodeAheadController decodeAhead;
+            DecoderTaskController decoderTask;
+            VideoController* controller = &direct;
+            DecodeAheadController* statistics = 0;
+            if (c == 0)
+            {
+                direct.addDecoder(decoder, 0);
+            }
+            else
+            {
+                statistics = (c == 1) ? &decodeAhead : &decoderTask;
+                statistics->setVideoBuffer(videoBuffer.data(), (uint32_t)videoBuffer.size());
+                statistics->addDecoder(decoder, 0);
+                controller = statistics;
+            }
+            const Playback playback = playAt60(hal, *controller, statistics, movie, frames, frameRates[scenario], iterations);
+            const bool same = playback.mismatches == 0;
+            ok = ok && same;
+
+            char name[64];
+            snprintf(name, sizeof(name), "%s %ufps %ums", controllers[c], (unsigned)frameRates[scenario], (unsigned)decodeMs[scenario]);
+            if (json)
+            {
+                printf("%s\n  {\"name\": \"%s\", \"video_fps\": %u, \"decode_ms\": %u, \"tick_ns\": %.1f, \"max_tick_ns\": %.1f, \"missed_vsyncs\": %u, \"frames_shown\": %u",
+                       (scenario || c) ? "," : "", controllers[c], (unsigned)frameRates[scenario], (unsigned)decodeMs[scenario],
+                       playback.tickNs, playback.maxTickNs, (unsigned)playback.missedVSyncs, (unsigned)playback.framesShown);
+                if (playback.hasStatistics)
+                {
+                    printf(", \"frames_late\": %u, \"frames_dropped\": %u, \"frames_decoded\": %u",
+                           (unsigned)playback.statistics.framesLate, (unsigned)playback.statistics.framesDropped, (unsigned)playback.statistics.framesDecoded);
+                }
+                printf(", \"ok\": %s}", same ? "true" : "false");
+            }
+            else if (playback.hasStatistics)
+            {
+                printf("%-30s %10.1f %10.1f %8u %8u %8u %8u %8u  %s\n", name, playback.tickNs, playback.maxTickNs, (unsigned)playback.missedVSyncs, (unsigned)playback.framesShown,
+                       (unsigned)playback.statistics.framesLate, (unsigned)playback.statistics.framesDropped, (unsigned)playback.statistics.framesDecoded, same ? "ok" : "FAILED");
+            }
+            else
+            {
+                printf("%-30s %10.1f %10.1f %8u %8u %8s %8s %8s  %s\n", name, playback.tickNs, playback.maxTickNs, (unsigned)playback.missedVSyncs, (unsigned)playback.framesShown,
+                       "-", "-", "-", same ? "ok" : "FAILED");
+            }
+        }
+    }
+    if (json)
+    {
+        printf("\n]}\n");
+    }
+    return ok;
+}
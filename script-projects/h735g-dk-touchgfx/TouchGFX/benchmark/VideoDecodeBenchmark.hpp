@@ -0,0 +1,41 @@
+#ifndef VIDEODECODEBENCHMARK_HPP
+#define VIDEODECODEBENCHMARK_HPP
+
+#include <BenchmarkHAL.hpp>
+
+/**
+ * Encode a synthetic MJPEG AVI with libjpeg and play it through a
+ * SoftwareMJPEGDecoder, decoding every invalidated area from the start of
+ * the frame, and a FrameCacheMJPEGDecoder, decoding each frame once into a
+ * frame cache. Every frame is drawn as the four areas around an opaque
+ * widget on top of the video, and the frame cache also draws an area right
+ * of the video. Both decoders must draw the same pixels. Reports the time
+ * per video frame.
+ *
+ * @param iterations Number of video frames.
+ * @param json       Write the result as JSON.
+ *
+ * @return True if the decoders always draw the same pixels.
+ */
+bool runVideoDecodeBenchmark(int iterations, bool json);
+
+/**
+ * Play the synthetic MJPEG AVI in a VideoWidget covering the display at 60
+ * UI frames per second, with the video decoded in the render pass by a
+ * DirectFrameBufferVideoController, and decoded ahead by a
+ * DecodeAheadVideoController in the tick and in a decoder task. The
+ * decoder is paced to take as long as the software decoder on target, at
+ * video frame rates and decode times the decoder keeps up with and one it
+ * does not. The framebuffer must show the frame reported by the widget
+ * after every tick. Reports the UI time per tick, the VSYNCs missed, and
+ * the frames shown, late, dropped and decoded.
+ *
+ * @param [in] hal        The HAL, the widget draws into its framebuffer.
+ * @param      iterations Number of UI ticks for every controller.
+ * @param      json       Write the result as JSON.
+ *
+ * @return True if the framebuffer always shows the frame reported.
+ */
+bool runVideoPlaybackBenchmark(touchgfx::BenchmarkHAL& hal, int iterations, bool json);
+
+#endif // VIDEODECODEBENCHMARK_HPP
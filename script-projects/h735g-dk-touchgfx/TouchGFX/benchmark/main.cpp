@@ -0,0 +1,572 @@
+#include <BenchmarkHAL.hpp>
+#include <BenchmarkScenes.hpp>
+#include <BenchmarkUtils.hpp>
+#include <BlitKernelBenchmark.hpp>
+#include <BlockRingBenchmark.hpp>
+#include <CWRThreadBenchmark.hpp>
+#include <ContainerIndexBenchmark.hpp>
+#include <DMA2DBenchmark.hpp>
+#include <RegionBenchmark.hpp>
+#include <FontCacheBenchmark.hpp>
+#include <GlyphRunBenchmark.hpp>
+#include <NestedGeometryBenchmark.hpp>
+#include <NumericAtlasBenchmark.hpp>
+#include <PainterBenchmark.hpp>
+#include <ScrollBlitBenchmark.hpp>
+#include <VideoDecodeBenchmark.hpp>
+#include <BitmapDatabase.hpp>
+#include <fonts/ApplicationFontProvider.hpp>
+#include <gui_generated/common/SimConstants.hpp>
+#include <platform/driver/lcd/LCD24bpp.hpp>
+#include <platform/driver/touch/NoTouchController.hpp>
+#include <platform/hal/simulator/sdl2/TileRenderer.hpp>
+#include <texts/TypedTextDatabase.hpp>
+#include <touchgfx/Bitmap.hpp>
+#include <touchgfx/BitmapCache.hpp>
+#include <touchgfx/FontManager.hpp>
+#include <touchgfx/Texts.hpp>
+#include <touchgfx/TypedText.hpp>
+#include <touchgfx/canvas_widget_renderer/CanvasWidgetRenderer.hpp>
+#include <touchgfx/hal/NoDMA.hpp>
+#include <chrono>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Same order of magnitude as the CWR buffer used on target
+#define CANVAS_BUFFER_SIZE (32 * 1024)
+
+using namespace touchgfx;
+
+// Count every heap allocation so scenes that allocate while rendering stand out
+static volatile unsigned long allocationCount = 0;
+
+void* operator new(size_t size)
+{
+    allocationCount = allocationCount + 1;
+    void* p = malloc(size ? size : 1);
+    if (!p)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+    free(p);
+}
+
+namespace
+{
+struct Options
+{
+    int iterations;
+    const char* filter;
+    bool json;
+    bool list;
+    bool dma2d;
+    bool regions;
+    bool painters;
+    bool blockRing;
+    bool blitKernels;
+    bool fontCache;
+    bool glyphRuns;
+    bool numericAtlas;
+    bool containerIndex;
+    bool nestedGeometry;
+    bool scrollBlit;
+    bool videoDecode;
+    bool videoPlayback;
+    int tiles;
+    int cwrThreads;
+    unsigned cwrBuffer;
+    unsigned bitmapCache;
+};
+
+struct Result
+{
+    const char* scene;
+    const char* painter;
+    const char* format;
+    int iterations;
+    uint64_t pixels;
+    double elapsedNs;
+    double pixelsPerSecond;
+    double nsPerScanline;
+    unsigned long allocations;
+    uint32_t hash;
+    double tiledNs;
+    bool tiledMismatch;
+    CanvasWidgetRenderer::MemoryReport cwr;
+    BitmapCache::Statistics bitmapCache;
+};
+
+void printUsage(const char* program)
+{
+    printf("Usage: %s [options]\n", program);
+    printf("  --iterations N  Number of timed renders per scene (default 100)\n");
+    printf("  --scene NAME    Only run scenes whose name contains NAME\n");
+    printf("  --json          Write results as JSON\n");
+    printf("  --list          List the available scenes\n");
+    printf("  --dma2d         Measure the DMA2D command list against a mock DMA2D\n");
+    printf("  --regions       Compare dirty area merging on a dashboard with many small updates\n");
+    printf("  --painters      Check and time the packed RGB888 blend and the RGB565 span painter against the per-pixel code\n");
+    printf("  --blit-kernels  Compare and time the LCD24bppSpecialized bitmap and glyph kernels against LCD24bpp\n");
+    printf("  --block-ring    Hand partial framebuffer blocks to a simulated display through a RingBlockAllocator\n");
+    printf("  --font-cache    Time glyph lookups in a FontCache holding 5000 glyphs\n");
+    printf("  --glyph-runs    Compare and time CachedTextArea redraws from a GlyphRunCache against TextArea\n");
+    printf("  --numeric-atlas Compare and time NumericTextArea updates drawn from a GlyphAtlas against TextAreaWithOneWildcard\n");
+    printf("  --container-index Compare and time touches and draw chains of an IndexedContainer against a Container\n");
+    printf("  --nested-geometry Compare and time invalidation, drawing and touches of nested CachedGeometryContainers against Containers\n");
+    printf("  --scroll-blit   Compare and time scrolling by copying framebuffer pixels against redrawing, with double buffering\n");
+    printf("  --video-decode  Compare and time drawing MJPEG video frames from a frame cache against decoding every area\n");
+    printf("  --video-playback Play MJPEG video at 60 UI fps, decoded in the render pass and decoded ahead in a decoder task\n");
+    printf("  --tiles N       Also render each scene with N tile workers and compare the output\n");
+    printf("  --cwr-threads N Rasterize canvas widgets from N threads, each with its own CWR context\n");
+    printf("  --cwr-buffer N  Size of the CWR buffer in bytes, at most %d (default)\n", CANVAS_BUFFER_SIZE);
+    printf("  --bitmap-cache N Cache the bitmaps drawn in a BitmapCache of N bytes\n");
+}
+
+bool parseOptions(int argc, char** argv, Options& options)
+{
+    options.iterations = 100;
+    options.filter = 0;
+    options.json = false;
+    options.list = false;
+    options.dma2d = false;
+    options.regions = false;
+    options.painters = false;
+    options.blockRing = false;
+    options.blitKernels = false;
+    options.fontCache = false;
+    options.glyphRuns = false;
+    options.numericAtlas = false;
+    options.containerIndex = false;
+    options.nestedGeometry = false;
+    options.scrollBlit = false;
+    options.videoDecode = false;
+    options.videoPlayback = false;
+    options.tiles = 1;
+    options.cwrThreads = 0;
+    options.cwrBuffer = CANVAS_BUFFER_SIZE;
+    options.bitmapCache = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--iterations") && i + 1 < argc)
+        {
+            options.iterations = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--scene") && i + 1 < argc)
+        {
+            options.filter = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--json"))
+        {
+            options.json = true;
+        }
+        else if (!strcmp(argv[i], "--list"))
+        {
+            options.list = true;
+        }
+        else if (!strcmp(argv[i], "--dma2d"))
+        {
+            options.dma2d = true;
+        }
+        else if (!strcmp(argv[i], "--regions"))
+        {
+            options.regions = true;
+        }
+        else if (!strcmp(argv[i], "--painters"))
+        {
+            options.painters = true;
+        }
+        else if (!strcmp(argv[i], "--blit-kernels"))
+        {
+            options.blitKernels = true;
+        }
+        else if (!strcmp(argv[i], "--block-ring"))
+        {
+            options.blockRing = true;
+        }
+        else if (!strcmp(argv[i], "--font-cache"))
+        {
+            options.fontCache = true;
+        }
+        else if (!strcmp(argv[i], "--glyph-runs"))
+        {
+            options.glyphRuns = true;
+        }
+        else if (!strcmp(argv[i], "--numeric-atlas"))
+        {
+            options.numericAtlas = true;
+        }
+        else if (!strcmp(argv[i], "--container-index"))
+        {
+            options.containerIndex = true;
+        }
+        else if (!strcmp(argv[i], "--nested-geometry"))
+        {
+            options.nestedGeometry = true;
+        }
+        else if (!strcmp(argv[i], "--scroll-blit"))
+        {
+            options.scrollBlit = true;
+        }
+        else if (!strcmp(argv[i], "--video-decode"))
+        {
+            options.videoDecode = true;
+        }
+        else if (!strcmp(argv[i], "--video-playback"))
+        {
+            options.videoPlayback = true;
+        }
+        else if (!strcmp(argv[i], "--tiles") && i + 1 < argc)
+        {
+            options.tiles = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--cwr-threads") && i + 1 < argc)
+        {
+            options.cwrThreads = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--cwr-buffer") && i + 1 < argc)
+        {
+            options.cwrBuffer = (unsigned)atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--bitmap-cache") && i + 1 < argc)
+        {
+            options.bitmapCache = (unsigned)atoi(argv[++i]);
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return options.iterations > 0 && options.tiles > 0 && options.cwrThreads >= 0 && options.cwrBuffer <= CANVAS_BUFFER_SIZE;
+}
+
+/** Draws a tile of a scene for TileRenderer, like Application::draw() does in the simulator. */
+class SceneTileDrawer
+{
+public:
+    explicit SceneTileDrawer(BenchmarkScene& benchmarkScene)
+        : scene(benchmarkScene), callback(this, &SceneTileDrawer::draw)
+    {
+    }
+
+    GenericCallback<const Rect&>& getCallback()
+    {
+        return callback;
+    }
+
+private:
+    void draw(const Rect& tile)
+    {
+        // TileRenderer holds the framebuffer lock while the frame is drawn
+        TileRenderer::drawContainer(scene, tile);
+    }
+
+    BenchmarkScene& scene;
+    Callback<SceneTileDrawer, const Rect&> callback;
+};
+
+Result runScene(BenchmarkHAL& hal, BenchmarkScene& scene, int iterations, int tiles)
+{
+    Result result;
+    result.scene = scene.getName();
+    result.painter = scene.getPainterName();
+    result.format = scene.getFormatName();
+    result.iterations = iterations;
+
+    const Rect area = scene.getRenderArea();
+    CanvasWidgetRenderer::resetMemoryReport();
+    BitmapCache::resetStatistics();
+
+    // Render once on a known background, both as warm-up and to fingerprint the output
+    hal.clearFrameBuffer();
+    BitmapCache::nextFrame();
+    scene.draw(area);
+    result.hash = hal.hashFrameBuffer();
+
+    const unsigned long allocationsBefore = allocationCount;
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        BitmapCache::nextFrame();
+        scene.draw(area);
+    }
+    result.elapsedNs = elapsedNs(start);
+    result.allocations = allocationCount - allocationsBefore;
+    result.cwr = CanvasWidgetRenderer::getMemoryReport();
+    result.bitmapCache = BitmapCache::getStatistics();
+
+    result.pixels = (uint64_t)area.width * area.height * iterations;
+    result.pixelsPerSecond = result.elapsedNs > 0 ? result.pixels * 1e9 / result.elapsedNs : 0;
+    result.nsPerScanline = result.elapsedNs / ((double)area.height * iterations);
+
+    result.tiledNs = 0;
+    result.tiledMismatch = false;
+    if (tiles > 1)
+    {
+        // Verify mode draws in tiles even with fewer hardware threads, and compares with the serial frame
+        SceneTileDrawer drawer(scene);
+        TileRenderer::setWorkers(tiles);
+        TileRenderer::setVerify(true);
+        const uint32_t mismatchedFrames = TileRenderer::getStatistics().mismatchedFrames;
+        hal.clearFrameBuffer();
+        TileRenderer::render(&area, 1, drawer.getCallback(), drawer.getCallback());
+        result.tiledMismatch = TileRenderer::getStatistics().mismatchedFrames != mismatchedFrames;
+        TileRenderer::setVerify(false);
+
+        const std::chrono::steady_clock::time_point tiledStart = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++)
+        {
+            TileRenderer::render(&area, 1, drawer.getCallback(), drawer.getCallback());
+        }
+        const std::chrono::steady_clock::time_point tiledEnd = std::chrono::steady_clock::now();
+        result.tiledNs = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(tiledEnd - tiledStart).count();
+    }
+    return result;
+}
+
+void printText(const Result& result)
+{
+    printf("%-30s %-28s %-9s %10.2f Mpx/s %10.1f ns/scanline %6lu allocs  %08x",
+           result.scene, result.painter, result.format,
+           result.pixelsPerSecond / 1e6, result.nsPerScanline, result.allocations, result.hash);
+    if (result.tiledNs > 0)
+    {
+        printf("  %5.2fx tiled %s", result.elapsedNs / result.tiledNs, result.tiledMismatch ? "MISMATCH" : "ok");
+    }
+    if (result.cwr.outlines > 0)
+    {
+        printf("  CWR %u-%u bytes, %u retries", result.cwr.minimumBufferSize, result.cwr.unsplitBufferSize, result.cwr.retries);
+    }
+    if (result.bitmapCache.hits + result.bitmapCache.misses > 0)
+    {
+        printf("  cache %u hits, %u misses, %u evictions, %u failures",
+               (unsigned)result.bitmapCache.hits, (unsigned)result.bitmapCache.misses,
+               (unsigned)result.bitmapCache.evictions, (unsigned)result.bitmapCache.failures);
+    }
+    printf("\n");
+}
+
+void printJSON(const Result& result, bool first)
+{
+    printf("%s\n    {\"scene\": \"%s\", \"painter\": \"%s\", \"format\": \"%s\", \"iterations\": %d, "
+           "\"pixels\": %llu, \"elapsed_ns\": %.0f, \"pixels_per_second\": %.0f, \"ns_per_scanline\": %.1f, "
+           "\"allocations\": %lu, \"hash\": \"%08x\"",
+           first ? "" : ",",
+           result.scene, result.painter, result.format, result.iterations,
+           (unsigned long long)result.pixels, result.elapsedNs, result.pixelsPerSecond, result.nsPerScanline,
+           result.allocations, result.hash);
+    if (result.tiledNs > 0)
+    {
+        printf(", \"tiled_elapsed_ns\": %.0f, \"tiled_mismatch\": %s", result.tiledNs, result.tiledMismatch ? "true" : "false");
+    }
+    if (result.cwr.outlines > 0)
+    {
+        printf(", \"cwr_minimum_bytes\": %u, \"cwr_unsplit_bytes\": %u, \"cwr_retries\": %u, \"cwr_skipped_lines\": %u",
+               result.cwr.minimumBufferSize, result.cwr.unsplitBufferSize, result.cwr.retries, result.cwr.skippedLines);
+    }
+    if (result.bitmapCache.hits + result.bitmapCache.misses > 0)
+    {
+        printf(", \"cache_hits\": %u, \"cache_misses\": %u, \"cache_evictions\": %u, \"cache_failures\": %u",
+               (unsigned)result.bitmapCache.hits, (unsigned)result.bitmapCache.misses,
+               (unsigned)result.bitmapCache.evictions, (unsigned)result.bitmapCache.failures);
+    }
+    printf("}");
+}
+} // namespace
+
+static ApplicationFontProvider fontProvider;
+static Texts texts;
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+    {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (options.dma2d)
+    {
+        return runDMA2DBenchmark(options.iterations, options.json) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (options.regions)
+    {
+        return runRegionBenchmark(options.iterations, options.json) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (options.painters)
+    {
+        return runPainterBenchmark(options.iterations, options.json) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (options.blockRing)
+    {
+        return runBlockRingBenchmark(options.iterations, options.json) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (options.videoDecode)
+    {
+        return runVideoDecodeBenchmark(options.iterations, options.json) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // The numeric atlas benchmark copies glyphs with a DMA carried out in software
+    NoDMA noDMA;
+    GlyphCopyDMA glyphCopyDMA;
+    DMA_Interface& dma = options.numericAtlas ? static_cast<DMA_Interface&>(glyphCopyDMA) : noDMA;
+    LCD24bpp lcd;
+    NoTouchController tc;
+    BenchmarkHAL hal(dma, lcd, tc, SIM_WIDTH, SIM_HEIGHT);
+    hal.initialize();
+    // Nothing is ever transferred to a display, so DMA is always allowed
+    hal.allowDMATransfers();
+
+    // Samples touches with the finger size of the HAL
+    if (options.containerIndex)
+    {
+        return runContainerIndexBenchmark(options.iterations, options.json) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // Builds screens the size of the display of the HAL
+    if (options.nestedGeometry)
+    {
+        return runNestedGeometryBenchmark(options.iterations, options.json) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // Draws video frames into the framebuffer of the HAL
+    if (options.videoPlayback)
+    {
+        return runVideoPlaybackBenchmark(hal, options.iterations, options.json) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // Adds a second framebuffer to the HAL
+    if (options.scrollBlit)
+    {
+        return runScrollBlitBenchmark(hal, options.iterations, options.json) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    TypedText::registerTexts(&texts);
+    Texts::setLanguage(0);
+    FontManager::setFontProvider(&fontProvider);
+
+    // Registers its own bitmaps, the bitmap database can only be registered once
+    if (options.blitKernels)
+    {
+        return runBlitKernelBenchmark(hal, options.iterations, options.json) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // Registers the bitmap database with a cache for its atlases, and installs its own fonts and translation
+    if (options.numericAtlas)
+    {
+        return runNumericAtlasBenchmark(hal, glyphCopyDMA, options.iterations, options.json) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (options.bitmapCache > 0)
+    {
+        // Every scene starts from what the previous scenes left in the cache, like screens do
+        uint16_t* const bitmapCache = new uint16_t[(options.bitmapCache + 1) / 2];
+        BitmapCache::registerBitmapDatabase(BitmapDatabase::getInstance(), BitmapDatabase::getInstanceSize(), bitmapCache, options.bitmapCache);
+    }
+    else
+    {
+        Bitmap::registerBitmapDatabase(BitmapDatabase::getInstance(), BitmapDatabase::getInstanceSize());
+    }
+
+    static uint8_t canvasBuffer[CANVAS_BUFFER_SIZE];
+    CanvasWidgetRenderer::setupBuffer(canvasBuffer, options.cwrBuffer);
+    // The scenes report the smallest CWR buffer they draw with
+    CanvasWidgetRenderer::setMemoryReportEnabled(true);
+
+    // The font cache reads the font and bits per pixel of a TypedText
+    if (options.fontCache)
+    {
+        return runFontCacheBenchmark(options.iterations, options.json) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // Installs its own translation of the text database
+    if (options.glyphRuns)
+    {
+        return runGlyphRunBenchmark(hal, options.iterations, options.json) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (options.cwrThreads > 0)
+    {
+        return runCWRThreadBenchmark(hal, options.cwrThreads, options.iterations, options.cwrBuffer, options.json) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    int numberOfScenes = 0;
+    const BenchmarkSceneFactory* factories = getBenchmarkScenes(numberOfScenes);
+
+    if (options.list)
+    {
+        for (int i = 0; i < numberOfScenes; i++)
+        {
+            BenchmarkScene* scene = factories[i]();
+            printf("%s\n", scene->getName());
+            delete scene;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    if (options.json)
+    {
+        printf("{\"width\": %d, \"height\": %d, \"bpp\": %d, \"results\": [", SIM_WIDTH, SIM_HEIGHT, lcd.bitDepth());
+    }
+
+    bool first = true;
+    bool ok = true;
+    for (int i = 0; i < numberOfScenes; i++)
+    {
+        BenchmarkScene* scene = factories[i]();
+        if (!options.filter || strstr(scene->getName(), options.filter))
+        {
+            const Result result = runScene(hal, *scene, options.iterations, options.tiles);
+            ok = ok && !result.tiledMismatch;
+            if (options.json)
+            {
+                printJSON(result, first);
+            }
+            else
+            {
+                printText(result);
+            }
+            first = false;
+        }
+        delete scene;
+    }
+
+    if (options.json)
+    {
+        printf("\n]}\n");
+    }
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,78 @@
+#include <MockDMA2D.hpp>
+#include <string.h>
+
+DMA2D_TypeDef mockDMA2DRegisters;
+
+MockDMA2D::MockDMA2D()
+    : clutLoads(0), transfers(0), errors(0), hash(0)
+{
+    reset();
+}
+
+void MockDMA2D::reset()
+{
+    memset((void*)DMA2D, 0, sizeof(DMA2D_TypeDef));
+    clutLoads = 0;
+    transfers = 0;
+    errors = 0;
+    hash = 2166136261u;
+}
+
+MockDMA2D::Event MockDMA2D::step()
+{
+    DMA2D_TypeDef& regs = *DMA2D;
+
+    if (regs.FGPFCCR & DMA2D_FGPFCCR_START)
+    {
+        if (regs.CR & DMA2D_CR_START)
+        {
+            errors++;
+        }
+        clutLoads++;
+        hashRegister(regs.FGCMAR);
+        hashRegister(regs.FGPFCCR);
+        regs.FGPFCCR &= ~DMA2D_FGPFCCR_START;
+        if (regs.CR & DMA2D_IT_CTC)
+        {
+            regs.CR &= ~DMA2D_IT_CTC;
+            return CLUT_LOADED;
+        }
+        regs.ISR |= DMA2D_FLAG_CTC;
+    }
+
+    if (regs.CR & DMA2D_CR_START)
+    {
+        transfers++;
+        hashRegister(regs.CR);
+        hashRegister(regs.FGPFCCR);
+        hashRegister(regs.FGCOLR);
+        hashRegister(regs.FGMAR);
+        hashRegister(regs.FGOR);
+        hashRegister(regs.BGPFCCR);
+        hashRegister(regs.BGMAR);
+        hashRegister(regs.BGOR);
+        hashRegister(regs.OPFCCR);
+        hashRegister(regs.OCOLR);
+        hashRegister(regs.OMAR);
+        hashRegister(regs.OOR);
+        hashRegister(regs.NLR);
+        regs.CR &= ~DMA2D_CR_START;
+        if (regs.CR & DMA2D_IT_TC)
+        {
+            regs.CR &= ~DMA2D_IT_TC;
+            return TRANSFER_COMPLETE;
+        }
+        regs.ISR |= DMA2D_FLAG_TC;
+    }
+
+    return IDLE;
+}
+
+void MockDMA2D::hashRegister(uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        hash ^= (value >> (i * 8)) & 0xFF;
+        hash *= 16777619u;
+    }
+}
@@ -0,0 +1,67 @@
+#ifndef MOCKDMA2D_HPP
+#define MOCKDMA2D_HPP
+
+#include "stm32h7xx_hal.h"
+#include <stdint.h>
+
+/**
+ * Host model of the DMA2D, operating on the registers DMA2D points to.
+ * Transfers and CLUT loads complete when step() is called, which also
+ * acknowledges the interrupt the way HAL_DMA2D_IRQHandler() does. No
+ * pixels are moved; the registers of each started transfer and CLUT
+ * load are hashed so changes to the programmed values can be detected.
+ */
+class MockDMA2D
+{
+public:
+    /** What happened during a step. */
+    enum Event
+    {
+        IDLE,             ///< Nothing was started
+        CLUT_LOADED,      ///< A CLUT load completed with the CTC interrupt enabled
+        TRANSFER_COMPLETE ///< A transfer completed with the TC interrupt enabled
+    };
+
+    MockDMA2D();
+
+    /** Clear the registers and the statistics. */
+    void reset();
+
+    /**
+     * Complete the pending CLUT load or transfer.
+     *
+     * @return The interrupt raised, if any.
+     */
+    Event step();
+
+    uint32_t getClutLoads() const
+    {
+        return clutLoads;
+    }
+
+    uint32_t getTransfers() const
+    {
+        return transfers;
+    }
+
+    /** Number of transfers started while a CLUT load was still in progress. */
+    uint32_t getErrors() const
+    {
+        return errors;
+    }
+
+    uint32_t getHash() const
+    {
+        return hash;
+    }
+
+private:
+    void hashRegister(uint32_t value);
+
+    uint32_t clutLoads;
+    uint32_t transfers;
+    uint32_t errors;
+    uint32_t hash;
+};
+
+#endif // MOCKDMA2D_HPP
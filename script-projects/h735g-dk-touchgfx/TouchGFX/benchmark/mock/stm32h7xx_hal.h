@@ -0,0 +1,88 @@
+#ifndef STM32H7XX_HAL_H
+#define STM32H7XX_HAL_H
+
+/*
+ * Host stand-in for the STM32H7 HAL header, providing only the DMA2D
+ * register layout and definitions used by DMA2DCommandList. The values
+ * match stm32h735xx.h and stm32h7xx_hal_dma2d.h. DMA2D points to the
+ * registers of MockDMA2D instead of the peripheral.
+ */
+
+#include <stdint.h>
+
+#define __IO volatile
+
+typedef struct
+{
+    __IO uint32_t CR;
+    __IO uint32_t ISR;
+    __IO uint32_t IFCR;
+    __IO uint32_t FGMAR;
+    __IO uint32_t FGOR;
+    __IO uint32_t BGMAR;
+    __IO uint32_t BGOR;
+    __IO uint32_t FGPFCCR;
+    __IO uint32_t FGCOLR;
+    __IO uint32_t BGPFCCR;
+    __IO uint32_t BGCOLR;
+    __IO uint32_t FGCMAR;
+    __IO uint32_t BGCMAR;
+    __IO uint32_t OPFCCR;
+    __IO uint32_t OCOLR;
+    __IO uint32_t OMAR;
+    __IO uint32_t OOR;
+    __IO uint32_t NLR;
+    __IO uint32_t LWR;
+    __IO uint32_t AMTCR;
+} DMA2D_TypeDef;
+
+extern DMA2D_TypeDef mockDMA2DRegisters;
+#define DMA2D (&mockDMA2DRegisters)
+
+#define SET_BIT(REG, BIT) ((REG) |= (BIT))
+#define CLEAR_BIT(REG, BIT) ((REG) &= ~(BIT))
+#define READ_REG(REG) ((REG))
+#define WRITE_REG(REG, VAL) ((REG) = (VAL))
+
+/* stm32h735xx.h */
+#define DMA2D_CR_START (0x1UL << 0U)
+#define DMA2D_CR_TCIE (0x1UL << 9U)
+#define DMA2D_CR_CTCIE (0x1UL << 12U)
+#define DMA2D_CR_MODE_0 (0x1UL << 16U)
+#define DMA2D_CR_MODE_1 (0x2UL << 16U)
+#define DMA2D_ISR_TCIF (0x1UL << 1U)
+#define DMA2D_ISR_CTCIF (0x1UL << 4U)
+#define DMA2D_FGPFCCR_CCM_Pos (4U)
+#define DMA2D_FGPFCCR_START (0x1UL << 5U)
+#define DMA2D_FGPFCCR_CS_Pos (8U)
+#define DMA2D_BGPFCCR_AM_Pos (16U)
+#define DMA2D_BGPFCCR_ALPHA (0xFFUL << 24U)
+#define DMA2D_OPFCCR_CM_0 (0x1UL << 0U)
+#define DMA2D_OPFCCR_CM_1 (0x2UL << 0U)
+#define DMA2D_NLR_PL_Pos (16U)
+
+/* stm32h7xx_hal_dma2d.h */
+#define DMA2D_M2M 0x00000000U
+#define DMA2D_M2M_PFC DMA2D_CR_MODE_0
+#define DMA2D_M2M_BLEND DMA2D_CR_MODE_1
+#define DMA2D_R2M (DMA2D_CR_MODE_1 | DMA2D_CR_MODE_0)
+#define DMA2D_OUTPUT_ARGB8888 0x00000000U
+#define DMA2D_OUTPUT_RGB888 DMA2D_OPFCCR_CM_0
+#define DMA2D_OUTPUT_RGB565 DMA2D_OPFCCR_CM_1
+#define DMA2D_INPUT_ARGB8888 0x00000000U
+#define DMA2D_INPUT_RGB888 0x00000001U
+#define DMA2D_INPUT_RGB565 0x00000002U
+#define DMA2D_INPUT_L8 0x00000005U
+#define DMA2D_INPUT_A8 0x00000009U
+#define DMA2D_INPUT_A4 0x0000000AU
+#define DMA2D_NO_MODIF_ALPHA 0x00000000U
+#define DMA2D_REPLACE_ALPHA 0x00000001U
+#define DMA2D_COMBINE_ALPHA 0x00000002U
+#define DMA2D_CCM_ARGB8888 0x00000000U
+#define DMA2D_CCM_RGB888 0x00000001U
+#define DMA2D_IT_CTC DMA2D_CR_CTCIE
+#define DMA2D_IT_TC DMA2D_CR_TCIE
+#define DMA2D_FLAG_CTC DMA2D_ISR_CTCIF
+#define DMA2D_FLAG_TC DMA2D_ISR_TCIF
+
+#endif // STM32H7XX_HAL_H
@@ -0,0 +1,562 @@
+#ifndef DECODEAHEADVIDEOCONTROLLER_HPP
+#define DECODEAHEADVIDEOCONTROLLER_HPP
+
+#include <touchgfx/widgets/VideoWidget.hpp>
+#include <string.h>
+#ifdef SIMULATOR
+#include <simulator/video/MJPEGDecoder.hpp>
+#else
+#include <MJPEGDecoder.hpp>
+#endif
+
+/**
+ * @class DecodeAheadVideoController
+ *
+ * @brief A VideoController decoding the next video frame while the current frame is shown.
+ *
+ *        A VideoController decoding the next video frame while the current frame is shown.
+ *        Each stream has two buffers. The VideoWidget shows one, while the next frame is
+ *        decoded into the other by a decoder task. The tick swaps the buffers when the next
+ *        frame is due, at the rate set with setFrameRate(), and decoded. The tick never waits
+ *        for the decoder task, a frame not decoded when due is shown in a later tick and
+ *        counted late. The decoder task skips the frames it fell behind by, counted as
+ *        dropped, so the video keeps time.
+ *
+ *        The decoder task runs decoderTaskEntry(). Subclasses connect it to the OS by
+ *        implementing signalDecoderTask(), waitForDecodeRequest(), lockStreams(),
+ *        tryLockStreams() and unlockStreams(), see FreeRTOSDecodeAheadVideoController on
+ *        target and ThreadedDecodeAheadVideoController in the simulator. Without a decoder
+ *        task, the next frame is decoded in the tick requesting it.
+ *
+ *        The MJPEGDecoder is generated by TouchGFX Designer, in TouchGFX/target/generated
+ *        on target, when a video is added to the project.
+ *
+ * @tparam no_streams    Number of video streams.
+ * @tparam width         Width of the video frames.
+ * @tparam height        Height of the video frames.
+ * @tparam output_format Format of the decoded frames, RGB565 or RGB888.
+ */
+template <uint32_t no_streams, uint32_t width, uint32_t height, touchgfx::Bitmap::BitmapFormat output_format>
+class DecodeAheadVideoController : public touchgfx::VideoController
+{
+public:
+    /** Frames counted for a stream since setVideoData() or resetStatistics(). */
+    struct Statistics
+    {
+        uint32_t framesDecoded; ///< Video frames decoded by the decoder task
+        uint32_t framesShown;   ///< Video frames shown by the widget
+        uint32_t framesLate;    ///< Video frames shown one or more ticks after they were due
+        uint32_t framesDropped; ///< Video frames skipped by the decoder task to catch up with late frames
+    };
+
+    /**
+     * @fn DecodeAheadVideoController::DecodeAheadVideoController();
+     *
+     * @brief Default constructor.
+     */
+    DecodeAheadVideoController()
+        : VideoController(), videoBuffer(0)
+    {
+        assert((no_streams > 0) && "Video: Number of streams zero!");
+
+        // Clear arrays
+        memset(mjpegDecoders, 0, sizeof(mjpegDecoders));
+    }
+
+    /**
+     * @fn void DecodeAheadVideoController::setVideoBuffer(uint8_t* buffer, uint32_t size);
+     *
+     * @brief Sets the buffer for all streams.
+     *
+     *        Sets the buffer for all streams, two frames of width x height pixels per stream.
+     *        Must be called before widgets are registered.
+     *
+     * @param [in] buffer The buffer.
+     * @param      size   The size of the buffer in bytes.
+     */
+    void setVideoBuffer(uint8_t* buffer, uint32_t size)
+    {
+        assert((size >= no_streams * 2 * FRAME_SIZE) && "Video: Buffer to small!");
+        videoBuffer = buffer;
+        for (uint32_t i = 0; i < no_streams; i++)
+        {
+            streams[i].buffers[0] = buffer + i * 2 * FRAME_SIZE;
+            streams[i].buffers[1] = buffer + i * 2 * FRAME_SIZE + FRAME_SIZE;
+        }
+    }
+
+    Handle registerVideoWidget(touchgfx::VideoWidget& widget)
+    {
+        assert(videoBuffer && "Video: Buffer must be assigned prior to registering widgets!");
+
+        // Find stream handle for Widget
+        Handle handle = getFreeHandle();
+
+        streams[handle].isActive = true;
+
+        //Set Widget buffer format and address, no frame decoded yet
+        widget.setVideoBufferFormat(output_format, width, height);
+        widget.setVideoBuffer((uint8_t*)0);
+
+        return handle;
+    }
+
+    void unregisterVideoWidget(const Handle handle)
+    {
+        streams[handle].isActive = false;
+    }
+
+    void setFrameRate(const Handle handle, uint32_t ui_frames, uint32_t video_frames)
+    {
+        assert(handle < no_streams);
+        Stream& stream = streams[handle];
+
+        // Reset counters
+        stream.frameCount = 0;
+        stream.tickCount = 0;
+
+        // Save requested frame rate ratio
+        stream.frame_rate_ticks = ui_frames;
+        stream.frame_rate_video = video_frames;
+    }
+
+    void setVideoData(const Handle handle, const uint8_t* movie, const uint32_t length)
+    {
+        assert(handle < no_streams);
+
+        lockStreams();
+        // Reset decoder to first frame
+        mjpegDecoders[handle]->setVideoData(movie, length);
+        restartStream(handle);
+        unlockStreams();
+
+        // Decode the first frame to show it
+        signalDecoderTask();
+    }
+
+    void setVideoData(const Handle handle, touchgfx::VideoDataReader& reader)
+    {
+        assert(handle < no_streams);
+
+        lockStreams();
+        // Reset decoder to first frame
+        mjpegDecoders[handle]->setVideoData(reader);
+        restartStream(handle);
+        unlockStreams();
+
+        // Decode the first frame to show it
+        signalDecoderTask();
+    }
+
+    void setCommand(const Handle handle, Command cmd, uint32_t param)
+    {
+        assert(handle < no_streams);
+        Stream& stream = streams[handle];
+
+        lockStreams();
+        switch (cmd)
+        {
+        case PLAY:
+            // Cannot Play without movie
+            if (mjpegDecoders[handle]->hasVideo())
+            {
+                stream.isPlaying = true;
+                // Reset counters
+                stream.frameCount = 0;
+                stream.tickCount = 0;
+                // If non-repeating video stopped at the end, the decoder has wrapped to the first frame
+                if (!stream.nextReady && !stream.decodeRequested)
+                {
+                    stream.decodeRequested = true;
+                }
+            }
+            break;
+        case PAUSE:
+            stream.isPlaying = false;
+            break;
+        case SEEK:
+            seekStream(stream, param);
+            break;
+        case STOP:
+            stream.isPlaying = false;
+            seekStream(stream, 1);
+            break;
+        case SET_REPEAT:
+            stream.repeat = (param > 0);
+            break;
+        }
+        unlockStreams();
+
+        signalDecoderTask();
+    }
+
+    bool updateFrame(const Handle handle, touchgfx::VideoWidget& widget)
+    {
+        assert(handle < no_streams);
+        Stream& stream = streams[handle];
+
+        // Show the first frame, or the frame sought, also when not playing
+        if (!stream.isPlaying && !stream.showNextFrame)
+        {
+            return true;
+        }
+
+        // Number of video frames due since play
+        uint32_t framesDue = stream.frameCount + 1;
+        if (stream.isPlaying)
+        {
+            stream.tickCount++;
+            if (stream.frame_rate_ticks > 0)
+            {
+                framesDue = stream.tickCount * stream.frame_rate_video / stream.frame_rate_ticks;
+            }
+            if (framesDue <= stream.frameCount)
+            {
+                // Keep showing the current frame
+                return true;
+            }
+        }
+
+        // Never wait for the decoder task, a frame not ready now is late
+        if (!tryLockStreams())
+        {
+            stream.isLate = true;
+            return true;
+        }
+        if (!stream.nextReady)
+        {
+            stream.isLate = stream.isPlaying;
+            unlockStreams();
+            return true;
+        }
+
+        // Show the decoded frame
+        stream.shownBuffer ^= 1;
+        widget.setVideoBuffer(stream.buffers[stream.shownBuffer]);
+        widget.invalidate();
+        stream.frameNumber = stream.nextFrameNumber;
+        stream.nextReady = false;
+        stream.statistics.framesShown++;
+
+        bool hasMoreFrames = stream.nextHasMoreFrames;
+        if (stream.showNextFrame)
+        {
+            // First frame after new video data or seek
+            stream.showNextFrame = false;
+            stream.frameCount = framesDue;
+        }
+        else
+        {
+            // Frames late by a whole video frame or more are skipped by the decoder, keeping the video in time
+            if (stream.isLate || framesDue > stream.frameCount + 1)
+            {
+                stream.statistics.framesLate++;
+            }
+            stream.skipFrames = framesDue - stream.frameCount - 1;
+            stream.frameCount = framesDue;
+        }
+        stream.isLate = false;
+
+        if (!hasMoreFrames && !stream.repeat)
+        {
+            // Showing last frame, stop here
+            stream.isPlaying = false;
+            stream.skipFrames = 0;
+        }
+        else
+        {
+            hasMoreFrames = true;
+            // Decode the frame after this into the other buffer
+            stream.decodeRequested = true;
+        }
+        const bool signal = stream.decodeRequested;
+        unlockStreams();
+
+        if (signal)
+        {
+            signalDecoderTask();
+        }
+        return hasMoreFrames;
+    }
+
+    void draw(const Handle handle, const touchgfx::Rect& invalidatedArea, const touchgfx::VideoWidget& widget)
+    {
+        // The widget draws the buffer of the frame shown
+    }
+
+    void addDecoder(MJPEGDecoder& decoder, uint32_t index)
+    {
+        assert(index < no_streams);
+        mjpegDecoders[index] = &decoder;
+    }
+
+    uint32_t getCurrentFrameNumber(const Handle handle)
+    {
+        assert(handle < no_streams);
+        Stream& stream = streams[handle];
+
+        return stream.frameNumber;
+    }
+
+    void getVideoInformation(const Handle handle, touchgfx::VideoInformation* data)
+    {
+        assert(handle < no_streams);
+        lockStreams();
+        mjpegDecoders[handle]->getVideoInfo(data);
+        unlockStreams();
+    }
+
+    bool getIsPlaying(const Handle handle)
+    {
+        assert(handle < no_streams);
+        Stream& stream = streams[handle];
+        return stream.isPlaying;
+    }
+
+    /**
+     * @fn Statistics DecodeAheadVideoController::getStatistics(const Handle handle);
+     *
+     * @brief Gets the frames decoded, shown, late and dropped for a stream.
+     *
+     * @param handle The handle of the stream.
+     *
+     * @return The statistics of the stream.
+     */
+    Statistics getStatistics(const Handle handle)
+    {
+        assert(handle < no_streams);
+        lockStreams();
+        const Statistics statistics = streams[handle].statistics;
+        unlockStreams();
+        return statistics;
+    }
+
+    /**
+     * @fn void DecodeAheadVideoController::resetStatistics(const Handle handle);
+     *
+     * @brief Resets the statistics of a stream.
+     *
+     * @param handle The handle of the stream.
+     */
+    void resetStatistics(const Handle handle)
+    {
+        assert(handle < no_streams);
+        lockStreams();
+        memset(&streams[handle].statistics, 0, sizeof(Statistics));
+        unlockStreams();
+    }
+
+    /**
+     * @fn bool DecodeAheadVideoController::decodeRequestedFrames();
+     *
+     * @brief Decodes the frames requested for all streams.
+     *
+     *        Decodes the frames requested for all streams. Called by the decoder task, or in
+     *        the tick requesting a frame without a decoder task.
+     *
+     * @return True if a frame was decoded.
+     */
+    bool decodeRequestedFrames()
+    {
+        bool decoded = false;
+        for (uint32_t i = 0; i < no_streams; i++)
+        {
+            lockStreams();
+            Stream& stream = streams[i];
+            if (stream.decodeRequested && mjpegDecoders[i] && mjpegDecoders[i]->hasVideo())
+            {
+                MJPEGDecoder* const decoder = mjpegDecoders[i];
+                stream.decodeRequested = false;
+
+                // Seek or skip the frames which are too late
+                if (stream.seek_to_frame > 0)
+                {
+                    decoder->gotoFrame(stream.seek_to_frame);
+                    stream.seek_to_frame = 0;
+                }
+                for (; stream.skipFrames > 0; stream.skipFrames--)
+                {
+                    // Never skip past the last frame of a non-repeating video
+                    if (!stream.repeat && decoder->getCurrentFrameNumber() == decoder->getNumberOfFrames())
+                    {
+                        stream.skipFrames = 0;
+                        break;
+                    }
+                    decoder->gotoNextFrame();
+                    stream.statistics.framesDropped++;
+                }
+
+                // Decode current frame into the buffer not shown, and go to the next frame
+                stream.nextFrameNumber = decoder->getCurrentFrameNumber();
+                stream.nextHasMoreFrames = decoder->decodeNextFrame(stream.buffers[stream.shownBuffer ^ 1], width, height, width * BYTES_PER_PIXEL);
+                stream.nextReady = true;
+                stream.statistics.framesDecoded++;
+                decoded = true;
+            }
+            unlockStreams();
+        }
+        return decoded;
+    }
+
+    /**
+     * @fn void DecodeAheadVideoController::decoderTaskEntry();
+     *
+     * @brief The body of the decoder task.
+     *
+     *        The body of the decoder task. Decodes the requested frames every time it is
+     *        signalled, until waitForDecodeRequest() returns false.
+     */
+    void decoderTaskEntry()
+    {
+        while (waitForDecodeRequest())
+        {
+            decodeRequestedFrames();
+        }
+    }
+
+protected:
+    /**
+     * @fn virtual void DecodeAheadVideoController::signalDecoderTask();
+     *
+     * @brief Signals the decoder task that a frame is requested.
+     *
+     *        Signals the decoder task that a frame is requested. Without a decoder task, the
+     *        frame is decoded now.
+     */
+    virtual void signalDecoderTask()
+    {
+        decodeRequestedFrames();
+    }
+
+    /**
+     * @fn virtual bool DecodeAheadVideoController::waitForDecodeRequest();
+     *
+     * @brief Blocks the decoder task until signalled.
+     *
+     * @return False to end the decoder task.
+     */
+    virtual bool waitForDecodeRequest()
+    {
+        return false;
+    }
+
+    /**
+     * @fn virtual void DecodeAheadVideoController::lockStreams();
+     *
+     * @brief Locks the streams and decoders shared with the decoder task.
+     */
+    virtual void lockStreams()
+    {
+    }
+
+    /**
+     * @fn virtual bool DecodeAheadVideoController::tryLockStreams();
+     *
+     * @brief Locks the streams if they are not locked by the decoder task.
+     *
+     * @return True if the streams are locked.
+     */
+    virtual bool tryLockStreams()
+    {
+        return true;
+    }
+
+    /**
+     * @fn virtual void DecodeAheadVideoController::unlockStreams();
+     *
+     * @brief Unlocks the streams.
+     */
+    virtual void unlockStreams()
+    {
+    }
+
+private:
+    static const uint32_t BYTES_PER_PIXEL = (output_format == touchgfx::Bitmap::RGB565) ? 2 : 3;
+    static const uint32_t FRAME_SIZE = width * height * BYTES_PER_PIXEL;
+
+    class Stream
+    {
+    public:
+        Stream()
+            : frameCount(0), frameNumber(0), tickCount(0),
+              frame_rate_video(0), frame_rate_ticks(0),
+              seek_to_frame(0), skipFrames(0), nextFrameNumber(0),
+              shownBuffer(0),
+              isActive(false), isPlaying(false), repeat(true),
+              isLate(false), showNextFrame(false), decodeRequested(false), nextReady(false), nextHasMoreFrames(true)
+        {
+            buffers[0] = buffers[1] = 0;
+            memset(&statistics, 0, sizeof(statistics));
+        }
+        uint32_t frameCount;       // Video frames showed since play, including skipped frames
+        uint32_t frameNumber;      // Video frame showed number
+        uint32_t tickCount;        // UI frames since play
+        uint32_t frame_rate_video; // Ratio of frames wanted divider
+        uint32_t frame_rate_ticks; // Ratio of frames wanted counter
+        uint32_t seek_to_frame;    // Requested next frame number
+        uint32_t skipFrames;       // Frames to skip before decoding the next frame
+        uint32_t nextFrameNumber;  // Video frame number in the buffer not shown
+        uint8_t* buffers[2];
+        uint8_t shownBuffer;       // Index of buffer shown by the widget
+        bool isActive;
+        bool isPlaying;
+        bool repeat;
+        bool isLate;            // High if the next frame was not ready when due
+        bool showNextFrame;     // High if the next frame is shown even when not playing
+        bool decodeRequested;   // High if the decoder task should decode the next frame
+        bool nextReady;         // High if the next frame is decoded in the buffer not shown
+        bool nextHasMoreFrames; // Low if the next frame is the last frame
+        Statistics statistics;
+    };
+
+    MJPEGDecoder* mjpegDecoders[no_streams];
+    Stream streams[no_streams];
+    uint8_t* videoBuffer;
+
+    // Start stream from the first frame, streams must be locked
+    void restartStream(const Handle handle)
+    {
+        Stream& stream = streams[handle];
+        stream.frameNumber = mjpegDecoders[handle]->getCurrentFrameNumber();
+        stream.seek_to_frame = 0;
+        stream.skipFrames = 0;
+        stream.isLate = false;
+        stream.showNextFrame = true;
+        stream.decodeRequested = true;
+        stream.nextReady = false;
+        memset(&stream.statistics, 0, sizeof(Statistics));
+
+        // Stop playing
+        stream.isPlaying = false;
+    }
+
+    // Decode the frame sought and show it next, streams must be locked
+    void seekStream(Stream& stream, uint32_t frameNumber)
+    {
+        stream.seek_to_frame = frameNumber;
+        stream.skipFrames = 0;
+        // Reset counters
+        stream.frameCount = 0;
+        stream.tickCount = 0;
+        stream.isLate = false;
+        stream.showNextFrame = true;
+        stream.decodeRequested = true;
+        stream.nextReady = false;
+    }
+
+    Handle getFreeHandle()
+    {
+        for (uint32_t i = 0; i < no_streams; i++)
+        {
+            if (streams[i].isActive == false)
+            {
+                return static_cast<VideoController::Handle>(i);
+            }
+        }
+
+        assert(0 && "Unable to find free video stream handle!");
+        return static_cast<VideoController::Handle>(0);
+    }
+};
+
+#endif // DECODEAHEADVIDEOCONTROLLER_HPP
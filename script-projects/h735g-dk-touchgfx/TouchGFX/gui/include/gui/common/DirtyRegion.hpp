@@ -0,0 +1,204 @@
+#ifndef DIRTYREGION_HPP
+#define DIRTYREGION_HPP
+
+#include <touchgfx/hal/Types.hpp>
+#include <stdint.h>
+
+/**
+ * @class DirtyRegion
+ *
+ * @brief Set of invalidated screen areas kept as a list of disjoint rectangles.
+ *
+ *        Set of invalidated screen areas kept as a list of disjoint rectangles. Every
+ *        added area is split against the rectangles already in the region, so a pixel is
+ *        never drawn twice, and pieces sharing a full edge are joined again.
+ *
+ *        Drawing a rectangle has a fixed cost on top of the pixels drawn (traversing the
+ *        widget tree, setting up painters and DMA). The region uses a cost model where a
+ *        rectangle costs its area plus setRectCost() pixels. optimize() merges rectangles
+ *        as long as the merged cover is cheaper, and when the region runs out of rectangles
+ *        the pair whose bounding box adds the fewest pixels is merged. This replaces
+ *        merging everything into large bounding boxes once a fixed number of rectangles is
+ *        exceeded.
+ *
+ *        With a tile size above 1x1 every added area is expanded to the tile grid, which
+ *        trades a little overdraw for fewer, better aligned rectangles.
+ */
+class DirtyRegion
+{
+public:
+    static const uint16_t MAX_RECTS = 32;           ///< Number of rectangles a region can hold
+    static const uint32_t DEFAULT_RECT_COST = 1024; ///< Default cost of a rectangle in pixels
+
+    /**
+     * @struct Statistics
+     *
+     * @brief Pixel counts of a region, used to report overdraw.
+     */
+    struct Statistics
+    {
+        uint32_t dirtyPixels; ///< Pixels added to the region, each counted once
+        uint32_t drawnPixels; ///< Pixels covered by the rectangles of the region
+        uint16_t rects;       ///< Number of rectangles in the region
+        uint16_t merges;      ///< Number of lossy merges performed
+
+        /**
+         * @fn uint32_t DirtyRegion::Statistics::getOverdrawPermille() const;
+         *
+         * @brief Gets the drawn pixels relative to the dirty pixels.
+         *
+         * @return Drawn pixels per thousand dirty pixels, 1000 means no overdraw.
+         */
+        uint32_t getOverdrawPermille() const
+        {
+            return dirtyPixels ? (uint32_t)(((uint64_t)drawnPixels * 1000) / dirtyPixels) : 1000;
+        }
+    };
+
+    /**
+     * @fn DirtyRegion::DirtyRegion();
+     *
+     * @brief Constructs an empty region without bounds, using 1x1 tiles, MAX_RECTS
+     *        rectangles and a rectangle cost of DEFAULT_RECT_COST pixels.
+     */
+    DirtyRegion();
+
+    /**
+     * @fn void DirtyRegion::setBounds(const touchgfx::Rect& area);
+     *
+     * @brief Sets the area added rectangles are clipped to, typically the display.
+     *
+     * @param area The bounds, an empty Rect disables clipping.
+     */
+    void setBounds(const touchgfx::Rect& area)
+    {
+        bounds = area;
+    }
+
+    /**
+     * @fn void DirtyRegion::setTileSize(uint16_t width, uint16_t height);
+     *
+     * @brief Sets the grid added rectangles are expanded to.
+     *
+     * @param width  The tile width, 1 keeps the exact horizontal extent.
+     * @param height The tile height, 1 keeps the exact vertical extent.
+     */
+    void setTileSize(uint16_t width, uint16_t height);
+
+    /**
+     * @fn void DirtyRegion::setRectCost(uint32_t pixels);
+     *
+     * @brief Sets the cost of drawing a rectangle, in addition to its pixels.
+     *
+     * @param pixels The setup cost of a rectangle expressed in drawn pixels.
+     */
+    void setRectCost(uint32_t pixels)
+    {
+        rectCost = pixels;
+    }
+
+    /**
+     * @fn void DirtyRegion::setMaxRects(uint16_t rects);
+     *
+     * @brief Sets the maximum number of rectangles in the region.
+     *
+     * @param rects The number of rectangles, between 1 and MAX_RECTS.
+     */
+    void setMaxRects(uint16_t rects);
+
+    /**
+     * @fn void DirtyRegion::add(const touchgfx::Rect& area);
+     *
+     * @brief Adds an area to the region.
+     *
+     * @param area The area to add, in absolute coordinates.
+     */
+    void add(const touchgfx::Rect& area);
+
+    /**
+     * @fn void DirtyRegion::add(const DirtyRegion& region);
+     *
+     * @brief Adds all rectangles of another region to the region.
+     *
+     * @param region The region to add.
+     */
+    void add(const DirtyRegion& region);
+
+    /**
+     * @fn void DirtyRegion::optimize();
+     *
+     * @brief Merges rectangles while it lowers the cost of drawing the region.
+     *
+     *        Merges rectangles while it lowers the cost of drawing the region. Two
+     *        rectangles are merged when the pixels added by their bounding box cost less
+     *        than drawing one more rectangle. Rectangles overlapping the bounding box are
+     *        merged as well, so the region stays disjoint.
+     */
+    void optimize();
+
+    /**
+     * @fn void DirtyRegion::clear();
+     *
+     * @brief Removes all rectangles and resets the statistics.
+     */
+    void clear();
+
+    bool isEmpty() const
+    {
+        return count == 0;
+    }
+
+    uint16_t size() const
+    {
+        return count;
+    }
+
+    const touchgfx::Rect& operator[](uint16_t index) const
+    {
+        return rects[index];
+    }
+
+    /**
+     * @fn Statistics DirtyRegion::getStatistics() const;
+     *
+     * @brief Gets the pixel counts of the region.
+     *
+     *        Gets the pixel counts of the region. Dirty pixels are counted when added, so
+     *        pixels added inside the bounding box of a lossy merge are not counted and the
+     *        reported overdraw is an upper bound.
+     *
+     * @return The statistics.
+     */
+    Statistics getStatistics() const;
+
+    /**
+     * @fn uint32_t DirtyRegion::getCost() const;
+     *
+     * @brief Gets the cost of drawing the region according to the cost model.
+     *
+     * @return The covered pixels plus the rectangle cost of each rectangle.
+     */
+    uint32_t getCost() const;
+
+private:
+    void insert(touchgfx::Rect area);
+    void append(const touchgfx::Rect& area);
+    void removeAt(uint16_t index);
+    bool overlaps(const touchgfx::Rect& area) const;
+    void mergeCheapestPair();
+    touchgfx::Rect absorb(touchgfx::Rect area, uint32_t& absorbedPixels, uint16_t& absorbedRects) const;
+    void mergeInto(touchgfx::Rect area);
+    touchgfx::Rect snap(const touchgfx::Rect& area) const;
+
+    touchgfx::Rect rects[MAX_RECTS + 1]; ///< The disjoint rectangles, one spare used while inserting
+    uint16_t count;                      ///< Number of rectangles in use
+    uint16_t maxRects;                   ///< Maximum number of rectangles kept
+    uint16_t tileWidth;                  ///< Horizontal grid added areas are expanded to
+    uint16_t tileHeight;                 ///< Vertical grid added areas are expanded to
+    uint32_t rectCost;                   ///< Cost of a rectangle in pixels
+    touchgfx::Rect bounds;               ///< Area added rectangles are clipped to, empty if none
+    uint32_t dirtyPixels;                ///< Pixels added, see getStatistics()
+    uint16_t merges;                     ///< Lossy merges performed
+};
+
+#endif // DIRTYREGION_HPP
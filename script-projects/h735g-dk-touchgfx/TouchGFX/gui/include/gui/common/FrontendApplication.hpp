@@ -2,6 +2,9 @@
 #define FRONTENDAPPLICATION_HPP
 
 #include <gui_generated/common/FrontendApplicationBase.hpp>
+#include <gui/common/DirtyRegion.hpp>
+#include <touchgfx/BitmapCache.hpp>
+#include <touchgfx/Callback.hpp>
 
 class FrontendHeap;
 
@@ -15,10 +18,70 @@ public:
 
     virtual void handleTickEvent()
     {
+        BitmapCache::nextFrame();
         model.tick();
         FrontendApplicationBase::handleTickEvent();
     }
+
+    /**
+     * Collects the invalidated areas in dirtyRegion instead of the fixed size vector
+     * of Application while draw operations are cached.
+     */
+    virtual void draw(Rect& rect);
+
+    /**
+     * Draws the optimized dirtyRegion, including the area drawn in the previous frame
+     * when double buffering, when the draw cache is disabled.
+     */
+    virtual void cacheDrawOperations(bool enableCache);
+
+    /**
+     * Ends the CanvasWidgetRenderer memory report of the current screen before a pending
+     * screen transition, so CanvasWidgetRenderer::getMemoryReport() covers a single screen.
+     * In the simulator the report is printed if the CWR memory usage report is enabled.
+     */
+    virtual void handlePendingScreenTransition();
+
+    /**
+     * Draws the area like Application::draw() when RenderProfiler is enabled, timing every
+     * widget JSMOC draws. The draw chain of the screen is set up as usual, and the first
+     * drawables of the chain are replaced by probes timing their draw() calls before JSMOC
+     * runs, so occlusion culling and cached containers work as when not profiling.
+     *
+     * @param [in] rect The area in absolute coordinates.
+     */
+    void drawProfiled(Rect& rect);
+
+    /**
+     * Gets the dirty region, e.g. to configure its cost model.
+     *
+     * @return The dirty region.
+     */
+    DirtyRegion& getDirtyRegion()
+    {
+        return dirtyRegion;
+    }
+
+    /**
+     * Gets the pixel counts of the last frame drawn, used to monitor overdraw.
+     *
+     * @return The statistics of the last drawn frame.
+     */
+    const DirtyRegion::Statistics& getFrameStatistics() const
+    {
+        return frameStatistics;
+    }
+
 private:
+    void drawArea(const Rect& area);
+    void drawTile(const Rect& tile);
+
+    DirtyRegion dirtyRegion;                                     ///< Areas invalidated in this frame
+    DirtyRegion lastRegion;                                      ///< Areas invalidated in the previous frame, needed when double buffering
+    DirtyRegion frameRegion;                                     ///< Areas to draw in this frame
+    DirtyRegion::Statistics frameStatistics;                     ///< Statistics of the last drawn frame
+    Callback<FrontendApplication, const Rect&> drawAreaCallback; ///< Draws an area of frameRegion, used by the simulator when tiled rendering is disabled or verified
+    Callback<FrontendApplication, const Rect&> drawTileCallback; ///< Draws a tile of frameRegion without flushing it, called from the threads of the simulator TileRenderer
 };
 
 #endif // FRONTENDAPPLICATION_HPP
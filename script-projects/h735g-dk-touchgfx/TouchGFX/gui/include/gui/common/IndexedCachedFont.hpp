@@ -0,0 +1,142 @@
+#ifndef INDEXEDCACHEDFONT_HPP
+#define INDEXEDCACHEDFONT_HPP
+
+#include <fonts/GeneratedFont.hpp>
+#include <gui/common/IndexedFontCache.hpp>
+
+/**
+ * @class IndexedCachedFont
+ *
+ * @brief A font whose glyphs are found in the flash font or in an IndexedFontCache.
+ *
+ *        A font whose glyphs are found in the flash font or in an IndexedFontCache, as the
+ *        generated CachedFont does with a FontCache. When the kerning table is loaded by
+ *        IndexedFontCache::initializeCachedFont(), the cached glyphs are kerned with it.
+ *
+ * @see IndexedFontCache
+ */
+class IndexedCachedFont : public touchgfx::GeneratedFont
+{
+public:
+    /**
+     * @fn IndexedCachedFont::IndexedCachedFont(const touchgfx::BinaryFontData* data, touchgfx::FontId id, IndexedFontCache* _cache, const touchgfx::GeneratedFont* _flashFont);
+     *
+     * @brief Constructs a font from the header of a binary font.
+     *
+     * @param data       The header of the binary font.
+     * @param id         The font id.
+     * @param _cache     The cache holding the glyphs.
+     * @param _flashFont The font in flash, looked in first.
+     */
+    IndexedCachedFont(const touchgfx::BinaryFontData* data, touchgfx::FontId id, IndexedFontCache* _cache, const touchgfx::GeneratedFont* _flashFont)
+        : GeneratedFont(0, // GlyphNode*
+                        data->numberOfGlyphs,
+                        data->height,
+                        data->pixBelowBase,
+                        data->bitsPerPixel,
+                        data->byteAlignRow,
+                        data->maxLeft,
+                        data->maxRight,
+                        0, // glyphDataPointer
+                        0, // Kerning table, set by IndexedFontCache
+                        data->fallbackChar,
+                        data->ellipsisChar,
+                        0,  // lsubTablePointer
+                        0), // contextualFormsPointer
+          fontId(id),
+          cache(_cache),
+          flashFont(_flashFont)
+    {
+    }
+
+    /**
+     * @fn IndexedCachedFont::IndexedCachedFont();
+     *
+     * @brief Constructs an empty font, initialized by IndexedFontCache::initializeCachedFont().
+     */
+    IndexedCachedFont()
+        : GeneratedFont(), fontId(0), cache(0), flashFont(0)
+    {
+    }
+
+    using GeneratedFont::getGlyph;
+
+    virtual const touchgfx::GlyphNode* getGlyph(touchgfx::Unicode::UnicodeChar unicode, const uint8_t*& pixelData, uint8_t& bitsPerPixel) const;
+
+    virtual const uint8_t* getPixelData(const touchgfx::GlyphNode* glyph) const;
+
+    /**
+     * @fn virtual int8_t IndexedCachedFont::getKerning(touchgfx::Unicode::UnicodeChar prevChar, const touchgfx::GlyphNode* glyph) const;
+     *
+     * @brief Gets the kerning distance between two characters.
+     *
+     *        Gets the kerning distance between two characters. Cached glyphs refer to the
+     *        kerning table of the binary font, and are not kerned unless the table was
+     *        loaded into the cache.
+     *
+     * @param prevChar The unicode value of the previous character.
+     * @param glyph    the glyph object for the current character.
+     *
+     * @return The kerning distance between prevChar and glyph char.
+     */
+    virtual int8_t getKerning(touchgfx::Unicode::UnicodeChar prevChar, const touchgfx::GlyphNode* glyph) const;
+
+    /**
+     * @fn touchgfx::FontId IndexedCachedFont::getFontId() const;
+     *
+     * @brief Gets the font id.
+     *
+     * @return The font id.
+     */
+    touchgfx::FontId getFontId() const
+    {
+        return fontId;
+    }
+
+    virtual const uint16_t* getGSUBTable() const
+    {
+        if (gsubTable != 0)
+        {
+            return gsubTable;
+        }
+        return flashFont->getGSUBTable();
+    }
+
+    virtual void setGSUBTable(const uint16_t* table)
+    {
+        gsubTable = table;
+    }
+
+    virtual const touchgfx::FontContextualFormsTable* getContextualFormsTable() const
+    {
+        if (arabicTable != 0)
+        {
+            return arabicTable;
+        }
+        return flashFont->getContextualFormsTable();
+    }
+
+    virtual void setContextualFormsTable(const touchgfx::FontContextualFormsTable* table)
+    {
+        arabicTable = table;
+    }
+
+    /**
+     * @fn void IndexedCachedFont::setKerningTable(const touchgfx::KerningNode* table);
+     *
+     * @brief Sets the kerning table of the cached glyphs.
+     *
+     * @param table The kerning table loaded into the cache, 0 if not loaded.
+     */
+    void setKerningTable(const touchgfx::KerningNode* table)
+    {
+        kerningData = table;
+    }
+
+private:
+    touchgfx::FontId fontId;
+    IndexedFontCache* cache;
+    const touchgfx::GeneratedFont* flashFont;
+};
+
+#endif // INDEXEDCACHEDFONT_HPP
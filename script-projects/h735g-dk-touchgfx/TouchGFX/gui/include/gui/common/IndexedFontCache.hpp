@@ -0,0 +1,268 @@
+#ifndef INDEXEDFONTCACHE_HPP
+#define INDEXEDFONTCACHE_HPP
+
+#include <fonts/FontCache.hpp>
+#include <touchgfx/Font.hpp>
+#include <touchgfx/TypedText.hpp>
+#include <stdint.h>
+
+class IndexedCachedFont;
+
+/**
+ * @class AsyncFontDataReader
+ *
+ * @brief A FontDataReader which can read data in the background, e.g. with DMA.
+ *
+ *        A FontDataReader which can read data in the background, e.g. with DMA.
+ *        IndexedFontCache reads glyph data with startReadData(), and copies the glyphs
+ *        already read while the next data is read. At most one read is started at a time,
+ *        and waitForData() is called before the data is used and before the next
+ *        setPosition() or readData().
+ */
+class AsyncFontDataReader : public touchgfx::FontDataReader
+{
+public:
+    /**
+     * @fn virtual void AsyncFontDataReader::startReadData(void* out, uint32_t numberOfBytes) = 0;
+     *
+     * @brief Starts reading data from the current position, which may complete after returning.
+     *
+     * @param [out] out           Where the data is read to.
+     * @param       numberOfBytes The number of bytes to read.
+     */
+    virtual void startReadData(void* out, uint32_t numberOfBytes) = 0;
+
+    /**
+     * @fn virtual void AsyncFontDataReader::waitForData() = 0;
+     *
+     * @brief Waits for the read started with startReadData() to complete.
+     */
+    virtual void waitForData() = 0;
+};
+
+/**
+ * @class IndexedFontCache
+ *
+ * @brief Caches glyphs of binary fonts, as FontCache, with a hash index of the cached glyphs.
+ *
+ *        Caches glyphs of binary fonts, as the generated FontCache, for IndexedCachedFont.
+ *        The cached glyphs are found through a hash index in the start of the cache memory
+ *        instead of walking a list per font, which makes getGlyph() independent of the
+ *        number of glyphs cached. Caching a string sorts it with heapsort, reads the glyph
+ *        table of the font in blocks, and reads the data of glyphs close together in the
+ *        font in one go. With an AsyncFontDataReader, the glyphs read are copied in place
+ *        while the next data is read.
+ *
+ *        The kerning table of a font can be loaded into the cache, so IndexedCachedFont
+ *        can kern the cached glyphs.
+ *
+ * @see IndexedCachedFont, AsyncFontDataReader
+ */
+class IndexedFontCache
+{
+public:
+    /**
+     * @fn IndexedFontCache::IndexedFontCache();
+     *
+     * @brief Constructs a cache without memory and reader.
+     */
+    IndexedFontCache();
+
+    /**
+     * @fn void IndexedFontCache::setReader(touchgfx::FontDataReader* reader);
+     *
+     * @brief Sets the reader of the binary fonts.
+     *
+     * @param [in] reader The reader, which reads all data synchronously.
+     */
+    void setReader(touchgfx::FontDataReader* reader);
+
+    /**
+     * @fn void IndexedFontCache::setReader(AsyncFontDataReader* reader);
+     *
+     * @brief Sets the reader of the binary fonts.
+     *
+     * @param [in] reader The reader, which reads glyph data in the background.
+     */
+    void setReader(AsyncFontDataReader* reader);
+
+    /**
+     * @fn void IndexedFontCache::clear(bool keepGsubOrContextTable = false);
+     *
+     * @brief Removes all cached glyphs.
+     *
+     * @param keepGsubOrContextTable True to keep the GSUB, contextual forms and kerning
+     *                               tables loaded by initializeCachedFont().
+     */
+    void clear(bool keepGsubOrContextTable = false);
+
+    /**
+     * @fn void IndexedFontCache::setMemory(uint8_t* memory, uint32_t size);
+     *
+     * @brief Sets the memory of the cache and clears it.
+     *
+     * @param [in] memory The memory.
+     * @param      size   The size of the memory in bytes, at most 64MB.
+     */
+    void setMemory(uint8_t* memory, uint32_t size);
+
+    /**
+     * @fn void IndexedFontCache::initializeCachedFont(touchgfx::TypedText t, IndexedCachedFont* font, bool loadGsubOrContextTable = false, bool loadKerningTable = false);
+     *
+     * @brief Initializes a cached font from the header of the binary font of a text.
+     *
+     * @param      t                      The text, whose font is read.
+     * @param [in] font                   The font to initialize.
+     * @param      loadGsubOrContextTable True to load the GSUB and contextual forms tables
+     *                                    into the end of the cache.
+     * @param      loadKerningTable       True to load the kerning table into the end of the
+     *                                    cache, so the cached glyphs are kerned.
+     */
+    void initializeCachedFont(touchgfx::TypedText t, IndexedCachedFont* font, bool loadGsubOrContextTable = false, bool loadKerningTable = false);
+
+    /**
+     * @fn bool IndexedFontCache::cacheString(touchgfx::TypedText t, const touchgfx::Unicode::UnicodeChar* string);
+     *
+     * @brief Caches the glyphs of a string.
+     *
+     * @param t      The text, whose font is cached.
+     * @param string The characters to cache.
+     *
+     * @return False if the cache ran out of memory.
+     */
+    bool cacheString(touchgfx::TypedText t, const touchgfx::Unicode::UnicodeChar* string);
+
+    /**
+     * @fn bool IndexedFontCache::cacheLigatures(IndexedCachedFont* font, touchgfx::TypedText t, const touchgfx::Unicode::UnicodeChar* string);
+     *
+     * @brief Caches the glyphs of the ligatures of a string.
+     *
+     * @param [in] font   The cached font, whose GSUB and contextual forms tables are used.
+     * @param      t      The text, whose font is cached.
+     * @param      string The characters to cache.
+     *
+     * @return False if the cache ran out of memory.
+     */
+    bool cacheLigatures(IndexedCachedFont* font, touchgfx::TypedText t, const touchgfx::Unicode::UnicodeChar* string);
+
+    /**
+     * @fn const touchgfx::GlyphNode* IndexedFontCache::getGlyph(touchgfx::Unicode::UnicodeChar unicode, touchgfx::FontId font) const;
+     *
+     * @brief Finds a cached glyph.
+     *
+     * @param unicode The character.
+     * @param font    The font.
+     *
+     * @return The glyph, 0 if not cached.
+     */
+    const touchgfx::GlyphNode* getGlyph(touchgfx::Unicode::UnicodeChar unicode, touchgfx::FontId font) const;
+
+    /**
+     * @fn uint32_t IndexedFontCache::getMemoryUsage();
+     *
+     * @brief Gets the memory used by the glyph index, the glyphs and the loaded tables.
+     *
+     * @return The number of bytes used.
+     */
+    uint32_t getMemoryUsage()
+    {
+        return memorySize - (gsubStart - top);
+    }
+
+    /**
+     * @fn void IndexedFontCache::open();
+     *
+     * @brief Opens the reader.
+     */
+    void open();
+
+    /**
+     * @fn void IndexedFontCache::close();
+     *
+     * @brief Closes the reader.
+     */
+    void close();
+
+    /**
+     * @fn static const uint8_t* IndexedFontCache::getPixelData(const touchgfx::GlyphNode* glyph);
+     *
+     * @brief Gets the pixel data of a cached glyph.
+     *
+     * @param glyph The cached glyph.
+     *
+     * @return The pixel data, stored after the glyph.
+     */
+    static const uint8_t* getPixelData(const touchgfx::GlyphNode* glyph)
+    {
+        return ((const uint8_t*)glyph) + SIZE_GLYPH_NODE + 4;
+    }
+
+    /**
+     * @fn static bool IndexedFontCache::isCached(const touchgfx::GlyphNode* glyph);
+     *
+     * @brief Query if a glyph is stored in the cache.
+     *
+     * @param glyph The glyph.
+     *
+     * @return True if the glyph is cached, false if it is a glyph of a flash font.
+     */
+    static bool isCached(const touchgfx::GlyphNode* glyph)
+    {
+        return glyph->dataOffset == 0xFFFFFFFF;
+    }
+
+private:
+    static const uint32_t SIZE_GLYPH_NODE = 16;
+
+    bool contains(touchgfx::Unicode::UnicodeChar unicode, touchgfx::FontId font) const;
+    void insert(touchgfx::Unicode::UnicodeChar unicode, touchgfx::FontId font, uint32_t bpp, bool& outOfMemory);
+    uint8_t* copyGlyph(uint8_t* top, touchgfx::Unicode::UnicodeChar unicode, uint32_t bpp, bool& outOfMemory);
+    uint32_t bucketOf(touchgfx::Unicode::UnicodeChar unicode, touchgfx::FontId font) const
+    {
+        // Fibonacci hashing spreads consecutive code points over the buckets
+        return ((((uint32_t)font << 16) | unicode) * 2654435769u >> 16) & glyphIndexMask;
+    }
+
+    void readGlyphNode();
+    void cacheData(uint32_t bpp, uint8_t* first);
+    bool cacheSortedString(touchgfx::TypedText t);
+    bool createSortedString(const touchgfx::Unicode::UnicodeChar* string);
+    bool createSortedLigatures(IndexedCachedFont* font, touchgfx::TypedText t, const touchgfx::Unicode::UnicodeChar* string, ...);
+    bool sortSortedString(int n);
+
+    void setPosition(uint32_t position);
+    void readData(void* out, uint32_t numberOfBytes);
+    void startReadData(void* out, uint32_t numberOfBytes);
+    void waitForData();
+
+    // Hash index of the cached glyphs, allocated in the start of the cache. Each bucket holds
+    // the word offset from glyphIndex of the first GlyphNode in the bucket, 0 if empty. The
+    // word after each GlyphNode holds its font in the top 8 bits and the word offset of the
+    // next GlyphNode in the bucket in the low 24 bits.
+    uint32_t* glyphIndex;
+    uint32_t glyphIndexMask; // Number of buckets - 1
+
+    uint32_t memorySize;
+    uint8_t* memory;    // Start of memory
+    uint8_t* top;       // First unused byte
+    uint8_t* gsubStart; // First address of GSUB and kerning tables, allocated in the end of the cache
+
+    touchgfx::FontDataReader* reader;
+    AsyncFontDataReader* asyncReader; // The reader if it reads in the background, otherwise 0
+
+    touchgfx::Unicode::UnicodeChar* sortedString;
+    // Must be bigger than BinaryFontData
+    static const uint32_t MAX_BUFFER_SIZE = 64;
+    char buffer[MAX_BUFFER_SIZE];
+    uint32_t glyphDataOffset;
+    uint16_t numGlyphs;
+    uint16_t currentFileGlyphNumber;
+    touchgfx::GlyphNode currentFileGlyphNode;
+    // GlyphNodes are read from the font in blocks of this many
+    static const uint16_t GLYPH_NODE_BUFFER_SIZE = 64;
+    touchgfx::GlyphNode glyphNodeBuffer[GLYPH_NODE_BUFFER_SIZE];
+    uint16_t glyphNodesBuffered;
+    uint16_t nextBufferedGlyphNode;
+};
+
+#endif // INDEXEDFONTCACHE_HPP
@@ -0,0 +1,87 @@
+#ifndef KERNEDGENERATEDFONT_HPP
+#define KERNEDGENERATEDFONT_HPP
+
+#include <fonts/GeneratedFont.hpp>
+#include <gui/common/KerningLookup.hpp>
+
+/**
+ * @class KernedGeneratedFont
+ *
+ * @brief A copy of a GeneratedFont finding kerning pairs in a hash table.
+ *
+ *        A copy of a GeneratedFont finding kerning pairs in a hash table. The glyphs,
+ *        kerning table and GSUB tables of the font in the generated font table are shared,
+ *        and getKerning() uses a KerningLookup instead of scanning the kerning pairs of the
+ *        glyph. This pays off for fonts with many kerning pairs per glyph.
+ *
+ *        The generated fonts are not changed, the copy is used instead of the font by
+ *        installing it with TypedTextDatabase::setFont():
+ *
+ *        @code
+ *        static KernedGeneratedFont font(*static_cast<const GeneratedFont*>(TypedTextDatabase::getFonts()[id]));
+ *        static uint32_t memory[1024];
+ *        font.setupKerningLookup((uint8_t*)memory, sizeof(memory));
+ *        TypedTextDatabase::setFont(id, &font);
+ *        @endcode
+ *
+ * @see KerningLookup, KernedUnmappedDataFont
+ */
+class KernedGeneratedFont : public touchgfx::GeneratedFont
+{
+public:
+    /**
+     * @fn KernedGeneratedFont::KernedGeneratedFont(const touchgfx::GeneratedFont& font);
+     *
+     * @brief Constructs a copy of a font, searching the kerning pairs until
+     *        setupKerningLookup() is called.
+     *
+     * @param font The font to copy.
+     */
+    explicit KernedGeneratedFont(const touchgfx::GeneratedFont& font)
+        : GeneratedFont(font), kerningLookup()
+    {
+    }
+
+    /**
+     * @fn virtual int8_t KernedGeneratedFont::getKerning(touchgfx::Unicode::UnicodeChar prevChar, const touchgfx::GlyphNode* glyph) const;
+     *
+     * @brief Gets the kerning distance between two characters.
+     *
+     * @param prevChar The unicode value of the previous character.
+     * @param glyph    the glyph object for the current character.
+     *
+     * @return The kerning distance between prevChar and glyph char.
+     */
+    virtual int8_t getKerning(touchgfx::Unicode::UnicodeChar prevChar, const touchgfx::GlyphNode* glyph) const
+    {
+        return kerningLookup.getKerning(prevChar, glyph, kerningData);
+    }
+
+    /**
+     * @fn uint32_t KernedGeneratedFont::getKerningLookupMemorySize() const;
+     *
+     * @brief Gets the memory needed by setupKerningLookup().
+     *
+     * @return The size in bytes of a hash table of all kerning pairs of the font.
+     */
+    uint32_t getKerningLookupMemorySize() const;
+
+    /**
+     * @fn bool KernedGeneratedFont::setupKerningLookup(uint8_t* memory, uint32_t size);
+     *
+     * @brief Puts all kerning pairs of the font in a hash table in the given memory.
+     *
+     * @param memory The memory, at a 32bit address, used until the font is no longer used.
+     * @param size   The size of the memory in bytes, at least getKerningLookupMemorySize().
+     *
+     * @return True if the memory is large enough and the font has kerning pairs.
+     */
+    bool setupKerningLookup(uint8_t* memory, uint32_t size);
+
+private:
+    uint32_t countKerningPairs() const;
+
+    KerningLookup kerningLookup; ///< Finds kerning pairs
+};
+
+#endif // KERNEDGENERATEDFONT_HPP
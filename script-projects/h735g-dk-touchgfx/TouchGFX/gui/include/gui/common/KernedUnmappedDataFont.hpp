@@ -0,0 +1,83 @@
+#ifndef KERNEDUNMAPPEDDATAFONT_HPP
+#define KERNEDUNMAPPEDDATAFONT_HPP
+
+#include <fonts/UnmappedDataFont.hpp>
+#include <gui/common/KerningLookup.hpp>
+#include <touchgfx/hal/FlashDataReader.hpp>
+
+/**
+ * @class KernedUnmappedDataFont
+ *
+ * @brief A copy of an UnmappedDataFont finding kerning pairs in a hash table.
+ *
+ *        A copy of an UnmappedDataFont finding kerning pairs in a hash table. The glyph
+ *        table in unmapped flash is read once by setupKerningLookup(), through the
+ *        FlashDataReader of the ApplicationFontProvider, and getKerning() then uses a
+ *        KerningLookup instead of scanning the kerning pairs of the glyph.
+ *
+ *        The copy is used instead of the font by installing it with
+ *        TypedTextDatabase::setFont(), as for KernedGeneratedFont.
+ *
+ * @see KerningLookup, KernedGeneratedFont
+ */
+class KernedUnmappedDataFont : public touchgfx::UnmappedDataFont
+{
+public:
+    /**
+     * @fn KernedUnmappedDataFont::KernedUnmappedDataFont(const touchgfx::UnmappedDataFont& font);
+     *
+     * @brief Constructs a copy of a font, searching the kerning pairs until
+     *        setupKerningLookup() is called.
+     *
+     * @param font The font to copy.
+     */
+    explicit KernedUnmappedDataFont(const touchgfx::UnmappedDataFont& font)
+        : UnmappedDataFont(font), kerningLookup()
+    {
+    }
+
+    /**
+     * @fn virtual int8_t KernedUnmappedDataFont::getKerning(touchgfx::Unicode::UnicodeChar prevChar, const touchgfx::GlyphNode* glyph) const;
+     *
+     * @brief Gets the kerning distance between two characters.
+     *
+     * @param prevChar The unicode value of the previous character.
+     * @param glyph    the glyph object for the current character.
+     *
+     * @return The kerning distance between prevChar and glyph char.
+     */
+    virtual int8_t getKerning(touchgfx::Unicode::UnicodeChar prevChar, const touchgfx::GlyphNode* glyph) const
+    {
+        return kerningLookup.getKerning(prevChar, glyph, kerningData);
+    }
+
+    /**
+     * @fn uint32_t KernedUnmappedDataFont::getKerningLookupMemorySize() const;
+     *
+     * @brief Gets the memory needed by setupKerningLookup().
+     *
+     * @return The size in bytes of a hash table of all kerning pairs of the font, 0 if the
+     *         ApplicationFontProvider has no FlashDataReader.
+     */
+    uint32_t getKerningLookupMemorySize() const;
+
+    /**
+     * @fn bool KernedUnmappedDataFont::setupKerningLookup(uint8_t* memory, uint32_t size);
+     *
+     * @brief Puts all kerning pairs of the font in a hash table in the given memory.
+     *
+     * @param memory The memory, at a 32bit address, used until the font is no longer used.
+     * @param size   The size of the memory in bytes, at least getKerningLookupMemorySize().
+     *
+     * @return True if the memory is large enough, the font has kerning pairs and the
+     *         ApplicationFontProvider has a FlashDataReader.
+     */
+    bool setupKerningLookup(uint8_t* memory, uint32_t size);
+
+private:
+    uint32_t countKerningPairs(touchgfx::FlashDataReader* flashReader) const;
+
+    KerningLookup kerningLookup; ///< Finds kerning pairs
+};
+
+#endif // KERNEDUNMAPPEDDATAFONT_HPP
@@ -0,0 +1,135 @@
+#ifndef KERNINGLOOKUP_HPP
+#define KERNINGLOOKUP_HPP
+
+#include <touchgfx/Font.hpp>
+#include <stdint.h>
+
+/**
+ * @class KerningLookup
+ *
+ * @brief Finds the kerning of a pair of characters.
+ *
+ *        Finds the kerning of a pair of characters. The kerning pairs of a glyph are stored
+ *        in the kerning table of the font, sorted by the previous character, and are found
+ *        by binary search. When memory is given with setup(), the pairs of all glyphs of
+ *        the font are added to an open addressing hash table keyed on the pair, which finds
+ *        a pair in one or two probes.
+ *
+ * @see KernedGeneratedFont, KernedUnmappedDataFont, IndexedCachedFont
+ */
+class KerningLookup
+{
+public:
+    /**
+     * @fn KerningLookup::KerningLookup();
+     *
+     * @brief Constructs a lookup without a hash table, searching the kerning table.
+     */
+    KerningLookup()
+        : keys(0), distances(0), mask(0), shift(0)
+    {
+    }
+
+    /**
+     * @fn static uint32_t KerningLookup::getMemorySize(uint32_t numberOfPairs);
+     *
+     * @brief Gets the memory needed for a hash table of a number of kerning pairs.
+     *
+     * @param numberOfPairs The number of kerning pairs.
+     *
+     * @return The size in bytes.
+     */
+    static uint32_t getMemorySize(uint32_t numberOfPairs)
+    {
+        return getCapacity(numberOfPairs) * (sizeof(uint32_t) + sizeof(int8_t));
+    }
+
+    /**
+     * @fn bool KerningLookup::setup(uint8_t* memory, uint32_t size, uint32_t numberOfPairs);
+     *
+     * @brief Sets up an empty hash table in the given memory.
+     *
+     *        Sets up an empty hash table in the given memory, at most half full with the
+     *        given number of kerning pairs.
+     *
+     * @param memory        The memory, at a 32bit address.
+     * @param size          The size of the memory in bytes.
+     * @param numberOfPairs The number of kerning pairs to add.
+     *
+     * @return True if the memory is large enough, otherwise the hash table is not used.
+     */
+    bool setup(uint8_t* memory, uint32_t size, uint32_t numberOfPairs);
+
+    /**
+     * @fn void KerningLookup::add(touchgfx::Unicode::UnicodeChar unicode, const touchgfx::KerningNode* kerning, uint16_t size);
+     *
+     * @brief Adds the kerning pairs of a glyph to the hash table.
+     *
+     * @param unicode The character of the glyph.
+     * @param kerning The kerning pairs of the glyph.
+     * @param size    The number of kerning pairs.
+     */
+    void add(touchgfx::Unicode::UnicodeChar unicode, const touchgfx::KerningNode* kerning, uint16_t size);
+
+    /**
+     * @fn bool KerningLookup::isHashed() const;
+     *
+     * @brief Query if the hash table is used.
+     *
+     * @return True if setup() succeeded.
+     */
+    bool isHashed() const
+    {
+        return keys != 0;
+    }
+
+    /**
+     * @fn int8_t KerningLookup::getKerning(touchgfx::Unicode::UnicodeChar prevChar, const touchgfx::GlyphNode* glyph, const touchgfx::KerningNode* kerningData) const;
+     *
+     * @brief Gets the kerning distance between two characters.
+     *
+     * @param prevChar    The unicode value of the previous character.
+     * @param glyph       The glyph object for the current character.
+     * @param kerningData The kerning table of the font, searched if there is no hash table.
+     *
+     * @return The kerning distance between prevChar and glyph char.
+     */
+    int8_t getKerning(touchgfx::Unicode::UnicodeChar prevChar, const touchgfx::GlyphNode* glyph, const touchgfx::KerningNode* kerningData) const;
+
+    /**
+     * @fn static int8_t KerningLookup::find(touchgfx::Unicode::UnicodeChar prevChar, const touchgfx::KerningNode* kerning, uint16_t size);
+     *
+     * @brief Finds the kerning distance after a previous character in the kerning pairs of a glyph.
+     *
+     * @param prevChar The unicode value of the previous character.
+     * @param kerning  The kerning pairs of the glyph, sorted by the previous character.
+     * @param size     The number of kerning pairs.
+     *
+     * @return The kerning distance, 0 if prevChar is not in the kerning pairs.
+     */
+    static int8_t find(touchgfx::Unicode::UnicodeChar prevChar, const touchgfx::KerningNode* kerning, uint16_t size);
+
+private:
+    static uint32_t getCapacity(uint32_t numberOfPairs)
+    {
+        uint32_t capacity = 2;
+        while (capacity < 2 * numberOfPairs)
+        {
+            capacity *= 2;
+        }
+        return capacity;
+    }
+
+    uint32_t hash(uint32_t key) const
+    {
+        // Fibonacci hashing, the top bits of the product are the best mixed
+        return (key * 2654435769u) >> shift;
+    }
+
+    uint32_t* keys;    ///< The pairs as previous character << 16 | character, 0 if unused
+    int8_t* distances; ///< The kerning distance of each pair
+    uint32_t mask;     ///< Capacity of the hash table - 1
+    uint8_t shift;     ///< 32 - log2 of the capacity
+};
+
+#endif // KERNINGLOOKUP_HPP
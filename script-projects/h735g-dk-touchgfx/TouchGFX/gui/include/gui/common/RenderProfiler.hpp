@@ -0,0 +1,300 @@
+#ifndef RENDERPROFILER_HPP
+#define RENDERPROFILER_HPP
+
+#include <touchgfx/Callback.hpp>
+#include <stdint.h>
+#if defined(__GXX_RTTI) || defined(_CPPRTTI)
+#include <typeinfo>
+#endif
+
+#ifndef RENDER_PROFILER_EVENTS
+#define RENDER_PROFILER_EVENTS 256
+#endif
+
+/**
+ * @class RenderProfiler
+ *
+ * @brief Records the time spent drawing each frame, area and widget.
+ *
+ *        Records the time spent drawing each frame, area and widget. Scopes are timed with
+ *        HAL::getCPUCycles(), which reads the DWT cycle counter through
+ *        CortexMMCUInstrumentation on target, and with a host clock in the simulator.
+ *        Scopes nest, and each completed scope is stored as an Event in a ring buffer
+ *        holding the last RENDER_PROFILER_EVENTS events.
+ *
+ *        Events are keyed by the type of the widget and of the current screen. The type is
+ *        identified by the address of its vtable, which is resolved to a name with e.g.
+ *        "arm-none-eabi-nm -C" on the ELF file. When compiled with RTTI, as the simulator
+ *        is, the type name is recorded as well.
+ *
+ *        The ring buffer is exported as text lines, e.g. over SWO or UART, as a per widget
+ *        summary, or as a Chrome trace (chrome://tracing, Perfetto) JSON document.
+ */
+class RenderProfiler
+{
+public:
+    static const uint16_t MAX_EVENTS = RENDER_PROFILER_EVENTS; ///< Number of events kept in the ring buffer
+    static const uint8_t MAX_DEPTH = 16;                       ///< Number of nested scopes timed, deeper scopes are ignored
+
+    /**
+     * @enum Kind
+     *
+     * @brief What a scope measures.
+     */
+    enum Kind
+    {
+        FRAME,      ///< Drawing all dirty areas of a frame
+        AREA,       ///< Drawing a single dirty area
+        DRAW_CHAIN, ///< Container::setupDrawChain() traversal of the screen for an area
+        DRAWABLE,   ///< A single Drawable::draw() call
+        NUMBER_OF_KINDS
+    };
+
+    /**
+     * @struct Event
+     *
+     * @brief A completed scope.
+     */
+    struct Event
+    {
+        uint64_t start;         ///< Start of the scope in cycles
+        uint32_t cycles;        ///< Duration of the scope in cycles
+        const void* type;       ///< vtable of the measured object, 0 if none
+        const char* typeName;   ///< Type name of the measured object if compiled with RTTI, otherwise 0
+        const void* screen;     ///< vtable of the current screen
+        const char* screenName; ///< Type name of the current screen if compiled with RTTI, otherwise 0
+        uint16_t frame;         ///< Frame number
+        uint8_t kind;           ///< The Kind of scope
+        uint8_t depth;          ///< Nesting depth, 0 for frames
+    };
+
+    /**
+     * @class Scope
+     *
+     * @brief Times the lifetime of the object as a scope of the profiler.
+     */
+    class Scope
+    {
+    public:
+        /**
+         * @fn RenderProfiler::Scope::Scope(Kind kind);
+         *
+         * @brief Starts a scope not measuring an object.
+         *
+         * @param kind The kind of scope.
+         */
+        Scope(Kind kind)
+            : scopeKind(kind), type(0), typeName(0)
+        {
+            RenderProfiler::begin();
+        }
+
+        /**
+         * @fn template <class T> RenderProfiler::Scope::Scope(Kind kind, const T& object);
+         *
+         * @brief Starts a scope measuring an object, which must have virtual functions.
+         *
+         * @param kind   The kind of scope.
+         * @param object The object measured, e.g. the drawable drawn.
+         */
+        template <class T>
+        Scope(Kind kind, const T& object)
+            : scopeKind(kind), type(getType(object)), typeName(getTypeName(object))
+        {
+            RenderProfiler::begin();
+        }
+
+        ~Scope()
+        {
+            RenderProfiler::end(scopeKind, type, typeName);
+        }
+
+    private:
+        Kind scopeKind;
+        const void* type;
+        const char* typeName;
+    };
+
+    /**
+     * @fn static void RenderProfiler::enable(bool enable);
+     *
+     * @brief Enables or disables the profiler.
+     *
+     * @param enable True to record scopes.
+     */
+    static void enable(bool enable);
+
+    static bool isEnabled()
+    {
+        return enabled;
+    }
+
+    /**
+     * @fn static void RenderProfiler::setClockFrequency(uint32_t hz);
+     *
+     * @brief Sets the frequency of the cycle counter, used to convert cycles to time.
+     *
+     * @param hz The cycle counter frequency, e.g. SystemCoreClock.
+     */
+    static void setClockFrequency(uint32_t hz)
+    {
+        clockFrequency = hz;
+    }
+
+    static uint32_t getClockFrequency()
+    {
+        return clockFrequency;
+    }
+
+    /**
+     * @fn static void RenderProfiler::setExport(touchgfx::GenericCallback<const char*>* writer, uint16_t frames);
+     *
+     * @brief Exports the ring buffer as text lines every number of frames.
+     *
+     * @param writer Callback writing a line, e.g. to SWO or UART, 0 to disable.
+     * @param frames Number of frames between exports.
+     */
+    static void setExport(touchgfx::GenericCallback<const char*>* writer, uint16_t frames);
+
+    /**
+     * @fn template <class T> static void RenderProfiler::setScreen(const T& screen);
+     *
+     * @brief Sets the screen drawn, recorded with every following event.
+     *
+     * @param screen The current screen.
+     */
+    template <class T>
+    static void setScreen(const T& screen)
+    {
+        currentScreen = getType(screen);
+        currentScreenName = getTypeName(screen);
+    }
+
+    /**
+     * @fn static void RenderProfiler::beginFrame();
+     *
+     * @brief Starts the FRAME scope.
+     */
+    static void beginFrame();
+
+    /**
+     * @fn static void RenderProfiler::endFrame();
+     *
+     * @brief Ends the FRAME scope and exports the events if setExport() asks for it.
+     */
+    static void endFrame();
+
+    /**
+     * @fn static void RenderProfiler::begin();
+     *
+     * @brief Starts a scope. Prefer Scope, which ends the scope automatically.
+     */
+    static void begin();
+
+    /**
+     * @fn static void RenderProfiler::end(Kind kind, const void* type, const char* typeName);
+     *
+     * @brief Ends the innermost scope and records it.
+     *
+     * @param kind     The kind of scope.
+     * @param type     vtable of the measured object, 0 if none.
+     * @param typeName Type name of the measured object, 0 if unknown.
+     */
+    static void end(Kind kind, const void* type, const char* typeName);
+
+    /**
+     * @fn static void RenderProfiler::clear();
+     *
+     * @brief Removes all events from the ring buffer.
+     */
+    static void clear();
+
+    static uint16_t size()
+    {
+        return count;
+    }
+
+    /**
+     * @fn static const Event& RenderProfiler::getEvent(uint16_t index);
+     *
+     * @brief Gets an event from the ring buffer.
+     *
+     * @param index Index of the event, 0 is the oldest.
+     *
+     * @return The event.
+     */
+    static const Event& getEvent(uint16_t index)
+    {
+        return events[(head + MAX_EVENTS - count + index) % MAX_EVENTS];
+    }
+
+    /**
+     * @fn static void RenderProfiler::exportText(touchgfx::GenericCallback<const char*>& writer);
+     *
+     * @brief Writes the ring buffer as comma separated lines.
+     *
+     *        Writes the ring buffer as comma separated lines of frame, kind, depth, screen,
+     *        type, start and duration. Times are in cycles, relative to the oldest event.
+     *
+     * @param writer Callback writing a line.
+     */
+    static void exportText(touchgfx::GenericCallback<const char*>& writer);
+
+    /**
+     * @fn static void RenderProfiler::exportSummary(touchgfx::GenericCallback<const char*>& writer);
+     *
+     * @brief Writes the draw time of each widget type in the ring buffer.
+     *
+     *        Writes the draw time of each widget type in the ring buffer, most expensive
+     *        first, as calls, total and maximum microseconds, and share of the frame time.
+     *
+     * @param writer Callback writing a line.
+     */
+    static void exportSummary(touchgfx::GenericCallback<const char*>& writer);
+
+    /**
+     * @fn static void RenderProfiler::exportChromeTrace(touchgfx::GenericCallback<const char*>& writer);
+     *
+     * @brief Writes the ring buffer as a Chrome trace JSON document.
+     *
+     * @param writer Callback writing a part of the document.
+     */
+    static void exportChromeTrace(touchgfx::GenericCallback<const char*>& writer);
+
+private:
+    template <class T>
+    static const void* getType(const T& object)
+    {
+        // The vtable pointer identifies the dynamic type without RTTI
+        return *reinterpret_cast<const void* const*>(&object);
+    }
+
+    template <class T>
+    static const char* getTypeName(const T& object)
+    {
+#if defined(__GXX_RTTI) || defined(_CPPRTTI)
+        return typeid(object).name();
+#else
+        (void)object;
+        return 0;
+#endif
+    }
+
+    static uint64_t now();
+
+    static Event events[MAX_EVENTS];
+    static uint16_t head;
+    static uint16_t count;
+    static uint64_t starts[MAX_DEPTH];
+    static uint16_t depth;
+    static uint16_t frame;
+    static bool enabled;
+    static uint32_t clockFrequency;
+    static const void* currentScreen;
+    static const char* currentScreenName;
+    static touchgfx::GenericCallback<const char*>* exportWriter;
+    static uint16_t exportFrames;
+    static uint16_t framesSinceExport;
+};
+
+#endif // RENDERPROFILER_HPP
@@ -0,0 +1,378 @@
+#include <gui/common/DirtyRegion.hpp>
+#include <cassert>
+
+using namespace touchgfx;
+
+namespace
+{
+// Pieces an added area can be split into before it is merged as a whole instead,
+// kept small since the pieces live on the stack of the GUI task
+const uint16_t MAX_PIECES = 16;
+
+int32_t floorToTile(int32_t value, int32_t tile)
+{
+    const int32_t rest = value % tile;
+    return rest < 0 ? value - rest - tile : value - rest;
+}
+
+bool shareHorizontalEdge(const Rect& a, const Rect& b)
+{
+    return a.x == b.x && a.width == b.width && (a.bottom() == b.y || b.bottom() == a.y);
+}
+
+bool shareVerticalEdge(const Rect& a, const Rect& b)
+{
+    return a.y == b.y && a.height == b.height && (a.right() == b.x || b.right() == a.x);
+}
+} // namespace
+
+DirtyRegion::DirtyRegion()
+    : count(0), maxRects(MAX_RECTS), tileWidth(1), tileHeight(1), rectCost(DEFAULT_RECT_COST), bounds(), dirtyPixels(0), merges(0)
+{
+}
+
+void DirtyRegion::setTileSize(uint16_t width, uint16_t height)
+{
+    assert(width > 0 && height > 0 && "Tile size must be at least 1x1");
+    tileWidth = width;
+    tileHeight = height;
+}
+
+void DirtyRegion::setMaxRects(uint16_t rects)
+{
+    assert(rects > 0 && rects <= MAX_RECTS && "Number of rectangles out of range");
+    maxRects = rects;
+    while (count > maxRects)
+    {
+        mergeCheapestPair();
+    }
+}
+
+void DirtyRegion::add(const Rect& area)
+{
+    Rect r = area;
+    if (!bounds.isEmpty())
+    {
+        r &= bounds;
+    }
+    if (r.isEmpty())
+    {
+        return;
+    }
+    r = snap(r);
+    if (!bounds.isEmpty())
+    {
+        r &= bounds;
+    }
+
+    // Split the area into the pieces not already in the region
+    Rect pieces[2][MAX_PIECES];
+    uint16_t numPieces = 1;
+    int current = 0;
+    pieces[current][0] = r;
+    for (uint16_t i = 0; i < count && numPieces > 0; i++)
+    {
+        const Rect& e = rects[i];
+        const Rect* in = pieces[current];
+        Rect* out = pieces[current ^ 1];
+        uint16_t numOut = 0;
+        for (uint16_t p = 0; p < numPieces; p++)
+        {
+            const Rect& piece = in[p];
+            if (!piece.intersect(e))
+            {
+                if (numOut == MAX_PIECES)
+                {
+                    mergeInto(r);
+                    return;
+                }
+                out[numOut++] = piece;
+                continue;
+            }
+            if (e.includes(piece))
+            {
+                continue;
+            }
+            if (numOut + 4 > MAX_PIECES)
+            {
+                // Too fragmented, add the area as a whole
+                mergeInto(r);
+                return;
+            }
+            const int16_t top = MAX(piece.y, e.y);
+            const int16_t bottom = MIN(piece.bottom(), e.bottom());
+            if (e.y > piece.y)
+            {
+                out[numOut++] = Rect(piece.x, piece.y, piece.width, e.y - piece.y);
+            }
+            if (e.bottom() < piece.bottom())
+            {
+                out[numOut++] = Rect(piece.x, e.bottom(), piece.width, piece.bottom() - e.bottom());
+            }
+            if (e.x > piece.x)
+            {
+                out[numOut++] = Rect(piece.x, top, e.x - piece.x, bottom - top);
+            }
+            if (e.right() < piece.right())
+            {
+                out[numOut++] = Rect(e.right(), top, piece.right() - e.right(), bottom - top);
+            }
+        }
+        numPieces = numOut;
+        current ^= 1;
+    }
+
+    const uint16_t mergesBefore = merges;
+    for (uint16_t p = 0; p < numPieces; p++)
+    {
+        const Rect& piece = pieces[current][p];
+        if (merges != mergesBefore && overlaps(piece))
+        {
+            // A merge while inserting the previous pieces grew a rectangle over this one
+            mergeInto(piece);
+            continue;
+        }
+        dirtyPixels += piece.area();
+        insert(piece);
+    }
+}
+
+void DirtyRegion::add(const DirtyRegion& region)
+{
+    if (&region == this)
+    {
+        return;
+    }
+    for (uint16_t i = 0; i < region.count; i++)
+    {
+        add(region.rects[i]);
+    }
+}
+
+void DirtyRegion::optimize()
+{
+    for (;;)
+    {
+        Rect best;
+        int32_t bestGain = 0;
+        for (uint16_t i = 0; i < count; i++)
+        {
+            for (uint16_t j = i + 1; j < count; j++)
+            {
+                Rect box = rects[i];
+                box.expandToFit(rects[j]);
+                const int32_t extra = (int32_t)(box.area() - rects[i].area() - rects[j].area());
+                if (extra >= (int32_t)rectCost)
+                {
+                    continue;
+                }
+                // The bounding box may overlap other rectangles, which are merged as well
+                uint32_t absorbedPixels;
+                uint16_t absorbedRects;
+                box = absorb(box, absorbedPixels, absorbedRects);
+                const int32_t gain = (int32_t)((absorbedRects - 1) * rectCost) - (int32_t)(box.area() - absorbedPixels);
+                if (gain > bestGain)
+                {
+                    bestGain = gain;
+                    best = box;
+                }
+            }
+        }
+        if (bestGain <= 0)
+        {
+            return;
+        }
+        merges++;
+        mergeInto(best);
+    }
+}
+
+void DirtyRegion::clear()
+{
+    count = 0;
+    dirtyPixels = 0;
+    merges = 0;
+}
+
+DirtyRegion::Statistics DirtyRegion::getStatistics() const
+{
+    Statistics statistics;
+    statistics.dirtyPixels = dirtyPixels;
+    statistics.drawnPixels = 0;
+    for (uint16_t i = 0; i < count; i++)
+    {
+        statistics.drawnPixels += rects[i].area();
+    }
+    statistics.rects = count;
+    statistics.merges = merges;
+    return statistics;
+}
+
+uint32_t DirtyRegion::getCost() const
+{
+    uint32_t cost = count * rectCost;
+    for (uint16_t i = 0; i < count; i++)
+    {
+        cost += rects[i].area();
+    }
+    return cost;
+}
+
+void DirtyRegion::insert(Rect area)
+{
+    // Join with rectangles sharing a full edge, the union is then still a rectangle
+    for (uint16_t i = 0; i < count;)
+    {
+        if (shareHorizontalEdge(rects[i], area) || shareVerticalEdge(rects[i], area))
+        {
+            area.expandToFit(rects[i]);
+            removeAt(i);
+            i = 0;
+        }
+        else
+        {
+            i++;
+        }
+    }
+
+    // Merge with a nearby rectangle if that lowers the cost, keeping optimize() cheap
+    Rect best;
+    int32_t bestGain = 0;
+    for (uint16_t i = 0; i < count; i++)
+    {
+        Rect box = area;
+        box.expandToFit(rects[i]);
+        if (box.area() - area.area() - rects[i].area() >= rectCost)
+        {
+            continue;
+        }
+        uint32_t absorbedPixels;
+        uint16_t absorbedRects;
+        box = absorb(box, absorbedPixels, absorbedRects);
+        const int32_t gain = (int32_t)(absorbedRects * rectCost) - (int32_t)(box.area() - area.area() - absorbedPixels);
+        if (gain > bestGain)
+        {
+            bestGain = gain;
+            best = box;
+        }
+    }
+    if (bestGain > 0)
+    {
+        merges++;
+        mergeInto(best);
+        return;
+    }
+
+    append(area);
+    while (count > maxRects)
+    {
+        mergeCheapestPair();
+    }
+}
+
+void DirtyRegion::append(const Rect& area)
+{
+    assert(count <= MAX_RECTS && "DirtyRegion overflow");
+    rects[count++] = area;
+}
+
+void DirtyRegion::removeAt(uint16_t index)
+{
+    rects[index] = rects[--count];
+}
+
+bool DirtyRegion::overlaps(const Rect& area) const
+{
+    for (uint16_t i = 0; i < count; i++)
+    {
+        if (rects[i].intersect(area))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void DirtyRegion::mergeCheapestPair()
+{
+    assert(count >= 2);
+    uint16_t bestI = 0;
+    uint16_t bestJ = 1;
+    uint32_t bestExtra = 0xFFFFFFFF;
+    for (uint16_t i = 0; i < count; i++)
+    {
+        for (uint16_t j = i + 1; j < count; j++)
+        {
+            Rect box = rects[i];
+            box.expandToFit(rects[j]);
+            const uint32_t extra = box.area() - rects[i].area() - rects[j].area();
+            if (extra < bestExtra)
+            {
+                bestExtra = extra;
+                bestI = i;
+                bestJ = j;
+            }
+        }
+    }
+    Rect box = rects[bestI];
+    box.expandToFit(rects[bestJ]);
+    merges++;
+    mergeInto(box);
+}
+
+Rect DirtyRegion::absorb(Rect area, uint32_t& absorbedPixels, uint16_t& absorbedRects) const
+{
+    bool absorbed[MAX_RECTS + 1] = { false };
+    absorbedPixels = 0;
+    absorbedRects = 0;
+    for (uint16_t i = 0; i < count;)
+    {
+        if (!absorbed[i] && rects[i].intersect(area))
+        {
+            absorbed[i] = true;
+            absorbedPixels += rects[i].area();
+            absorbedRects++;
+            if (!area.includes(rects[i]))
+            {
+                // The area grew, rectangles skipped so far may now overlap
+                area.expandToFit(rects[i]);
+                i = 0;
+                continue;
+            }
+        }
+        i++;
+    }
+    return area;
+}
+
+void DirtyRegion::mergeInto(Rect area)
+{
+    // Remove everything overlapping the area, growing it to keep the region disjoint
+    for (uint16_t i = 0; i < count;)
+    {
+        if (rects[i].intersect(area))
+        {
+            area.expandToFit(rects[i]);
+            removeAt(i);
+            i = 0;
+        }
+        else
+        {
+            i++;
+        }
+    }
+    insert(area);
+}
+
+Rect DirtyRegion::snap(const Rect& area) const
+{
+    if (tileWidth == 1 && tileHeight == 1)
+    {
+        return area;
+    }
+    const int32_t x = floorToTile(area.x, tileWidth);
+    const int32_t y = floorToTile(area.y, tileHeight);
+    const int32_t right = floorToTile(area.right() + tileWidth - 1, tileWidth);
+    const int32_t bottom = floorToTile(area.bottom() + tileHeight - 1, tileHeight);
+    return Rect(x, y, right - x, bottom - y);
+}
@@ -1,7 +1,279 @@
 #include <gui/common/FrontendApplication.hpp>
+#include <gui/common/RenderProfiler.hpp>
+#include <touchgfx/Screen.hpp>
+#include <touchgfx/Utils.hpp>
+#include <touchgfx/canvas_widget_renderer/CanvasWidgetRenderer.hpp>
+#include <touchgfx/hal/HAL.hpp>
+#include <touchgfx/lcd/DebugPrinter.hpp>
+#include <touchgfx/transforms/DisplayTransformation.hpp>
+#ifdef SIMULATOR
+#include <platform/hal/simulator/sdl2/TileRenderer.hpp>
+#endif
+
+namespace
+{
+/** Reaches the protected Drawable::setupDrawChain(), which the profiler calls like Screen does. */
+class DrawChain : public Drawable
+{
+public:
+    static void setup(Drawable& drawable, const Rect& invalidatedArea, Drawable** nextPreviousElement)
+    {
+        void (Drawable::*setupDrawChain)(const Rect&, Drawable**) = &DrawChain::setupDrawChain;
+        (drawable.*setupDrawChain)(invalidatedArea, nextPreviousElement);
+    }
+
+    static Drawable* next(const Drawable& drawable)
+    {
+        Drawable* const Drawable::*nextElement = &DrawChain::nextDrawChainElement;
+        return drawable.*nextElement;
+    }
+};
+
+/**
+ * Stands in for a drawable in the draw chain, timing its draw() calls. JSMOC reads the
+ * cached visible rectangle and absolute position of the elements, which are copied from
+ * the drawable.
+ */
+class DrawProbe : public Drawable
+{
+public:
+    DrawProbe()
+        : target(0)
+    {
+    }
+
+    void wrap(Drawable& drawable, Drawable* next)
+    {
+        Rect& (Drawable::*visibleRect)() = &DrawProbe::getCachedVisibleRect;
+        int16_t (Drawable::*absX)() = &DrawProbe::getCachedAbsX;
+        int16_t (Drawable::*absY)() = &DrawProbe::getCachedAbsY;
+        target = &drawable;
+        cachedVisibleRect = (drawable.*visibleRect)();
+        cachedAbsX = (drawable.*absX)();
+        cachedAbsY = (drawable.*absY)();
+        nextDrawChainElement = next;
+    }
+
+    virtual void draw(const Rect& invalidatedArea) const
+    {
+        RenderProfiler::Scope scope(RenderProfiler::DRAWABLE, *target);
+        target->draw(invalidatedArea);
+    }
+
+    virtual Rect getSolidRect() const
+    {
+        return target->getSolidRect();
+    }
+
+    virtual void getLastChild(int16_t /*x*/, int16_t /*y*/, Drawable** /*last*/)
+    {
+    }
+
+private:
+    Drawable* target;
+};
+
+const uint16_t MAX_PROBES = 64;
+DrawProbe probes[MAX_PROBES];
+
+/** Replaces the first MAX_PROBES elements of the draw chain with probes. */
+Drawable* insertProbes(Drawable* head)
+{
+    Drawable* elements[MAX_PROBES];
+    uint16_t count = 0;
+    Drawable* next = head;
+    while (next && count < MAX_PROBES)
+    {
+        elements[count++] = next;
+        next = DrawChain::next(*next);
+    }
+    // Wrap from the back, so each probe links to the probe of the next element
+    for (uint16_t i = count; i > 0; i--)
+    {
+        probes[i - 1].wrap(*elements[i - 1], next);
+        next = &probes[i - 1];
+    }
+    return next;
+}
+} // namespace
 
 FrontendApplication::FrontendApplication(Model& m, FrontendHeap& heap)
-    : FrontendApplicationBase(m, heap)
+    : FrontendApplicationBase(m, heap),
+      drawAreaCallback(this, &FrontendApplication::drawArea),
+      drawTileCallback(this, &FrontendApplication::drawTile)
+{
+    // The other regions are copies of dirtyRegion, and share its configuration
+    dirtyRegion.setBounds(Rect(0, 0, HAL::DISPLAY_WIDTH, HAL::DISPLAY_HEIGHT));
+    frameStatistics.dirtyPixels = 0;
+    frameStatistics.drawnPixels = 0;
+    frameStatistics.rects = 0;
+    frameStatistics.merges = 0;
+}
+
+void FrontendApplication::draw(Rect& rect)
 {
+    if (drawCacheEnabled && HAL::getInstance()->getFrameRefreshStrategy() == HAL::REFRESH_STRATEGY_DEFAULT)
+    {
+        dirtyRegion.add(rect);
+        return;
+    }
+    if (RenderProfiler::isEnabled() && !drawCacheEnabled && currentScreen)
+    {
+        drawProfiled(rect);
+        return;
+    }
+    FrontendApplicationBase::draw(rect);
+}
+
+void FrontendApplication::cacheDrawOperations(bool enableCache)
+{
+    if (enableCache || HAL::getInstance()->getFrameRefreshStrategy() != HAL::REFRESH_STRATEGY_DEFAULT)
+    {
+        // The other strategies split the dirty areas to follow the display, leave them to Application
+        FrontendApplicationBase::cacheDrawOperations(enableCache);
+        return;
+    }
+
+    drawCacheEnabled = false;
+    if (!redraw.isEmpty())
+    {
+        dirtyRegion.add(redraw);
+        redraw = Rect();
+    }
+    if (debugPrinter && !debugRegionInvalidRect.isEmpty())
+    {
+        Rect debugRect = debugRegionInvalidRect;
+        DisplayTransformation::transformFrameBufferToDisplay(debugRect);
+        dirtyRegion.add(debugRect);
+        debugRegionInvalidRect = Rect();
+    }
+    if (dirtyRegion.isEmpty())
+    {
+        return;
+    }
+
+    // The framebuffer drawn into last held the frame before the previous one
+    frameRegion = dirtyRegion;
+    if (HAL::USE_DOUBLE_BUFFERING)
+    {
+        frameRegion.add(lastRegion);
+        lastRegion = dirtyRegion;
+    }
+    frameRegion.optimize();
+    frameStatistics = frameRegion.getStatistics();
+    dirtyRegion.clear();
+
+#ifdef SIMULATOR
+    if (TileRenderer::isEnabled() && !RenderProfiler::isEnabled())
+    {
+        Rect rects[DirtyRegion::MAX_RECTS];
+        for (uint16_t i = 0; i < frameRegion.size(); i++)
+        {
+            rects[i] = frameRegion[i];
+        }
+        if (TileRenderer::render(rects, frameRegion.size(), drawTileCallback, drawAreaCallback))
+        {
+            // The tiles are drawn on several threads, the areas are flushed when all are done
+            for (uint16_t i = 0; i < frameRegion.size(); i++)
+            {
+                HAL::getInstance()->flushFrameBuffer(rects[i]);
+            }
+        }
+        return;
+    }
+#endif
+
+    const bool profiling = RenderProfiler::isEnabled();
+    if (profiling)
+    {
+        RenderProfiler::setScreen(*currentScreen);
+        RenderProfiler::beginFrame();
+    }
+    for (uint16_t i = 0; i < frameRegion.size(); i++)
+    {
+        Rect rect = frameRegion[i];
+        draw(rect);
+    }
+    if (profiling)
+    {
+        RenderProfiler::endFrame();
+    }
+}
+
+void FrontendApplication::handlePendingScreenTransition()
+{
+    if (pendingScreenTransitionCallback && pendingScreenTransitionCallback->isValid())
+    {
+#ifdef SIMULATOR
+        const CanvasWidgetRenderer::MemoryReport& report = CanvasWidgetRenderer::getMemoryReport();
+        if (CanvasWidgetRenderer::getWriteMemoryUsageReport() && report.outlines > 0)
+        {
+            touchgfx_printf("CWR on this screen requires %u bytes, %u bytes to draw without splitting (%u retries, %u skipped lines)\n",
+                            report.minimumBufferSize, report.unsplitBufferSize, report.retries, report.skippedLines);
+        }
+#endif
+        CanvasWidgetRenderer::resetMemoryReport();
+    }
+    FrontendApplicationBase::handlePendingScreenTransition();
+}
+
+void FrontendApplication::drawArea(const Rect& area)
+{
+    Rect rect = area;
+    FrontendApplicationBase::draw(rect);
+}
 
+void FrontendApplication::drawTile(const Rect& tile)
+{
+    // Same steps as Application::draw(), drawing the root container back to front instead
+    // of through the draw chain of Screen, which is kept in the drawables of the screen
+    Container& root = currentScreen->getRootContainer();
+    Rect rect = tile;
+    rect.x -= root.getX();
+    rect.y -= root.getY();
+    TileRenderer::drawContainer(root, rect);
+    if (debugPrinter)
+    {
+        debugPrinter->draw(tile);
+    }
+}
+
+void FrontendApplication::drawProfiled(Rect& rect)
+{
+    // Same steps as Application::draw() and Screen::draw(), with probes timing the drawables
+    // of the draw chain JSMOC draws from
+    rect &= Rect(0, 0, HAL::DISPLAY_WIDTH, HAL::DISPLAY_HEIGHT);
+    {
+        RenderProfiler::Scope area(RenderProfiler::AREA);
+        Container& root = currentScreen->getRootContainer();
+        const Rect screenRect = rect & root.getRect();
+        if (currentScreen->usingSMOC())
+        {
+            Drawable* head = 0;
+            {
+                RenderProfiler::Scope chain(RenderProfiler::DRAW_CHAIN, root);
+                Rect relative = screenRect;
+                relative.x -= root.getX();
+                relative.y -= root.getY();
+                DrawChain::setup(root, relative, &head);
+                head = insertProbes(head);
+            }
+            if (head)
+            {
+                currentScreen->JSMOC(screenRect, head);
+            }
+        }
+        else
+        {
+            // The painter's algorithm has no draw chain to time, the screen is timed as a whole
+            RenderProfiler::Scope scope(RenderProfiler::DRAWABLE, root);
+            Rect area = screenRect;
+            currentScreen->draw(area);
+        }
+        if (debugPrinter)
+        {
+            debugPrinter->draw(rect);
+        }
+    }
+    HAL::getInstance()->flushFrameBuffer(rect);
 }
@@ -0,0 +1,59 @@
+#include <gui/common/IndexedCachedFont.hpp>
+#include <gui/common/KerningLookup.hpp>
+
+using namespace touchgfx;
+
+const uint8_t* IndexedCachedFont::getPixelData(const GlyphNode* glyph) const
+{
+    // If glyph is cached, then data is present just after the GlyphNode
+    if (IndexedFontCache::isCached(glyph))
+    {
+        return IndexedFontCache::getPixelData(glyph);
+    }
+    return flashFont->getPixelData(glyph);
+}
+
+const GlyphNode* IndexedCachedFont::getGlyph(Unicode::UnicodeChar unicode, const uint8_t*& pixelData, uint8_t& bitsPerPixel) const
+{
+    // Look first in internal flash font
+    const GlyphNode* n = flashFont->find(unicode);
+
+    if ((n == 0) && (cache != 0))
+    {
+        // Now look in the cache
+        n = cache->getGlyph(unicode, fontId);
+    }
+
+    // Revert to normal behaviour if still not found
+    if (n == 0 && unicode != 0 && unicode != '\n')
+    {
+        Unicode::UnicodeChar fallbackChar = flashFont->getFallbackChar();
+        n = flashFont->find(fallbackChar);
+        if (n == 0 && cache != 0)
+        {
+            n = cache->getGlyph(fallbackChar, fontId);
+        }
+    }
+
+    if (n != 0)
+    {
+        pixelData = getPixelData(n);
+        bitsPerPixel = getBitsPerPixel();
+        return n;
+    }
+    return (const GlyphNode*)0;
+}
+
+int8_t IndexedCachedFont::getKerning(Unicode::UnicodeChar prevChar, const GlyphNode* glyph) const
+{
+    // Glyphs in the cache refer to the kerning table of the binary font, loaded by IndexedFontCache
+    if (glyph && IndexedFontCache::isCached(glyph))
+    {
+        if (glyph->kerningTableSize == 0 || !kerningData)
+        {
+            return 0;
+        }
+        return KerningLookup::find(prevChar, kerningData + glyph->kerningTablePos(), glyph->kerningTableSize);
+    }
+    return flashFont->getKerning(prevChar, glyph);
+}
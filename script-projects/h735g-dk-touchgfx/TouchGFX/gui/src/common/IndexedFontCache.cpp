@@ -0,0 +1,586 @@
+#include <gui/common/IndexedCachedFont.hpp>
+#include <gui/common/IndexedFontCache.hpp>
+#include <touchgfx/TextProvider.hpp>
+#include <touchgfx/Utils.hpp>
+#include <texts/TypedTextDatabase.hpp>
+#include <cassert>
+#include <cstring>
+
+using namespace touchgfx;
+
+namespace
+{
+// One bucket in the glyph index per this many bytes of cache memory
+const uint32_t BYTES_PER_BUCKET = 128;
+const uint32_t MAX_BUCKETS = 8192;
+// The link word after a GlyphNode holds the font and the offset of the next GlyphNode
+const uint32_t LINK_FONT_SHIFT = 24;
+const uint32_t LINK_OFFSET_MASK = (1u << LINK_FONT_SHIFT) - 1;
+// Glyph data this close together in the font is read in one go, including the bytes between
+const uint32_t MAX_READ_GAP = 256;
+
+uint32_t glyphDataSize(const GlyphNode* glyph, uint32_t bpp)
+{
+    return ((glyph->width() + 1) & ~1) * glyph->height() * bpp / 8;
+}
+
+// A cached glyph is the GlyphNode, the link and the glyph data
+uint32_t cachedGlyphSize(const GlyphNode* glyph, uint32_t bpp)
+{
+    return 16 + 4 + ((glyphDataSize(glyph, bpp) + 3) & ~0x03);
+}
+
+// Glyph data of consecutive cached glyphs, read from the font with a single read
+struct DataRun
+{
+    uint8_t* first;  // First cached glyph
+    uint8_t* end;    // After the last cached glyph
+    uint32_t offset; // Offset of the data from the start of the glyph data in the font
+    uint32_t size;   // Number of bytes to read
+    uint8_t* target; // Where the data is read to
+};
+
+void siftDown(Unicode::UnicodeChar* uc, int root, int n)
+{
+    const Unicode::UnicodeChar value = uc[root];
+    int child;
+    while ((child = 2 * root + 1) < n)
+    {
+        if (child + 1 < n && uc[child + 1] > uc[child])
+        {
+            child++;
+        }
+        if (uc[child] <= value)
+        {
+            break;
+        }
+        uc[root] = uc[child];
+        root = child;
+    }
+    uc[root] = value;
+}
+} // namespace
+
+IndexedFontCache::IndexedFontCache()
+    : glyphIndex(0), glyphIndexMask(0), memorySize(0), memory(0), top(0), gsubStart(0), reader(0), asyncReader(0), sortedString(0), glyphNodesBuffered(0), nextBufferedGlyphNode(0)
+{
+}
+
+void IndexedFontCache::clear(bool keepGsubOrContextTable /* = false */)
+{
+    // The glyph index is placed first, at a 32bit address
+    uint8_t* const start = (uint8_t*)(((uintptr_t)memory + 3) & ~(uintptr_t)0x3);
+    const uint32_t available = memory + memorySize > start ? (uint32_t)(memory + memorySize - start) : 0;
+    uint32_t buckets = 1;
+    while (buckets < MAX_BUCKETS && buckets * 2 * BYTES_PER_BUCKET <= available)
+    {
+        buckets *= 2;
+    }
+
+    if (available < buckets * sizeof(uint32_t))
+    {
+        // No room for a glyph index, nothing can be cached
+        glyphIndex = 0;
+        glyphIndexMask = 0;
+        top = memory;
+    }
+    else
+    {
+        glyphIndex = (uint32_t*)start;
+        glyphIndexMask = buckets - 1;
+        memset(glyphIndex, 0, buckets * sizeof(uint32_t));
+
+        // Top is after the glyph index, no glyphs are cached yet
+        top = start + buckets * sizeof(uint32_t);
+    }
+
+    if (!keepGsubOrContextTable)
+    {
+        // gsubStart points to end of memory (nothing loaded yet)
+        gsubStart = memory + memorySize;
+
+        // Round down to 32bit address
+        gsubStart = (uint8_t*)((uintptr_t)gsubStart & ~(uintptr_t)0x3);
+    }
+}
+
+void IndexedFontCache::setMemory(uint8_t* _memory, uint32_t size)
+{
+    // GlyphNodes are linked by 24 bit word offsets
+    assert(size <= (LINK_OFFSET_MASK + 1) * sizeof(uint32_t) && "IndexedFontCache memory too large for the glyph index");
+    memory = _memory;
+    memorySize = size;
+
+    clear();
+}
+
+void IndexedFontCache::setReader(FontDataReader* _reader)
+{
+    reader = _reader;
+    asyncReader = 0;
+}
+
+void IndexedFontCache::setReader(AsyncFontDataReader* _reader)
+{
+    reader = _reader;
+    asyncReader = _reader;
+}
+
+const GlyphNode* IndexedFontCache::getGlyph(Unicode::UnicodeChar unicode, FontId font) const
+{
+    if (!glyphIndex)
+    {
+        return 0;
+    }
+    uint32_t offset = glyphIndex[bucketOf(unicode, font)];
+    while (offset)
+    {
+        const GlyphNode* g = (const GlyphNode*)(glyphIndex + offset);
+        const uint32_t link = *(const uint32_t*)((const uint8_t*)g + SIZE_GLYPH_NODE);
+        if (g->unicode == unicode && (link >> LINK_FONT_SHIFT) == font)
+        {
+            return g;
+        }
+        offset = link & LINK_OFFSET_MASK;
+    }
+    return 0;
+}
+
+void IndexedFontCache::open()
+{
+    if (reader)
+    {
+        reader->open();
+    }
+}
+
+void IndexedFontCache::close()
+{
+    if (reader)
+    {
+        reader->close();
+    }
+}
+
+void IndexedFontCache::initializeCachedFont(TypedText t, IndexedCachedFont* font, bool loadGsubOrContextTable /*= false*/, bool loadKerningTable /*= false*/)
+{
+    // Get font index from typed text
+    FontId fontId = t.getFontId();
+    // Reset to start of file
+    open();
+    setPosition(0);
+
+    assert(sizeof(touchgfx::BinaryFontData) < MAX_BUFFER_SIZE);
+    readData(buffer, sizeof(touchgfx::BinaryFontData));
+    const struct touchgfx::BinaryFontData* binaryFontData = reinterpret_cast<const struct touchgfx::BinaryFontData*>(buffer);
+
+    const Font** flashFonts = TypedTextDatabase::getFonts();
+    const GeneratedFont* flashFont = static_cast<const GeneratedFont*>(flashFonts[fontId]);
+    *font = IndexedCachedFont(reinterpret_cast<const struct touchgfx::BinaryFontData*>(buffer), fontId, this, flashFont);
+
+    if (loadGsubOrContextTable && (binaryFontData->offsetToGSUB != 0))
+    {
+        setPosition(binaryFontData->offsetToGSUB);
+
+        const uint32_t sizeOfGSUB = (binaryFontData->offsetToArabicTable != 0 ? binaryFontData->offsetToArabicTable : binaryFontData->sizeOfFontData) - binaryFontData->offsetToGSUB;
+
+        if (top + sizeOfGSUB < gsubStart) // Room for this GSUB table
+        {
+            uint8_t* const gsubPosition = gsubStart - sizeOfGSUB;
+            readData(gsubPosition, sizeOfGSUB);
+            font->setGSUBTable(reinterpret_cast<uint16_t*>(gsubPosition));
+            gsubStart -= sizeOfGSUB;
+
+            // Round down to 32bit address
+            gsubStart = (uint8_t*)((uintptr_t)gsubStart & ~(uintptr_t)0x3);
+        }
+        else
+        {
+            font->setGSUBTable(0);
+        }
+    }
+
+    if (loadGsubOrContextTable && (binaryFontData->offsetToArabicTable != 0))
+    {
+        setPosition(binaryFontData->offsetToArabicTable);
+
+        const uint32_t sizeTableData = binaryFontData->sizeOfFontData - binaryFontData->offsetToArabicTable;
+
+        if (top + sizeTableData + sizeof(FontContextualFormsTable) < gsubStart) // Room for the ContextualFormsTables
+        {
+            // Allocate FontContextualFormsTable first
+            gsubStart -= sizeof(FontContextualFormsTable);
+            // Round down to 32bit address
+            gsubStart = (uint8_t*)((uintptr_t)gsubStart & ~(uintptr_t)0x3);
+
+            FontContextualFormsTable* table = (FontContextualFormsTable*)gsubStart;
+            font->setContextualFormsTable(table);
+            gsubStart -= sizeTableData;
+            readData(gsubStart, sizeTableData);
+
+            // Set pointers in table
+            const uint16_t* const base = (const uint16_t*)gsubStart;
+            // First elements in binary font are offsets to arrays in 16bit words
+            table->contextualForms4Long = (FontContextualFormsTable::arrayOf5UnicodesPtr)(base + base[0]);
+            table->contextualForms3Long = (FontContextualFormsTable::arrayOf5UnicodesPtr)(base + base[1]);
+            table->contextualForms2Long = (FontContextualFormsTable::arrayOf5UnicodesPtr)(base + base[2]);
+            table->contextualForms0621_063a = (FontContextualFormsTable::arrayOf4UnicodesPtr)(base + base[3]);
+            table->contextualForms0641_064a = (FontContextualFormsTable::arrayOf4UnicodesPtr)(base + base[4]);
+            table->contextualForms06XX = (FontContextualFormsTable::arrayOf5UnicodesPtr)(base + base[5]);
+            table->contextualForms4LongSize = base[6];
+            table->contextualForms3LongSize = base[7];
+            table->contextualForms2LongSize = base[8];
+            table->contextualForms06XXSize = base[9];
+        }
+        else
+        {
+            font->setContextualFormsTable(0);
+        }
+    }
+
+    // The kerning table is between the glyph table and the glyph data
+    if (loadKerningTable && binaryFontData->offsetToKerning != 0 && binaryFontData->offsetToGlyphs > binaryFontData->offsetToKerning)
+    {
+        setPosition(binaryFontData->offsetToKerning);
+
+        const uint32_t sizeOfKerning = binaryFontData->offsetToGlyphs - binaryFontData->offsetToKerning;
+
+        if (top + sizeOfKerning + 3 < gsubStart) // Room for the kerning table, at a 32bit address
+        {
+            uint8_t* const kerningPosition = (uint8_t*)((uintptr_t)(gsubStart - sizeOfKerning) & ~(uintptr_t)0x3);
+            readData(kerningPosition, sizeOfKerning);
+            font->setKerningTable(reinterpret_cast<const KerningNode*>(kerningPosition));
+            gsubStart = kerningPosition;
+        }
+        else
+        {
+            font->setKerningTable(0);
+        }
+    }
+
+    close();
+}
+
+bool IndexedFontCache::cacheString(TypedText t, const Unicode::UnicodeChar* string)
+{
+    open();
+    if (!createSortedString(string))
+    {
+        close();
+        return false;
+    }
+    const bool result = cacheSortedString(t);
+    close();
+    return result;
+}
+
+bool IndexedFontCache::cacheLigatures(IndexedCachedFont* font, TypedText t, const Unicode::UnicodeChar* string)
+{
+    open();
+    if (!createSortedLigatures(font, t, string, 0, 0))
+    {
+        close();
+        return false;
+    }
+    const bool result = cacheSortedString(t);
+    close();
+    return result;
+}
+
+bool IndexedFontCache::cacheSortedString(TypedText t)
+{
+    setPosition(8); // Skip font index and size
+    uint32_t glyphNodeOffset;
+    readData(buffer, 5 * sizeof(uint32_t) + sizeof(uint16_t));
+    memcpy(&glyphNodeOffset, buffer, sizeof(uint32_t));      // offsetToTable
+    memcpy(&glyphDataOffset, buffer + 8, sizeof(uint32_t));  // offsetToGlyphs, after offsetToKerning
+    memcpy(&numGlyphs, buffer + 20, sizeof(uint16_t));       // numberOfGlyphs, after offsetToGlyphs and offsetToArabicTable
+
+    FontId fontId = t.getFontId();                 // Get font index from typed text
+    uint32_t bpp = t.getFont()->getBitsPerPixel(); // Get BPP from standard font
+
+    setPosition(glyphNodeOffset); // Go to glyph nodes for font
+    currentFileGlyphNumber = 0;
+    currentFileGlyphNode.unicode = 0; // Force reading of first glyph
+    glyphNodesBuffered = 0;
+    nextBufferedGlyphNode = 0;
+
+    const Unicode::UnicodeChar* string = sortedString;
+    Unicode::UnicodeChar last = 0;
+    uint8_t* const firstNewGlyph = top; // New glyphs are stored from here
+    bool outOfMemory = false;
+    while (*string)
+    {
+        Unicode::UnicodeChar ch = *string;
+        if (ch != last)
+        {
+            if (!contains(ch, fontId))
+            {
+                insert(ch, fontId, bpp, outOfMemory);
+                if (outOfMemory)
+                {
+                    break;
+                }
+            }
+        }
+        last = ch;
+        string++;
+    }
+
+    cacheData(bpp, firstNewGlyph);
+    return !outOfMemory;
+}
+
+bool IndexedFontCache::contains(Unicode::UnicodeChar unicode, FontId font) const
+{
+    return getGlyph(unicode, font) != 0;
+}
+
+void IndexedFontCache::insert(Unicode::UnicodeChar unicode, FontId font, uint32_t bpp, bool& outOfMemory)
+{
+    if (!glyphIndex)
+    {
+        outOfMemory = true;
+        return;
+    }
+    assert(font <= (0xFFFFFFFF >> LINK_FONT_SHIFT) && "IndexedFontCache supports 256 fonts");
+
+    // Insert new glyphnode and glyph at top
+    uint8_t* oldTop = top;
+    top = copyGlyph(top, unicode, bpp, outOfMemory);
+
+    if (top == oldTop)
+    {
+        return;
+    }
+
+    // Link the new glyph first in its bucket
+    uint32_t& bucket = glyphIndex[bucketOf(unicode, font)];
+    uint32_t* link = (uint32_t*)(oldTop + SIZE_GLYPH_NODE);
+    *link = ((uint32_t)font << LINK_FONT_SHIFT) | bucket;
+    bucket = (uint32_t)((uint32_t*)oldTop - glyphIndex);
+}
+
+uint8_t* IndexedFontCache::copyGlyph(uint8_t* top, Unicode::UnicodeChar unicode, uint32_t bpp, bool& outOfMemory)
+{
+    while (currentFileGlyphNumber < numGlyphs && currentFileGlyphNode.unicode < unicode)
+    {
+        readGlyphNode();
+    }
+    if (currentFileGlyphNode.unicode != unicode)
+    {
+        // GlyphNode not found
+        return top;
+    }
+
+    // GlyphNode found
+    uint32_t requiredMem = cachedGlyphSize(&currentFileGlyphNode, bpp); // GlyphNode + link + glyph
+
+    // Is space available before sortedString
+    if (top + requiredMem > (uint8_t*)sortedString)
+    {
+        outOfMemory = true;
+        return top;
+    }
+
+    *(GlyphNode*)top = currentFileGlyphNode;
+    top += requiredMem;
+    return top;
+}
+
+void IndexedFontCache::readGlyphNode()
+{
+    // The GlyphNodes are read in order, a block at a time
+    if (nextBufferedGlyphNode == glyphNodesBuffered)
+    {
+        glyphNodesBuffered = MIN(GLYPH_NODE_BUFFER_SIZE, numGlyphs - currentFileGlyphNumber);
+        nextBufferedGlyphNode = 0;
+        readData(glyphNodeBuffer, glyphNodesBuffered * sizeof(GlyphNode));
+    }
+    currentFileGlyphNode = glyphNodeBuffer[nextBufferedGlyphNode++];
+    currentFileGlyphNumber++;
+}
+
+void IndexedFontCache::cacheData(uint32_t bpp, uint8_t* first)
+{
+    // The new glyphs are stored one after the other from first to top, in the order of
+    // their data in the font. The data of glyphs close together in the font is read in one
+    // go into a block of the free memory, which is split in two, so the glyphs read into one
+    // block are copied while the reader fills the other.
+    uint8_t* const freeMemory = (uint8_t*)(((uintptr_t)top + 3) & ~(uintptr_t)0x3);
+    const uint32_t blockSize = gsubStart > freeMemory ? (uint32_t)(gsubStart - freeMemory) / 2 : 0;
+    uint8_t* const blocks[2] = { freeMemory, freeMemory + blockSize };
+    int block = 0;
+
+    DataRun run;
+    bool pending = false; // run is being read
+    uint8_t* p = first;
+    while (pending || p < top)
+    {
+        if (pending && run.size > 0)
+        {
+            waitForData();
+        }
+
+        // Start reading the next glyphs
+        DataRun next;
+        const bool hasNext = p < top;
+        if (hasNext)
+        {
+            const GlyphNode* gn = (const GlyphNode*)p;
+            next.first = p;
+            next.offset = gn->dataOffset;
+            uint32_t end = next.offset + glyphDataSize(gn, bpp);
+            next.end = p + cachedGlyphSize(gn, bpp);
+            while (next.end < top)
+            {
+                gn = (const GlyphNode*)next.end;
+                const uint32_t glyphSize = glyphDataSize(gn, bpp);
+                if (gn->dataOffset < end || gn->dataOffset - end > MAX_READ_GAP || gn->dataOffset + glyphSize - next.offset > blockSize)
+                {
+                    break;
+                }
+                end = gn->dataOffset + glyphSize;
+                next.end += cachedGlyphSize(gn, bpp);
+            }
+            next.size = end - next.offset;
+            p = next.end;
+
+            // A single glyph is read where it is cached
+            if (next.end == next.first + cachedGlyphSize((const GlyphNode*)next.first, bpp))
+            {
+                next.target = next.first + SIZE_GLYPH_NODE + 4;
+            }
+            else
+            {
+                next.target = blocks[block];
+                block ^= 1;
+            }
+            if (next.size > 0)
+            {
+                setPosition(glyphDataOffset + next.offset);
+                startReadData(next.target, next.size);
+            }
+        }
+
+        // Copy the glyphs read before
+        if (pending)
+        {
+            for (uint8_t* q = run.first; q < run.end; q += cachedGlyphSize((const GlyphNode*)q, bpp))
+            {
+                GlyphNode* gn = (GlyphNode*)q;
+                uint8_t* const data = q + SIZE_GLYPH_NODE + 4;
+                if (run.target != data)
+                {
+                    memcpy(data, run.target + (gn->dataOffset - run.offset), glyphDataSize(gn, bpp));
+                }
+                // Mark glyphNode as cached
+                gn->dataOffset = 0xFFFFFFFF;
+            }
+        }
+        run = next;
+        pending = hasNext;
+    }
+}
+
+bool IndexedFontCache::createSortedString(const Unicode::UnicodeChar* string)
+{
+    int length = Unicode::strlen(string);
+    // Sorted string is allocated at end of buffer
+    sortedString = (Unicode::UnicodeChar*)(gsubStart - (length + 1) * 2);
+    if ((uint8_t*)sortedString < top)
+    {
+        // Unable to allocate string buffer in end of memory
+        return false;
+    }
+    int n = 0;
+    Unicode::UnicodeChar* uc = sortedString;
+    while (*string)
+    {
+        *uc++ = *string++;
+        n++;
+    }
+    *uc = 0;
+    return sortSortedString(n);
+}
+
+bool IndexedFontCache::createSortedLigatures(IndexedCachedFont* font, TypedText t, const Unicode::UnicodeChar* string, ...)
+{
+    va_list pArg;
+    va_start(pArg, string);
+    TextProvider tp;
+    tp.initialize(string, pArg, font->getGSUBTable(), font->getContextualFormsTable());
+    va_end(pArg);
+    Unicode::UnicodeChar ligature;
+    sortedString = (Unicode::UnicodeChar*)(gsubStart);
+    if ((uint8_t*)(sortedString - 1) < top)
+    {
+        return false;
+    }
+    *--sortedString = 0;
+    int n = 0;
+    while ((ligature = tp.getNextLigature(t.getTextDirection())) != 0)
+    {
+        if ((uint8_t*)(sortedString - 1) < top)
+        {
+            return false;
+        }
+        *--sortedString = ligature;
+        n++;
+    }
+    return sortSortedString(n);
+}
+
+bool IndexedFontCache::sortSortedString(int n)
+{
+    // Heapsort, in place and O(n log n) for the long strings of a whole language
+    Unicode::UnicodeChar* uc = sortedString;
+    for (int i = n / 2 - 1; i >= 0; i--)
+    {
+        siftDown(uc, i, n);
+    }
+    for (int end = n - 1; end > 0; end--)
+    {
+        Unicode::UnicodeChar temp = uc[0];
+        uc[0] = uc[end];
+        uc[end] = temp;
+        siftDown(uc, 0, end);
+    }
+    return true;
+}
+
+void IndexedFontCache::setPosition(uint32_t position)
+{
+    if (reader)
+    {
+        reader->setPosition(position);
+    }
+}
+
+void IndexedFontCache::readData(void* out, uint32_t numberOfBytes)
+{
+    if (reader)
+    {
+        reader->readData(out, numberOfBytes);
+    }
+}
+
+void IndexedFontCache::startReadData(void* out, uint32_t numberOfBytes)
+{
+    if (asyncReader)
+    {
+        asyncReader->startReadData(out, numberOfBytes);
+    }
+    else
+    {
+        readData(out, numberOfBytes);
+    }
+}
+
+void IndexedFontCache::waitForData()
+{
+    if (asyncReader)
+    {
+        asyncReader->waitForData();
+    }
+}
@@ -0,0 +1,29 @@
+#include <gui/common/KernedGeneratedFont.hpp>
+
+uint32_t KernedGeneratedFont::getKerningLookupMemorySize() const
+{
+    return KerningLookup::getMemorySize(countKerningPairs());
+}
+
+bool KernedGeneratedFont::setupKerningLookup(uint8_t* memory, uint32_t size)
+{
+    if (!kerningData || !kerningLookup.setup(memory, size, countKerningPairs()))
+    {
+        return false;
+    }
+    for (uint16_t i = 0; i < listSize; i++)
+    {
+        kerningLookup.add(glyphList[i].unicode, kerningData + glyphList[i].kerningTablePos(), glyphList[i].kerningTableSize);
+    }
+    return true;
+}
+
+uint32_t KernedGeneratedFont::countKerningPairs() const
+{
+    uint32_t numberOfPairs = 0;
+    for (uint16_t i = 0; glyphList && i < listSize; i++)
+    {
+        numberOfPairs += glyphList[i].kerningTableSize;
+    }
+    return numberOfPairs;
+}
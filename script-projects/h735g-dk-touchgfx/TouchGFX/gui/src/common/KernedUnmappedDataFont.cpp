@@ -0,0 +1,43 @@
+#include <gui/common/KernedUnmappedDataFont.hpp>
+#include <fonts/ApplicationFontProvider.hpp>
+
+using namespace touchgfx;
+
+uint32_t KernedUnmappedDataFont::getKerningLookupMemorySize() const
+{
+    FlashDataReader* const flashReader = ApplicationFontProvider::getFlashReader();
+    if (!flashReader)
+    {
+        return 0;
+    }
+    return KerningLookup::getMemorySize(countKerningPairs(flashReader));
+}
+
+bool KernedUnmappedDataFont::setupKerningLookup(uint8_t* memory, uint32_t size)
+{
+    // The glyph table is in unmapped flash and can only be read through the reader
+    FlashDataReader* const flashReader = ApplicationFontProvider::getFlashReader();
+    if (!flashReader || !kerningData || !kerningLookup.setup(memory, size, countKerningPairs(flashReader)))
+    {
+        return false;
+    }
+    GlyphNode glyph;
+    for (uint16_t i = 0; i < listSize; i++)
+    {
+        flashReader->copyData(glyphList + i, &glyph, sizeof(GlyphNode));
+        kerningLookup.add(glyph.unicode, kerningData + glyph.kerningTablePos(), glyph.kerningTableSize);
+    }
+    return true;
+}
+
+uint32_t KernedUnmappedDataFont::countKerningPairs(FlashDataReader* flashReader) const
+{
+    uint32_t numberOfPairs = 0;
+    GlyphNode glyph;
+    for (uint16_t i = 0; glyphList && i < listSize; i++)
+    {
+        flashReader->copyData(glyphList + i, &glyph, sizeof(GlyphNode));
+        numberOfPairs += glyph.kerningTableSize;
+    }
+    return numberOfPairs;
+}
@@ -0,0 +1,85 @@
+#include <gui/common/KerningLookup.hpp>
+
+using namespace touchgfx;
+
+bool KerningLookup::setup(uint8_t* memory, uint32_t size, uint32_t numberOfPairs)
+{
+    keys = 0;
+    const uint32_t capacity = getCapacity(numberOfPairs);
+    if (numberOfPairs == 0 || memory == 0 || size < getMemorySize(numberOfPairs))
+    {
+        return false;
+    }
+    keys = (uint32_t*)memory;
+    distances = (int8_t*)(keys + capacity);
+    mask = capacity - 1;
+    shift = 32;
+    for (uint32_t c = capacity; c > 1; c >>= 1)
+    {
+        shift--;
+    }
+    for (uint32_t i = 0; i < capacity; i++)
+    {
+        keys[i] = 0;
+    }
+    return true;
+}
+
+void KerningLookup::add(Unicode::UnicodeChar unicode, const KerningNode* kerning, uint16_t size)
+{
+    for (uint16_t i = 0; keys && i < size; i++)
+    {
+        const uint32_t key = ((uint32_t)kerning[i].unicodePrevChar << 16) | unicode;
+        uint32_t slot = hash(key);
+        while (keys[slot] != 0 && keys[slot] != key)
+        {
+            slot = (slot + 1) & mask;
+        }
+        keys[slot] = key;
+        distances[slot] = kerning[i].distance;
+    }
+}
+
+int8_t KerningLookup::getKerning(Unicode::UnicodeChar prevChar, const GlyphNode* glyph, const KerningNode* kerningData) const
+{
+    if (!glyph || glyph->kerningTableSize == 0)
+    {
+        return 0;
+    }
+    if (keys)
+    {
+        const uint32_t key = ((uint32_t)prevChar << 16) | glyph->unicode;
+        for (uint32_t slot = hash(key); keys[slot] != 0; slot = (slot + 1) & mask)
+        {
+            if (keys[slot] == key)
+            {
+                return distances[slot];
+            }
+        }
+        return 0;
+    }
+    if (!kerningData)
+    {
+        return 0;
+    }
+    return find(prevChar, kerningData + glyph->kerningTablePos(), glyph->kerningTableSize);
+}
+
+int8_t KerningLookup::find(Unicode::UnicodeChar prevChar, const KerningNode* kerning, uint16_t size)
+{
+    uint16_t low = 0;
+    uint16_t high = size;
+    while (low < high)
+    {
+        const uint16_t middle = (low + high) / 2;
+        if (kerning[middle].unicodePrevChar < prevChar)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return (low < size && kerning[low].unicodePrevChar == prevChar) ? kerning[low].distance : 0;
+}
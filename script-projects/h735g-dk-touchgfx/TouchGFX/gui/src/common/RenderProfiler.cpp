@@ -0,0 +1,317 @@
+#include <gui/common/RenderProfiler.hpp>
+#include <touchgfx/hal/HAL.hpp>
+#include <stdio.h>
+#include <stdlib.h>
+#ifdef SIMULATOR
+#include <chrono>
+#endif
+#if defined(__GNUC__) && defined(__GXX_RTTI)
+#include <cxxabi.h>
+#endif
+
+using namespace touchgfx;
+
+RenderProfiler::Event RenderProfiler::events[RenderProfiler::MAX_EVENTS];
+uint16_t RenderProfiler::head = 0;
+uint16_t RenderProfiler::count = 0;
+uint64_t RenderProfiler::starts[RenderProfiler::MAX_DEPTH];
+uint16_t RenderProfiler::depth = 0;
+uint16_t RenderProfiler::frame = 0;
+bool RenderProfiler::enabled = false;
+#ifdef SIMULATOR
+uint32_t RenderProfiler::clockFrequency = 1000000000; // now() counts nanoseconds
+#else
+uint32_t RenderProfiler::clockFrequency = 0;
+#endif
+const void* RenderProfiler::currentScreen = 0;
+const char* RenderProfiler::currentScreenName = 0;
+GenericCallback<const char*>* RenderProfiler::exportWriter = 0;
+uint16_t RenderProfiler::exportFrames = 0;
+uint16_t RenderProfiler::framesSinceExport = 0;
+
+namespace
+{
+const uint16_t MAX_SUMMARY_TYPES = 32;
+const int LINE_SIZE = 192;
+const int NAME_SIZE = 96;
+
+const char* const kindNames[RenderProfiler::NUMBER_OF_KINDS] = { "frame", "area", "draw_chain", "drawable" };
+
+void formatType(char* buffer, const void* type, const char* name)
+{
+    if (name)
+    {
+#if defined(__GNUC__) && defined(__GXX_RTTI)
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(name, 0, 0, &status);
+        if (status == 0 && demangled)
+        {
+            snprintf(buffer, NAME_SIZE, "%s", demangled);
+            free(demangled);
+            return;
+        }
+#endif
+        snprintf(buffer, NAME_SIZE, "%s", name);
+    }
+    else if (type)
+    {
+        // The vtable pointer skips the offset to top and the type info of the vtable symbol
+        const uintptr_t vtable = reinterpret_cast<uintptr_t>(type) - 2 * sizeof(void*);
+        snprintf(buffer, NAME_SIZE, "vtable@0x%08lx", (unsigned long)vtable);
+    }
+    else
+    {
+        snprintf(buffer, NAME_SIZE, "-");
+    }
+}
+
+/** Formats cycles as microseconds with three decimals, without floating point printf. */
+void formatMicroseconds(char* buffer, uint64_t cycles, uint32_t frequency)
+{
+    if (frequency == 0)
+    {
+        snprintf(buffer, 24, "0.000");
+        return;
+    }
+    const uint64_t ns = (cycles / frequency) * 1000000000ull + (cycles % frequency) * 1000000000ull / frequency;
+    snprintf(buffer, 24, "%lu.%03lu", (unsigned long)(ns / 1000), (unsigned long)(ns % 1000));
+}
+
+uint64_t oldestStart()
+{
+    uint64_t base = ~0ull;
+    for (uint16_t i = 0; i < RenderProfiler::size(); i++)
+    {
+        const uint64_t start = RenderProfiler::getEvent(i).start;
+        base = start < base ? start : base;
+    }
+    return base;
+}
+} // namespace
+
+void RenderProfiler::enable(bool enable)
+{
+    enabled = enable;
+    depth = 0;
+}
+
+void RenderProfiler::setExport(GenericCallback<const char*>* writer, uint16_t frames)
+{
+    exportWriter = writer;
+    exportFrames = frames;
+    framesSinceExport = 0;
+}
+
+void RenderProfiler::beginFrame()
+{
+    frame++;
+    depth = 0;
+    begin();
+}
+
+void RenderProfiler::endFrame()
+{
+    end(FRAME, 0, 0);
+    if (exportWriter && exportWriter->isValid() && exportFrames > 0 && ++framesSinceExport >= exportFrames)
+    {
+        exportText(*exportWriter);
+        clear();
+        framesSinceExport = 0;
+    }
+}
+
+void RenderProfiler::begin()
+{
+    if (depth < MAX_DEPTH)
+    {
+        starts[depth] = now();
+    }
+    depth++;
+}
+
+void RenderProfiler::end(Kind kind, const void* type, const char* typeName)
+{
+    if (depth == 0)
+    {
+        // Enabled in the middle of a scope
+        return;
+    }
+    depth--;
+    if (depth >= MAX_DEPTH)
+    {
+        return;
+    }
+    Event& event = events[head];
+    event.start = starts[depth];
+    event.cycles = (uint32_t)(now() - event.start);
+    event.type = type;
+    event.typeName = typeName;
+    event.screen = currentScreen;
+    event.screenName = currentScreenName;
+    event.frame = frame;
+    event.kind = (uint8_t)kind;
+    event.depth = (uint8_t)depth;
+    head = (head + 1) % MAX_EVENTS;
+    if (count < MAX_EVENTS)
+    {
+        count++;
+    }
+}
+
+void RenderProfiler::clear()
+{
+    count = 0;
+}
+
+void RenderProfiler::exportText(GenericCallback<const char*>& writer)
+{
+    char line[LINE_SIZE + 2 * NAME_SIZE];
+    char screen[NAME_SIZE];
+    char type[NAME_SIZE];
+    const uint64_t base = oldestStart();
+    snprintf(line, sizeof(line), "# frame,kind,depth,screen,type,start,cycles (%lu Hz)\n", (unsigned long)clockFrequency);
+    writer.execute(line);
+    for (uint16_t i = 0; i < count; i++)
+    {
+        const Event& event = getEvent(i);
+        formatType(screen, event.screen, event.screenName);
+        formatType(type, event.type, event.typeName);
+        snprintf(line, sizeof(line), "%u,%s,%u,%s,%s,%lu,%lu\n",
+                 (unsigned)event.frame, kindNames[event.kind], (unsigned)event.depth, screen, type,
+                 (unsigned long)(event.start - base), (unsigned long)event.cycles);
+        writer.execute(line);
+    }
+}
+
+void RenderProfiler::exportSummary(GenericCallback<const char*>& writer)
+{
+    struct Entry
+    {
+        const void* type;
+        const char* typeName;
+        uint32_t calls;
+        uint64_t total;
+        uint32_t max;
+    };
+    Entry entries[MAX_SUMMARY_TYPES];
+    uint16_t numEntries = 0;
+    uint64_t frameCycles = 0;
+    uint64_t areaCycles = 0;
+    for (uint16_t i = 0; i < count; i++)
+    {
+        const Event& event = getEvent(i);
+        if (event.kind == FRAME)
+        {
+            frameCycles += event.cycles;
+        }
+        else if (event.kind == AREA)
+        {
+            areaCycles += event.cycles;
+        }
+        if (event.kind != DRAWABLE)
+        {
+            continue;
+        }
+        uint16_t e = 0;
+        while (e < numEntries && entries[e].type != event.type)
+        {
+            e++;
+        }
+        if (e == numEntries)
+        {
+            if (numEntries == MAX_SUMMARY_TYPES)
+            {
+                continue;
+            }
+            entries[e].type = event.type;
+            entries[e].typeName = event.typeName;
+            entries[e].calls = 0;
+            entries[e].total = 0;
+            entries[e].max = 0;
+            numEntries++;
+        }
+        entries[e].calls++;
+        entries[e].total += event.cycles;
+        entries[e].max = event.cycles > entries[e].max ? event.cycles : entries[e].max;
+    }
+    const uint64_t budget = frameCycles ? frameCycles : areaCycles;
+
+    char line[LINE_SIZE + NAME_SIZE];
+    char type[NAME_SIZE];
+    char total[24];
+    char max[24];
+    snprintf(line, sizeof(line), "# type,calls,total_us,max_us,permille_of_frames\n");
+    writer.execute(line);
+    for (uint16_t i = 0; i < numEntries; i++)
+    {
+        // Most expensive first
+        uint16_t best = i;
+        for (uint16_t j = i + 1; j < numEntries; j++)
+        {
+            if (entries[j].total > entries[best].total)
+            {
+                best = j;
+            }
+        }
+        const Entry entry = entries[best];
+        entries[best] = entries[i];
+        entries[i] = entry;
+
+        formatType(type, entry.type, entry.typeName);
+        formatMicroseconds(total, entry.total, clockFrequency);
+        formatMicroseconds(max, entry.max, clockFrequency);
+        snprintf(line, sizeof(line), "%s,%lu,%s,%s,%lu\n", type, (unsigned long)entry.calls, total, max,
+                 (unsigned long)(budget ? entry.total * 1000 / budget : 0));
+        writer.execute(line);
+    }
+}
+
+void RenderProfiler::exportChromeTrace(GenericCallback<const char*>& writer)
+{
+    char line[LINE_SIZE + 2 * NAME_SIZE];
+    char screen[NAME_SIZE];
+    char type[NAME_SIZE];
+    char ts[24];
+    char dur[24];
+    const uint64_t base = oldestStart();
+    writer.execute("{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+    for (uint16_t i = 0; i < count; i++)
+    {
+        const Event& event = getEvent(i);
+        formatType(screen, event.screen, event.screenName);
+        if (event.type)
+        {
+            formatType(type, event.type, event.typeName);
+        }
+        else
+        {
+            snprintf(type, NAME_SIZE, "%s", kindNames[event.kind]);
+        }
+        formatMicroseconds(ts, event.start - base, clockFrequency);
+        formatMicroseconds(dur, event.cycles, clockFrequency);
+        snprintf(line, sizeof(line),
+                 "%s\n  {\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"X\", \"ts\": %s, \"dur\": %s, \"pid\": 1, \"tid\": 1, "
+                 "\"args\": {\"frame\": %u, \"screen\": \"%s\"}}",
+                 i ? "," : "", type, kindNames[event.kind], ts, dur, (unsigned)event.frame, screen);
+        writer.execute(line);
+    }
+    writer.execute("\n]}\n");
+}
+
+uint64_t RenderProfiler::now()
+{
+#ifdef SIMULATOR
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#else
+    // Extend the 32 bit cycle counter, which wraps every few seconds
+    static uint32_t lastCycles = 0;
+    static uint32_t wraps = 0;
+    const uint32_t cycles = HAL::getInstance()->getCPUCycles();
+    if (cycles < lastCycles)
+    {
+        wraps++;
+    }
+    lastCycles = cycles;
+    return ((uint64_t)wraps << 32) | cycles;
+#endif
+}
@@ -0,0 +1,67 @@
+#include "FrameCacheMJPEGDecoder.hpp"
+#include <string.h>
+
+using namespace touchgfx;
+
+FrameCacheMJPEGDecoder::FrameCacheMJPEGDecoder(uint8_t* linebuffer)
+    : SoftwareMJPEGDecoder(linebuffer), frameCache(0), frameCacheSize(0), frameWidth(0), frameHeight(0), cachedFrameNumber(0)
+{
+}
+
+void FrameCacheMJPEGDecoder::setFrameCacheBuffer(uint8_t* buffer, uint32_t size)
+{
+    frameCache = buffer;
+    frameCacheSize = size;
+    cachedFrameNumber = 0;
+}
+
+void FrameCacheMJPEGDecoder::setVideoData(const uint8_t* movie, const uint32_t length)
+{
+    SoftwareMJPEGDecoder::setVideoData(movie, length);
+    readFrameSize();
+}
+
+void FrameCacheMJPEGDecoder::setVideoData(VideoDataReader& reader)
+{
+    SoftwareMJPEGDecoder::setVideoData(reader);
+    readFrameSize();
+}
+
+bool FrameCacheMJPEGDecoder::decodeFrame(const Rect& area, uint8_t* frameBuffer, uint32_t framebuffer_width)
+{
+    const Rect frame(0, 0, (int16_t)frameWidth, (int16_t)frameHeight);
+    const Rect part = area & frame;
+    if (part.isEmpty())
+    {
+        return true;
+    }
+    if (frameCache == 0 || frameCacheSize < frameWidth * frameHeight * BYTES_PER_PIXEL)
+    {
+        return SoftwareMJPEGDecoder::decodeFrame(part, frameBuffer, framebuffer_width);
+    }
+
+    // Frame numbers start at 1, every frame number is the same frame until new video data
+    if (cachedFrameNumber != getCurrentFrameNumber())
+    {
+        SoftwareMJPEGDecoder::decodeFrame(frame, frameCache, frameWidth);
+        cachedFrameNumber = getCurrentFrameNumber();
+    }
+    const uint8_t* source = frameCache + (part.y * frameWidth + part.x) * BYTES_PER_PIXEL;
+    uint8_t* destination = frameBuffer + (part.y * framebuffer_width + part.x) * BYTES_PER_PIXEL;
+    for (int16_t y = 0; y < part.height; y++)
+    {
+        memcpy(destination, source, part.width * BYTES_PER_PIXEL);
+        source += frameWidth * BYTES_PER_PIXEL;
+        destination += framebuffer_width * BYTES_PER_PIXEL;
+    }
+    return true;
+}
+
+void FrameCacheMJPEGDecoder::readFrameSize()
+{
+    VideoInformation info;
+    getVideoInfo(&info);
+    frameWidth = info.frame_width;
+    frameHeight = info.frame_height;
+    cachedFrameNumber = 0;
+}
@@ -0,0 +1,68 @@
+#ifndef FRAMECACHEMJPEGDECODER_HPP
+#define FRAMECACHEMJPEGDECODER_HPP
+
+#include <simulator/video/SoftwareMJPEGDecoder.hpp>
+
+/**
+ * @class FrameCacheMJPEGDecoder
+ *
+ * @brief A SoftwareMJPEGDecoder decoding each video frame once for all the areas drawn.
+ *
+ *        A SoftwareMJPEGDecoder decoding each video frame once for all the areas drawn.
+ *        SoftwareMJPEGDecoder::decodeFrame() decompresses the frame from the first scanline
+ *        for every invalidated area, so a video split into several areas by the widgets on
+ *        top of it is decoded several times per frame. Given a buffer for a whole frame
+ *        with setFrameCacheBuffer(), decodeFrame() decodes the current frame once into it
+ *        and copies every area from it. Without a buffer, or with a buffer too small for the
+ *        frame, every area is decoded as by SoftwareMJPEGDecoder.
+ *
+ *        Areas are clipped to the video, areas right of or below the video draw nothing.
+ *
+ *        Frames are decoded with the float IDCT at the full size of the video, as set by the
+ *        generated SoftwareMJPEGDecoder, which does not let a subclass choose the integer
+ *        IDCT or scale the DCT to a smaller widget.
+ *
+ * @see DirectFrameBufferVideoController
+ */
+class FrameCacheMJPEGDecoder : public SoftwareMJPEGDecoder
+{
+public:
+    /**
+     * @fn FrameCacheMJPEGDecoder::FrameCacheMJPEGDecoder(uint8_t* linebuffer);
+     *
+     * @brief Constructor.
+     *
+     * @param [in] linebuffer The line buffer of the decoder, one line of the video.
+     */
+    FrameCacheMJPEGDecoder(uint8_t* linebuffer);
+
+    /**
+     * @fn void FrameCacheMJPEGDecoder::setFrameCacheBuffer(uint8_t* buffer, uint32_t size);
+     *
+     * @brief Sets the buffer of the decoded frame.
+     *
+     * @param [in] buffer The buffer, or 0 to decode every area.
+     * @param      size   The size of the buffer in bytes, width x height x 3 to cache a frame.
+     */
+    void setFrameCacheBuffer(uint8_t* buffer, uint32_t size);
+
+    virtual void setVideoData(const uint8_t* movie, const uint32_t length);
+
+    virtual void setVideoData(touchgfx::VideoDataReader& reader);
+
+    virtual bool decodeFrame(const touchgfx::Rect& area, uint8_t* frameBuffer, uint32_t framebuffer_width);
+
+private:
+    /** The decoder draws RGB888, see VIDEO_DECODE_FORMAT. */
+    static const uint32_t BYTES_PER_PIXEL = 3;
+
+    void readFrameSize();
+
+    uint8_t* frameCache;
+    uint32_t frameCacheSize;
+    uint32_t frameWidth;
+    uint32_t frameHeight;
+    uint32_t cachedFrameNumber; ///< Number of the frame in the cache, 0 if none
+};
+
+#endif // FRAMECACHEMJPEGDECODER_HPP
@@ -0,0 +1,125 @@
+#ifndef THREADEDDECODEAHEADVIDEOCONTROLLER_HPP
+#define THREADEDDECODEAHEADVIDEOCONTROLLER_HPP
+
+#include <SDL2/SDL_mutex.h>
+#include <SDL2/SDL_thread.h>
+#include <gui/common/DecodeAheadVideoController.hpp>
+
+/**
+ * @class ThreadedDecodeAheadVideoController
+ *
+ * @brief A DecodeAheadVideoController with the decoder task in an SDL thread.
+ *
+ *        A DecodeAheadVideoController with the decoder task in an SDL thread of the
+ *        simulator, like FreeRTOSDecodeAheadVideoController on target. Frames are decoded
+ *        in the tick requesting them until startDecoderTask() is called.
+ *
+ * @see DecodeAheadVideoController
+ */
+template <uint32_t no_streams, uint32_t width, uint32_t height, touchgfx::Bitmap::BitmapFormat output_format>
+class ThreadedDecodeAheadVideoController : public DecodeAheadVideoController<no_streams, width, height, output_format>
+{
+public:
+    /**
+     * @fn ThreadedDecodeAheadVideoController::ThreadedDecodeAheadVideoController();
+     *
+     * @brief Default constructor.
+     */
+    ThreadedDecodeAheadVideoController()
+        : DecodeAheadVideoController<no_streams, width, height, output_format>(),
+          decoderThread(0), decodeRequest(SDL_CreateSemaphore(0)), streamMutex(SDL_CreateMutex()), stopping(false)
+    {
+        assert(decodeRequest && streamMutex && "Video: Unable to create decoder task semaphores!");
+    }
+
+    virtual ~ThreadedDecodeAheadVideoController()
+    {
+        stopDecoderTask();
+        SDL_DestroyMutex(streamMutex);
+        SDL_DestroySemaphore(decodeRequest);
+    }
+
+    /**
+     * @fn void ThreadedDecodeAheadVideoController::startDecoderTask();
+     *
+     * @brief Starts the decoder task.
+     */
+    void startDecoderTask()
+    {
+        if (decoderThread == 0)
+        {
+            stopping = false;
+            decoderThread = SDL_CreateThread(decoderThreadEntry, "VideoDecoder", this);
+            assert(decoderThread && "Video: Unable to create decoder task!");
+        }
+    }
+
+    /**
+     * @fn void ThreadedDecodeAheadVideoController::stopDecoderTask();
+     *
+     * @brief Stops the decoder task, waiting for the frame being decoded.
+     */
+    void stopDecoderTask()
+    {
+        if (decoderThread != 0)
+        {
+            SDL_LockMutex(streamMutex);
+            stopping = true;
+            SDL_UnlockMutex(streamMutex);
+            SDL_SemPost(decodeRequest);
+            SDL_WaitThread(decoderThread, 0);
+            decoderThread = 0;
+        }
+    }
+
+protected:
+    virtual void signalDecoderTask()
+    {
+        if (decoderThread != 0)
+        {
+            SDL_SemPost(decodeRequest);
+        }
+        else
+        {
+            DecodeAheadVideoController<no_streams, width, height, output_format>::signalDecoderTask();
+        }
+    }
+
+    virtual bool waitForDecodeRequest()
+    {
+        SDL_SemWait(decodeRequest);
+        SDL_LockMutex(streamMutex);
+        const bool keepRunning = !stopping;
+        SDL_UnlockMutex(streamMutex);
+        return keepRunning;
+    }
+
+    virtual void lockStreams()
+    {
+        SDL_LockMutex(streamMutex);
+    }
+
+    virtual bool tryLockStreams()
+    {
+        return SDL_TryLockMutex(streamMutex) == 0;
+    }
+
+    virtual void unlockStreams()
+    {
+        SDL_UnlockMutex(streamMutex);
+    }
+
+private:
+    SDL_Thread* decoderThread;
+    SDL_sem* decodeRequest;
+    SDL_mutex* streamMutex;
+    bool stopping;
+
+    static int decoderThreadEntry(void* controller)
+    {
+        static_cast<ThreadedDecodeAheadVideoController*>(controller)->decoderTaskEntry();
+        return 0;
+    }
+};
+
+#endif // THREADEDDECODEAHEADVIDEOCONTROLLER_HPP
@@ -0,0 +1,28 @@
+# Framework sources built from source instead of taken from libtouchgfx, as they
+# are changed in this project. Paths are relative to the application, where the
+# generated Makefile is run.
+framework_source_path := ../Middlewares/ST/touchgfx/framework/source
+
+FRAMEWORK_SOURCES := \
+	$(framework_source_path)/touchgfx/BitmapCache.cpp \
+	$(framework_source_path)/touchgfx/canvas_widget_renderer/CanvasWidgetRenderer.cpp \
+	$(framework_source_path)/touchgfx/containers/BlitScrollableContainer.cpp \
+	$(framework_source_path)/touchgfx/containers/CachedGeometryContainer.cpp \
+	$(framework_source_path)/touchgfx/containers/IndexedContainer.cpp \
+	$(framework_source_path)/touchgfx/containers/ScrollBlitter.cpp \
+	$(framework_source_path)/touchgfx/widgets/Button.cpp \
+	$(framework_source_path)/touchgfx/widgets/ButtonWithIcon.cpp \
+	$(framework_source_path)/touchgfx/widgets/CachedTextArea.cpp \
+	$(framework_source_path)/touchgfx/widgets/canvas/Canvas.cpp \
+	$(framework_source_path)/touchgfx/widgets/canvas/CanvasWidget.cpp \
+	$(framework_source_path)/touchgfx/widgets/canvas/PainterRGB565.cpp \
+	$(framework_source_path)/touchgfx/widgets/canvas/PainterRGB888.cpp \
+	$(framework_source_path)/touchgfx/widgets/canvas/PainterRGB888Bitmap.cpp \
+	$(framework_source_path)/touchgfx/widgets/canvas/PainterRGB888L8Bitmap.cpp \
+	$(framework_source_path)/touchgfx/widgets/GlyphAtlas.cpp \
+	$(framework_source_path)/touchgfx/widgets/Image.cpp \
+	$(framework_source_path)/touchgfx/widgets/NumericTextArea.cpp \
+	$(framework_source_path)/touchgfx/widgets/RadioButton.cpp \
+	$(framework_source_path)/touchgfx/widgets/ScalableImage.cpp \
+	$(framework_source_path)/touchgfx/widgets/TextureMapper.cpp \
+	$(framework_source_path)/touchgfx/widgets/TiledImage.cpp
@@ -4,14 +4,47 @@
 #include <gui_generated/common/SimConstants.hpp>
 #include <platform/driver/touch/SDL2TouchController.hpp>
 #include <touchgfx/lcd/LCD.hpp>
+#include <platform/driver/lcd/LCD24bppSpecialized.hpp>
+#include <touchgfx/Utils.hpp>
+#include <platform/hal/simulator/sdl2/TileRenderer.hpp>
 #include <stdlib.h>
+#include <string.h>
 #include <simulator/mainBase.hpp>
+#include <gui/common/RenderProfiler.hpp>
+#include <stdio.h>
 
 //#include <touchgfx/canvas_widget_renderer/CanvasWidgetRenderer.hpp>
 //#define CANVAS_BUFFER_SIZE (3600)
 
 using namespace touchgfx;
 
+namespace
+{
+/** Writes the RenderProfiler export to a file. */
+class FileWriter
+{
+public:
+    FileWriter(FILE* f)
+        : file(f), callback(this, &FileWriter::write)
+    {
+    }
+
+    GenericCallback<const char*>& getCallback()
+    {
+        return callback;
+    }
+
+private:
+    void write(const char* text)
+    {
+        fputs(text, file);
+    }
+
+    FILE* file;
+    Callback<FileWriter, const char*> callback;
+};
+} // namespace
+
 #ifdef __linux__
 int main(int argc, char** argv)
 {
@@ -27,11 +60,67 @@ int CALLBACK WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLi
 #endif
 
     touchgfx::NoDMA dma; //For windows/linux, DMA transfers are simulated
-    LCD& lcd = setupLCD();
+    // Draws as the LCD24bpp of setupLCD(), with the kernels of LCD24bppBlitConfig.hpp
+    static touchgfx::LCD24bppSpecialized lcd;
     touchgfx::SDL2TouchController tc;
 
     touchgfx::HAL& hal = touchgfx::touchgfx_generic_init<touchgfx::HALSDL2>(dma, lcd, tc, SIM_WIDTH, SIM_HEIGHT, 0, 0);
 
+    // Optional tiled rendering, e.g. "--tile-workers 4 --tile-size 64 --tile-verify",
+    // per widget profiling written as a Chrome trace on exit, e.g. "--profile trace.json",
+    // and drawing without a window from a script, e.g. "--headless 1000 --headless-input
+    // touches.txt --headless-report frames.txt --headless-save frames"
+    const char* profileFile = 0;
+    int headlessFrames = -1;
+    const char* headlessInput = 0;
+    const char* headlessReport = 0;
+    const char* headlessFolder = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--tile-workers") && i + 1 < argc)
+        {
+            touchgfx::TileRenderer::setWorkers(atoi(argv[++i]));
+            touchgfx::TileRenderer::setReportInterval(100);
+        }
+        else if (!strcmp(argv[i], "--tile-size") && i + 1 < argc)
+        {
+            const int size = atoi(argv[++i]);
+            touchgfx::TileRenderer::setTileSize(size, size);
+        }
+        else if (!strcmp(argv[i], "--tile-verify"))
+        {
+            touchgfx::TileRenderer::setVerify(true);
+        }
+        else if (!strcmp(argv[i], "--profile") && i + 1 < argc)
+        {
+            profileFile = argv[++i];
+            RenderProfiler::enable(true);
+        }
+        else if (!strcmp(argv[i], "--headless") && i + 1 < argc)
+        {
+            headlessFrames = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--headless-input") && i + 1 < argc)
+        {
+            headlessInput = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--headless-report") && i + 1 < argc)
+        {
+            headlessReport = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--headless-save") && i + 1 < argc)
+        {
+            headlessFolder = argv[++i];
+        }
+    }
+
+    // Headless mode must be chosen before SDL is initialized
+    if (headlessFrames >= 0 && !static_cast<touchgfx::HALSDL2&>(hal).setHeadless(headlessFrames, headlessInput, headlessReport, headlessFolder))
+    {
+        touchgfx_printf("Headless mode needs a number of frames or an input script\n");
+        return EXIT_FAILURE;
+    }
+
     setupSimulator(argc, argv, hal);
 
     // Ensure there is a console window to print to using printf() or
@@ -50,5 +139,19 @@ int CALLBACK WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLi
 
     touchgfx::HAL::getInstance()->taskEntry(); //Never returns
 
+    if (profileFile)
+    {
+        // The ring buffer holds the last frames drawn before the simulator was closed
+        FILE* file = fopen(profileFile, "w");
+        if (file)
+        {
+            FileWriter trace(file);
+            RenderProfiler::exportChromeTrace(trace.getCallback());
+            fclose(file);
+        }
+        FileWriter summary(stdout);
+        RenderProfiler::exportSummary(summary.getCallback());
+    }
+
     return EXIT_SUCCESS;
 }
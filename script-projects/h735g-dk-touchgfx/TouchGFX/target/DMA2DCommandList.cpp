@@ -0,0 +1,271 @@
+#include <DMA2DCommandList.hpp>
+#include <cassert>
+
+using namespace touchgfx;
+
+typedef struct
+{
+    const uint16_t format;
+    const uint16_t size;
+    const uint32_t* const data;
+} clutData_t;
+
+namespace
+{
+inline uint32_t address(const void* p)
+{
+    return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(p));
+}
+} // namespace
+
+DMA2DCommandList::DMA2DCommandList(Command* mem, atomic_t n)
+    : DMA_Queue(), q(mem), capacity(n), head(0), tail(0), loadedClut(0), loadedClutGeneration(0), clutGeneration(0), pendingCR(0), clutLoads(0)
+{
+}
+
+bool DMA2DCommandList::isEmpty()
+{
+    return head == tail;
+}
+
+bool DMA2DCommandList::isFull()
+{
+    atomic_t next = tail + 1;
+    if (next == capacity)
+    {
+        next = 0;
+    }
+    return next == head;
+}
+
+void DMA2DCommandList::pushCopyOf(const BlitOp& op)
+{
+    Command& command = q[tail];
+    command.op = op;
+    buildCommand(op, command);
+    command.clutGeneration = clutGeneration;
+
+    atomic_t next = tail + 1;
+    if (next == capacity)
+    {
+        next = 0;
+    }
+    atomic_set(tail, next);
+}
+
+void DMA2DCommandList::pop()
+{
+    assert(!isEmpty());
+    atomic_t next = head + 1;
+    if (next == capacity)
+    {
+        next = 0;
+    }
+    atomic_set(head, next);
+}
+
+const BlitOp* DMA2DCommandList::first()
+{
+    return &q[head].op;
+}
+
+void DMA2DCommandList::start(const BlitOp& op, DMA2D_TypeDef* dma2d)
+{
+    const Command& command = q[head];
+    assert(&command.op == &op && "Only the first BlitOp in the queue can be started");
+    (void)op; // Only used by assert
+
+    WRITE_REG(dma2d->OOR, command.OOR);
+    WRITE_REG(dma2d->BGOR, command.BGOR);
+    WRITE_REG(dma2d->FGOR, command.FGOR);
+    WRITE_REG(dma2d->OPFCCR, command.OPFCCR);
+    WRITE_REG(dma2d->NLR, command.NLR);
+    WRITE_REG(dma2d->OMAR, command.OMAR);
+    WRITE_REG(dma2d->OCOLR, command.OCOLR);
+    WRITE_REG(dma2d->FGMAR, command.FGMAR);
+    WRITE_REG(dma2d->FGCOLR, command.FGCOLR);
+    WRITE_REG(dma2d->BGPFCCR, command.BGPFCCR);
+    WRITE_REG(dma2d->BGMAR, command.BGMAR);
+    WRITE_REG(dma2d->FGPFCCR, command.FGPFCCR);
+
+    if (command.clut && (command.clut != loadedClut || command.clutGeneration != loadedClutGeneration))
+    {
+        /* Load the CLUT, the transfer is started from the CLUT transfer complete interrupt */
+        loadedClut = command.clut;
+        loadedClutGeneration = command.clutGeneration;
+        clutLoads++;
+        pendingCR = command.CR;
+        WRITE_REG(dma2d->FGCMAR, address(&reinterpret_cast<const clutData_t*>(command.clut)->data));
+        WRITE_REG(dma2d->CR, DMA2D_IT_CTC);
+        SET_BIT(dma2d->FGPFCCR, DMA2D_FGPFCCR_START);
+        return;
+    }
+
+    WRITE_REG(dma2d->CR, command.CR);
+}
+
+void DMA2DCommandList::clutLoaded(DMA2D_TypeDef* dma2d)
+{
+    WRITE_REG(dma2d->CR, pendingCR);
+}
+
+void DMA2DCommandList::buildCommand(const BlitOp& op, Command& command)
+{
+    const uint32_t dma2dOutputColorMode = getChromARTOutputFormat(static_cast<Bitmap::BitmapFormat>(op.dstFormat));
+
+    command.clut = 0;
+    command.OPFCCR = dma2dOutputColorMode;
+    command.NLR = op.nLoops | (op.nSteps << DMA2D_NLR_PL_Pos);
+    command.OMAR = address(op.pDst);
+    command.OOR = op.dstLoopStride - op.nSteps;
+    command.BGOR = op.dstLoopStride - op.nSteps;
+    command.OCOLR = 0;
+    command.FGCOLR = 0;
+    command.BGMAR = address(op.pDst);
+
+    if (op.operation == BLIT_OP_FILL || op.operation == BLIT_OP_FILL_WITH_ALPHA)
+    {
+        if (op.operation == BLIT_OP_FILL_WITH_ALPHA)
+        {
+            command.FGOR = op.dstLoopStride - op.nSteps;
+            command.BGPFCCR = dma2dOutputColorMode | (DMA2D_NO_MODIF_ALPHA << DMA2D_BGPFCCR_AM_Pos);
+            command.FGPFCCR = DMA2D_INPUT_A8 | (DMA2D_REPLACE_ALPHA << DMA2D_BGPFCCR_AM_Pos) | ((op.alpha << 24) & DMA2D_BGPFCCR_ALPHA);
+            command.FGCOLR = op.color;
+            command.FGMAR = address(op.pDst);
+            command.CR = DMA2D_IT_TC | DMA2D_CR_START | DMA2D_M2M_BLEND;
+        }
+        else
+        {
+            command.FGOR = 0;
+            command.BGPFCCR = 0;
+            command.FGPFCCR = dma2dOutputColorMode | (DMA2D_NO_MODIF_ALPHA << DMA2D_BGPFCCR_AM_Pos);
+            command.FGMAR = 0;
+            command.OCOLR = op.color;
+            command.CR = DMA2D_IT_TC | DMA2D_CR_START | DMA2D_R2M;
+        }
+        return;
+    }
+
+    const uint32_t dma2dForegroundColorMode = getChromARTInputFormat(static_cast<Bitmap::BitmapFormat>(op.srcFormat));
+    const uint32_t dma2dBackgroundColorMode = getChromARTInputFormat(static_cast<Bitmap::BitmapFormat>(op.dstFormat));
+
+    command.FGOR = op.srcLoopStride - op.nSteps;
+    command.FGMAR = address(op.pSrc);
+    command.BGPFCCR = dma2dBackgroundColorMode | (DMA2D_NO_MODIF_ALPHA << DMA2D_BGPFCCR_AM_Pos);
+
+    switch (op.operation)
+    {
+    case BLIT_OP_COPY_A4:
+    case BLIT_OP_COPY_A8:
+        command.FGPFCCR = (op.operation == BLIT_OP_COPY_A4 ? DMA2D_INPUT_A4 : DMA2D_INPUT_A8) | (DMA2D_COMBINE_ALPHA << DMA2D_BGPFCCR_AM_Pos) | (op.alpha << 24);
+        command.FGCOLR = op.color;
+        command.CR = DMA2D_M2M_BLEND | DMA2D_IT_TC | DMA2D_CR_START;
+        break;
+    case BLIT_OP_COPY_L8:
+        {
+            const clutData_t* const palette = reinterpret_cast<const clutData_t*>(op.pClut);
+            bool blend = true;
+
+            command.FGPFCCR = dma2dForegroundColorMode | (DMA2D_COMBINE_ALPHA << DMA2D_BGPFCCR_AM_Pos) | (op.alpha << 24);
+            switch ((Bitmap::ClutFormat)palette->format)
+            {
+            case Bitmap::CLUT_FORMAT_L8_ARGB8888:
+                command.FGPFCCR |= ((palette->size - 1) << DMA2D_FGPFCCR_CS_Pos) | (DMA2D_CCM_ARGB8888 << DMA2D_FGPFCCR_CCM_Pos);
+                break;
+            case Bitmap::CLUT_FORMAT_L8_RGB888:
+                if (op.alpha == 255)
+                {
+                    blend = false;
+                }
+                command.FGPFCCR |= ((palette->size - 1) << DMA2D_FGPFCCR_CS_Pos) | (DMA2D_CCM_RGB888 << DMA2D_FGPFCCR_CCM_Pos);
+                break;
+            case Bitmap::CLUT_FORMAT_L8_RGB565:
+            default:
+                assert(0 && "Unsupported format");
+                break;
+            }
+            command.clut = op.pClut;
+            command.CR = (blend ? DMA2D_M2M_BLEND : DMA2D_M2M_PFC) | DMA2D_IT_TC | DMA2D_CR_START;
+        }
+        break;
+    case BLIT_OP_COPY_WITH_ALPHA:
+    case BLIT_OP_COPY_ARGB8888:
+    case BLIT_OP_COPY_ARGB8888_WITH_ALPHA:
+        command.FGPFCCR = dma2dForegroundColorMode | (DMA2D_COMBINE_ALPHA << DMA2D_BGPFCCR_AM_Pos) | (op.alpha << 24);
+        command.CR = DMA2D_M2M_BLEND | DMA2D_IT_TC | DMA2D_CR_START;
+        break;
+    default: /* BLIT_OP_COPY */
+        command.FGPFCCR = dma2dForegroundColorMode | (DMA2D_COMBINE_ALPHA << DMA2D_BGPFCCR_AM_Pos) | (op.alpha << 24);
+        /* Perform pixel-format-conversion (PFC) If Bitmap format is not same format as framebuffer format */
+        command.CR = (op.srcFormat != op.dstFormat ? DMA2D_M2M_PFC : DMA2D_M2M) | DMA2D_IT_TC | DMA2D_CR_START;
+        break;
+    }
+}
+
+uint32_t DMA2DCommandList::getChromARTInputFormat(Bitmap::BitmapFormat format)
+{
+    // Default color mode set to ARGB8888
+    uint32_t dma2dColorMode = DMA2D_INPUT_ARGB8888;
+
+    switch (format)
+    {
+    case Bitmap::ARGB8888: /* DMA2D input mode set to 32bit ARGB */
+        dma2dColorMode = DMA2D_INPUT_ARGB8888;
+        break;
+    case Bitmap::RGB888: /* DMA2D input mode set to 24bit RGB */
+        dma2dColorMode = DMA2D_INPUT_RGB888;
+        break;
+    case Bitmap::RGB565: /* DMA2D input mode set to 16bit RGB */
+        dma2dColorMode = DMA2D_INPUT_RGB565;
+        break;
+    case Bitmap::ARGB2222: /* Fall through */
+    case Bitmap::ABGR2222: /* Fall through */
+    case Bitmap::RGBA2222: /* Fall through */
+    case Bitmap::BGRA2222: /* Fall through */
+    case Bitmap::L8:       /* DMA2D input mode set to 8bit Color Look up table*/
+        dma2dColorMode = DMA2D_INPUT_L8;
+        break;
+    case Bitmap::BW:     /* Fall through */
+    case Bitmap::BW_RLE: /* Fall through */
+    case Bitmap::GRAY4:  /* Fall through */
+    case Bitmap::GRAY2:  /* Fall through */
+    default:             /* Unsupported input format for DMA2D */
+        assert(0 && "Unsupported Format!");
+        break;
+    }
+
+    return dma2dColorMode;
+}
+
+uint32_t DMA2DCommandList::getChromARTOutputFormat(Bitmap::BitmapFormat format)
+{
+    // Default color mode set to ARGB8888
+    uint32_t dma2dColorMode = DMA2D_OUTPUT_ARGB8888;
+
+    switch (format)
+    {
+    case Bitmap::ARGB8888: /* DMA2D output mode set to 32bit ARGB */
+        dma2dColorMode = DMA2D_OUTPUT_ARGB8888;
+        break;
+    case Bitmap::RGB888:   /* Fall through */
+    case Bitmap::ARGB2222: /* Fall through */
+    case Bitmap::ABGR2222: /* Fall through */
+    case Bitmap::RGBA2222: /* Fall through */
+    case Bitmap::BGRA2222: /* DMA2D output mode set to 24bit RGB */
+        dma2dColorMode = DMA2D_OUTPUT_RGB888;
+        break;
+    case Bitmap::RGB565: /* DMA2D output mode set to 16bit RGB */
+        dma2dColorMode = DMA2D_OUTPUT_RGB565;
+        break;
+    case Bitmap::L8:     /* Fall through */
+    case Bitmap::BW:     /* Fall through */
+    case Bitmap::BW_RLE: /* Fall through */
+    case Bitmap::GRAY4:  /* Fall through */
+    case Bitmap::GRAY2:  /* Fall through */
+    default:             /* Unsupported output format for DMA2D */
+        assert(0 && "Unsupported Format!");
+        break;
+    }
+
+    return dma2dColorMode;
+}
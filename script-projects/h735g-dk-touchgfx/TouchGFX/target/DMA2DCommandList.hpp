@@ -0,0 +1,176 @@
+#ifndef DMA2DCOMMANDLIST_HPP
+#define DMA2DCOMMANDLIST_HPP
+
+#include "stm32h7xx_hal.h"
+#include <touchgfx/Bitmap.hpp>
+#include <touchgfx/hal/Atomic.hpp>
+#include <touchgfx/hal/DMA.hpp>
+#include <stdint.h>
+
+/**
+ * @class DMA2DCommandList
+ *
+ * @brief DMA_Queue storing the DMA2D register image of each BlitOp next to the BlitOp.
+ *
+ *        DMA_Queue storing the DMA2D register image of each BlitOp next to the BlitOp. The
+ *        register image is computed by pushCopyOf() on the thread adding the BlitOp, so
+ *        starting a transfer from the DMA2D interrupt is a plain sequence of register writes.
+ *
+ *        The CLUT of the last L8 transfer is remembered, and is only loaded again when an L8
+ *        transfer uses a different CLUT, or when clutChanged() was called after it was
+ *        loaded. A CLUT load is not waited for; the transfer is started by clutLoaded() from
+ *        the CLUT transfer complete (CTC) interrupt.
+ *
+ *        Only depends on the DMA2D register layout, so the queue can be driven by a mock
+ *        DMA2D on the host.
+ *
+ * @sa touchgfx::DMA_Queue, STM32DMA
+ */
+class DMA2DCommandList : public touchgfx::DMA_Queue
+{
+public:
+    /**
+     * @struct Command
+     *
+     * @brief A BlitOp and the DMA2D register values performing it.
+     */
+    struct Command
+    {
+        touchgfx::BlitOp op;     ///< The BlitOp as added to the queue
+        uint32_t CR;             ///< Control register, including mode, interrupt enable and start
+        uint32_t FGPFCCR;        ///< Foreground PFC control register, without the CLUT start bit
+        uint32_t FGCOLR;         ///< Foreground color register
+        uint32_t FGMAR;          ///< Foreground memory address register
+        uint32_t FGOR;           ///< Foreground offset register
+        uint32_t BGPFCCR;        ///< Background PFC control register
+        uint32_t BGMAR;          ///< Background memory address register
+        uint32_t BGOR;           ///< Background offset register
+        uint32_t OPFCCR;         ///< Output PFC control register
+        uint32_t OCOLR;          ///< Output color register
+        uint32_t OMAR;           ///< Output memory address register
+        uint32_t OOR;            ///< Output offset register
+        uint32_t NLR;            ///< Number of lines register
+        const uint8_t* clut;     ///< CLUT used by the transfer, 0 if none
+        uint32_t clutGeneration; ///< The clutChanged() count when the BlitOp was added
+    };
+
+    /**
+     * @fn DMA2DCommandList::DMA2DCommandList(Command* mem, atomic_t n);
+     *
+     * @brief Constructs a command list.
+     *
+     * @param mem Pointer to the memory used to store the commands.
+     * @param n   Number of commands the memory can contain.
+     */
+    DMA2DCommandList(Command* mem, atomic_t n);
+
+    virtual bool isEmpty();
+
+    virtual bool isFull();
+
+    /**
+     * @fn virtual void DMA2DCommandList::pushCopyOf(const touchgfx::BlitOp& op);
+     *
+     * @brief Adds a BlitOp and its register image to the queue.
+     *
+     * @param op The BlitOp to add.
+     */
+    virtual void pushCopyOf(const touchgfx::BlitOp& op);
+
+    /**
+     * @fn void DMA2DCommandList::start(const touchgfx::BlitOp& op, DMA2D_TypeDef* dma2d);
+     *
+     * @brief Program the DMA2D with the first command in the queue.
+     *
+     *        Program the DMA2D with the first command in the queue. If the command needs a CLUT
+     *        which is not already loaded, the CLUT load is started with the CTC interrupt
+     *        enabled and the transfer itself is started by clutLoaded().
+     *
+     * @param op    The BlitOp being executed, must be the first in the queue.
+     * @param dma2d The DMA2D peripheral.
+     */
+    void start(const touchgfx::BlitOp& op, DMA2D_TypeDef* dma2d);
+
+    /**
+     * @fn void DMA2DCommandList::clutLoaded(DMA2D_TypeDef* dma2d);
+     *
+     * @brief Start the transfer waiting for a CLUT load to complete.
+     *
+     *        Start the transfer waiting for a CLUT load to complete. Called from the CLUT
+     *        transfer complete interrupt.
+     *
+     * @param dma2d The DMA2D peripheral.
+     */
+    void clutLoaded(DMA2D_TypeDef* dma2d);
+
+    /**
+     * @fn void DMA2DCommandList::invalidateClut();
+     *
+     * @brief Forget the loaded CLUT.
+     *
+     *        Forget the loaded CLUT, e.g. after a reset of the DMA2D or when the DMA2D CLUT
+     *        has been loaded by other code.
+     */
+    void invalidateClut()
+    {
+        loadedClut = 0;
+    }
+
+    /**
+     * @fn void DMA2DCommandList::clutChanged();
+     *
+     * @brief The colors of a CLUT may have changed.
+     *
+     *        The colors of a CLUT may have changed without its address changing, e.g. the CLUT
+     *        of a dynamic bitmap, or an L8 bitmap moved to the memory of another bitmap. BlitOps
+     *        added from now on load their CLUT again, even if a CLUT at the same address is
+     *        loaded. Called by the thread adding BlitOps.
+     */
+    void clutChanged()
+    {
+        clutGeneration++;
+    }
+
+    /**
+     * @fn uint32_t DMA2DCommandList::getClutLoads() const;
+     *
+     * @brief Gets the number of CLUT loads started.
+     *
+     * @return The number of CLUT loads.
+     */
+    uint32_t getClutLoads() const
+    {
+        return clutLoads;
+    }
+
+    /**
+     * @fn static void DMA2DCommandList::buildCommand(const touchgfx::BlitOp& op, Command& command);
+     *
+     * @brief Compute the DMA2D register values performing a BlitOp.
+     *
+     * @param       op      The BlitOp.
+     * @param [out] command The command to fill in.
+     */
+    static void buildCommand(const touchgfx::BlitOp& op, Command& command);
+
+protected:
+    virtual void pop();
+
+    virtual const touchgfx::BlitOp* first();
+
+    Command* q;                    ///< Pointer to the queue memory
+    atomic_t capacity;             ///< The number of commands the queue can contain
+    atomic_t head;                 ///< Index to the head command
+    atomic_t tail;                 ///< Index to the tail command
+    const uint8_t* loadedClut;     ///< The CLUT currently loaded in the DMA2D, 0 if unknown
+    uint32_t loadedClutGeneration; ///< The clutChanged() count of the BlitOp which loaded loadedClut
+    uint32_t clutGeneration;       ///< The number of clutChanged() calls
+    volatile uint32_t pendingCR;   ///< Control register to write when the CLUT load completes
+    uint32_t clutLoads;            ///< Number of CLUT loads started
+
+private:
+    static uint32_t getChromARTInputFormat(touchgfx::Bitmap::BitmapFormat format);
+    static uint32_t getChromARTOutputFormat(touchgfx::Bitmap::BitmapFormat format);
+};
+
+#endif // DMA2DCOMMANDLIST_HPP
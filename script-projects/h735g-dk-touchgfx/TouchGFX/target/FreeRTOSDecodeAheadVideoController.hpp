@@ -0,0 +1,126 @@
+#ifndef FREERTOSDECODEAHEADVIDEOCONTROLLER_HPP
+#define FREERTOSDECODEAHEADVIDEOCONTROLLER_HPP
+
+#include <gui/common/DecodeAheadVideoController.hpp>
+#include <cmsis_os2.h>
+#include <string.h>
+
+/**
+ * @class FreeRTOSDecodeAheadVideoController
+ *
+ * @brief A DecodeAheadVideoController with the decoder task in a FreeRTOS task.
+ *
+ *        A DecodeAheadVideoController with the decoder task in a FreeRTOS task created
+ *        through CMSIS-RTOS2. The task runs below the priority of the TouchGFX task, so
+ *        decoding only uses the time the UI leaves between frames, and waits on a binary
+ *        semaphore released for every frame requested. A mutex guards the streams shared
+ *        with the TouchGFX task, which only tries to take it in the tick.
+ *
+ *        Frames are decoded in the tick requesting them until startDecoderTask() is called
+ *        from the TouchGFX task, after the kernel is started and before a video is played.
+ *        The stack of the task must fit the MJPEGDecoder, and the kernel heap the stack of
+ *        the task, see configTOTAL_HEAP_SIZE.
+ *
+ * @see DecodeAheadVideoController
+ */
+template <uint32_t no_streams, uint32_t width, uint32_t height, touchgfx::Bitmap::BitmapFormat output_format>
+class FreeRTOSDecodeAheadVideoController : public DecodeAheadVideoController<no_streams, width, height, output_format>
+{
+public:
+    /**
+     * @fn FreeRTOSDecodeAheadVideoController::FreeRTOSDecodeAheadVideoController();
+     *
+     * @brief Default constructor.
+     */
+    FreeRTOSDecodeAheadVideoController()
+        : DecodeAheadVideoController<no_streams, width, height, output_format>(),
+          decoderTask(0), decodeRequest(0), streamMutex(0)
+    {
+    }
+
+    /**
+     * @fn bool FreeRTOSDecodeAheadVideoController::startDecoderTask(uint32_t stackSize = 1024 * 4, osPriority_t priority = osPriorityBelowNormal);
+     *
+     * @brief Starts the decoder task.
+     *
+     * @param stackSize The stack size of the task in bytes.
+     * @param priority  The priority of the task, below the TouchGFX task.
+     *
+     * @return True if the task runs, otherwise frames are decoded in the tick.
+     */
+    bool startDecoderTask(uint32_t stackSize = 1024 * 4, osPriority_t priority = osPriorityBelowNormal)
+    {
+        if (decoderTask != 0)
+        {
+            return true;
+        }
+        decodeRequest = osSemaphoreNew(1, 0, NULL); // Binary semaphore
+        streamMutex = osMutexNew(NULL);
+        if (decodeRequest == 0 || streamMutex == 0)
+        {
+            return false;
+        }
+
+        osThreadAttr_t attributes;
+        memset(&attributes, 0, sizeof(attributes));
+        attributes.name = "VideoDecoderTask";
+        attributes.stack_size = stackSize;
+        attributes.priority = priority;
+        decoderTask = osThreadNew(decoderTaskFunction, this, &attributes);
+        return decoderTask != 0;
+    }
+
+protected:
+    virtual void signalDecoderTask()
+    {
+        if (decoderTask != 0)
+        {
+            osSemaphoreRelease(decodeRequest);
+        }
+        else
+        {
+            DecodeAheadVideoController<no_streams, width, height, output_format>::signalDecoderTask();
+        }
+    }
+
+    virtual bool waitForDecodeRequest()
+    {
+        // Requests made while decoding are decoded in one pass
+        return osSemaphoreAcquire(decodeRequest, osWaitForever) == osOK;
+    }
+
+    virtual void lockStreams()
+    {
+        // The mutex is created before the task, which may lock it before decoderTask is set
+        if (streamMutex != 0)
+        {
+            osMutexAcquire(streamMutex, osWaitForever);
+        }
+    }
+
+    virtual bool tryLockStreams()
+    {
+        return streamMutex == 0 || osMutexAcquire(streamMutex, 0) == osOK;
+    }
+
+    virtual void unlockStreams()
+    {
+        if (streamMutex != 0)
+        {
+            osMutexRelease(streamMutex);
+        }
+    }
+
+private:
+    osThreadId_t decoderTask;
+    osSemaphoreId_t decodeRequest;
+    osMutexId_t streamMutex;
+
+    static void decoderTaskFunction(void* controller)
+    {
+        static_cast<FreeRTOSDecodeAheadVideoController*>(controller)->decoderTaskEntry();
+        osThreadExit();
+    }
+};
+
+#endif // FREERTOSDECODEAHEADVIDEOCONTROLLER_HPP
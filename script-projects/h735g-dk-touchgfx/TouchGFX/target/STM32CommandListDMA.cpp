@@ -0,0 +1,92 @@
+#include "stm32h7xx_hal.h"
+#include "stm32h7xx_hal_dma2d.h"
+#include <STM32CommandListDMA.hpp>
+#include <touchgfx/hal/HAL.hpp>
+
+using namespace touchgfx;
+
+extern "C" DMA2D_HandleTypeDef hdma2d;
+
+/* The DMA waiting for a CLUT load to complete */
+static STM32CommandListDMA* clutLoadingDMA = 0;
+
+extern "C" {
+    static void DMA2D_XferCpltCallback(DMA2D_HandleTypeDef* handle)
+    {
+        (void)handle; // Unused argument
+        HAL::getInstance()->signalDMAInterrupt();
+    }
+
+    void HAL_DMA2D_CLUTLoadingCpltCallback(DMA2D_HandleTypeDef* handle)
+    {
+        (void)handle; // Unused argument
+        if (clutLoadingDMA)
+        {
+            clutLoadingDMA->signalCLUTLoaded();
+        }
+    }
+}
+
+STM32CommandListDMA::STM32CommandListDMA()
+    : DMA_Interface(dma_queue), dma_queue(queue_storage, sizeof(queue_storage) / sizeof(queue_storage[0]))
+{
+    clutLoadingDMA = this;
+}
+
+STM32CommandListDMA::~STM32CommandListDMA()
+{
+    /* Disable DMA2D global Interrupt */
+    NVIC_DisableIRQ(DMA2D_IRQn);
+    clutLoadingDMA = 0;
+}
+
+void STM32CommandListDMA::initialize()
+{
+    /* Ensure DMA2D Clock is enabled */
+    __HAL_RCC_DMA2D_CLK_ENABLE();
+    __HAL_RCC_DMA2D_FORCE_RESET();
+    __HAL_RCC_DMA2D_RELEASE_RESET();
+
+    /* The CLUT memory does not survive the reset */
+    dma_queue.invalidateClut();
+
+    /* Add transfer complete callback function */
+    hdma2d.XferCpltCallback = DMA2D_XferCpltCallback;
+
+    /* Enable DMA2D global Interrupt */
+    NVIC_EnableIRQ(DMA2D_IRQn);
+}
+
+BlitOperations STM32CommandListDMA::getBlitCaps()
+{
+    return static_cast<BlitOperations>(BLIT_OP_FILL
+                                       | BLIT_OP_FILL_WITH_ALPHA
+                                       | BLIT_OP_COPY
+                                       | BLIT_OP_COPY_L8
+                                       | BLIT_OP_COPY_WITH_ALPHA
+                                       | BLIT_OP_COPY_ARGB8888
+                                       | BLIT_OP_COPY_ARGB8888_WITH_ALPHA
+                                       | BLIT_OP_COPY_A4
+                                       | BLIT_OP_COPY_A8);
+}
+
+void STM32CommandListDMA::signalCLUTLoaded()
+{
+    dma_queue.clutLoaded(DMA2D);
+}
+
+/*
+ * The registers values were computed by DMA2DCommandList when the BlitOp was queued.
+ * A BLIT_OP_COPY_L8 with a CLUT which is not loaded already returns once the CLUT
+ * load has been started, the transfer is started from the CLUT transfer complete
+ * interrupt.
+ */
+void STM32CommandListDMA::setupDataCopy(const BlitOp& blitOp)
+{
+    dma_queue.start(blitOp, DMA2D);
+}
+
+void STM32CommandListDMA::setupDataFill(const BlitOp& blitOp)
+{
+    dma_queue.start(blitOp, DMA2D);
+}
@@ -0,0 +1,128 @@
+#ifndef STM32COMMANDLISTDMA_HPP
+#define STM32COMMANDLISTDMA_HPP
+
+#include <DMA2DCommandList.hpp>
+#include <touchgfx/Bitmap.hpp>
+#include <touchgfx/hal/DMA.hpp>
+
+/**
+ * @class STM32CommandListDMA
+ *
+ * @brief DMA_Interface for the DMA2D queueing the register image of each BlitOp.
+ *
+ *        DMA_Interface for the DMA2D queueing BlitOps in a DMA2DCommandList, so starting a
+ *        transfer only writes registers computed when the BlitOp was queued, and a CLUT is
+ *        only loaded when it differs from the CLUT already loaded. Used by TouchGFXHAL in
+ *        place of the generated STM32DMA.
+ *
+ *        The loaded CLUT is identified by its address. If the colors of a CLUT may have
+ *        changed at the same address, call clutChanged() before queueing BlitOps using it.
+ *        TouchGFXHAL does so at the start of every frame, which covers CLUTs of dynamic
+ *        bitmaps changed by the application and L8 bitmaps moved by BitmapCache compaction.
+ *
+ * @sa touchgfx::DMA_Interface, DMA2DCommandList
+ */
+class STM32CommandListDMA : public touchgfx::DMA_Interface
+{
+public:
+    /**
+     * @fn STM32CommandListDMA::STM32CommandListDMA();
+     *
+     * @brief Default constructor.
+     */
+    STM32CommandListDMA();
+
+    /**
+     * @fn STM32CommandListDMA::~STM32CommandListDMA();
+     *
+     * @brief Destructor.
+     */
+    virtual ~STM32CommandListDMA();
+
+    /**
+     * @fn touchgfx::DMAType STM32CommandListDMA::getDMAType()
+     *
+     * @brief Function for obtaining the DMA type of the concrete DMA_Interface implementation.
+     *
+     * @return DMA_TYPE_CHROMART.
+     */
+    virtual touchgfx::DMAType getDMAType(void)
+    {
+        return touchgfx::DMA_TYPE_CHROMART;
+    }
+
+    /**
+     * @fn touchgfx::BlitOperations STM32CommandListDMA::getBlitCaps();
+     *
+     * @brief Gets the blit capabilities.
+     *
+     *        Gets the blit capabilities, the same as those of STM32DMA.
+     *
+     * @return Currently supported blitcaps.
+     */
+    virtual touchgfx::BlitOperations getBlitCaps();
+
+    /**
+     * @fn void STM32CommandListDMA::initialize();
+     *
+     * @brief Perform hardware specific initialization.
+     */
+    virtual void initialize();
+
+    /**
+     * @fn void STM32CommandListDMA::signalDMAInterrupt()
+     *
+     * @brief Raises a DMA interrupt signal.
+     */
+    virtual void signalDMAInterrupt()
+    {
+        executeCompleted();
+    }
+
+    /**
+     * @fn void STM32CommandListDMA::signalCLUTLoaded()
+     *
+     * @brief Raises a CLUT transfer complete signal.
+     *
+     *        Raises a CLUT transfer complete signal. Starts the transfer which was waiting
+     *        for its CLUT to be loaded.
+     */
+    void signalCLUTLoaded();
+
+    /**
+     * @fn void STM32CommandListDMA::clutChanged()
+     *
+     * @brief The colors of a CLUT may have changed.
+     *
+     * @sa DMA2DCommandList::clutChanged()
+     */
+    void clutChanged()
+    {
+        dma_queue.clutChanged();
+    }
+
+protected:
+    /**
+     * @fn virtual void STM32CommandListDMA::setupDataCopy(const touchgfx::BlitOp& blitOp);
+     *
+     * @brief Configures the DMA for copying data to the frame buffer.
+     *
+     * @param blitOp Details on the copy to perform.
+     */
+    virtual void setupDataCopy(const touchgfx::BlitOp& blitOp);
+
+    /**
+     * @fn virtual void STM32CommandListDMA::setupDataFill(const touchgfx::BlitOp& blitOp);
+     *
+     * @brief Configures the DMA for "filling" the frame-buffer with a single color.
+     *
+     * @param blitOp Details on the "fill" to perform.
+     */
+    virtual void setupDataFill(const touchgfx::BlitOp& blitOp);
+
+private:
+    DMA2DCommandList dma_queue;
+    DMA2DCommandList::Command queue_storage[96];
+};
+
+#endif // STM32COMMANDLISTDMA_HPP
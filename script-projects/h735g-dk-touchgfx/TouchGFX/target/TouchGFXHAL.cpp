@@ -25,9 +25,55 @@
 #include "main.h"
 #include "FreeRTOS.h"
 #include "task.h"
+#ifdef TOUCHGFX_RENDER_PROFILER
+#include <gui/common/RenderProfiler.hpp>
+#endif
+#ifdef TOUCHGFX_BITMAP_CACHE
+#include <BitmapDatabase.hpp>
+#include <touchgfx/BitmapCache.hpp>
+#endif
 
 using namespace touchgfx;
 
+#ifdef TOUCHGFX_BITMAP_CACHE
+#ifndef TOUCHGFX_BITMAP_CACHE_SIZE
+#define TOUCHGFX_BITMAP_CACHE_SIZE 0x400000
+#endif
+#endif
+
+#ifdef TOUCHGFX_RENDER_PROFILER
+namespace
+{
+/** Writes the RenderProfiler export to ITM stimulus port 0, read with e.g. the SWV console. */
+class SWOWriter
+{
+public:
+    SWOWriter()
+        : callback(this, &SWOWriter::write)
+    {
+    }
+
+    GenericCallback<const char*>& getCallback()
+    {
+        return callback;
+    }
+
+private:
+    void write(const char* text)
+    {
+        while (*text)
+        {
+            ITM_SendChar(*text++);
+        }
+    }
+
+    Callback<SWOWriter, const char*> callback;
+};
+
+SWOWriter swoWriter;
+} // namespace
+#endif
+
 void TouchGFXHAL::initialize()
 {
     // Calling parent implementation of initialize().
@@ -44,6 +90,20 @@ void TouchGFXHAL::initialize()
     instrumentation.init();
     setMCUInstrumentation(&instrumentation);
     enableMCULoadCalculation(true);
+
+#ifdef TOUCHGFX_RENDER_PROFILER
+    // Time every widget drawn with the DWT cycle counter, exported over SWO once a second
+    RenderProfiler::setClockFrequency(SystemCoreClock);
+    RenderProfiler::setExport(&swoWriter.getCallback(), 60);
+    RenderProfiler::enable(true);
+#endif
+
+#ifdef TOUCHGFX_BITMAP_CACHE
+    // Cache the bitmaps drawn from OCTOSPI flash in HyperRAM after the framebuffers set above,
+    // evicting the least recently drawn
+    BitmapCache::registerBitmapDatabase(BitmapDatabase::getInstance(), BitmapDatabase::getInstanceSize(),
+                                        reinterpret_cast<uint16_t*>(getEndOfFrameBuffers()), TOUCHGFX_BITMAP_CACHE_SIZE);
+#endif
 }
 
 void TouchGFXHAL::taskEntry()
@@ -66,6 +126,13 @@ void TouchGFXHAL::taskEntry()
     }
 }
 
+bool TouchGFXHAL::beginFrame()
+{
+    // Dynamic bitmaps may have new colors, and BitmapCache may have moved L8 bitmaps
+    commandListDMA.clutChanged();
+    return TouchGFXGeneratedHAL::beginFrame();
+}
+
 /**
  * Gets the frame buffer address used by the TFT controller.
  *
@@ -81,6 +148,22 @@ uint16_t* TouchGFXHAL::getTFTFrameBuffer() const
     return TouchGFXGeneratedHAL::getTFTFrameBuffer();
 }
 
+uint8_t* TouchGFXHAL::getEndOfFrameBuffers() const
+{
+    const uint32_t frameBufferSize = lcd().framebufferStride() * FRAME_BUFFER_HEIGHT;
+    const uint16_t* const frameBuffers[] = { frameBuffer0, frameBuffer1, frameBuffer2 };
+    uintptr_t end = 0;
+    for (unsigned i = 0; i < sizeof(frameBuffers) / sizeof(frameBuffers[0]); i++)
+    {
+        if (frameBuffers[i] != 0)
+        {
+            end = MAX(end, reinterpret_cast<uintptr_t>(frameBuffers[i]) + frameBufferSize);
+        }
+    }
+    // The data cache of the Cortex-M7 is maintained in lines of 32 bytes
+    return reinterpret_cast<uint8_t*>((end + 31) & ~static_cast<uintptr_t>(31));
+}
+
 /**
  * Sets the frame buffer address used by the TFT controller.
  *
@@ -121,6 +204,32 @@ void TouchGFXHAL::flushFrameBuffer(const touchgfx::Rect& rect)
     SCB_CleanInvalidateDCache();
 }
 
+/**
+ * Copies data, reading flash which is not memory mapped through the FlashDataReader.
+ *
+ * @param [out] dest     Pointer to destination memory.
+ * @param [in]  src      Pointer to source memory.
+ * @param       numBytes Number of bytes to copy.
+ *
+ * @return true if the copy succeeded, false if copy was not performed.
+ */
+bool TouchGFXHAL::blockCopy(void* RESTRICT dest, const void* RESTRICT src, uint32_t numBytes)
+{
+    bool copied = true;
+    if (flashDataReader && !flashDataReader->addressIsAddressable(src))
+    {
+        flashDataReader->copyData(src, dest, numBytes);
+    }
+    else
+    {
+        copied = TouchGFXGeneratedHAL::blockCopy(dest, src, numBytes);
+    }
+
+    // The copy may be read by DMA2D, e.g. a bitmap copied to the bitmap cache
+    SCB_CleanDCache_by_Addr((uint32_t*)((uint32_t)dest & ~31u), numBytes + ((uint32_t)dest & 31u));
+    return copied;
+}
+
 /**
  * Configures the interrupts relevant for TouchGFX. This primarily entails setting
  * the interrupt priorities for the DMA and LCD interrupts.
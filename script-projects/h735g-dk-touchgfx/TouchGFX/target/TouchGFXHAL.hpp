@@ -23,6 +23,9 @@
 
 #include <TouchGFXGeneratedHAL.hpp>
 #include <CortexMMCUInstrumentation.hpp>
+#include <STM32CommandListDMA.hpp>
+#include <touchgfx/hal/FlashDataReader.hpp>
+#include <platform/driver/lcd/LCD24bppSpecialized.hpp>
 
 /**
  * @class TouchGFXHAL
@@ -39,16 +42,20 @@ public:
      *
      * @brief Constructor.
      *
-     *        Constructor. Initializes members.
+     *        Constructor. Initializes members. The DMA2D is driven by the STM32CommandListDMA
+     *        of the HAL rather than by the given DMA interface, and the framework draws
+     *        through the LCD24bppSpecialized of the HAL rather than through the given LCD.
      *
-     * @param [in,out] dma     Reference to DMA interface.
-     * @param [in,out] display Reference to LCD interface.
+     * @param [in,out] dma     Reference to DMA interface, not used.
+     * @param [in,out] display Reference to LCD interface, not used.
      * @param [in,out] tc      Reference to Touch Controller driver.
      * @param width            Width of the display.
      * @param height           Height of the display.
      */
-    TouchGFXHAL(touchgfx::DMA_Interface& dma, touchgfx::LCD& display, touchgfx::TouchController& tc, uint16_t width, uint16_t height) : TouchGFXGeneratedHAL(dma, display, tc, width, height)
+    TouchGFXHAL(touchgfx::DMA_Interface& dma, touchgfx::LCD& display, touchgfx::TouchController& tc, uint16_t width, uint16_t height) : TouchGFXGeneratedHAL(commandListDMA, specializedDisplay, tc, width, height), flashDataReader(0)
     {
+        (void)dma;     // Replaced by commandListDMA
+        (void)display; // Replaced by specializedDisplay
     }
 
     /**
@@ -100,6 +107,18 @@ public:
      */
     virtual void enableLCDControllerInterrupt();
 
+    /**
+     * @fn virtual bool TouchGFXHAL::beginFrame();
+     *
+     * @brief Called when beginning to rendering a frame.
+     *
+     *        Called when beginning to rendering a frame. CLUTs may have changed since the
+     *        previous frame, so they are loaded again by the DMA2D.
+     *
+     * @return true if rendering can begin, false otherwise.
+     */
+    virtual bool beginFrame();
+
     /**
      * @fn virtual void TouchGFXHAL::flushFrameBuffer();
      *
@@ -129,6 +148,40 @@ public:
      */
     virtual void flushFrameBuffer(const touchgfx::Rect& rect);
 
+    /**
+     * @fn virtual bool TouchGFXHAL::blockCopy(void* RESTRICT dest, const void* RESTRICT src, uint32_t numBytes);
+     *
+     * @brief Copies data, e.g. a bitmap copied to the bitmap cache.
+     *
+     *        Copies data, e.g. a bitmap copied to the bitmap cache by Bitmap::cache(). Data
+     *        the MCU cannot address is read through the FlashDataReader, if one is set. The
+     *        copy is cleaned from the data cache, so DMA2D reads the copied data.
+     *
+     * @param [out] dest     Pointer to destination memory.
+     * @param [in]  src      Pointer to source memory.
+     * @param       numBytes Number of bytes to copy.
+     *
+     * @return true if the copy succeeded, false if copy was not performed.
+     */
+    virtual bool blockCopy(void* RESTRICT dest, const void* RESTRICT src, uint32_t numBytes);
+
+    /**
+     * @fn void TouchGFXHAL::setFlashDataReader(touchgfx::FlashDataReader* reader);
+     *
+     * @brief Sets the reader of the flash that is not memory mapped.
+     *
+     * @param [in] reader The flash data reader, 0 if all flash is memory mapped.
+     */
+    void setFlashDataReader(touchgfx::FlashDataReader* reader)
+    {
+        flashDataReader = reader;
+    }
+
+    virtual touchgfx::FlashDataReader* getFlashDataReader() const
+    {
+        return flashDataReader;
+    }
+
 protected:
     /**
      * @fn virtual uint16_t* TouchGFXHAL::getTFTFrameBuffer() const;
@@ -152,8 +205,23 @@ protected:
      */
     virtual void setTFTFrameBuffer(uint16_t* adr);
 
+    /**
+     * @fn uint8_t* TouchGFXHAL::getEndOfFrameBuffers() const;
+     *
+     * @brief Gets the first address after the framebuffers.
+     *
+     *        Gets the first address after the framebuffers and the animation storage given
+     *        to setFrameBufferStartAddresses(), aligned to a data cache line.
+     *
+     * @return The first address after the framebuffers.
+     */
+    uint8_t* getEndOfFrameBuffers() const;
+
 private:
+    STM32CommandListDMA commandListDMA;
+    touchgfx::LCD24bppSpecialized specializedDisplay;
     touchgfx::CortexMMCUInstrumentation instrumentation;
+    touchgfx::FlashDataReader* flashDataReader;
 };
 
 /* USER CODE END TouchGFXHAL.hpp */
@@ -56,6 +56,28 @@ set(sources_SRCS ${sources_SRCS}
     ${CMAKE_CURRENT_SOURCE_DIR}/Drivers/STM32H7xx_HAL_Driver/Src/stm32h7xx_hal_rcc_ex.c
     ${CMAKE_CURRENT_SOURCE_DIR}/Drivers/STM32H7xx_HAL_Driver/Src/stm32h7xx_hal_tim.c
     ${CMAKE_CURRENT_SOURCE_DIR}/Drivers/STM32H7xx_HAL_Driver/Src/stm32h7xx_hal_tim_ex.c
+    ${CMAKE_CURRENT_SOURCE_DIR}/Middlewares/ST/touchgfx/framework/source/touchgfx/BitmapCache.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/Middlewares/ST/touchgfx/framework/source/touchgfx/canvas_widget_renderer/CanvasWidgetRenderer.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/Middlewares/ST/touchgfx/framework/source/touchgfx/containers/BlitScrollableContainer.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/Middlewares/ST/touchgfx/framework/source/touchgfx/containers/CachedGeometryContainer.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/Middlewares/ST/touchgfx/framework/source/touchgfx/containers/IndexedContainer.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/Middlewares/ST/touchgfx/framework/source/touchgfx/containers/ScrollBlitter.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/Middlewares/ST/touchgfx/framework/source/touchgfx/widgets/Button.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/Middlewares/ST/touchgfx/framework/source/touchgfx/widgets/ButtonWithIcon.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/Middlewares/ST/touchgfx/framework/source/touchgfx/widgets/CachedTextArea.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/Middlewares/ST/touchgfx/framework/source/touchgfx/widgets/canvas/Canvas.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/Middlewares/ST/touchgfx/framework/source/touchgfx/widgets/canvas/CanvasWidget.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/Middlewares/ST/touchgfx/framework/source/touchgfx/widgets/canvas/PainterRGB565.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/Middlewares/ST/touchgfx/framework/source/touchgfx/widgets/canvas/PainterRGB888.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/Middlewares/ST/touchgfx/framework/source/touchgfx/widgets/canvas/PainterRGB888Bitmap.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/Middlewares/ST/touchgfx/framework/source/touchgfx/widgets/canvas/PainterRGB888L8Bitmap.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/Middlewares/ST/touchgfx/framework/source/touchgfx/widgets/GlyphAtlas.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/Middlewares/ST/touchgfx/framework/source/touchgfx/widgets/Image.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/Middlewares/ST/touchgfx/framework/source/touchgfx/widgets/NumericTextArea.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/Middlewares/ST/touchgfx/framework/source/touchgfx/widgets/RadioButton.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/Middlewares/ST/touchgfx/framework/source/touchgfx/widgets/ScalableImage.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/Middlewares/ST/touchgfx/framework/source/touchgfx/widgets/TextureMapper.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/Middlewares/ST/touchgfx/framework/source/touchgfx/widgets/TiledImage.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/Middlewares/Third_Party/FreeRTOS/Source/CMSIS_RTOS_V2/cmsis_os2.c
     ${CMAKE_CURRENT_SOURCE_DIR}/Middlewares/Third_Party/FreeRTOS/Source/croutine.c
     ${CMAKE_CURRENT_SOURCE_DIR}/Middlewares/Third_Party/FreeRTOS/Source/event_groups.c
@@ -95,12 +117,21 @@ set(sources_SRCS ${sources_SRCS}
     ${CMAKE_CURRENT_SOURCE_DIR}/TouchGFX/generated/texts/src/LanguageGb.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/TouchGFX/generated/texts/src/Texts.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/TouchGFX/generated/texts/src/TypedTextDatabase.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/TouchGFX/gui/src/common/DirtyRegion.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/TouchGFX/gui/src/common/FrontendApplication.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/TouchGFX/gui/src/common/IndexedCachedFont.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/TouchGFX/gui/src/common/IndexedFontCache.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/TouchGFX/gui/src/common/KernedGeneratedFont.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/TouchGFX/gui/src/common/KernedUnmappedDataFont.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/TouchGFX/gui/src/common/KerningLookup.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/TouchGFX/gui/src/common/RenderProfiler.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/TouchGFX/gui/src/containers/ScrollList_myContainer.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/TouchGFX/gui/src/model/Model.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/TouchGFX/gui/src/screen1_screen/Screen1Presenter.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/TouchGFX/gui/src/screen1_screen/Screen1View.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/TouchGFX/target/CortexMMCUInstrumentation.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/TouchGFX/target/DMA2DCommandList.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/TouchGFX/target/STM32CommandListDMA.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/TouchGFX/target/STM32TouchController.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/TouchGFX/target/TouchGFXGPIO.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/TouchGFX/target/TouchGFXHAL.cpp